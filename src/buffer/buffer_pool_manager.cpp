@@ -37,7 +37,8 @@ BufferPoolManager::~BufferPoolManager() {
 frame_id_t BufferPoolManager::findVictimPage() {
   frame_id_t frameId = INVALID_PAGE_ID;
   if (free_list_.empty()) {
-    bool res = replacer_->Victim(&frameId);
+    // prefer victims that can be written back without forcing the log
+    bool res = replacer_->Victim(&frameId, [this](frame_id_t frame_id) { return isLogDurable(&pages_[frame_id]); });
     if (!res) {
       return INVALID_PAGE_ID;
     }
@@ -48,6 +49,41 @@ frame_id_t BufferPoolManager::findVictimPage() {
   return frameId;
 }
 
+// WAL: a dirty page may only reach the disk after the log records up to its LSN did. Pages whose LSN was never set
+// carry no log records, and an LSN this log never assigned (e.g. redone from an earlier log) has nothing to wait for.
+bool BufferPoolManager::isLogDurable(Page *page) {
+  if (!page->IsDirty() || !page->has_lsn_ || !enable_logging || log_manager_ == nullptr) {
+    return true;
+  }
+  lsn_t lsn = page->GetLSN();
+  return lsn <= log_manager_->GetPersistentLSN() || lsn >= log_manager_->GetNextLSN();
+}
+
+// The log is flushed with latch_ released, the frame stays pinned meanwhile so it is neither evicted nor deleted
+void BufferPoolManager::flushLogFor(std::unique_lock<std::mutex> *lock, frame_id_t frame_id) {
+  auto &page = pages_[frame_id];
+  lsn_t lsn = page.GetLSN();
+  if (page.pin_count_++ == 0) {
+    replacer_->Pin(frame_id);
+  }
+  lock->unlock();
+  log_manager_->Flush(lsn);
+  lock->lock();
+  if (--page.pin_count_ == 0) {
+    replacer_->Unpin(frame_id);
+  }
+}
+
+// 外部调用他需要加锁
+void BufferPoolManager::writeBackPage(std::unique_lock<std::mutex> *lock, frame_id_t frame_id) {
+  auto &page = pages_[frame_id];
+  // the page may be written again while the log is flushed
+  while (!isLogDurable(&page)) {
+    flushLogFor(lock, frame_id);
+  }
+  disk_manager_->WritePage(page.GetPageId(), page.GetData());
+}
+
 Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
@@ -57,37 +93,45 @@ Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
   // if (page_id == INVALID_PAGE_ID) return nullptr;
-  std::lock_guard<std::mutex> lk(latch_);
+  std::unique_lock<std::mutex> lk(latch_);
   frame_id_t frameId = INVALID_PAGE_ID;
 
-  auto it = page_table_.find(page_id);
-  if (it != page_table_.end()) {
-    frameId = it->second;
-    auto &page = pages_[frameId];
-    if (page.GetPinCount() == 0) {
-      replacer_->Pin(frameId);
+  while (true) {
+    auto it = page_table_.find(page_id);
+    if (it != page_table_.end()) {
+      frameId = it->second;
+      auto &page = pages_[frameId];
+      if (page.GetPinCount() == 0) {
+        replacer_->Pin(frameId);
+      }
+      page.pin_count_ += 1;
+      return &page;
     }
-    page.pin_count_ += 1;
-    return &page;
-  }
-  frameId = findVictimPage();
+    frameId = findVictimPage();
 
-  if (frameId == INVALID_PAGE_ID) {
-    // std::cout << "Fetch page id" << page_id << " failure " << std::endl;
-    // std::cout << free_list_.size() << " / " << replacer_->Size() << " / " << std::endl;
-    // throw Exception("findVictim Page 有问题在FetchPageImpl, 有过多page没有unpin");
-    return nullptr;
+    if (frameId == INVALID_PAGE_ID) {
+      // std::cout << "Fetch page id" << page_id << " failure " << std::endl;
+      // std::cout << free_list_.size() << " / " << replacer_->Size() << " / " << std::endl;
+      // throw Exception("findVictim Page 有问题在FetchPageImpl, 有过多page没有unpin");
+      return nullptr;
+    }
+    if (isLogDurable(&pages_[frameId])) {
+      break;
+    }
+    // another thread may load the page while the latch is released, so start over after the log flush
+    flushLogFor(&lk, frameId);
   }
   auto &page = pages_[frameId];
   page_id_t old_page_id = page.page_id_;
   if (page.IsDirty()) {
-    disk_manager_->WritePage(old_page_id, page.GetData());
+    writeBackPage(&lk, frameId);
   }
   page_table_.erase(old_page_id);
   replacer_->Pin(frameId);
   page_table_.insert({page_id, frameId});
   // page->ResetMemory();
   page.is_dirty_ = false;
+  page.has_lsn_ = false;
   page.page_id_ = page_id;
   page.pin_count_ = 1;
   disk_manager_->ReadPage(page.page_id_, page.GetData());
@@ -120,7 +164,7 @@ bool BufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
 
 // 外部使用这个函数需要加锁
 bool BufferPoolManager::FlushPageImpl(page_id_t page_id) {
-  std::lock_guard<std::mutex> lk(latch_);
+  std::unique_lock<std::mutex> lk(latch_);
   // Make sure you call DiskManager::WritePage!
 
   auto it = page_table_.find(page_id);
@@ -131,7 +175,7 @@ bool BufferPoolManager::FlushPageImpl(page_id_t page_id) {
   // WritePage需不需要检查page的数据是否超过4096
   auto &page = pages_[frameId];
 
-  disk_manager_->WritePage(page.GetPageId(), page.GetData());
+  writeBackPage(&lk, frameId);
 
   page.is_dirty_ = false;
 
@@ -144,7 +188,7 @@ Page *BufferPoolManager::NewPageImpl(page_id_t *page_id) {
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
-  std::lock_guard<std::mutex> lk(latch_);
+  std::unique_lock<std::mutex> lk(latch_);
   bool notunpinned = true;
   for (size_t index = 0; index < pool_size_; ++index) {
     if (pages_[index].GetPinCount() == 0) {
@@ -155,15 +199,19 @@ Page *BufferPoolManager::NewPageImpl(page_id_t *page_id) {
   if (notunpinned) {
     return nullptr;
   }
-  page_id_t pageId = disk_manager_->AllocatePage();
   frame_id_t victimId = findVictimPage();
+  while (victimId != INVALID_PAGE_ID && !isLogDurable(&pages_[victimId])) {
+    flushLogFor(&lk, victimId);
+    victimId = findVictimPage();
+  }
   if (victimId == INVALID_PAGE_ID) {
     // throw Exception("findVictimPage有问题在NewPageImpl, 有过多页面用完没unpin");
     return nullptr;
   }
+  page_id_t pageId = disk_manager_->AllocatePage();
   auto &page = pages_[victimId];
   if (page.IsDirty()) {
-    disk_manager_->WritePage(page.page_id_, page.GetData());
+    writeBackPage(&lk, victimId);
   }
   replacer_->Pin(victimId);
   page_table_.erase(page.page_id_);
@@ -173,6 +221,7 @@ Page *BufferPoolManager::NewPageImpl(page_id_t *page_id) {
   page.pin_count_ = 1;
   page.ResetMemory();
   page.is_dirty_ = false;
+  page.has_lsn_ = false;
   page_table_[pageId] = victimId;
   *page_id = pageId;
   return &page;
@@ -207,6 +256,7 @@ bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
   // page.page_id_ = INVALID_PAGE_ID;
 
   page.is_dirty_ = false;
+  page.has_lsn_ = false;
   page.ResetMemory();
 
   return true;
@@ -214,10 +264,14 @@ bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
 
 void BufferPoolManager::FlushAllPagesImpl() {
   // You can do it!
-  std::lock_guard<std::mutex> lk(latch_);
-  for (auto &it : page_table_) {
-    auto &page = pages_[it.second];
-    disk_manager_->WritePage(page.GetPageId(), page.GetData());
+  std::unique_lock<std::mutex> lk(latch_);
+  // walk the frames rather than page_table_, which may change while the log is flushed
+  for (size_t index = 0; index < pool_size_; ++index) {
+    auto frameId = static_cast<frame_id_t>(index);
+    auto it = page_table_.find(pages_[frameId].page_id_);
+    if (it != page_table_.end() && it->second == frameId) {
+      writeBackPage(&lk, frameId);
+    }
   }
 }
 
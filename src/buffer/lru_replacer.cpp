@@ -32,6 +32,27 @@ bool LRUReplacer::Victim(frame_id_t *frame_id) {
   return true;
 }
 
+bool LRUReplacer::Victim(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &prefer) {
+  std::lock_guard<std::mutex> lk(latch);
+
+  if (hash_.empty()) {
+    *frame_id = INVALID_PAGE_ID;
+    return false;
+  }
+  // scan from the least recently used end
+  auto victim = std::prev(unpinned_list.end());
+  for (auto it = unpinned_list.rbegin(); it != unpinned_list.rend(); ++it) {
+    if (prefer(*it)) {
+      victim = std::prev(it.base());
+      break;
+    }
+  }
+  *frame_id = *victim;
+  hash_.erase(*frame_id);
+  unpinned_list.erase(victim);
+  return true;
+}
+
 void LRUReplacer::Pin(frame_id_t frame_id) {
   std::lock_guard<std::mutex> lk(latch);
   auto it = hash_.find(frame_id);
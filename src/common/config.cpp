@@ -18,6 +18,12 @@ std::atomic<bool> enable_logging(false);
 
 std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
+std::atomic<bool> enable_log_compression(false);
+
+std::chrono::milliseconds async_commit_max_lag = std::chrono::milliseconds(10);
+
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::chrono::milliseconds b_plus_tree_maintenance_interval = std::chrono::milliseconds(100);
+
 }  // namespace bustub
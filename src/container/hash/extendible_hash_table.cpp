@@ -0,0 +1,409 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table.cpp
+//
+// Identification: src/container/hash/extendible_hash_table.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "container/hash/extendible_hash_table.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+EXTENDIBLE_HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                                                const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  Page *directory_page = buffer_pool_manager_->NewPage(&directory_page_id_);
+  if (directory_page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory in creating the hash table");
+  }
+  page_id_t bucket_page_id;
+  Page *bucket_page = buffer_pool_manager_->NewPage(&bucket_page_id);
+  if (bucket_page == nullptr) {
+    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory in creating the hash table");
+  }
+  // a new page is zeroed, so the global depth and the local depth of the bucket are 0
+  auto *directory = reinterpret_cast<HashTableDirectoryPage *>(directory_page->GetData());
+  directory->SetPageId(directory_page_id_);
+  directory->SetBucketPageId(0, bucket_page_id);
+  reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(bucket_page->GetData())->SetOverflowPageId(INVALID_PAGE_ID);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+}
+
+/*****************************************************************************
+ * HELPERS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::Hash(const KeyType &key) {
+  return static_cast<uint32_t>(hash_fn_.GetHash(key));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HashTableDirectoryPage *EXTENDIBLE_HASH_TABLE_TYPE::FetchDirectoryPage() {
+  return reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id_)->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HASH_TABLE_BUCKET_TYPE *EXTENDIBLE_HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) {
+  return reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(buffer_pool_manager_->FetchPage(bucket_page_id)->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::ChainGetValue(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key,
+                                               std::vector<ValueType> *result) {
+  bool found = bucket->GetValue(key, comparator_, result);
+  for (page_id_t page_id = bucket->GetOverflowPageId(); page_id != INVALID_PAGE_ID;) {
+    HASH_TABLE_BUCKET_TYPE *overflow = FetchBucketPage(page_id);
+    found = overflow->GetValue(key, comparator_, result) || found;
+    page_id_t next_page_id = overflow->GetOverflowPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::ChainInsert(HASH_TABLE_BUCKET_TYPE *bucket, page_id_t bucket_page_id,
+                                             const KeyType &key, const ValueType &value, bool *full) {
+  if (bucket->GetOverflowPageId() == INVALID_PAGE_ID) {
+    bool inserted = bucket->Insert(key, value, comparator_);
+    // the bucket is full unless the pair was in it already
+    *full = !inserted && !bucket->Contains(key, value, comparator_);
+    return inserted;
+  }
+  // the pair may be in any page of the chain, so all of them are searched before it goes into one with room
+  page_id_t target_page_id = bucket->IsFull() ? INVALID_PAGE_ID : bucket_page_id;
+  bool found = bucket->Contains(key, value, comparator_);
+  for (page_id_t page_id = bucket->GetOverflowPageId(); !found && page_id != INVALID_PAGE_ID;) {
+    HASH_TABLE_BUCKET_TYPE *overflow = FetchBucketPage(page_id);
+    found = overflow->Contains(key, value, comparator_);
+    if (target_page_id == INVALID_PAGE_ID && !overflow->IsFull()) {
+      target_page_id = page_id;
+    }
+    page_id_t next_page_id = overflow->GetOverflowPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  *full = !found && target_page_id == INVALID_PAGE_ID;
+  if (found || *full) {
+    return false;
+  }
+  if (target_page_id == bucket_page_id) {
+    return bucket->Insert(key, value, comparator_);
+  }
+  bool inserted = FetchBucketPage(target_page_id)->Insert(key, value, comparator_);
+  buffer_pool_manager_->UnpinPage(target_page_id, inserted);
+  return inserted;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::ChainRemove(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key,
+                                             const ValueType &value) {
+  bool removed = bucket->Remove(key, value, comparator_);
+  HASH_TABLE_BUCKET_TYPE *prev = bucket;
+  // the bucket page itself is pinned by the caller
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  for (page_id_t page_id = bucket->GetOverflowPageId(); !removed && page_id != INVALID_PAGE_ID;) {
+    HASH_TABLE_BUCKET_TYPE *overflow = FetchBucketPage(page_id);
+    removed = overflow->Remove(key, value, comparator_);
+    page_id_t next_page_id = overflow->GetOverflowPageId();
+    if (removed && overflow->IsEmpty()) {
+      prev->SetOverflowPageId(next_page_id);
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+      break;
+    }
+    if (prev_page_id != INVALID_PAGE_ID) {
+      buffer_pool_manager_->UnpinPage(prev_page_id, false);
+    }
+    prev = overflow;
+    prev_page_id = page_id;
+    page_id = next_page_id;
+  }
+  if (prev_page_id != INVALID_PAGE_ID) {
+    buffer_pool_manager_->UnpinPage(prev_page_id, removed);
+  }
+  return removed;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::CanSplit(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key, uint32_t local_depth) {
+  if (local_depth >= HASH_TABLE_MAX_GLOBAL_DEPTH || bucket->GetOverflowPageId() != INVALID_PAGE_ID) {
+    return false;
+  }
+  // the pairs of the bucket agree with key on the bits below local_depth, a split needs one that differs above
+  uint32_t mask = (1U << HASH_TABLE_MAX_GLOBAL_DEPTH) - 1;
+  uint32_t key_hash = Hash(key) & mask;
+  for (slot_offset_t i = 0; i < BUCKET_ARRAY_SIZE && bucket->IsOccupied(i); i++) {
+    if (bucket->IsReadable(i) && (Hash(bucket->KeyAt(i)) & mask) != key_hash) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key,
+                                          std::vector<ValueType> *result) {
+  table_latch_.RLock();
+  HashTableDirectoryPage *directory = FetchDirectoryPage();
+  page_id_t bucket_page_id = directory->GetBucketPageId(Hash(key) & directory->GetGlobalDepthMask());
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  page->RLatch();
+  bool found = ChainGetValue(reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData()), key, result);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  return found;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.RLock();
+  HashTableDirectoryPage *directory = FetchDirectoryPage();
+  page_id_t bucket_page_id = directory->GetBucketPageId(Hash(key) & directory->GetGlobalDepthMask());
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  page->WLatch();
+  bool full;
+  bool inserted =
+      ChainInsert(reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData()), bucket_page_id, key, value, &full);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  if (!full) {
+    return inserted;
+  }
+  return SplitInsert(transaction, key, value);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.WLock();
+  HashTableDirectoryPage *directory = FetchDirectoryPage();
+  bool inserted = false;
+  // the pairs of a bucket may all go to one side of a split, then the bucket is split again, unless no split can
+  // separate them
+  while (true) {
+    uint32_t bucket_idx = Hash(key) & directory->GetGlobalDepthMask();
+    page_id_t bucket_page_id = directory->GetBucketPageId(bucket_idx);
+    HASH_TABLE_BUCKET_TYPE *bucket = FetchBucketPage(bucket_page_id);
+    bool full;
+    inserted = ChainInsert(bucket, bucket_page_id, key, value, &full);
+    if (!full) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+      break;
+    }
+
+    uint32_t local_depth = directory->GetLocalDepth(bucket_idx);
+    bool split = CanSplit(bucket, key, local_depth);
+    page_id_t image_page_id;
+    Page *image_page = buffer_pool_manager_->NewPage(&image_page_id);
+    if (image_page == nullptr) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+      table_latch_.WUnlock();
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory in growing a hash table bucket");
+    }
+    auto *image = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(image_page->GetData());
+    if (!split) {
+      // the new page becomes the first overflow page of the chain
+      image->SetOverflowPageId(bucket->GetOverflowPageId());
+      bucket->SetOverflowPageId(image_page_id);
+      inserted = image->Insert(key, value, comparator_);
+      buffer_pool_manager_->UnpinPage(image_page_id, true);
+      buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+      break;
+    }
+    image->SetOverflowPageId(INVALID_PAGE_ID);
+    if (local_depth == directory->GetGlobalDepth()) {
+      directory->IncrGlobalDepth();
+    }
+    // of the indexes that share the bucket, the ones with the next hash bit set go to the image
+    uint32_t bit = 1U << local_depth;
+    for (uint32_t i = bucket_idx & (bit - 1); i < directory->Size(); i += bit) {
+      directory->SetLocalDepth(i, local_depth + 1);
+      if ((i & bit) != 0) {
+        directory->SetBucketPageId(i, image_page_id);
+      }
+    }
+    bucket->SplitTo(image, [&](const KeyType &item_key) { return (Hash(item_key) & bit) == 0; });
+    buffer_pool_manager_->UnpinPage(image_page_id, true);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+  table_latch_.WUnlock();
+  return inserted;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.RLock();
+  HashTableDirectoryPage *directory = FetchDirectoryPage();
+  uint32_t bucket_idx = Hash(key) & directory->GetGlobalDepthMask();
+  page_id_t bucket_page_id = directory->GetBucketPageId(bucket_idx);
+  bool may_merge = directory->GetLocalDepth(bucket_idx) > 0;
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  page->WLatch();
+  auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  bool removed = ChainRemove(bucket, key, value);
+  bool empty = removed && bucket->IsEmpty() && bucket->GetOverflowPageId() == INVALID_PAGE_ID;
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, removed);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  if (empty && may_merge) {
+    Merge(transaction, key);
+  }
+  return removed;
+}
+
+/*****************************************************************************
+ * MERGE
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key) {
+  table_latch_.WLock();
+  HashTableDirectoryPage *directory = FetchDirectoryPage();
+  // an insert may have filled the bucket again in between, so it is checked anew
+  while (true) {
+    uint32_t bucket_idx = Hash(key) & directory->GetGlobalDepthMask();
+    uint32_t local_depth = directory->GetLocalDepth(bucket_idx);
+    if (local_depth == 0) {
+      break;
+    }
+    uint32_t image_idx = directory->GetSplitImageIndex(bucket_idx);
+    if (directory->GetLocalDepth(image_idx) != local_depth) {
+      break;
+    }
+    page_id_t bucket_page_id = directory->GetBucketPageId(bucket_idx);
+    page_id_t image_page_id = directory->GetBucketPageId(image_idx);
+    HASH_TABLE_BUCKET_TYPE *bucket = FetchBucketPage(bucket_page_id);
+    bool bucket_empty = bucket->IsEmpty() && bucket->GetOverflowPageId() == INVALID_PAGE_ID;
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    HASH_TABLE_BUCKET_TYPE *image = FetchBucketPage(image_page_id);
+    bool image_empty = image->IsEmpty() && image->GetOverflowPageId() == INVALID_PAGE_ID;
+    buffer_pool_manager_->UnpinPage(image_page_id, false);
+    if (!bucket_empty && !image_empty) {
+      break;
+    }
+    page_id_t kept_page_id = bucket_empty ? image_page_id : bucket_page_id;
+    uint32_t bit = 1U << (local_depth - 1);
+    for (uint32_t i = bucket_idx & (bit - 1); i < directory->Size(); i += bit) {
+      directory->SetBucketPageId(i, kept_page_id);
+      directory->SetLocalDepth(i, local_depth - 1);
+    }
+    buffer_pool_manager_->DeletePage(bucket_empty ? bucket_page_id : image_page_id);
+  }
+  while (directory->CanShrink()) {
+    directory->DecrGlobalDepth();
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+  table_latch_.WUnlock();
+}
+
+/*****************************************************************************
+ * GETGLOBALDEPTH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::GetGlobalDepth() {
+  table_latch_.RLock();
+  uint32_t global_depth = FetchDirectoryPage()->GetGlobalDepth();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  return global_depth;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+size_t EXTENDIBLE_HASH_TABLE_TYPE::GetNumBuckets() {
+  table_latch_.RLock();
+  HashTableDirectoryPage *directory = FetchDirectoryPage();
+  std::unordered_set<page_id_t> bucket_page_ids;
+  for (uint32_t i = 0; i < directory->Size(); i++) {
+    bucket_page_ids.insert(directory->GetBucketPageId(i));
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  return bucket_page_ids.size();
+}
+
+/*****************************************************************************
+ * VERIFY INTEGRITY
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::VerifyIntegrity() {
+  table_latch_.RLock();
+  HashTableDirectoryPage *directory = FetchDirectoryPage();
+  bool valid = true;
+  std::unordered_map<page_id_t, uint32_t> shared_by;
+  for (uint32_t i = 0; i < directory->Size() && valid; i++) {
+    uint32_t local_depth = directory->GetLocalDepth(i);
+    uint32_t local_mask = (1U << local_depth) - 1;
+    page_id_t bucket_page_id = directory->GetBucketPageId(i);
+    valid = local_depth <= directory->GetGlobalDepth() &&
+            directory->GetBucketPageId(i & local_mask) == bucket_page_id &&
+            directory->GetLocalDepth(i & local_mask) == local_depth;
+    if (!valid || shared_by[bucket_page_id]++ > 0) {
+      continue;
+    }
+    // the overflow pages are checked like the bucket page
+    for (page_id_t page_id = bucket_page_id; page_id != INVALID_PAGE_ID;) {
+      HASH_TABLE_BUCKET_TYPE *bucket = FetchBucketPage(page_id);
+      for (slot_offset_t j = 0; j < BUCKET_ARRAY_SIZE && bucket->IsOccupied(j); j++) {
+        if (bucket->IsReadable(j) && (Hash(bucket->KeyAt(j)) & local_mask) != (i & local_mask)) {
+          valid = false;
+        }
+      }
+      page_id_t next_page_id = bucket->GetOverflowPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      page_id = next_page_id;
+    }
+  }
+  for (const auto &bucket : shared_by) {
+    uint32_t local_depth = 0;
+    for (uint32_t i = 0; i < directory->Size(); i++) {
+      if (directory->GetBucketPageId(i) == bucket.first) {
+        local_depth = directory->GetLocalDepth(i);
+      }
+    }
+    valid = valid && bucket.second == 1U << (directory->GetGlobalDepth() - local_depth);
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  return valid;
+}
+
+template class ExtendibleHashTable<int, int, IntComparator>;
+
+template class ExtendibleHashTable<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
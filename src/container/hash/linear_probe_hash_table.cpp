@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -26,21 +27,76 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                       const KeyComparator &comparator, size_t num_buckets,
                                       HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  Page *page = buffer_pool_manager_->NewPage(&header_page_id_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory in creating the hash table");
+  }
+  reinterpret_cast<HashTableHeaderPage *>(page->GetData())->SetPageId(header_page_id_);
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
+  // the slots are rounded up to whole blocks
+  AllocateBlocks(num_buckets == 0 ? 1 : (num_buckets - 1) / BLOCK_ARRAY_SIZE + 1);
+}
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) {
-  return false;
+  bool found = false;
+  table_latch_.RLock();
+  Probe(hash_fn_.GetHash(key), false, [&](size_t block_index, HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset) {
+    if (!block->IsOccupied(offset)) {
+      return true;
+    }
+    if (block->IsReadable(offset) && comparator_(block->KeyAt(offset), key) == 0) {
+      result->push_back(block->ValueAt(offset));
+      found = true;
+    }
+    return false;
+  });
+  table_latch_.RUnlock();
+  return found;
 }
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  uint64_t hash = hash_fn_.GetHash(key);
+  uint8_t fingerprint = HASH_TABLE_BLOCK_TYPE::Fingerprint(hash);
+  while (true) {
+    bool inserted = false;
+    table_latch_.RLock();
+    // a tombstone is only taken once the probe reaches a free slot in the same block, so a duplicate pair after it
+    // is found first, and two inserts of the same pair meet under the latch of that block
+    size_t tombstone_block = block_page_ids_.size();
+    slot_offset_t tombstone_offset = 0;
+    bool done = Probe(hash, true, [&](size_t block_index, HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset) {
+      if (!block->IsOccupied(offset)) {
+        // the block was let go in between if the probe wrapped around to it, the tombstone may be gone
+        inserted = (tombstone_block == block_index && block->Reuse(tombstone_offset, key, value, fingerprint)) ||
+                   block->Insert(offset, key, value, fingerprint);
+        return true;
+      }
+      if (!block->IsReadable(offset)) {
+        if (tombstone_block != block_index) {
+          tombstone_block = block_index;
+          tombstone_offset = offset;
+        }
+        return false;
+      }
+      // duplicate values for the same key are not allowed
+      return comparator_(block->KeyAt(offset), key) == 0 && block->ValueAt(offset) == value;
+    });
+    size_t num_buckets = num_buckets_;
+    table_latch_.RUnlock();
+    if (done) {
+      return inserted;
+    }
+    // every slot is taken or a tombstone
+    Resize(num_buckets);
+  }
 }
 
 /*****************************************************************************
@@ -48,21 +104,150 @@ bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  bool removed = false;
+  table_latch_.RLock();
+  Probe(hash_fn_.GetHash(key), true, [&](size_t block_index, HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset) {
+    if (!block->IsOccupied(offset)) {
+      return true;
+    }
+    if (block->IsReadable(offset) && comparator_(block->KeyAt(offset), key) == 0 && block->ValueAt(offset) == value) {
+      block->Remove(offset);
+      removed = true;
+      return true;
+    }
+    return false;
+  });
+  table_latch_.RUnlock();
+  return removed;
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+void HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  table_latch_.WLock();
+  if (num_buckets_ >= 2 * initial_size) {
+    // another insert grew the table meanwhile
+    table_latch_.WUnlock();
+    return;
+  }
+  size_t num_blocks = (2 * initial_size - 1) / BLOCK_ARRAY_SIZE + 1;
+  if (num_blocks > HASH_TABLE_MAX_BLOCKS) {
+    table_latch_.WUnlock();
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "hash table has more blocks than its header page holds");
+  }
+  std::vector<page_id_t> old_block_page_ids;
+  old_block_page_ids.swap(block_page_ids_);
+  AllocateBlocks(num_blocks);
+
+  // the new blocks have no tombstones and no duplicates, every pair goes into the first free slot
+  for (page_id_t old_page_id : old_block_page_ids) {
+    Page *old_page = buffer_pool_manager_->FetchPage(old_page_id);
+    auto *old_block = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(old_page->GetData());
+    for (slot_offset_t i = 0; i < BLOCK_ARRAY_SIZE; i++) {
+      if (!old_block->IsReadable(i)) {
+        continue;
+      }
+      KeyType key = old_block->KeyAt(i);
+      ValueType value = old_block->ValueAt(i);
+      uint64_t hash = hash_fn_.GetHash(key);
+      Probe(hash, true, [&](size_t block_index, HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset) {
+        return block->Insert(offset, key, value, HASH_TABLE_BLOCK_TYPE::Fingerprint(hash));
+      });
+    }
+    buffer_pool_manager_->UnpinPage(old_page_id, false);
+    buffer_pool_manager_->DeletePage(old_page_id);
+  }
+  table_latch_.WUnlock();
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 size_t HASH_TABLE_TYPE::GetSize() {
-  return 0;
+  table_latch_.RLock();
+  size_t size = num_buckets_;
+  table_latch_.RUnlock();
+  return size;
+}
+
+/*****************************************************************************
+ * UTILITIES
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::AllocateBlocks(size_t num_blocks) {
+  Page *header_page = buffer_pool_manager_->FetchPage(header_page_id_);
+  auto *header = reinterpret_cast<HashTableHeaderPage *>(header_page->GetData());
+  header->ResetBlockPageIds();
+  block_page_ids_.clear();
+  for (size_t i = 0; i < num_blocks; i++) {
+    page_id_t block_page_id;
+    // new pages are zeroed, so every slot is free
+    if (buffer_pool_manager_->NewPage(&block_page_id) == nullptr) {
+      buffer_pool_manager_->UnpinPage(header_page_id_, true);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory in allocating hash table blocks");
+    }
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+    header->AddBlockPageId(block_page_id);
+    block_page_ids_.push_back(block_page_id);
+  }
+  num_buckets_ = num_blocks * BLOCK_ARRAY_SIZE;
+  header->SetSize(num_buckets_);
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Visit>
+bool HASH_TABLE_TYPE::Probe(uint64_t hash, bool exclusive, Visit &&visit) {
+  uint8_t fingerprint = HASH_TABLE_BLOCK_TYPE::Fingerprint(hash);
+  size_t bucket = hash % num_buckets_;
+  size_t block_index = bucket / BLOCK_ARRAY_SIZE;
+  slot_offset_t offset = bucket % BLOCK_ARRAY_SIZE;
+  size_t probed = 0;
+  while (probed < num_buckets_) {
+    page_id_t page_id = block_page_ids_[block_index];
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (exclusive) {
+      page->WLatch();
+    } else {
+      page->RLatch();
+    }
+    auto *block = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+    bool stop = false;
+    // the slots of the block from offset on, a group of fingerprints at a time
+    slot_offset_t end = std::min<slot_offset_t>(BLOCK_ARRAY_SIZE, offset + (num_buckets_ - probed));
+    while (offset < end && !stop) {
+      size_t group = offset / BLOCK_GROUP_SIZE;
+      slot_offset_t group_end = std::min<slot_offset_t>(end, (group + 1) * BLOCK_GROUP_SIZE);
+      uint32_t mask = block->MatchGroup(group, fingerprint) & (~0U << (offset % BLOCK_GROUP_SIZE));
+      for (; mask != 0; mask &= mask - 1) {
+        slot_offset_t slot = group * BLOCK_GROUP_SIZE + __builtin_ctz(mask);
+        if (slot >= group_end) {
+          break;
+        }
+        if (visit(block_index, block, slot)) {
+          stop = true;
+          break;
+        }
+      }
+      probed += group_end - offset;
+      offset = group_end;
+    }
+    if (exclusive) {
+      page->WUnlatch();
+    } else {
+      page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(page_id, exclusive);
+    if (stop) {
+      return true;
+    }
+    block_index = (block_index + 1) % block_page_ids_.size();
+    offset = 0;
+  }
+  return false;
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
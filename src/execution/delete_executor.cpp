@@ -36,8 +36,12 @@ bool DeleteExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) {
       throw Exception("Delete Tuple fail in delete executor");
     }
     for (auto &index : indexes) {
-      auto key_tuple = child_tuple.KeyFromTuple(metadata_->schema_, index->key_schema_, index->index_->GetKeyAttrs());
+      auto key_tuple = child_tuple.KeyFromTuple(metadata_->schema_, *index->index_->GetEntrySchema(),
+                                                index->index_->GetEntryAttrs());
       index->index_->DeleteEntry(key_tuple, child_rid, exec_ctx_->GetTransaction());
+      // an abort inserts the entry again
+      exec_ctx_->GetTransaction()->GetIndexWriteSet()->emplace_back(
+          child_rid, metadata_->oid_, WType::DELETE, child_tuple, index->index_oid_, exec_ctx_->GetCatalog());
     }
   }
 
@@ -0,0 +1,53 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_index_lookup_executor.cpp
+//
+// Identification: src/execution/hash_index_lookup_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include "execution/executors/hash_index_lookup_executor.h"
+
+namespace bustub {
+HashIndexLookupExecutor::HashIndexLookupExecutor(ExecutorContext *exec_ctx, const HashIndexLookupPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void HashIndexLookupExecutor::Init() {
+  IndexInfo *index_info = exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid());
+  metadata_ = exec_ctx_->GetCatalog()->GetTable(index_info->table_name_);
+  rids_.clear();
+  rid_pos_ = 0;
+  index_info->index_->ScanKey(*plan_->GetKey(), &rids_, exec_ctx_->GetTransaction());
+}
+
+bool HashIndexLookupExecutor::Next(Tuple *tuple, RID *rid) {
+  Tuple t;
+  while (rid_pos_ < rids_.size()) {
+    RID id = rids_[rid_pos_++];
+    if (!metadata_->table_->GetTuple(id, &t, exec_ctx_->GetTransaction())) {
+      LOG_DEBUG("HashIndexLookupExecutor not found the tuple whose rid is %s", id.ToString().c_str());
+      continue;
+    }
+    auto predicate = plan_->GetPredicate();
+    if (predicate != nullptr && !predicate->Evaluate(&t, GetOutputSchema()).GetAs<bool>()) {
+      continue;
+    }
+    *tuple = GetOutputTuple(&t);
+    *rid = id;
+    return true;
+  }
+  return false;
+}
+
+Tuple HashIndexLookupExecutor::GetOutputTuple(const Tuple *t) {
+  std::vector<Value> values;
+  for (const auto &col : GetOutputSchema()->GetColumns()) {
+    values.push_back(col.GetExpr()->Evaluate(t, &metadata_->schema_));
+  }
+  return Tuple(values, GetOutputSchema());
+}
+
+}  // namespace bustub
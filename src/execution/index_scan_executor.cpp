@@ -11,17 +11,247 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include "execution/expressions/column_value_expression.h"
+#include "storage/index/normalized_key.h"
+#include "type/value_factory.h"
+
 namespace bustub {
+/**
+ * The entries of a key range of a B+ tree index, copied out a leaf at a time when ascending, see
+ * IndexIterator::NextBatch.
+ */
+template <typename KeyType, typename KeyComparator>
+class IndexScanExecutor::TreeCursor : public IndexScanExecutor::Cursor {
+ public:
+  TreeCursor(BPlusTreeIndex<KeyType, RID, KeyComparator> *index, const IndexScanPlanNode *plan)
+      : index_(index), has_lower_(plan->GetLowerKey() != nullptr), has_upper_(plan->GetUpperKey() != nullptr) {
+    // the rid only counts in a non-unique index, where the bounds then take in every rid of their keys
+    if (has_lower_) {
+      index_->MakeKey(*plan->GetLowerKey(), RID(INVALID_PAGE_ID, 0), &lower_key_);
+    }
+    if (has_upper_) {
+      index_->MakeKey(*plan->GetUpperKey(), RID(INT32_MAX, INT32_MAX), &upper_key_);
+    }
+    if (plan->IsDescending()) {
+      reverse_iterator_ = std::make_unique<ReverseIndexIterator<KeyType, RID, KeyComparator>>(
+          has_upper_ ? index_->GetReverseBeginIterator(upper_key_) : index_->GetReverseBeginIterator());
+    } else {
+      iterator_ = std::make_unique<IndexIterator<KeyType, RID, KeyComparator>>(
+          has_lower_ ? index_->GetBeginIterator(lower_key_) : index_->GetBeginIterator());
+    }
+  }
+
+  bool Next(RID *rid) override {
+    const KeyComparator &comparator = index_->GetComparator();
+    if (iterator_ != nullptr) {
+      if (batch_pos_ == batch_.size()) {
+        batch_.clear();
+        batch_pos_ = 0;
+        iterator_->NextBatch(&batch_);
+      }
+      if (batch_pos_ < batch_.size()) {
+        entry_ = batch_[batch_pos_];
+        if (!has_upper_ || comparator(entry_.first, upper_key_) <= 0) {
+          batch_pos_++;
+          *rid = entry_.second;
+          return true;
+        }
+      }
+    } else if (reverse_iterator_ != nullptr && !reverse_iterator_->isEnd()) {
+      entry_ = **reverse_iterator_;
+      if (!has_lower_ || comparator(entry_.first, lower_key_) >= 0) {
+        ++(*reverse_iterator_);
+        *rid = entry_.second;
+        return true;
+      }
+    }
+    // past the range, drop the iterator so the leaf it holds is released now
+    iterator_.reset();
+    reverse_iterator_.reset();
+    return false;
+  }
+
+  Value KeyValue(uint32_t column_idx) override { return entry_.first.ToValue(index_->GetKeySchema(), column_idx); }
+
+  std::vector<Value> EntryValues() override { return index_->EntryValues(entry_.first); }
+
+ private:
+  BPlusTreeIndex<KeyType, RID, KeyComparator> *index_;
+  std::unique_ptr<IndexIterator<KeyType, RID, KeyComparator>> iterator_;
+  std::unique_ptr<ReverseIndexIterator<KeyType, RID, KeyComparator>> reverse_iterator_;
+  std::vector<std::pair<KeyType, RID>> batch_;
+  size_t batch_pos_{0};
+  std::pair<KeyType, RID> entry_;
+  bool has_lower_;
+  bool has_upper_;
+  KeyType lower_key_;
+  KeyType upper_key_;
+};
+
+/** The entries of one key of an index that only looks keys up, such as a hash index. */
+class IndexScanExecutor::PointCursor : public IndexScanExecutor::Cursor {
+ public:
+  PointCursor(Index *index, const Tuple &key, Transaction *txn) : index_(index), key_(key) {
+    index_->ScanKey(key_, &rids_, txn);
+  }
+
+  bool Next(RID *rid) override {
+    if (rid_pos_ == rids_.size()) {
+      return false;
+    }
+    *rid = rids_[rid_pos_++];
+    return true;
+  }
+
+  Value KeyValue(uint32_t column_idx) override { return key_.GetValue(index_->GetKeySchema(), column_idx); }
+
+  // such an index has no included columns, its entries hold the key alone
+  std::vector<Value> EntryValues() override {
+    std::vector<Value> values;
+    for (uint32_t i = 0; i < index_->GetKeySchema()->GetColumnCount(); i++) {
+      values.push_back(KeyValue(i));
+    }
+    return values;
+  }
+
+ private:
+  Index *index_;
+  Tuple key_;
+  std::vector<RID> rids_;
+  size_t rid_pos_{0};
+};
+
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
     : AbstractExecutor(exec_ctx), plan_(plan) {}
 
 void IndexScanExecutor::Init() {
   indexInfo_ = exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid());
   metadata_ = exec_ctx_->GetCatalog()->GetTable(indexInfo_->table_name_);
-  b_plus_tree_index_ =
-      reinterpret_cast<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> *>(indexInfo_->index_.get());
-  index_iterator_ =
-      std::make_unique<IndexIterator<GenericKey<8>, RID, GenericComparator<8>>>(b_plus_tree_index_->GetBeginIterator());
+  covered_ = CoversPlan();
+  // the cursor of a previous run holds a leaf until it is dropped
+  cursor_.reset();
+  cursor_ = MakeCursor();
+}
+
+std::unique_ptr<IndexScanExecutor::Cursor> IndexScanExecutor::MakeCursor() {
+  std::unique_ptr<Cursor> cursor;
+  switch (indexInfo_->key_size_) {
+    case 4:
+      cursor = MakeTreeCursor<4>();
+      break;
+    case 8:
+      cursor = MakeTreeCursor<8>();
+      break;
+    case 16:
+      cursor = MakeTreeCursor<16>();
+      break;
+    case 32:
+      cursor = MakeTreeCursor<32>();
+      break;
+    case 64:
+      cursor = MakeTreeCursor<64>();
+      break;
+    default:
+      break;
+  }
+  if (cursor != nullptr) {
+    return cursor;
+  }
+  if (!ScansOneKey()) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "only a B+ tree index scans a range of keys");
+  }
+  return std::make_unique<PointCursor>(indexInfo_->index_.get(), *plan_->GetLowerKey(), exec_ctx_->GetTransaction());
+}
+
+template <size_t KeySize>
+std::unique_ptr<IndexScanExecutor::Cursor> IndexScanExecutor::MakeTreeCursor() {
+  Index *index = indexInfo_->index_.get();
+  if (auto tree = dynamic_cast<BPlusTreeIndex<GenericKey<KeySize>, RID, GenericComparator<KeySize>> *>(index)) {
+    return std::make_unique<TreeCursor<GenericKey<KeySize>, GenericComparator<KeySize>>>(tree, plan_);
+  }
+  if (auto tree = dynamic_cast<BPlusTreeIndex<NormalizedKey<KeySize>, RID, NormalizedComparator<KeySize>> *>(index)) {
+    return std::make_unique<TreeCursor<NormalizedKey<KeySize>, NormalizedComparator<KeySize>>>(tree, plan_);
+  }
+  return nullptr;
+}
+
+bool IndexScanExecutor::ScansOneKey() const {
+  const Tuple *lower_key = plan_->GetLowerKey();
+  const Tuple *upper_key = plan_->GetUpperKey();
+  if (lower_key == nullptr || upper_key == nullptr) {
+    return false;
+  }
+  Schema *key_schema = indexInfo_->index_->GetKeySchema();
+  for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+    if (lower_key->GetValue(key_schema, i).CompareEquals(upper_key->GetValue(key_schema, i)) != CmpBool::CmpTrue) {
+      return false;
+    }
+  }
+  return true;
+}
+
+namespace {
+/** Adds the columns that expr reads to columns. */
+void CollectColumns(const AbstractExpression *expr, std::vector<uint32_t> *columns) {
+  if (expr == nullptr) {
+    return;
+  }
+  if (auto column = dynamic_cast<const ColumnValueExpression *>(expr)) {
+    columns->push_back(column->GetColIdx());
+  }
+  for (const auto *child : expr->GetChildren()) {
+    CollectColumns(child, columns);
+  }
+}
+}  // namespace
+
+bool IndexScanExecutor::CoversPlan() const {
+  std::vector<uint32_t> columns;
+  CollectColumns(plan_->GetPredicate(), &columns);
+  for (const auto &col : plan_->OutputSchema()->GetColumns()) {
+    CollectColumns(col.GetExpr(), &columns);
+  }
+  const auto &entry_attrs = indexInfo_->index_->GetEntryAttrs();
+  for (uint32_t column : columns) {
+    if (std::find(entry_attrs.begin(), entry_attrs.end(), column) == entry_attrs.end()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Tuple IndexScanExecutor::TupleFromEntry() {
+  const Schema &schema = metadata_->schema_;
+  std::vector<Value> values;
+  values.reserve(schema.GetColumnCount());
+  for (const auto &col : schema.GetColumns()) {
+    values.push_back(col.GetType() == TypeId::VARCHAR ? ValueFactory::GetVarcharValue("")
+                                                      : ValueFactory::GetNullValueByType(col.GetType()));
+  }
+  std::vector<Value> entry_values = cursor_->EntryValues();
+  const auto &entry_attrs = indexInfo_->index_->GetEntryAttrs();
+  for (size_t i = 0; i < entry_attrs.size(); i++) {
+    values[entry_attrs[i]] = entry_values[i];
+  }
+  return Tuple(values, &schema);
+}
+
+bool IndexScanExecutor::MatchKey() {
+  auto key_predicate = plan_->GetKeyPredicate();
+  if (key_predicate == nullptr) {
+    return true;
+  }
+  Schema *key_schema = indexInfo_->index_->GetKeySchema();
+  std::vector<Value> values;
+  for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+    values.push_back(cursor_->KeyValue(i));
+  }
+  Tuple key_tuple(values, key_schema);
+  return key_predicate->Evaluate(&key_tuple, key_schema).GetAs<bool>();
 }
 
 bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) {
@@ -29,14 +259,18 @@ bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) {
   bool not_ended = false;
   Tuple t{};
   RID id;
-  while (*index_iterator_ != b_plus_tree_index_->GetEndIterator()) {
-    auto cur = **index_iterator_;
-    id = cur.second;
-    ++(*index_iterator_);
-
-    auto res = metadata_->table_->GetTuple(cur.second, &t, exec_ctx_->GetTransaction());
-    if (!res) {
-      LOG_DEBUG("IndexScanExecutor not found the tuple whose rid is %s", cur.second.ToString().c_str());
+  while (cursor_ != nullptr && cursor_->Next(&id)) {
+    if (!MatchKey()) {
+      continue;
+    }
+
+    auto txn = exec_ctx_->GetTransaction();
+    if (covered_ && (!enable_logging || txn->IsSharedLocked(id) || txn->IsExclusiveLocked(id))) {
+      // the columns the plan reads are all in the entry, which matches the tuple as long as no other transaction
+      // could change it since the entry was read. Otherwise GetTuple() waits for its lock and skips a deleted tuple.
+      t = TupleFromEntry();
+    } else if (!metadata_->table_->GetTuple(id, &t, exec_ctx_->GetTransaction())) {
+      LOG_DEBUG("IndexScanExecutor not found the tuple whose rid is %s", id.ToString().c_str());
       continue;
     }
 
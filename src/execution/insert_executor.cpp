@@ -31,8 +31,12 @@ bool InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) {
       Tuple t = Tuple(val, &metadata_->schema_);
       metadata_->table_->InsertTuple(t, rid, exec_ctx_->GetTransaction());
       for (auto &index_i : indexes) {
-        auto key = t.KeyFromTuple(metadata_->schema_, index_i->key_schema_, index_i->index_->GetKeyAttrs());
+        auto key = t.KeyFromTuple(metadata_->schema_, *index_i->index_->GetEntrySchema(),
+                                  index_i->index_->GetEntryAttrs());
         index_i->index_->InsertEntry(key, *rid, exec_ctx_->GetTransaction());
+        // an abort deletes the entry again
+        exec_ctx_->GetTransaction()->GetIndexWriteSet()->emplace_back(
+            *rid, metadata_->oid_, WType::INSERT, t, index_i->index_oid_, exec_ctx_->GetCatalog());
       }
     }
 
@@ -53,8 +57,11 @@ bool InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) {
         metadata_->table_->InsertTuple(child_tuple, &child_rid, exec_ctx_->GetTransaction());
 
         for (auto &index_i : indexes) {
-          auto key = child_tuple.KeyFromTuple(metadata_->schema_, index_i->key_schema_, index_i->index_->GetKeyAttrs());
+          auto key = child_tuple.KeyFromTuple(metadata_->schema_, *index_i->index_->GetEntrySchema(),
+                                              index_i->index_->GetEntryAttrs());
           index_i->index_->InsertEntry(key, child_rid, exec_ctx_->GetTransaction());
+          exec_ctx_->GetTransaction()->GetIndexWriteSet()->emplace_back(
+              child_rid, metadata_->oid_, WType::INSERT, child_tuple, index_i->index_oid_, exec_ctx_->GetCatalog());
         }
       }
     } catch (Exception &e) {
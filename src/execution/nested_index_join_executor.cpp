@@ -12,6 +12,8 @@
 
 #include "execution/executors/nested_index_join_executor.h"
 
+#include <algorithm>
+
 namespace bustub {
 
 NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const NestedIndexJoinPlanNode *plan,
@@ -21,6 +23,8 @@ NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const Ne
 void NestIndexJoinExecutor::Init() {
   outer_executor_->Init();
   inner_metadata_ = exec_ctx_->GetCatalog()->GetTable(plan_->GetInnerTableOid());
+  outer_batch_.clear();
+  batch_pos_ = 0;
 }
 
 // 不支持 两个tuple的某一列同名
@@ -57,40 +61,67 @@ bool NestIndexJoinExecutor::GetOutputTuple(const Tuple *outer_tuple, const Tuple
   *output_tuple = Tuple(vals, GetOutputSchema());
   return true;
 }
-bool NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) {
-  bool found = false;
-
+bool NestIndexJoinExecutor::FetchBatch() {
+  outer_batch_.clear();
+  batch_pos_ = 0;
+  size_t batch_size = std::max<size_t>(plan_->GetBatchSize(), 1);
   Tuple outer_tuple;
   RID outer_rid;
+  while (outer_batch_.size() < batch_size && outer_executor_->Next(&outer_tuple, &outer_rid)) {
+    outer_batch_.push_back(outer_tuple);
+  }
+  if (outer_batch_.empty()) {
+    return false;
+  }
 
-  while (outer_executor_->Next(&outer_tuple, &outer_rid)) {
-    Tuple inner_tuple;
-    auto indexes = exec_ctx_->GetCatalog()->GetTableIndexes(inner_metadata_->name_);
+  std::vector<Value> join_vals;
+  join_vals.reserve(outer_batch_.size());
+  for (const auto &tuple : outer_batch_) {
+    join_vals.push_back(plan_->Predicate()->GetChildAt(0)->EvaluateJoin(&tuple, plan_->OuterTableSchema(), nullptr,
+                                                                        nullptr));  // to get the join val
+  }
+  inner_rids_.assign(outer_batch_.size(), RID());
+  matched_.assign(outer_batch_.size(), false);
 
-    auto join_val = plan_->Predicate()->GetChildAt(0)->EvaluateJoin(&outer_tuple, plan_->OuterTableSchema(), nullptr,
-                                                                    nullptr);  // to get the join val
+  auto indexes = exec_ctx_->GetCatalog()->GetTableIndexes(inner_metadata_->name_);
+  for (auto index : indexes) {
+    auto key_schema = exec_ctx_->GetCatalog()->GetIndex(index->index_oid_)->key_schema_;
+    std::vector<Tuple> key_tuples;
+    key_tuples.reserve(join_vals.size());
+    for (const auto &join_val : join_vals) {
+      key_tuples.emplace_back(std::vector<Value>{join_val}, &key_schema);
+    }
+    // the index sorts the keys of the batch and shares the descents of keys that fall into the same leaves
+    std::vector<std::vector<RID>> result;
+    index->index_->ScanKeys(key_tuples, &result, exec_ctx_->GetTransaction());
+    // 因为我们这里用的索引都不支持范围查找，只是单点查找，所以不需要考虑那么多
+    for (size_t i = 0; i < result.size(); i++) {
+      if (!result[i].empty()) {
+        inner_rids_[i] = result[i][0];
+        matched_[i] = true;
+      }
+    }
+  }
+  return true;
+}
 
-    for (auto index : indexes) {
-      std::vector<Value> vals;
-      vals.push_back(join_val);
-      auto key_schema = exec_ctx_->GetCatalog()->GetIndex(index->index_oid_)->key_schema_;
-      std::vector<RID> result;
-      Tuple key_tuple = Tuple(vals, &key_schema);
-      index->index_->ScanKey(key_tuple, &result, exec_ctx_->GetTransaction());
-      // 因为我们这里用的索引都不支持范围查找，只是单点查找，所以不需要考虑那么多
-      if (result.empty()) {
+bool NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) {
+  while (true) {
+    while (batch_pos_ < outer_batch_.size()) {
+      size_t i = batch_pos_++;
+      if (!matched_[i]) {
         continue;
       }
-      inner_metadata_->table_->GetTuple(result[0], &inner_tuple, exec_ctx_->GetTransaction());
-      found = true;
+      Tuple inner_tuple;
+      inner_metadata_->table_->GetTuple(inner_rids_[i], &inner_tuple, exec_ctx_->GetTransaction());
+      if (GetOutputTuple(&outer_batch_[i], &inner_tuple, tuple)) {
+        return true;
+      }
     }
-
-    if (found && GetOutputTuple(&outer_tuple, &inner_tuple, tuple)) {
-      break;
+    if (!FetchBatch()) {
+      return false;
     }
   }
-
-  return found;
 }
 
 }  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 #include <include/execution/executor_factory.h>
+#include <algorithm>
 #include <memory>
 
 #include "execution/executors/update_executor.h"
@@ -29,8 +30,9 @@ bool UpdateExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) {
   Tuple child_tuple;
   RID child_rid;
   bool res = false;
-  if (child_executor_->Next(&child_tuple, &child_rid)) {  // 如果有值
-    child_tuple = GenerateUpdatedTuple(child_tuple);
+  Tuple old_tuple;
+  if (child_executor_->Next(&old_tuple, &child_rid)) {  // 如果有值
+    child_tuple = GenerateUpdatedTuple(old_tuple);
 
     res = table_info_->table_->UpdateTuple(child_tuple, child_rid, exec_ctx_->GetTransaction());
   }
@@ -38,10 +40,34 @@ bool UpdateExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) {
   if (!res) {
     return false;
   }
+  UpdateIndexes(&old_tuple, &child_tuple, child_rid);
 
   *tuple = child_tuple;
   *rid = child_rid;
   return true;
 }
 
+void UpdateExecutor::UpdateIndexes(Tuple *old_tuple, Tuple *new_tuple, const RID &rid) {
+  auto txn = exec_ctx_->GetTransaction();
+  const Schema *schema = &table_info_->schema_;
+  for (auto index_info : exec_ctx_->GetCatalog()->GetTableIndexes(table_info_->name_)) {
+    Index *index = index_info->index_.get();
+    const auto &entry_attrs = index->GetEntryAttrs();
+    // the key and the included columns are both stored in the entry
+    bool changed = std::any_of(entry_attrs.begin(), entry_attrs.end(), [&](uint32_t attr) {
+      return old_tuple->GetValue(schema, attr).CompareEquals(new_tuple->GetValue(schema, attr)) != CmpBool::CmpTrue;
+    });
+    if (!changed) {
+      continue;
+    }
+    index->DeleteEntry(old_tuple->KeyFromTuple(*schema, *index->GetEntrySchema(), entry_attrs), rid, txn);
+    index->InsertEntry(new_tuple->KeyFromTuple(*schema, *index->GetEntrySchema(), entry_attrs), rid, txn);
+    // an abort moves the entry back to the old tuple
+    IndexWriteRecord record(rid, table_info_->oid_, WType::UPDATE, *new_tuple, index_info->index_oid_,
+                            exec_ctx_->GetCatalog());
+    record.old_tuple_ = *old_tuple;
+    txn->GetIndexWriteSet()->push_back(record);
+  }
+}
+
 }  // namespace bustub
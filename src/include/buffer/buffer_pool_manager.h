@@ -157,6 +157,12 @@ class BufferPoolManager {
   Page getPage(frame_id_t frame);
   // find VictimPage from the free_list_ first, then from the replacer
   frame_id_t findVictimPage();
+  // true if the page can be written without flushing the log first
+  bool isLogDurable(Page *page);
+  // flush the log up to the LSN of the page in the frame without holding latch_, lock holds latch_
+  void flushLogFor(std::unique_lock<std::mutex> *lock, frame_id_t frame_id);
+  // write the page in the frame to disk, flushing the log up to its LSN first
+  void writeBackPage(std::unique_lock<std::mutex> *lock, frame_id_t frame_id);
   /** Number of pages in the buffer pool. */
   size_t pool_size_;
   /** Array of buffer pool pages. */
@@ -164,7 +170,7 @@ class BufferPoolManager {
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. */
-  LogManager *log_manager_ __attribute__((__unused__));
+  LogManager *log_manager_;
   /** Page table for keeping track of buffer pool pages. */
   std::unordered_map<page_id_t, frame_id_t> page_table_;
   /** Replacer to find unpinned pages for replacement. */
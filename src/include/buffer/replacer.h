@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include "common/config.h"
 
 namespace bustub {
@@ -31,6 +33,17 @@ class Replacer {
    */
   virtual bool Victim(frame_id_t *frame_id) = 0;
 
+  /**
+   * Remove a victim frame, preferring frames the caller can evict cheaply. Falls back to Victim(frame_id) when no
+   * candidate is preferred. The default implementation ignores the preference.
+   * @param[out] frame_id id of frame that was removed
+   * @param prefer returns true for frames that should be evicted before the others
+   * @return true if a victim frame was found, false otherwise
+   */
+  virtual bool Victim(frame_id_t *frame_id, const std::function<bool(frame_id_t)> & /* prefer */) {
+    return Victim(frame_id);
+  }
+
   /**
    * Pins a frame, indicating that it should not be victimized until it is unpinned.
    * @param frame_id the id of the frame to pin
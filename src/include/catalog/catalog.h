@@ -11,7 +11,10 @@
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "storage/index/b_plus_tree_index.h"
+#include "storage/index/external_sorter.h"
 #include "storage/index/index.h"
+#include "storage/index/linear_probe_hash_table_index.h"
+#include "storage/index/var_b_plus_tree_index.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -78,6 +81,7 @@ struct IndexInfo {
   std::unique_ptr<Index> index_;
   index_oid_t index_oid_;
   std::string table_name_;
+  // 0 for an index with variable length keys
   const size_t key_size_;
 };
 
@@ -144,12 +148,14 @@ class Catalog {
    * @param key_schema the schema of the key
    * @param key_attrs key attributes
    * @param keysize size of the key
+   * @param unique false if the key may repeat, the key type then also has to hold the rid (8 bytes)
+   * @param include_attrs table columns stored in the entries after the key, the key type has to hold them too
    * @return a pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
                          const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
-                         size_t keysize) {
+                         size_t keysize, bool unique = true, const std::vector<uint32_t> &include_attrs = {}) {
 
     auto it = index_names_.find(table_name);
     if (it == index_names_.end()) {  // because we have make it in the CreateTable and we should create table before
@@ -158,19 +164,83 @@ class Catalog {
 
     index_oid_t index_oid = next_index_oid_++;
 
-    auto *index_meta = new IndexMetadata(index_name, table_name, &schema, key_attrs);
-    auto b_plus_tree_index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(index_meta, bpm_);
-    auto index_info = std::make_unique<IndexInfo>(key_schema, index_name, std::move(b_plus_tree_index), index_oid,
-                                                  table_name, keysize);
+    auto *index_meta = new IndexMetadata(index_name, table_name, &schema, key_attrs, include_attrs);
+    auto b_plus_tree_index =
+        std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(index_meta, bpm_, unique);
+
+    // sort the keys of the table and build the tree bottom-up instead of inserting the tuples one by one
+    ExternalSorter<KeyType, ValueType, KeyComparator> sorter{b_plus_tree_index->GetComparator()};
     auto table_meta = GetTable(table_name);
     auto table_it = table_meta->table_->Begin(txn);
     auto end = table_meta->table_->End();
 
     while (table_it != end) {
-      auto key = table_it->KeyFromTuple(schema, key_schema, key_attrs);
-      index_info->index_->InsertEntry(key, table_it->GetRid(), txn);
+      KeyType index_key;
+      b_plus_tree_index->MakeKey(
+          table_it->KeyFromTuple(schema, *index_meta->GetEntrySchema(), index_meta->GetEntryAttrs()),
+          table_it->GetRid(), &index_key, true);
+      sorter.Add(index_key, table_it->GetRid());
       ++table_it;
     }
+    sorter.Sort();
+    b_plus_tree_index->BulkLoad([&sorter](KeyType *key, ValueType *value) { return sorter.Next(key, value); });
+
+    auto index_info = std::make_unique<IndexInfo>(key_schema, index_name, std::move(b_plus_tree_index), index_oid,
+                                                  table_name, keysize);
+
+    index_names_[table_name].insert({index_name, index_oid});
+    indexes_.insert({index_oid, std::move(index_info)});
+    return indexes_[index_oid].get();
+  }
+
+  /**
+   * Create an index over variable length keys, whose keys are not padded to a fixed size like GenericKey.
+   * The tuples of the table are inserted one by one.
+   */
+  IndexInfo *CreateVarIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
+                            const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs) {
+    // throws for an unknown table before an index oid or any page is taken
+    auto table_meta = GetTable(table_name);
+    index_oid_t index_oid = next_index_oid_++;
+
+    auto *index_meta = new IndexMetadata(index_name, table_name, &schema, key_attrs);
+    auto var_index = std::make_unique<VarBPlusTreeIndex>(index_meta, bpm_);
+
+    for (auto table_it = table_meta->table_->Begin(txn); table_it != table_meta->table_->End(); ++table_it) {
+      var_index->InsertEntry(table_it->KeyFromTuple(schema, key_schema, key_attrs), table_it->GetRid(), txn);
+    }
+
+    auto index_info =
+        std::make_unique<IndexInfo>(key_schema, index_name, std::move(var_index), index_oid, table_name, 0);
+
+    index_names_[table_name].insert({index_name, index_oid});
+    indexes_.insert({index_oid, std::move(index_info)});
+    return indexes_[index_oid].get();
+  }
+
+  /**
+   * Create a hash index, which answers lookups of a single key but no key ranges, see HashIndexLookupPlanNode.
+   * The tuples of the table are inserted one by one.
+   * @param num_buckets the number of slots the hash table starts with, it grows when they fill up
+   */
+  template <class KeyType, class ValueType, class KeyComparator>
+  IndexInfo *CreateHashIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
+                             const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
+                             size_t keysize, size_t num_buckets) {
+    // throws for an unknown table before an index oid or any page is taken
+    auto table_meta = GetTable(table_name);
+    index_oid_t index_oid = next_index_oid_++;
+
+    auto *index_meta = new IndexMetadata(index_name, table_name, &schema, key_attrs);
+    auto hash_index = std::make_unique<LinearProbeHashTableIndex<KeyType, ValueType, KeyComparator>>(
+        index_meta, bpm_, num_buckets, HashFunction<KeyType>());
+
+    for (auto table_it = table_meta->table_->Begin(txn); table_it != table_meta->table_->End(); ++table_it) {
+      hash_index->InsertEntry(table_it->KeyFromTuple(schema, key_schema, key_attrs), table_it->GetRid(), txn);
+    }
+
+    auto index_info = std::make_unique<IndexInfo>(key_schema, index_name, std::move(hash_index), index_oid,
+                                                  table_name, keysize);
 
     index_names_[table_name].insert({index_name, index_oid});
     indexes_.insert({index_oid, std::move(index_info)});
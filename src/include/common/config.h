@@ -21,12 +21,21 @@ namespace bustub {
 /** Cycle detection is performed every CYCLE_DETECTION_INTERVAL milliseconds. */
 extern std::chrono::milliseconds cycle_detection_interval;
 
+/** B+ trees with lazy merging rebalance the leaves that removes left underfull every this many milliseconds. */
+extern std::chrono::milliseconds b_plus_tree_maintenance_interval;
+
 /** True if logging should be enabled, false otherwise. */
 extern std::atomic<bool> enable_logging;
 
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** True if flushed log batches should be compressed, recovery reads both kinds of batches. */
+extern std::atomic<bool> enable_log_compression;
+
+/** An asynchronous commit reaches the disk at most ASYNC_COMMIT_MAX_LAG after it returned. */
+extern std::chrono::milliseconds async_commit_max_lag;
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
@@ -35,6 +44,11 @@ static constexpr int PAGE_SIZE = 4096;                                        //
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr double BULK_LOAD_FILL_FACTOR = 0.9;                          // share of a page filled by bulk load
+static constexpr size_t KEY_COMPRESSION_MIN_KEY_SIZE = 32;                    // b+ tree indexes compress keys this wide
+static constexpr size_t VAR_KEY_MAX_SIZE = PAGE_SIZE / 16;                    // longest key of a varlen key index
+static constexpr size_t EXTERNAL_SORT_RUN_SIZE = 64 * 1024 * 1024;            // bytes sorted in memory per run
+static constexpr size_t INDEX_JOIN_BATCH_SIZE = 64;                          // outer tuples probed per index lookup
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
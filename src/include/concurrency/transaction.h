@@ -246,6 +246,16 @@ class Transaction {
    */
   inline void SetPrevLSN(lsn_t prev_lsn) { prev_lsn_ = prev_lsn; }
 
+  /** @return true if Commit returns before the COMMIT record is on disk */
+  inline bool IsAsyncCommit() const { return async_commit_; }
+
+  /**
+   * Set the commit mode. An asynchronous commit only appends the COMMIT record, the flush thread writes it within
+   * async_commit_max_lag. Wait for GetPrevLSN() after the commit to make it durable.
+   * @param async_commit true for asynchronous commit
+   */
+  inline void SetAsyncCommit(bool async_commit) { async_commit_ = async_commit; }
+
  private:
   /** The current transaction state. */
   TransactionState state_;
@@ -262,6 +272,8 @@ class Transaction {
   std::shared_ptr<std::deque<IndexWriteRecord>> index_write_set_;
   /** The LSN of the last record written by the transaction. */
   lsn_t prev_lsn_;
+  /** True if Commit does not wait for the log flush. */
+  bool async_commit_{false};
 
   /** Concurrent index: the pages that were latched during index operation. */
   std::shared_ptr<std::deque<Page *>> page_set_;
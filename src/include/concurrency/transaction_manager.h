@@ -73,6 +73,12 @@ class TransactionManager {
     return res;
   }
 
+  /**
+   * Set the commit mode of the transactions Begin() creates from now on, see Transaction::SetAsyncCommit.
+   * @param async_commit true for asynchronous commit
+   */
+  void SetAsyncCommit(bool async_commit) { async_commit_ = async_commit; }
+
   /** Prevents all transactions from performing operations, used for checkpointing. */
   void BlockAllTransactions();
 
@@ -98,8 +104,9 @@ class TransactionManager {
   }
 
   std::atomic<txn_id_t> next_txn_id_{0};
+  std::atomic<bool> async_commit_{false};
   LockManager *lock_manager_ __attribute__((__unused__));
-  LogManager *log_manager_ __attribute__((__unused__));
+  LogManager *log_manager_;
 
   /** The global transaction latch is used for checkpointing. */
   ReaderWriterLatch global_txn_latch_;
@@ -0,0 +1,162 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table.h
+//
+// Identification: src/include/container/hash/extendible_hash_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/transaction.h"
+#include "container/hash/hash_function.h"
+#include "container/hash/hash_table.h"
+#include "storage/index/generic_key.h"
+#include "storage/page/hash_table_bucket_page.h"
+#include "storage/page/hash_table_directory_page.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+
+#define EXTENDIBLE_HASH_TABLE_TYPE ExtendibleHashTable<KeyType, ValueType, KeyComparator>
+
+/**
+ * Implementation of extendible hash table that is backed by a buffer pool
+ * manager. Non-unique keys are supported. Supports insert and delete.
+ *
+ * A directory page maps the low global depth bits of a key's hash to a
+ * bucket page. A full bucket is split in two on its next hash bit, doubling
+ * the directory only if the bucket was already indexed by all of its bits,
+ * and an emptied bucket is merged back into its split image. So the table
+ * grows and shrinks one bucket at a time, instead of rehashing every pair
+ * like LinearProbeHashTable::Resize().
+ *
+ * Lookups, inserts and removes that stay within a bucket take table_latch_
+ * shared and only latch their bucket, a split or merge takes table_latch_
+ * exclusively for the time it moves the pairs of one bucket.
+ *
+ * A full bucket whose pairs and new key all agree on the hash bits a split
+ * could still use, like many values of one key, is not split but gets an
+ * overflow page chained to it, see HashTableBucketPage.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class ExtendibleHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
+ public:
+  /**
+   * Creates a new ExtendibleHashTable with a single bucket
+   *
+   * @param buffer_pool_manager buffer pool manager to be used
+   * @param comparator comparator for keys
+   * @param hash_fn the hash function
+   */
+  explicit ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                               const KeyComparator &comparator, HashFunction<KeyType> hash_fn);
+
+  /**
+   * Inserts a key-value pair into the hash table.
+   * @param transaction the current transaction
+   * @param key the key to create
+   * @param value the value to be associated with the key
+   * @return true if insert succeeded, false if the pair is in the table already
+   */
+  bool Insert(Transaction *transaction, const KeyType &key, const ValueType &value) override;
+
+  /**
+   * Deletes the associated value for the given key.
+   * @param transaction the current transaction
+   * @param key the key to delete
+   * @param value the value to delete
+   * @return true if remove succeeded, false otherwise
+   */
+  bool Remove(Transaction *transaction, const KeyType &key, const ValueType &value) override;
+
+  /**
+   * Performs a point query on the hash table.
+   * @param transaction the current transaction
+   * @param key the key to look up
+   * @param[out] result the value(s) associated with a given key
+   * @return the value(s) associated with the given key
+   */
+  bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) override;
+
+  /**
+   * @return the global depth of the directory
+   */
+  uint32_t GetGlobalDepth();
+
+  /**
+   * @return the number of distinct bucket pages
+   */
+  size_t GetNumBuckets();
+
+  /**
+   * Checks that every bucket is shared by the directory indexes its local depth says, and that all of its pairs hash
+   * to them, for tests.
+   * @return true if the directory and the buckets agree
+   */
+  bool VerifyIntegrity();
+
+ private:
+  // the low bits index the directory
+  uint32_t Hash(const KeyType &key);
+
+  HashTableDirectoryPage *FetchDirectoryPage();
+
+  HASH_TABLE_BUCKET_TYPE *FetchBucketPage(page_id_t bucket_page_id);
+
+  /**
+   * Collects the values of key from the bucket and its overflow pages. The caller holds the bucket page.
+   */
+  bool ChainGetValue(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key, std::vector<ValueType> *result);
+
+  /**
+   * Inserts the pair into the first page of the chain of bucket with room, unless the chain holds it already.
+   * @param[out] full true if no page of the chain has room for the pair
+   */
+  bool ChainInsert(HASH_TABLE_BUCKET_TYPE *bucket, page_id_t bucket_page_id, const KeyType &key,
+                   const ValueType &value, bool *full);
+
+  /**
+   * Removes the pair from the chain of bucket, an overflow page left empty is unlinked and deleted.
+   */
+  bool ChainRemove(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key, const ValueType &value);
+
+  /**
+   * @return true if a split of the full bucket at local_depth, or at a later depth, moves some of its pairs or key to
+   * the split image. Otherwise the bucket gets an overflow page.
+   */
+  bool CanSplit(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key, uint32_t local_depth);
+
+  /**
+   * Splits the bucket of key until it has room for the pair, then inserts it. Takes table_latch_ exclusively.
+   */
+  bool SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value);
+
+  /**
+   * Merges the bucket of key into its split image while it is empty and the two have the same local depth, and
+   * shrinks the directory as far as it can. Takes table_latch_ exclusively.
+   */
+  void Merge(Transaction *transaction, const KeyType &key);
+
+  // member variable
+  page_id_t directory_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+
+  // Readers includes inserts and removes that stay in their bucket, writer is splits and merges
+  ReaderWriterLatch table_latch_;
+
+  // Hash function
+  HashFunction<KeyType> hash_fn_;
+};
+
+}  // namespace bustub
@@ -32,6 +32,13 @@ namespace bustub {
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table dynamically grows once full.
+ *
+ * The slots are spread over block pages in order, a probe goes on from the
+ * last slot of a block to the first slot of the next and wraps around at the
+ * end of the table. A probe latches one block at a time, reads with a read
+ * latch and writes with a write latch, so operations on different blocks run
+ * in parallel. table_latch_ is taken shared by every operation and exclusively
+ * only by Resize(), which rehashes the table into new blocks twice as large.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
@@ -87,11 +94,30 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   size_t GetSize();
 
  private:
+  /**
+   * Creates num_blocks empty block pages and makes them the blocks of the table. The caller holds table_latch_
+   * exclusively or is the constructor.
+   */
+  void AllocateBlocks(size_t num_blocks);
+
+  /**
+   * Calls visit(block_index, block, offset) on the slots from the one a key with hash hashes to on, with the block
+   * write latched if exclusive and read latched otherwise, until visit returns true. Only the free slots, the
+   * tombstones and the slots with the key's fingerprint are visited. The caller holds table_latch_.
+   * @return false if visit went through all slots of the table without returning true
+   */
+  template <typename Visit>
+  bool Probe(uint64_t hash, bool exclusive, Visit &&visit);
+
   // member variable
   page_id_t header_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
+  // the block page ids and the number of slots, as in the header page
+  std::vector<page_id_t> block_page_ids_;
+  size_t num_buckets_{0};
+
   // Readers includes inserts and removes, writer is only resize
   ReaderWriterLatch table_latch_;
 
@@ -0,0 +1,56 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_index_lookup_executor.h
+//
+// Identification: src/include/execution/executors/hash_index_lookup_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "common/rid.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/hash_index_lookup_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * HashIndexLookupExecutor returns the tuples of one index key. The rids of the key are found by a single probe of the
+ * index, through Index::ScanKey, so any index serves the lookup and a hash index does it without a tree descent.
+ */
+class HashIndexLookupExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new hash index lookup executor.
+   * @param exec_ctx the executor context
+   * @param plan the hash index lookup plan to be executed
+   */
+  HashIndexLookupExecutor(ExecutorContext *exec_ctx, const HashIndexLookupPlanNode *plan);
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+  void Init() override;
+
+  bool Next(Tuple *tuple, RID *rid) override;
+
+ private:
+  /** @return the output tuple for a tuple of the table */
+  Tuple GetOutputTuple(const Tuple *t);
+
+  /** The hash index lookup plan node to be executed. */
+  const HashIndexLookupPlanNode *plan_;
+
+  TableMetadata *metadata_;
+  /** The rids of the looked up key, and the next one to return. */
+  std::vector<RID> rids_;
+  size_t rid_pos_{0};
+};
+}  // namespace bustub
@@ -42,16 +42,66 @@ class IndexScanExecutor : public AbstractExecutor {
   bool Next(Tuple *tuple, RID *rid) override;
 
  private:
+  /**
+   * Walks the entries of the scanned key range of the index in scan order. Its implementations know the type of the
+   * index and of its keys, see MakeCursor.
+   */
+  class Cursor {
+   public:
+    virtual ~Cursor() = default;
+
+    /** Move to the next entry of the range, false once the range is exhausted. */
+    virtual bool Next(RID *rid) = 0;
+
+    /** @return the value of a column of the key schema in the current entry */
+    virtual Value KeyValue(uint32_t column_idx) = 0;
+
+    /** @return the values of the columns of the entry schema in the current entry */
+    virtual std::vector<Value> EntryValues() = 0;
+  };
+
+  template <typename KeyType, typename KeyComparator>
+  class TreeCursor;
+  class PointCursor;
+
   /** added helper function */
   Tuple GetOutputTuple(const Schema *input_schema, const Schema *output_schema, const Tuple *t);
 
+  /**
+   * @return a cursor for the index of the plan, a range scan for a B+ tree index and a single key lookup for any other
+   * index, which is asked for its rids with Index::ScanKey
+   * @throw Exception if the index is no B+ tree index and the plan scans more than one key
+   */
+  std::unique_ptr<Cursor> MakeCursor();
+
+  /** @return a cursor over the B+ tree index of the plan if its keys have KeySize bytes, else nullptr */
+  template <size_t KeySize>
+  std::unique_ptr<Cursor> MakeTreeCursor();
+
+  /** @return true if the lower and the upper key of the plan are the same key */
+  bool ScansOneKey() const;
+
+  /** @return true if the current entry of the cursor passes the key predicate of the plan */
+  bool MatchKey();
+
+  /**
+   * @return true if the index entries hold every table column the plan reads. A tuple is then only fetched from the
+   * table when another transaction may have changed it since its entry was read.
+   */
+  bool CoversPlan() const;
+
+  /** @return a tuple of the table schema with the columns stored in the current entry, the others left null */
+  Tuple TupleFromEntry();
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
 
   // added
   IndexInfo *indexInfo_;
   TableMetadata *metadata_;
-  BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> *b_plus_tree_index_;
-  std::unique_ptr<IndexIterator<GenericKey<8>, RID, GenericComparator<8>>> index_iterator_;
+  /** The entries of the scanned range, dropped once the range is exhausted. */
+  std::unique_ptr<Cursor> cursor_;
+  /** Whether the output tuples are built from the index entries alone, see CoversPlan. */
+  bool covered_;
 };
 }  // namespace bustub
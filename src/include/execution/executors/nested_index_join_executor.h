@@ -51,11 +51,19 @@ class NestIndexJoinExecutor : public AbstractExecutor {
   /** added helper function */
   bool GetOutputTuple(const Tuple *outer_tuple, const Tuple *inner_tuple, Tuple *output_tuple);
 
+  /** Pull up to batch size outer tuples and look their join keys up in one index scan, false at the end. */
+  bool FetchBatch();
+
   /** The nested index join plan node. */
   const NestedIndexJoinPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> outer_executor_;
 
   // added
   TableMetadata *inner_metadata_;
+  std::vector<Tuple> outer_batch_;
+  // rid of the inner tuple matching each outer tuple of the batch
+  std::vector<RID> inner_rids_;
+  std::vector<bool> matched_;
+  size_t batch_pos_{0};
 };
 }  // namespace bustub
@@ -76,6 +76,9 @@ class UpdateExecutor : public AbstractExecutor {
   }
 
  private:
+  /** Moves the entries of the rid from old_tuple to new_tuple in every index whose entry columns changed. */
+  void UpdateIndexes(Tuple *old_tuple, Tuple *new_tuple, const RID &rid);
+
   /** The update plan node to be executed. */
   const UpdatePlanNode *plan_;
   /** Metadata identifying the table that should be updated. */
@@ -0,0 +1,58 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_index_lookup_plan.h
+//
+// Identification: src/include/execution/plans/hash_index_lookup_plan.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "catalog/catalog.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+/**
+ * HashIndexLookupPlanNode looks up the tuples whose index key equals a key, with one probe of the index instead of a
+ * walk over a key range. It serves equality predicates on the key columns of a hash index.
+ */
+class HashIndexLookupPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new hash index lookup plan node.
+   * @param output the output format of this lookup plan node
+   * @param predicate the predicate to test the found tuples with, tuples are returned if predicate(tuple) == true or
+   * predicate == nullptr
+   * @param index_oid the identifier of the index to look the key up in
+   * @param key the key to look up in the key schema of the index
+   */
+  HashIndexLookupPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid,
+                          const Tuple *key)
+      : AbstractPlanNode(output, {}), predicate_{predicate}, index_oid_(index_oid), key_(key) {}
+
+  PlanType GetType() const override { return PlanType::HashIndexLookup; }
+
+  /** @return the predicate to test tuples against; tuples should only be returned if they evaluate to true */
+  const AbstractExpression *GetPredicate() const { return predicate_; }
+
+  /** @return the identifier of the index to look the key up in */
+  index_oid_t GetIndexOid() const { return index_oid_; }
+
+  /** @return the key to look up */
+  const Tuple *GetKey() const { return key_; }
+
+ private:
+  /** The predicate that all returned tuples must satisfy. */
+  const AbstractExpression *predicate_;
+  /** The index to look the key up in. */
+  index_oid_t index_oid_;
+  /** The key whose tuples are returned. */
+  const Tuple *key_;
+};
+
+}  // namespace bustub
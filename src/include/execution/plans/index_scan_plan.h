@@ -28,9 +28,22 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * @param predicate the predicate to scan with, tuples are returned if predicate(tuple) == true or predicate ==
    * nullptr
    * @param table_oid the identifier of table to be scanned
+   * @param lower_key the smallest key to scan in the key schema of the index, nullptr scans from the first key
+   * @param upper_key the largest key to scan in the key schema of the index, nullptr scans to the last key
+   * @param key_predicate the predicate to test keys against before their tuples are fetched from the table, it is
+   * evaluated on a tuple of the key schema of the index, nullptr means every key in range is fetched
+   * @param descending true if the tuples are returned from the largest key to the smallest
    */
-  IndexScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid)
-      : AbstractPlanNode(output, {}), predicate_{predicate}, index_oid_(index_oid) {}
+  IndexScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid,
+                    const Tuple *lower_key = nullptr, const Tuple *upper_key = nullptr,
+                    const AbstractExpression *key_predicate = nullptr, bool descending = false)
+      : AbstractPlanNode(output, {}),
+        predicate_{predicate},
+        index_oid_(index_oid),
+        lower_key_(lower_key),
+        upper_key_(upper_key),
+        key_predicate_(key_predicate),
+        descending_(descending) {}
 
   PlanType GetType() const override { return PlanType::IndexScan; }
 
@@ -40,11 +53,30 @@ class IndexScanPlanNode : public AbstractPlanNode {
   /** @return the identifier of the table that should be scanned */
   index_oid_t GetIndexOid() const { return index_oid_; }
 
+  /** @return the inclusive lower bound of the scanned keys, nullptr if the scan starts at the first key */
+  const Tuple *GetLowerKey() const { return lower_key_; }
+
+  /** @return the inclusive upper bound of the scanned keys, nullptr if the scan ends at the last key */
+  const Tuple *GetUpperKey() const { return upper_key_; }
+
+  /** @return the predicate to test index keys against before fetching their tuples */
+  const AbstractExpression *GetKeyPredicate() const { return key_predicate_; }
+
+  /** @return true if the scan walks the index in descending key order */
+  bool IsDescending() const { return descending_; }
+
  private:
   /** The predicate that all returned tuples must satisfy. */
   const AbstractExpression *predicate_;
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
+  /** The key range to scan, both ends included. */
+  const Tuple *lower_key_;
+  const Tuple *upper_key_;
+  /** The predicate on index keys only, evaluated before the table heap is read. */
+  const AbstractExpression *key_predicate_;
+  /** Whether the keys are scanned in descending order. */
+  bool descending_;
 };
 
 }  // namespace bustub
@@ -31,13 +31,15 @@ class NestedIndexJoinPlanNode : public AbstractPlanNode {
  public:
   NestedIndexJoinPlanNode(const Schema *output_schema, std::vector<const AbstractPlanNode *> &&children,
                           const AbstractExpression *predicate, table_oid_t inner_table_oid, std::string index_name,
-                          const Schema *outer_table_schema, const Schema *inner_table_schema)
+                          const Schema *outer_table_schema, const Schema *inner_table_schema,
+                          size_t batch_size = INDEX_JOIN_BATCH_SIZE)
       : AbstractPlanNode(output_schema, std::move(children)),
         predicate_(predicate),
         inner_table_oid_(inner_table_oid),
         index_name_(std::move(index_name)),
         outer_table_schema_(outer_table_schema),
-        inner_table_schema_(inner_table_schema) {}
+        inner_table_schema_(inner_table_schema),
+        batch_size_(batch_size) {}
 
   PlanType GetType() const override { return PlanType::NestedIndexJoin; }
 
@@ -59,6 +61,9 @@ class NestedIndexJoinPlanNode : public AbstractPlanNode {
   /** @return Schema with needed columns in from the inner table */
   const Schema *InnerTableSchema() const { return inner_table_schema_; }
 
+  /** @return the number of outer tuples whose keys are looked up in the index at once */
+  size_t GetBatchSize() const { return batch_size_; }
+
  private:
   /** The nested index join predicate. */
   const AbstractExpression *predicate_;
@@ -66,5 +71,6 @@ class NestedIndexJoinPlanNode : public AbstractPlanNode {
   const std::string index_name_;
   const Schema *outer_table_schema_;
   const Schema *inner_table_schema_;
+  size_t batch_size_;
 };
 }  // namespace bustub
@@ -0,0 +1,58 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_compressor.h
+//
+// Identification: src/include/recovery/log_compressor.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * Every batch the LogManager flushes is written as one frame, so LogRecovery can find batch boundaries and
+ * decompress a batch before parsing its records. Records never span two frames.
+ *
+ * Frame format (size in bytes):
+ * ------------------------------------------------------
+ * | StoredSize (4) | RawSize (4) | batch (StoredSize) |
+ * ------------------------------------------------------
+ * StoredSize < RawSize means the batch is compressed, otherwise it holds the raw log records.
+ *
+ * The compressed block format is the one of LZ4: a sequence is a token byte (high nibble literal length,
+ * low nibble match length - 4, 15 means more length bytes follow), the literals, a 2 byte little endian match
+ * offset and the extra match length bytes. The last sequence only carries literals.
+ */
+class LogCompressor {
+ public:
+  static constexpr int32_t FRAME_HEADER_SIZE = 8;
+
+  /**
+   * Compress src into dst.
+   * @param src the raw bytes
+   * @param size number of raw bytes
+   * @param dst output buffer
+   * @param capacity size of dst, compression gives up when the output would not fit
+   * @return the compressed size, 0 if the output does not fit into capacity
+   */
+  static int32_t Compress(const char *src, int32_t size, char *dst, int32_t capacity);
+
+  /**
+   * Decompress a block written by Compress().
+   * @param src the compressed bytes
+   * @param size number of compressed bytes
+   * @param dst output buffer, must have room for raw_size bytes
+   * @param raw_size the expected decompressed size
+   * @return false if the block is corrupted or does not decompress to exactly raw_size bytes
+   */
+  static bool Decompress(const char *src, int32_t size, char *dst, int32_t raw_size);
+};
+
+}  // namespace bustub
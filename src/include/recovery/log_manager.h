@@ -17,6 +17,7 @@
 #include <future>              // NOLINT
 #include <mutex>               // NOLINT
 
+#include "recovery/log_compressor.h"
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
 
@@ -30,15 +31,19 @@ class LogManager {
  public:
   explicit LogManager(DiskManager *disk_manager)
       : next_lsn_(0), persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
-    flush_buffer_ = new char[LOG_BUFFER_SIZE];
+    // both buffers keep room for the frame header in front of the records
+    log_buffer_ = new char[LogCompressor::FRAME_HEADER_SIZE + LOG_BUFFER_SIZE];
+    flush_buffer_ = new char[LogCompressor::FRAME_HEADER_SIZE + LOG_BUFFER_SIZE];
+    compress_buffer_ = new char[LOG_BUFFER_SIZE];
   }
 
   ~LogManager() {
     delete[] log_buffer_;
     delete[] flush_buffer_;
+    delete[] compress_buffer_;
     log_buffer_ = nullptr;
     flush_buffer_ = nullptr;
+    compress_buffer_ = nullptr;
   }
 
   void RunFlushThread();
@@ -46,13 +51,35 @@ class LogManager {
 
   lsn_t AppendLogRecord(LogRecord *log_record);
 
+  /** Force every appended log record to disk, blocks until the persistent lsn catches up with it. */
+  void Flush();
+
+  /**
+   * Force the log records up to the given lsn to disk, blocks until GetPersistentLSN() >= lsn. Unlike
+   * WaitForPersistentLSN() the flush thread is woken up instead of waiting for its timeout. An lsn that was never
+   * assigned only flushes the records appended so far.
+   * @param lsn an lsn returned by AppendLogRecord
+   */
+  void Flush(lsn_t lsn);
+
+  /** Make the flush thread write every appended log record within async_commit_max_lag, does not block. */
+  void ScheduleFlush();
+
+  /**
+   * Block until the log record with the given lsn is on disk, i.e. GetPersistentLSN() >= lsn. Does not force a
+   * flush, the record is written by the next timeout or scheduled flush.
+   * @param lsn an lsn returned by AppendLogRecord
+   */
+  void WaitForPersistentLSN(lsn_t lsn);
+
   inline lsn_t GetNextLSN() { return next_lsn_; }
   inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
-  inline char *GetLogBuffer() { return log_buffer_; }
+  inline char *GetLogBuffer() { return log_buffer_ + LogCompressor::FRAME_HEADER_SIZE; }
 
  private:
-  // TODO(students): you may add your own member variables
+  /** Swap the log buffer out and write it to disk, the caller holds latch_ which is released during the write. */
+  void FlushBuffer(std::unique_lock<std::mutex> *lock);
 
   /** The atomic counter which records the next log sequence number. */
   std::atomic<lsn_t> next_lsn_;
@@ -61,14 +88,29 @@ class LogManager {
 
   char *log_buffer_;
   char *flush_buffer_;
+  /** Scratch space of the flush, only touched while flushing_ is set. */
+  char *compress_buffer_;
+  /** Bytes used in log_buffer_ and the lsn of the last record in it. */
+  int32_t offset_{0};
+  lsn_t buffer_last_lsn_{INVALID_LSN};
 
   std::mutex latch_;
 
-  std::thread *flush_thread_ __attribute__((__unused__));
+  std::thread *flush_thread_{nullptr};
+  bool stop_flush_{false};
+  /** Set when someone waits for a flush before the timeout expires. */
+  bool need_flush_{false};
+  /** The flush thread writes the buffer by this time, max() if no asynchronous commit is pending. */
+  std::chrono::steady_clock::time_point flush_deadline_{std::chrono::steady_clock::time_point::max()};
+  /** True while flush_buffer_ is being written, at most one write is in flight. */
+  bool flushing_{false};
 
+  /** Wakes up the flush thread. */
   std::condition_variable cv_;
+  /** Signalled every time a flush finished. */
+  std::condition_variable flushed_cv_;
 
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
 };
 
 }  // namespace bustub
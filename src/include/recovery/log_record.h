@@ -14,6 +14,8 @@
 
 #include <cassert>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "storage/table/tuple.h"
@@ -37,10 +39,15 @@ enum class LogRecordType {
 /**
  * For every write operation on the table page, you should write ahead a corresponding log record.
  *
- * For EACH log record, HEADER is like (5 fields in common, 20 bytes in total).
- *---------------------------------------------
- * | size | LSN | transID | prevLSN | LogType |
- *---------------------------------------------
+ * Log records are serialized in a compact form: integer fields are stored as LEB128 varints (signed fields are
+ * zigzag encoded first) and prevLSN is stored as its distance to LSN, so most headers fit in 5-8 bytes instead of 20.
+ *
+ * For EACH log record, HEADER is like (5 fields in common, variable length).
+ *------------------------------------------------------
+ * | size | LSN | transID | LSN - prevLSN | LogType (1) |
+ *------------------------------------------------------
+ * size counts the whole record, including the size field itself.
+ *
  * For insert type log record
  *---------------------------------------------------------------
  * | HEADER | tuple_rid | tuple_size | tuple_data(char[] array) |
@@ -49,14 +56,20 @@ enum class LogRecordType {
  *----------------------------------------------------------------
  * | HEADER | tuple_rid | tuple_size | tuple_data(char[] array) |
  *---------------------------------------------------------------
- * For update type log record
- *-----------------------------------------------------------------------------------
- * | HEADER | tuple_rid | tuple_size | old_tuple_data | tuple_size | new_tuple_data |
- *-----------------------------------------------------------------------------------
+ * For update type log record, either the full images (encoding = 0)
+ *----------------------------------------------------------------------------------------------
+ * | HEADER | tuple_rid | encoding | tuple_size | old_tuple_data | tuple_size | new_tuple_data |
+ *----------------------------------------------------------------------------------------------
+ * or, when both images have the same length and it is smaller, only the changed byte ranges (encoding = 1).
+ * Every range stores its distance to the end of the previous range, its length and old XOR new over that range.
+ *------------------------------------------------------------------------------------------------
+ * | HEADER | tuple_rid | encoding | tuple_size | range_count | gap | len | xor_data | gap | ... |
+ *------------------------------------------------------------------------------------------------
  * For new page type log record
- *--------------------------
- * | HEADER | prev_page_id |
- *--------------------------
+ *------------------------------------
+ * | HEADER | prev_page_id | page_id |
+ *------------------------------------
+ * tuple_rid is stored as | page_id | slot_num |.
  */
 class LogRecord {
   friend class LogManager;
@@ -67,7 +80,7 @@ class LogRecord {
 
   // constructor for Transaction type(BEGIN/COMMIT/ABORT)
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type)
-      : size_(HEADER_SIZE), txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type) {}
+      : txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type) {}
 
   // constructor for INSERT/DELETE type
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, const RID &rid, const Tuple &tuple)
@@ -81,8 +94,6 @@ class LogRecord {
       delete_rid_ = rid;
       delete_tuple_ = tuple;
     }
-    // calculate log record size
-    size_ = HEADER_SIZE + sizeof(RID) + sizeof(int32_t) + tuple.GetLength();
   }
 
   // constructor for UPDATE type
@@ -94,21 +105,17 @@ class LogRecord {
         update_rid_(update_rid),
         old_tuple_(old_tuple),
         new_tuple_(new_tuple) {
-    // calculate log record size
-    size_ = HEADER_SIZE + sizeof(RID) + old_tuple.GetLength() + new_tuple.GetLength() + 2 * sizeof(int32_t);
+    // only keep the changed byte ranges when that is cheaper than logging both images
+    BuildUpdateDelta();
   }
 
   // constructor for NEWPAGE type
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, page_id_t prev_page_id, page_id_t page_id)
-      : size_(HEADER_SIZE),
-        txn_id_(txn_id),
+      : txn_id_(txn_id),
         prev_lsn_(prev_lsn),
         log_record_type_(log_record_type),
         prev_page_id_(prev_page_id),
-        page_id_(page_id) {
-    // calculate log record size, header size + sizeof(prev_page_id) + sizeof(page_id)
-    size_ = HEADER_SIZE + sizeof(page_id_t) * 2;
-  }
+        page_id_(page_id) {}
 
   ~LogRecord() = default;
 
@@ -128,6 +135,36 @@ class LogRecord {
 
   inline page_id_t GetNewPageRecord() { return prev_page_id_; }
 
+  inline page_id_t GetNewPageId() { return page_id_; }
+
+  /** @return true if this UPDATE record only carries the changed byte ranges instead of both tuple images */
+  inline bool IsDeltaUpdate() const { return delta_update_; }
+
+  /**
+   * Rebuild one image of a delta UPDATE from the other one. The delta is old XOR new over the changed ranges, so the
+   * same call turns the old tuple into the new one (redo) and the new tuple into the old one (undo).
+   * @param image the tuple currently stored at the updated rid
+   * @return the other image
+   */
+  Tuple ApplyUpdateDelta(const Tuple &image) const;
+
+  /** @return the number of bytes SerializeTo() writes for this record, the LSN must already be assigned */
+  int32_t GetSerializedSize() const;
+
+  /**
+   * Serialize this record into storage, which must have room for GetSerializedSize() bytes.
+   * The size field written is the one computed by GetSerializedSize(), not size_.
+   */
+  void SerializeTo(char *storage) const;
+
+  /**
+   * Deserialize a record from storage (deep copy).
+   * @param storage start of the serialized record
+   * @param available number of readable bytes starting at storage
+   * @return false if storage does not hold a complete record
+   */
+  bool DeserializeFrom(const char *storage, int32_t available);
+
   inline int32_t GetSize() { return size_; }
 
   inline lsn_t GetLSN() { return lsn_; }
@@ -172,11 +209,20 @@ class LogRecord {
   RID update_rid_;
   Tuple old_tuple_;
   Tuple new_tuple_;
+  // for delta encoded update operation, (offset, old XOR new) of every changed byte range.
+  // A deserialized delta record only carries the ranges, its old/new tuple stay empty.
+  bool delta_update_{false};
+  uint32_t delta_tuple_size_{0};
+  std::vector<std::pair<uint32_t, std::string>> update_delta_;
 
   // case4: for new page operation
   page_id_t prev_page_id_{INVALID_PAGE_ID};
   page_id_t page_id_{INVALID_PAGE_ID};
-  static const int HEADER_SIZE = 20;
+
+  void BuildUpdateDelta();
+
+  template <typename Sink>
+  void SerializeBody(Sink *sink) const;
 };  // namespace bustub
 
 }  // namespace bustub
@@ -15,6 +15,7 @@
 #include <algorithm>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <utility>
 
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/lock_manager.h"
@@ -30,11 +31,14 @@ class LogRecovery {
   LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager)
       : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), offset_(0) {
     log_buffer_ = new char[LOG_BUFFER_SIZE];
+    frame_buffer_ = new char[LOG_BUFFER_SIZE];
   }
 
   ~LogRecovery() {
     delete[] log_buffer_;
+    delete[] frame_buffer_;
     log_buffer_ = nullptr;
+    frame_buffer_ = nullptr;
   }
 
   void Redo();
@@ -42,16 +46,32 @@ class LogRecovery {
   bool DeserializeLogRecord(const char *data, LogRecord *log_record);
 
  private:
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  /**
+   * Read the log frame starting at offset and decompress its records into log_buffer_.
+   * @param[out] frame_size the number of log file bytes the frame occupies
+   * @return false at the end of the log or for a damaged frame
+   */
+  bool ReadFrame(int offset, int32_t *frame_size);
+  /** Reapply one record if the page has not seen it yet. */
+  void RedoLogRecord(LogRecord *log_record);
+  /** Apply the inverse of one record of a loser transaction. */
+  void UndoLogRecord(LogRecord *log_record);
+
+  DiskManager *disk_manager_;
+  BufferPoolManager *buffer_pool_manager_;
 
   /** Maintain active transactions and its corresponding latest lsn. */
   std::unordered_map<txn_id_t, lsn_t> active_txn_;
-  /** Mapping the log sequence number to log file offset for undos. */
-  std::unordered_map<lsn_t, int> lsn_mapping_;
+  /** Mapping the log sequence number to (log file offset of its frame, offset inside the frame) for undos. */
+  std::unordered_map<lsn_t, std::pair<int, int32_t>> lsn_mapping_;
 
-  int offset_ __attribute__((__unused__));
+  /** Log file offset of the frame being scanned. */
+  int offset_;
+  /** Records of the frame last read by ReadFrame(), raw_size_ bytes of it are valid. */
   char *log_buffer_;
+  int32_t raw_size_{0};
+  /** Compressed bytes of a frame. */
+  char *frame_buffer_;
 };
 
 }  // namespace bustub
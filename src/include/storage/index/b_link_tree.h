@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/b_link_tree.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/transaction.h"
+#include "storage/page/b_link_tree_page.h"
+
+namespace bustub {
+
+#define BLINKTREE_TYPE BLinkTree<KeyType, ValueType, KeyComparator>
+
+/**
+ * B-link tree after Lehman and Yao, a variant of the B+ tree whose pages carry
+ * a high key and a link to their right sibling on every level (see
+ * BLinkTreePage).
+ *
+ * A split moves the upper half of a page to a new page on its right and links
+ * it in before the separator reaches the parent, so a key that is no longer
+ * in a page is always found by following right links from it. Readers
+ * therefore hold one latch at a time: they release a page before latching the
+ * child it points to, and move right when the key is at or above the high key
+ * of the page they land on. Writers descend the same way, remember the pages
+ * they passed on the way down instead of keeping them latched, and only latch
+ * the parent once a split has to be posted to it. Latches are always taken
+ * from left to right on a level and from a lower level to a higher one, so
+ * the protocol is free of deadlocks.
+ * (1) We only support unique key
+ * (2) Pages are never merged or freed, a remove only takes the key out of
+ *     its leaf and later inserts into the same range reuse the space
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BLinkTree {
+  using InternalPage = BLinkTreePage<KeyType, page_id_t, KeyComparator>;
+  using LeafPage = BLinkTreePage<KeyType, ValueType, KeyComparator>;
+
+ public:
+  explicit BLinkTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                     int leaf_max_size = B_LINK_LEAF_PAGE_SIZE, int internal_max_size = B_LINK_INTERNAL_PAGE_SIZE);
+
+  // Returns true if this tree has no pages yet.
+  bool IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
+
+  // Insert a key-value pair into this tree, false if the key exists.
+  bool Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // Remove a key and its value from this tree.
+  void Remove(const KeyType &key, Transaction *transaction = nullptr);
+
+  // return the value associated with a given key
+  bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
+
+  // calls visit on the pairs from key on in key order until it returns false, the leaf of the pair stays read latched
+  void Scan(const KeyType &key, const std::function<bool(const KeyType &, const ValueType &)> &visit);
+
+  page_id_t GetRootPageId() const { return root_page_id_; }
+
+ private:
+  /**
+   * Descends to the page of level that holds key and returns it latched,
+   * exclusively or shared. The pages above it are latched one at a time, and
+   * the internal pages the descent goes through are collected in stack.
+   */
+  Page *FindPage(const KeyType &key, uint32_t level, std::vector<page_id_t> *stack, bool exclusive);
+
+  // follows the right links of the latched page until key is below its high key, returns the latched page
+  Page *MoveRight(Page *page, const KeyType &key, bool exclusive);
+
+  void StartNewTree(const KeyType &key, const ValueType &value);
+
+  /**
+   * Posts the split of the write latched page child, whose upper half moved to
+   * right starting at key, to its parent. stack holds the internal pages passed
+   * on the way down, the parent or a page left of it is on top. Unlatches child.
+   */
+  void InsertIntoParent(std::vector<page_id_t> *stack, Page *child, const KeyType &key, page_id_t right);
+
+  Page *FetchPage(page_id_t page_id);
+
+  Page *NewPage(page_id_t *page_id);
+
+  void UpdateRootPageId(int insert_record = 0);
+
+  // member variable
+  std::string index_name_;
+  std::atomic<page_id_t> root_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  int leaf_max_size_;
+  int internal_max_size_;
+
+  // serializes the changes of root_page_id_, readers load it without a latch
+  std::mutex root_latch_;
+};
+
+}  // namespace bustub
@@ -10,8 +10,14 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "concurrency/transaction.h"
@@ -29,10 +35,30 @@ namespace bustub {
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) We only support unique key, non-unique indexes append the rid to their keys (see BPlusTreeIndex)
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * With key compression every page stores the bytes its keys have in common
+ * only once and leaves out their zero tails, and a leaf split pushes the
+ * shortest key that still separates the two leaves up to the parent. Pages
+ * then hold more keys the more alike the keys are, up to twice as many as
+ * at full width, and are only merged or rebalanced when the keys fit.
+ *
+ * With lazy merging a remove only rebalances a leaf that falls below a
+ * quarter full. Leaves between a quarter and half full are remembered and
+ * rebalanced later by RebalanceUnderfull(), which a background thread runs
+ * every b_plus_tree_maintenance_interval, so keys that are removed and
+ * inserted again around half full do not merge and split leaves each time.
+ *
+ * With cached levels the internal pages of the top levels stay pinned in a
+ * table of frames by page id, which lookups, scans and the optimistic inserts
+ * and removes take their pages from instead of fetching them from the buffer
+ * pool. The table is only read, a new one is built by the next insert or
+ * remove that latches the root once a root change, a split of a cached page
+ * or the delete of one retired the old table. A retired table keeps its pages
+ * pinned until no descent that may still read it is running.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
@@ -41,7 +67,10 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     bool key_compression = false);
+
+  ~BPlusTree();
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
@@ -52,14 +81,26 @@ class BPlusTree {
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
+  // Build this (empty) B+ tree bottom-up from key-value pairs in ascending key order.
+  bool BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor = BULK_LOAD_FILL_FACTOR);
+
   // return the value associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
 
+  // look up a batch of keys in ascending order, (*result)[i] holds the value of keys[i] if it exists
+  size_t GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *result,
+                   Transaction *transaction = nullptr);
+
   // index iterator
   INDEXITERATOR_TYPE begin();
   INDEXITERATOR_TYPE Begin(const KeyType &key);
   INDEXITERATOR_TYPE end();
 
+  // reverse index iterator, from the largest key (or the largest key not greater than key) down to the smallest
+  REVERSE_INDEXITERATOR_TYPE rbegin();
+  REVERSE_INDEXITERATOR_TYPE RBegin(const KeyType &key);
+  REVERSE_INDEXITERATOR_TYPE rend();
+
   void Print(BufferPoolManager *bpm) {
     ToString(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(root_page_id_)->GetData()), bpm);
   }
@@ -80,7 +121,34 @@ class BPlusTree {
   // read data from file and remove one by one
   void RemoveFromFile(const std::string &file_name, Transaction *transaction = nullptr);
   // expose for test purpose
-  Page *FindLeafPage(const KeyType &key, bool leftMost = false);  // 读锁
+  Page *FindLeafPage(const KeyType &key, bool leftMost = false, bool rightMost = false);  // 读锁
+
+  // the read latched leaf holding the largest key smaller than key and its index, nullptr if there is none
+  Page *FindLeafBefore(const KeyType &key, int *index);
+
+  // the page id of the leaf before leaf, the caller holds the latch of leaf
+  page_id_t GetPrevLeafId(const LeafPage *leaf);
+
+  // insert and remove try a read latched descent first and fall back to latch crabbing with write latches,
+  // point lookups read without latches and validate page versions (optimistic lock coupling)
+  void SetOptimisticLatching(bool enable) { optimistic_latching_ = enable; }
+
+  // tolerate leaves down to a quarter full on remove and rebalance the others in the background, disabling it
+  // stops the background thread and rebalances the remembered leaves at once
+  void SetLazyMerge(bool enable);
+
+  // rebalance the leaves that removes left less than half full, returns the number of leaves rebalanced
+  size_t RebalanceUnderfull();
+
+  // expose for test purpose, the number of leaves that removes rebalanced themselves
+  size_t GetRemoveRebalanceCount() const { return remove_rebalance_count_; }
+
+  // keep the internal pages of the top levels pinned, level 1 is the root, 0 (the default) turns it off. Set it
+  // before the tree is used by several threads, like the other switches
+  void SetCachedLevels(int levels);
+
+  // expose for test purpose, the number of pages the current table of cached levels holds
+  size_t GetCachedPageCount() const;
 
  private:
   void StartNewTree(const KeyType &key, const ValueType &value);
@@ -96,6 +164,14 @@ class BPlusTree {
   template <typename N>
   bool CoalesceOrRedistribute(N **node, Transaction *transaction = nullptr);
 
+  // the size a leaf is rebalanced below, lower on the remove path with lazy merging
+  int MinLeafSize(const LeafPage *leaf, bool lazy) const;
+
+  // remember leaf for RebalanceUnderfull() if a remove of key left it less than half full
+  void NoteUnderfull(const LeafPage *leaf, const KeyType &key);
+
+  void RunMaintenance();
+
   template <typename N>
   bool Coalesce(N *neighbor_node, N *node, BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *parent, int index,
                 Transaction *transaction = nullptr);
@@ -103,8 +179,19 @@ class BPlusTree {
   template <typename N>
   void Redistribute(N *neighbor_node, N *node, int index);
 
+  template <typename N>
+  bool RedistributeFits(N *neighbor_node, N *node, BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *parent,
+                        int index);
+
+  // the key pushed up to the parent when leaf got the new right sibling new_leaf
+  KeyType SeparatorOf(LeafPage *leaf, LeafPage *new_leaf) const;
+
+  KeyType ShortestSeparator(const KeyType &left, const KeyType &right) const;
+
   bool AdjustRoot(BPlusTreePage *node);
 
+  void RelinkNextLeaf(LeafPage *leaf);
+
   void UpdateRootPageId(int insert_record = 0);
 
   /* helper function for find subling in split */
@@ -113,13 +200,27 @@ class BPlusTree {
 
   /* helper function for latch crabbing below */
   template <typename N>
-  bool coalesceOrNot(N *node, N *sibling);
-  /* op == 1 means insert; op == 2 means delete */
+  bool coalesceOrNot(N *node, N *sibling, const KeyType &middle_key);
+  /* op == 1 means insert; op == 2 means delete; op == 3 means rebalance */
   template <typename N>
-  bool Safe(N *node, int op);
+  bool Safe(N *node, int op, const KeyType &key);
 
   Page *Search(const KeyType &key, int op, Transaction *transaction);
 
+  Page *OptimisticSearch(const KeyType &key, bool *root_locked);
+
+  bool OptimisticInsert(const KeyType &key, const ValueType &value, bool *res);
+
+  bool OptimisticRemove(const KeyType &key);
+
+  bool OptimisticGetValue(const KeyType &key, std::vector<ValueType> *result, bool *found);
+
+  Page *FindLeafPageWithBounds(const KeyType &key, std::vector<KeyType> *bounds, bool *root_locked);
+
+  Page *MoveRightToLeaf(Page *page, const KeyType &key, std::vector<KeyType> *bounds, bool *exact, bool *root_locked);
+
+  void ReleaseLeaf(Page *page, bool *root_locked);
+
   void LockPage(Page *page, bool enable, int op = 0);  // enable == true means WLatch,  enable == false means RLatch
 
   void UnlockPage(Page *page, bool enable, int op = 0);
@@ -136,6 +237,40 @@ class BPlusTree {
   void LockRoot(bool exclusive, int op = 0);
   void UnlockRoot(bool exclusive, int op = 0);
 
+  // frames of the cached upper levels by page id, a table is never changed once it is published
+  using CachedFrames = std::unordered_map<page_id_t, Page *>;
+
+  // a descent that may take pages from the table runs between these two and hands the table back on leaving,
+  // nullptr if the upper levels are not cached, an empty table while none is built
+  const CachedFrames *EnterCachedLevels();
+  void LeaveCachedLevels(const CachedFrames *frames);
+
+  // the cached frame of page_id if the table has one, otherwise the page pinned from the buffer pool
+  Page *FetchUpperPage(page_id_t page_id, const CachedFrames *frames, bool *cached);
+
+  bool IsCachedPage(page_id_t page_id);
+
+  // builds a new table if there is none, with the root latched exclusively and no page latched
+  void RebuildCachedLevels();
+
+  // page is pinned and read latched, keeps it in frames if it is an internal page, and levels - 1 levels below it
+  bool CacheLevels(Page *page, int levels, CachedFrames *frames);
+
+  // takes the table out of use, deleted_page_id is a page of it to delete once the table lets it go
+  void RetireCachedLevels(page_id_t deleted_page_id = INVALID_PAGE_ID);
+
+  // unpins the retired tables if no descent is running, and deletes their pages that left the tree meanwhile
+  void ReleaseRetiredLevels();
+
+  // optimistic lookups that keep conflicting with writers fall back to read latches after this many attempts
+  static constexpr int OPTIMISTIC_READ_ATTEMPTS = 4;
+
+  // a batched lookup follows at most this many sibling links before it descends from the root again
+  static constexpr size_t BATCH_LOOKUP_SIBLING_HOPS = 2;
+
+  // the cached levels pin at most this share of the buffer pool
+  static constexpr size_t CACHED_LEVELS_POOL_DIVISOR = 4;
+
   // member variable
   std::string index_name_;
   page_id_t root_page_id_;
@@ -143,6 +278,32 @@ class BPlusTree {
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  bool key_compression_;
+  // separators are only cut short when every key column is stored inline in the key
+  bool truncate_separators_;
+  bool optimistic_latching_{true};
+  bool lazy_merge_{false};
+  std::atomic<size_t> remove_rebalance_count_{0};
+
+  // a key of every leaf left less than half full by lazy merging, by page id
+  std::mutex underfull_latch_;
+  std::unordered_map<page_id_t, KeyType> underfull_leaves_;
+  std::atomic<bool> enable_maintenance_{false};
+  std::thread *maintenance_thread_{nullptr};
+
+  std::atomic<int> cached_levels_{0};
+  std::atomic<const CachedFrames *> cached_frames_{nullptr};
+  const CachedFrames no_cached_frames_;
+  // descents between EnterCachedLevels() and LeaveCachedLevels()
+  std::atomic<int> cached_frame_readers_{0};
+  std::mutex retired_latch_;
+  std::atomic<bool> has_retired_{false};
+  std::vector<const CachedFrames *> retired_frames_;
+  std::vector<page_id_t> retired_deletes_;
+
+  // previous page ids RelinkNextLeaf() could not write because another thread held the leaf, by leaf page id
+  std::mutex relink_latch_;
+  std::unordered_map<page_id_t, page_id_t> pending_prev_ids_;
 
   // adds a mutex protect the root_page_id
   ReaderWriterLatch mutex;
@@ -11,7 +11,9 @@
 
 #pragma once
 
+#include <functional>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -22,10 +24,25 @@ namespace bustub {
 
 #define BPLUSTREE_INDEX_TYPE BPlusTreeIndex<KeyType, ValueType, KeyComparator>
 
+/**
+ * Index over a B+ tree, whose keys must be unique. A non-unique index keeps
+ * every (key, rid) entry by appending the page id and slot of the rid to the
+ * key as two hidden INTEGER columns, so the entries of a key are stored next
+ * to each other in rid order and a key is scanned as the range of its rids.
+ * The keys of a run of duplicates share all their leading bytes, so
+ * non-unique indexes always compress the keys of their pages, which then
+ * hold the key bytes once and little more than the rids after them.
+ *
+ * The included columns of the metadata are stored in the key after the
+ * columns it is ordered by, where the comparator does not look at them, so an
+ * index scan that reads no other columns takes them from the entries instead
+ * of fetching the tuples from the table. The keys of a NormalizedComparator
+ * are ordered by all of their bytes and cannot carry included columns.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager);
+  BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager, bool unique = true);
 
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
@@ -33,13 +50,49 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *result,
+                Transaction *transaction) override;
+
+  // build the empty index from (key, rid) pairs in ascending key order
+  bool BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor = BULK_LOAD_FILL_FACTOR);
+
+  bool IsUnique() const { return unique_; }
+
+  // the key of the tree for the entry of key tuple and rid, the rid is only part of it in a non-unique index. With
+  // included key is a tuple of the entry schema whose included columns are stored too, else of the key schema
+  void MakeKey(const Tuple &key, RID rid, KeyType *index_key, bool included = false) const;
+
+  // the values of the columns of the entry schema stored in index_key, see IndexMetadata::GetEntrySchema
+  std::vector<Value> EntryValues(const KeyType &index_key) const;
+
+  const KeyComparator &GetComparator() const { return comparator_; }
+
+  // the keys of the iterators end with the rid in a non-unique index, see MakeKey
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
 
   INDEXITERATOR_TYPE GetEndIterator();
 
+  REVERSE_INDEXITERATOR_TYPE GetReverseBeginIterator();
+
+  REVERSE_INDEXITERATOR_TYPE GetReverseBeginIterator(const KeyType &key);
+
+  REVERSE_INDEXITERATOR_TYPE GetReverseEndIterator();
+
  protected:
+  // schema of the columns the tree orders its keys by, the key schema followed by the rid columns in a non-unique index
+  static Schema *OrderSchema(const Schema *key_schema, bool unique);
+
+  // schema of the keys in the tree, the order schema followed by the included columns
+  static Schema *StoredSchema(const Schema *order_schema, const IndexMetadata *metadata);
+
+  // compressed pages are not capped at the full width fanout, they hold as many keys as fit
+  static bool CompressKeys(bool unique) { return !unique || sizeof(KeyType) >= KEY_COMPRESSION_MIN_KEY_SIZE; }
+
+  bool unique_;
+  std::unique_ptr<Schema> order_schema_;
+  std::unique_ptr<Schema> stored_schema_;
   // comparator for key
   KeyComparator comparator_;
   // container
@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/storage/index/external_sorter.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define EXTERNAL_SORTER_TYPE ExternalSorter<KeyType, ValueType, KeyComparator>
+
+/**
+ * Sorts (key, value) pairs that may not fit into memory, used to feed BPlusTree::BulkLoad.
+ *
+ * Pairs are collected into a run of at most run_size bytes. A full run is sorted and spilled to a temporary file.
+ * After Sort(), Next() returns the pairs in key order, merging the spilled runs if there are any. Inputs that fit
+ * into one run never touch the disk.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ExternalSorter {
+ public:
+  explicit ExternalSorter(const KeyComparator &comparator, size_t run_size = EXTERNAL_SORT_RUN_SIZE);
+  ~ExternalSorter();
+
+  DISALLOW_COPY(ExternalSorter);
+
+  void Add(const KeyType &key, const ValueType &value);
+
+  // sort the pairs added so far, no pair can be added afterwards
+  void Sort();
+
+  // @return false once all pairs were returned
+  bool Next(KeyType *key, ValueType *value);
+
+  // number of runs spilled to disk
+  size_t GetRunCount() const { return runs_.size(); }
+
+ private:
+  struct Run {
+    std::FILE *file_;
+    std::vector<MappingType> buffer_;
+    size_t pos_;
+  };
+
+  void SortRun();
+
+  void SpillRun();
+
+  // read the next batch of a spilled run, false when the run is exhausted
+  bool RefillRun(Run *run);
+
+  // heap order on the current pair of each run, smallest key on top
+  bool HeapGreater(size_t lhs, size_t rhs) const;
+
+  KeyComparator comparator_;
+  size_t run_capacity_;
+  std::vector<MappingType> run_;
+  size_t run_pos_{0};
+  std::vector<Run> runs_;
+  std::vector<size_t> heap_;
+  bool sorted_{false};
+};
+
+}  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <cstring>
 
+#include "common/exception.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -35,6 +36,15 @@ class GenericKey {
     memcpy(data_, tuple.GetData(), tuple.GetLength());
   }
 
+  // same as above, keys are stored as the tuple is serialized so the schema is not needed, but a key that does not
+  // fit in the key size is rejected rather than cut short
+  inline void SetFromKey(const Tuple &tuple, Schema *key_schema) {
+    if (tuple.GetLength() > KeySize) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "key does not fit in the key size");
+    }
+    SetFromKey(tuple);
+  }
+
   // NOTE: for test purpose only
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
@@ -94,13 +104,23 @@ class GenericComparator {
     return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  GenericComparator(const GenericComparator &other)
+      : key_schema_{other.key_schema_}, single_bigint_{other.single_bigint_} {}
+
+  // true if no key column points to variable length data elsewhere in the key
+  bool IsInlined() const { return key_schema_->IsInlined(); }
+
+  // true if the key is a single BIGINT column, stored as a native integer at the start of the key
+  bool IsSingleBigInt() const { return single_bigint_; }
 
   // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  explicit GenericComparator(Schema *key_schema)
+      : key_schema_(key_schema),
+        single_bigint_(key_schema->GetColumnCount() == 1 && key_schema->GetColumn(0).GetType() == TypeId::BIGINT) {}
 
  private:
   Schema *key_schema_;
+  bool single_bigint_;
 };
 
 }  // namespace bustub
@@ -37,12 +37,21 @@ class IndexMetadata {
   IndexMetadata() = delete;
 
   IndexMetadata(std::string index_name, std::string table_name, const Schema *tuple_schema,
-                std::vector<uint32_t> key_attrs)
-      : name_(std::move(index_name)), table_name_(std::move(table_name)), key_attrs_(std::move(key_attrs)) {
+                std::vector<uint32_t> key_attrs, std::vector<uint32_t> include_attrs = {})
+      : name_(std::move(index_name)),
+        table_name_(std::move(table_name)),
+        key_attrs_(std::move(key_attrs)),
+        include_attrs_(std::move(include_attrs)) {
     key_schema_ = Schema::CopySchema(tuple_schema, key_attrs_);
+    entry_attrs_ = key_attrs_;
+    entry_attrs_.insert(entry_attrs_.end(), include_attrs_.begin(), include_attrs_.end());
+    entry_schema_ = Schema::CopySchema(tuple_schema, entry_attrs_);
   }
 
-  ~IndexMetadata() { delete key_schema_; }
+  ~IndexMetadata() {
+    delete key_schema_;
+    delete entry_schema_;
+  }
 
   inline const std::string &GetName() const { return name_; }
 
@@ -60,6 +69,15 @@ class IndexMetadata {
   //  columns
   inline const std::vector<uint32_t> &GetKeyAttrs() const { return key_attrs_; }
 
+  // Returns the base table columns stored along with the key without being part of it
+  inline const std::vector<uint32_t> &GetIncludeAttrs() const { return include_attrs_; }
+
+  // Returns the key columns followed by the included columns, the columns of the tuples
+  // that InsertEntry and DeleteEntry take
+  inline const std::vector<uint32_t> &GetEntryAttrs() const { return entry_attrs_; }
+
+  inline Schema *GetEntrySchema() const { return entry_schema_; }
+
   // Get a string representation for debugging
   std::string ToString() const {
     std::stringstream os;
@@ -78,8 +96,13 @@ class IndexMetadata {
   std::string table_name_;
   // The mapping relation between key schema and tuple schema
   const std::vector<uint32_t> key_attrs_;
+  // the columns stored in the entries after the key, for scans that read no more than the entry
+  const std::vector<uint32_t> include_attrs_;
+  std::vector<uint32_t> entry_attrs_;
   // schema of the indexed key
   Schema *key_schema_;
+  // schema of the key followed by the included columns
+  Schema *entry_schema_;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -117,6 +140,10 @@ class Index {
 
   const std::vector<uint32_t> &GetKeyAttrs() const { return metadata_->GetKeyAttrs(); }
 
+  Schema *GetEntrySchema() const { return metadata_->GetEntrySchema(); }
+
+  const std::vector<uint32_t> &GetEntryAttrs() const { return metadata_->GetEntryAttrs(); }
+
   // Get a string representation for debugging
   std::string ToString() const {
     std::stringstream os;
@@ -129,14 +156,24 @@ class Index {
   ///////////////////////////////////////////////////////////////////
   // Point Modification
   ///////////////////////////////////////////////////////////////////
-  // designed for secondary indexes.
+  // designed for secondary indexes. key is a tuple of the entry schema, which holds the included
+  // columns after the key columns, see IndexMetadata::GetEntrySchema
   virtual void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) = 0;
 
-  // delete the index entry linked to given tuple
+  // delete the index entry linked to given tuple, a tuple of the entry schema like for InsertEntry
   virtual void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) = 0;
 
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  // scan a batch of keys, (*result)[i] gets the rids of keys[i]; indexes that can share work across keys override it
+  virtual void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *result,
+                        Transaction *transaction) {
+    result->assign(keys.size(), std::vector<RID>());
+    for (size_t i = 0; i < keys.size(); i++) {
+      ScanKey(keys[i], &(*result)[i], transaction);
+    }
+  }
+
  private:
   //===--------------------------------------------------------------------===//
   //  Data members
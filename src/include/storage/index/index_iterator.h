@@ -13,26 +13,45 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <vector>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
+#define REVERSE_INDEXITERATOR_TYPE ReverseIndexIterator<KeyType, ValueType, KeyComparator>
+
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
 
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
  public:
-  // you may define your own constructor based on your member variable
-  IndexIterator(page_id_t pageId, int index, int size, BufferPoolManager *buffer_pool_manager);
+  // takes over the pinned and read latched leaf page, which is released once the iterator moves past it or is
+  // destroyed, so a scan can stop anywhere
+  IndexIterator(Page *page, int index, BufferPoolManager *buffer_pool_manager);
   explicit IndexIterator(bool is_end);
+  IndexIterator(IndexIterator &&other) noexcept;
+  IndexIterator &operator=(IndexIterator &&other) noexcept;
   ~IndexIterator();
 
+  DISALLOW_COPY(IndexIterator);
+
   bool isEnd() const;
 
   const MappingType &operator*();
 
   IndexIterator &operator++();
 
+  /**
+   * Appends the items of the current leaf from the iterator on to batch and
+   * moves on to the first item of the next leaf, so a scan takes a whole leaf
+   * per call instead of decoding and checking one item at a time.
+   * @return the number of items appended, 0 once the iterator is at the end
+   */
+  size_t NextBatch(std::vector<MappingType> *batch);
+
   bool operator==(const IndexIterator &itr) const {
     return (isEnd() && itr.isEnd()) || (pageId_ == itr.GetPageId() && index_ == itr.index_);
   }
@@ -49,12 +68,83 @@ class IndexIterator {
   int GetIndex() const { return index_; }
 
  private:
+  // move on to the next leaf that has an item at index_, or to the end
+  void SkipExhaustedLeaves();
+
+  void ReleasePage();
+
   // add your own private member variables here
-  page_id_t pageId_;
-  int index_;
-  int size_;
-  BufferPoolManager *buffer_pool_manager_;
+  page_id_t pageId_{INVALID_PAGE_ID};
+  int index_{0};
+  int size_{0};
+  Page *page_{nullptr};
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  bool is_end_{false};
+  // the current item, leaves with compressed keys do not hold it as is
+  MappingType item_;
+};
+
+/**
+ * Walks the keys of a b+ tree in descending order along the previous page ids of the leaves.
+ *
+ * Writers latch leaves from left to right, so the iterator never waits for the previous leaf while it holds the
+ * current one. It only tries the read latch of the previous leaf, and if that fails it lets the current leaf go
+ * and looks up the largest key below the first key of that leaf from the root again.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ReverseIndexIterator {
+ public:
+  // takes over the pinned and read latched leaf page like IndexIterator, index -1 starts at the previous leaf,
+  // high_key is the key the scan started from, if any
+  ReverseIndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, Page *page, int index,
+                       BufferPoolManager *buffer_pool_manager, const KeyType *high_key = nullptr);
+  explicit ReverseIndexIterator(bool is_end);
+  ReverseIndexIterator(ReverseIndexIterator &&other) noexcept;
+  ReverseIndexIterator &operator=(ReverseIndexIterator &&other) noexcept;
+  ~ReverseIndexIterator();
+
+  DISALLOW_COPY(ReverseIndexIterator);
+
+  bool isEnd() const;
+
+  const MappingType &operator*();
+
+  // moves to the next smaller key
+  ReverseIndexIterator &operator++();
+
+  bool operator==(const ReverseIndexIterator &itr) const {
+    return (isEnd() && itr.isEnd()) || (pageId_ == itr.GetPageId() && index_ == itr.index_);
+  }
+
+  bool operator!=(const ReverseIndexIterator &itr) const { return !(*this == itr); }
+
+  page_id_t GetPageId() const {
+    if (is_end_) {
+      return INVALID_PAGE_ID;
+    }
+    return pageId_;
+  }
+
+  int GetIndex() const { return index_; }
+
+ private:
+  // move on to the previous leaf while index_ is before the first item, or to the end
+  void SkipExhaustedLeaves();
+
+  void ReleasePage();
+
+  BPlusTree<KeyType, ValueType, KeyComparator> *tree_{nullptr};
+  page_id_t pageId_{INVALID_PAGE_ID};
+  int index_{0};
+  Page *page_{nullptr};
+  BufferPoolManager *buffer_pool_manager_{nullptr};
   bool is_end_{false};
+  MappingType item_;
+  // every key left to visit is smaller than low_key_ (the first key of the last leaf with keys), or not greater
+  // than the high key while no leaf had keys yet
+  KeyType low_key_;
+  bool has_low_key_{false};
+  bool has_high_key_{false};
 };
 
 }  // namespace bustub
@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search.h
+//
+// Identification: src/include/storage/index/key_search.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "storage/index/generic_key.h"
+#include "storage/index/normalized_key.h"
+
+namespace bustub {
+
+/**
+ * Counts the sorted 64 bit integer keys of a b+ tree page that are less than
+ * (or not greater than) a key. The keys lie stride bytes apart, interleaved
+ * with the values of the page.
+ *
+ * A binary search narrows the keys down to a window of a few cache lines,
+ * which is then counted four keys at a time with AVX2 gathers and compares
+ * instead of branching on every key.
+ */
+class Int64KeySearch {
+ public:
+  // keys stored big-endian with the sign bit flipped (normalized) or as native integers
+  template <bool NORMALIZED>
+  static int CountLess(const char *keys, size_t stride, int size, int64_t key, bool or_equal) {
+    int l = 0;
+    int r = size;
+    while (r - l > WINDOW_SIZE) {
+      int mid = (l + r) / 2;
+      int64_t mid_key = Load<NORMALIZED>(keys + mid * stride);
+      if (mid_key < key || (or_equal && mid_key == key)) {
+        l = mid + 1;
+      } else {
+        r = mid;
+      }
+    }
+    int count = l;
+    int i = l;
+#ifdef __AVX2__
+    const __m256i offsets = _mm256_set_epi64x(3 * stride, 2 * stride, stride, 0);
+    const __m256i needle = _mm256_set1_epi64x(key);
+    for (; i + 4 <= r; i += 4) {
+      __m256i lane_keys =
+          _mm256_i64gather_epi64(reinterpret_cast<const long long *>(keys + i * stride), offsets, 1);  // NOLINT
+      if (NORMALIZED) {
+        lane_keys = Decode(lane_keys);
+      }
+      // keys not greater than key, or keys less than key
+      __m256i mask = or_equal ? _mm256_cmpgt_epi64(lane_keys, needle) : _mm256_cmpgt_epi64(needle, lane_keys);
+      int bits = __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(mask)));
+      count += or_equal ? 4 - bits : bits;
+    }
+#endif
+    for (; i < r; i++) {
+      int64_t cur = Load<NORMALIZED>(keys + i * stride);
+      count += (cur < key || (or_equal && cur == key)) ? 1 : 0;
+    }
+    return count;
+  }
+
+  template <bool NORMALIZED>
+  static int64_t Load(const char *data) {
+    uint64_t bits;
+    memcpy(&bits, data, sizeof(bits));
+    if (NORMALIZED) {
+      bits = __builtin_bswap64(bits) ^ (1ULL << 63);
+    }
+    return static_cast<int64_t>(bits);
+  }
+
+ private:
+#ifdef __AVX2__
+  // byte swaps every lane and flips its sign bit, so normalized keys compare as signed integers
+  static __m256i Decode(__m256i lanes) {
+    const __m256i reverse = _mm256_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13,
+                                            14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i sign = _mm256_set1_epi64x(static_cast<int64_t>(1ULL << 63));
+    return _mm256_xor_si256(_mm256_shuffle_epi8(lanes, reverse), sign);
+  }
+#endif
+
+  // keys left to count once the binary search stops
+  static constexpr int WINDOW_SIZE = 16;
+};
+
+/**
+ * Search kernel for the keys of a page, selected by key type and comparator.
+ * The generic version does not apply, pages then compare key by key with
+ * their comparator. Specializations read the keys in place and may apply to
+ * only some key schemas.
+ */
+template <typename KeyType, typename KeyComparator>
+class KeySearch {
+ public:
+  static constexpr bool ENABLED = false;
+
+  static bool Applies(const KeyComparator &comparator) { return false; }
+
+  // number of keys less than key, or not greater than key if or_equal
+  static int CountLess(const char *keys, size_t stride, int size, const KeyType &key, bool or_equal) { return 0; }
+};
+
+// 8 byte generic keys of a single BIGINT column hold the integer as is
+template <>
+class KeySearch<GenericKey<8>, GenericComparator<8>> {
+ public:
+  static constexpr bool ENABLED = true;
+
+  static bool Applies(const GenericComparator<8> &comparator) { return comparator.IsSingleBigInt(); }
+
+  static int CountLess(const char *keys, size_t stride, int size, const GenericKey<8> &key, bool or_equal) {
+    return Int64KeySearch::CountLess<false>(keys, stride, size, Int64KeySearch::Load<false>(key.data_), or_equal);
+  }
+};
+
+// 8 byte normalized keys compare as big-endian unsigned integers, whatever their columns
+template <>
+class KeySearch<NormalizedKey<8>, NormalizedComparator<8>> {
+ public:
+  static constexpr bool ENABLED = true;
+
+  static bool Applies(const NormalizedComparator<8> &comparator) { return true; }
+
+  static int CountLess(const char *keys, size_t stride, int size, const NormalizedKey<8> &key, bool or_equal) {
+    return Int64KeySearch::CountLess<true>(keys, stride, size, Int64KeySearch::Load<true>(key.data_), or_equal);
+  }
+};
+
+}  // namespace bustub
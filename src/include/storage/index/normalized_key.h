@@ -0,0 +1,240 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// normalized_key.h
+//
+// Identification: src/include/storage/index/normalized_key.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "common/exception.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/**
+ * Encodes key tuples into byte strings that sort like the keys, so two keys
+ * are compared with a single memcmp instead of column by column through Value.
+ *
+ * The columns are encoded one after another:
+ *  - integers big-endian with the sign bit flipped, so negative numbers come
+ *    first
+ *  - decimals as their bits big-endian, with all bits flipped for negative
+ *    numbers and only the sign bit flipped otherwise
+ *  - timestamps big-endian
+ *  - varchars as their bytes followed by a zero byte, which sorts a prefix
+ *    before every longer string
+ *
+ * Nulls are stored as the smallest value of their type and sort first (an
+ * empty string for varchars), unlike Value comparisons where null is neither
+ * smaller nor greater than any value.
+ */
+class KeyNormalizer {
+ public:
+  /**
+   * Encodes the key tuple data of key_schema into out, which holds size bytes.
+   * @return the number of bytes written, the rest of out is left as is
+   */
+  static uint32_t Normalize(const char *data, Schema *key_schema, char *out, uint32_t size) {
+    uint32_t pos = 0;
+    for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+      const auto &col = key_schema->GetColumn(i);
+      const char *src = data + col.GetOffset();
+      switch (col.GetType()) {
+        case TypeId::BOOLEAN:
+        case TypeId::TINYINT:
+          pos = PutSigned<int8_t>(src, out, pos, size);
+          break;
+        case TypeId::SMALLINT:
+          pos = PutSigned<int16_t>(src, out, pos, size);
+          break;
+        case TypeId::INTEGER:
+          pos = PutSigned<int32_t>(src, out, pos, size);
+          break;
+        case TypeId::BIGINT:
+          pos = PutSigned<int64_t>(src, out, pos, size);
+          break;
+        case TypeId::DECIMAL: {
+          uint64_t bits;
+          memcpy(&bits, src, sizeof(bits));
+          bits = (bits >> 63) != 0 ? ~bits : bits ^ (1ULL << 63);
+          pos = PutBigEndian(bits, sizeof(bits), out, pos, size);
+          break;
+        }
+        case TypeId::TIMESTAMP: {
+          uint64_t bits;
+          memcpy(&bits, src, sizeof(bits));
+          pos = PutBigEndian(bits, sizeof(bits), out, pos, size);
+          break;
+        }
+        case TypeId::VARCHAR: {
+          const char *str = data + *reinterpret_cast<const int32_t *>(src);
+          uint32_t len = *reinterpret_cast<const uint32_t *>(str);
+          str += sizeof(uint32_t);
+          // the stored length counts the terminating zero, a null varchar has no bytes
+          len = len == BUSTUB_VALUE_NULL ? 0 : static_cast<uint32_t>(strnlen(str, len));
+          CheckSize(pos + len + 1, size);
+          memcpy(out + pos, str, len);
+          out[pos + len] = 0;
+          pos += len + 1;
+          break;
+        }
+        default:
+          throw Exception(ExceptionType::MISMATCH_TYPE, "type of key column cannot be normalized");
+      }
+    }
+    return pos;
+  }
+
+  // the value of a column of the normalized key at data
+  static Value ToValue(const char *data, Schema *key_schema, uint32_t column_idx) {
+    uint32_t pos = 0;
+    for (uint32_t i = 0;; i++) {
+      TypeId type = key_schema->GetColumn(i).GetType();
+      if (type == TypeId::VARCHAR) {
+        uint32_t len = static_cast<uint32_t>(strlen(data + pos));
+        if (i == column_idx) {
+          return ValueFactory::GetVarcharValue(std::string(data + pos, len));
+        }
+        pos += len + 1;
+        continue;
+      }
+      uint32_t len = Type::GetTypeSize(type);
+      if (i == column_idx) {
+        uint64_t bits = GetBigEndian(data + pos, len);
+        switch (type) {
+          case TypeId::BOOLEAN:
+            return ValueFactory::GetBooleanValue(static_cast<int8_t>(bits ^ 0x80U));
+          case TypeId::TINYINT:
+            return ValueFactory::GetTinyIntValue(static_cast<int8_t>(bits ^ 0x80U));
+          case TypeId::SMALLINT:
+            return ValueFactory::GetSmallIntValue(static_cast<int16_t>(bits ^ 0x8000U));
+          case TypeId::INTEGER:
+            return ValueFactory::GetIntegerValue(static_cast<int32_t>(bits ^ 0x80000000U));
+          case TypeId::BIGINT:
+            return ValueFactory::GetBigIntValue(static_cast<int64_t>(bits ^ (1ULL << 63)));
+          case TypeId::DECIMAL: {
+            bits = (bits >> 63) != 0 ? bits ^ (1ULL << 63) : ~bits;
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+            return ValueFactory::GetDecimalValue(value);
+          }
+          default:
+            return ValueFactory::GetTimestampValue(static_cast<int64_t>(bits));
+        }
+      }
+      pos += len;
+    }
+  }
+
+ private:
+  template <typename T>
+  static uint32_t PutSigned(const char *src, char *out, uint32_t pos, uint32_t size) {
+    T value;
+    memcpy(&value, src, sizeof(T));
+    auto bits = static_cast<uint64_t>(static_cast<std::make_unsigned_t<T>>(value));
+    return PutBigEndian(bits ^ (1ULL << (sizeof(T) * 8 - 1)), sizeof(T), out, pos, size);
+  }
+
+  static uint32_t PutBigEndian(uint64_t bits, uint32_t len, char *out, uint32_t pos, uint32_t size) {
+    CheckSize(pos + len, size);
+    for (uint32_t i = 0; i < len; i++) {
+      out[pos + i] = static_cast<char>(bits >> ((len - 1 - i) * 8));
+    }
+    return pos + len;
+  }
+
+  static uint64_t GetBigEndian(const char *data, uint32_t len) {
+    uint64_t bits = 0;
+    for (uint32_t i = 0; i < len; i++) {
+      bits = (bits << 8) | static_cast<uint8_t>(data[i]);
+    }
+    return bits;
+  }
+
+  static void CheckSize(uint32_t needed, uint32_t size) {
+    if (needed > size) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "normalized key does not fit in the key size");
+    }
+  }
+};
+
+/**
+ * Key that holds a key tuple as normalized by KeyNormalizer, padded with zeros
+ * to its fixed size, a drop-in replacement for GenericKey whose comparator is a
+ * single memcmp.
+ */
+template <size_t KeySize>
+class NormalizedKey {
+ public:
+  inline void SetFromKey(const Tuple &tuple, Schema *key_schema) {
+    // intialize to 0
+    memset(data_, 0, KeySize);
+    KeyNormalizer::Normalize(tuple.GetData(), key_schema, data_, KeySize);
+  }
+
+  // NOTE: for test purpose only
+  // stores key as a single bigint column
+  inline void SetFromInteger(int64_t key) {
+    memset(data_, 0, KeySize);
+    uint64_t bits = static_cast<uint64_t>(key) ^ (1ULL << 63);
+    for (size_t i = 0; i < sizeof(int64_t) && i < KeySize; i++) {
+      data_[i] = static_cast<char>(bits >> ((sizeof(int64_t) - 1 - i) * 8));
+    }
+  }
+
+  inline Value ToValue(Schema *schema, uint32_t column_idx) const {
+    return KeyNormalizer::ToValue(data_, schema, column_idx);
+  }
+
+  // NOTE: for test purpose only
+  // interpret the first 8 bytes as a normalized bigint
+  inline int64_t ToString() const {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < sizeof(int64_t) && i < KeySize; i++) {
+      bits |= static_cast<uint64_t>(static_cast<uint8_t>(data_[i])) << ((sizeof(int64_t) - 1 - i) * 8);
+    }
+    return static_cast<int64_t>(bits ^ (1ULL << 63));
+  }
+
+  // NOTE: for test purpose only
+  friend std::ostream &operator<<(std::ostream &os, const NormalizedKey &key) {
+    os << key.ToString();
+    return os;
+  }
+
+  // actual location of data
+  char data_[KeySize];
+};
+
+/**
+ * Function object that compares two normalized keys with memcmp.
+ */
+template <size_t KeySize>
+class NormalizedComparator {
+ public:
+  inline int operator()(const NormalizedKey<KeySize> &lhs, const NormalizedKey<KeySize> &rhs) const {
+    return memcmp(lhs.data_, rhs.data_, KeySize);
+  }
+
+  NormalizedComparator(const NormalizedComparator &other) = default;
+
+  // every byte of a normalized key is part of the order, so keys can be cut short byte by byte
+  bool IsInlined() const { return true; }
+
+  // constructor, the keys carry their own order so the schema is not needed
+  explicit NormalizedComparator(Schema *key_schema) {}
+};
+
+}  // namespace bustub
@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/var_b_plus_tree.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rwlatch.h"
+#include "concurrency/transaction.h"
+#include "storage/index/var_index_iterator.h"
+#include "storage/page/b_plus_tree_var_page.h"
+
+namespace bustub {
+
+/**
+ * B+ tree over variable length keys, for keys like VARCHAR columns that do
+ * not fit a GenericKey without padding every key to the longest one.
+ *
+ * Keys live in slotted pages (see BPlusTreeSlottedPage), so a page holds as
+ * many keys as fit in its bytes. Pages split when a key does not fit, are
+ * rebalanced once they use less than half of their bytes, and are merged when
+ * the keys of both pages fit in one. Keys may be at most VAR_KEY_MAX_SIZE
+ * bytes long.
+ * (1) We only support unique key
+ * (2) Writers crab down with write latches and keep the latches of the pages
+ *     they may change, readers crab down with read latches
+ */
+class VarBPlusTree {
+  using InternalPage = BPlusTreeVarInternalPage;
+  using LeafPage = BPlusTreeVarLeafPage;
+
+ public:
+  VarBPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const VarKeyComparator &comparator);
+
+  // Returns true if this B+ tree has no keys and values.
+  bool IsEmpty() const;
+
+  // Insert a key-value pair into this B+ tree, false if the key exists.
+  bool Insert(const VarKey &key, const RID &value, Transaction *transaction = nullptr);
+
+  // Remove a key and its value from this B+ tree.
+  void Remove(const VarKey &key, Transaction *transaction = nullptr);
+
+  // return the value associated with a given key
+  bool GetValue(const VarKey &key, std::vector<RID> *result, Transaction *transaction = nullptr);
+
+  // index iterator
+  VarIndexIterator begin();
+  VarIndexIterator Begin(const VarKey &key);
+  VarIndexIterator end();
+
+  // the pinned and read latched leaf that holds key, or the leftmost leaf if key is nullptr, nullptr if the tree is
+  // empty
+  Page *FindLeafPage(const VarKey *key);
+
+  const VarKeyComparator &GetComparator() const { return comparator_; }
+
+ private:
+  void StartNewTree(const VarKey &key, const RID &value);
+
+  // write latches the pages from the root down to the leaf of key into path, releasing the ancestors of every page
+  // that is safe for the operation (op == 1 means insert, op == 2 means delete)
+  void Search(const VarKey &key, int op, std::vector<Page *> *path, bool *root_locked);
+
+  bool Safe(BPlusTreePage *node, int op, const VarKey &key) const;
+
+  // path[level] split into old_node and new_node, inserts key and new_node into the parent
+  void InsertIntoParent(std::vector<Page *> *path, size_t level, BPlusTreePage *old_node, const VarKey &key,
+                        BPlusTreePage *new_node);
+
+  // path[level] became underfull, merges it with or borrows from a sibling, deleted collects the pages to delete
+  void Rebalance(std::vector<Page *> *path, size_t level, std::vector<page_id_t> *deleted);
+
+  void RebalanceLeaves(LeafPage *node, LeafPage *sibling, InternalPage *parent, int index,
+                       std::vector<page_id_t> *deleted);
+
+  void RebalanceInternals(InternalPage *node, InternalPage *sibling, InternalPage *parent, int index,
+                          std::vector<page_id_t> *deleted);
+
+  // the root page is underfull, makes its only child the root or empties the tree
+  void AdjustRoot(BPlusTreePage *root, std::vector<page_id_t> *deleted);
+
+  // points the previous page id of the leaf after leaf back at it
+  void RelinkNextLeaf(LeafPage *leaf);
+
+  void ReleasePath(std::vector<Page *> *path, size_t count, bool *root_locked, bool is_dirty);
+
+  Page *NewPage(page_id_t *page_id);
+
+  void CheckKeySize(const VarKey &key) const;
+
+  void UpdateRootPageId(int insert_record = 0);
+
+  // member variable
+  std::string index_name_;
+  page_id_t root_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  VarKeyComparator comparator_;
+
+  // protects root_page_id_
+  ReaderWriterLatch mutex;
+};
+
+}  // namespace bustub
@@ -0,0 +1,48 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/var_b_plus_tree_index.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "storage/index/index.h"
+#include "storage/index/var_b_plus_tree.h"
+
+namespace bustub {
+
+/**
+ * Index over a VarBPlusTree, its keys take only as many bytes as the key
+ * tuple needs, so VARCHAR keys are not padded to a fixed width.
+ */
+class VarBPlusTreeIndex : public Index {
+ public:
+  VarBPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager);
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  VarIndexIterator GetBeginIterator();
+
+  VarIndexIterator GetBeginIterator(const VarKey &key);
+
+  VarIndexIterator GetEndIterator();
+
+ protected:
+  // comparator for key
+  VarKeyComparator comparator_;
+  // container
+  VarBPlusTree container_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/var_index_iterator.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+/**
+ * var_index_iterator.h
+ * For range scan of the variable length key b+ tree
+ */
+#pragma once
+#include <utility>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/page/b_plus_tree_var_page.h"
+
+namespace bustub {
+
+class VarBPlusTree;
+
+/**
+ * Walks the keys of a VarBPlusTree in ascending order along the next page ids of the leaves.
+ *
+ * Like IndexIterator it releases a leaf before it latches the next one. The next leaf may have been merged away in
+ * between, so the iterator checks that it still links back to the leaf it came from, and otherwise looks up the
+ * last key it returned from the root again.
+ */
+class VarIndexIterator {
+ public:
+  // takes over the pinned and read latched leaf page, low_key is the key the scan started from, if any
+  VarIndexIterator(VarBPlusTree *tree, Page *page, int index, BufferPoolManager *buffer_pool_manager,
+                   const VarKey *low_key = nullptr);
+  explicit VarIndexIterator(bool is_end);
+  VarIndexIterator(VarIndexIterator &&other) noexcept;
+  VarIndexIterator &operator=(VarIndexIterator &&other) noexcept;
+  ~VarIndexIterator();
+
+  DISALLOW_COPY(VarIndexIterator);
+
+  bool isEnd() const;
+
+  const std::pair<VarKey, RID> &operator*();
+
+  VarIndexIterator &operator++();
+
+  bool operator==(const VarIndexIterator &itr) const {
+    return (isEnd() && itr.isEnd()) || (pageId_ == itr.GetPageId() && index_ == itr.index_);
+  }
+
+  bool operator!=(const VarIndexIterator &itr) const { return !(*this == itr); }
+
+  page_id_t GetPageId() const {
+    if (is_end_) {
+      return INVALID_PAGE_ID;
+    }
+    return pageId_;
+  }
+
+ private:
+  // move on to the next leaf that has an item at index_, or to the end
+  void SkipExhaustedLeaves();
+
+  // index_ of the first key of the current leaf after low_key_
+  void SeekPastLowKey();
+
+  void ReleasePage();
+
+  VarBPlusTree *tree_{nullptr};
+  page_id_t pageId_{INVALID_PAGE_ID};
+  int index_{0};
+  Page *page_{nullptr};
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  bool is_end_{false};
+  std::pair<VarKey, RID> item_;
+  // every key left to visit is greater than low_key_ (the last key returned), or not less than it while nothing was
+  // returned yet
+  VarKey low_key_;
+  bool has_low_key_{false};
+  bool low_key_inclusive_{false};
+};
+
+}  // namespace bustub
@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// var_key.h
+//
+// Identification: src/include/storage/index/var_key.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * Key of the variable length key b+ tree.
+ *
+ * It holds the key tuple as it is serialized, without the padding of
+ * GenericKey, so a key takes only as many bytes as its values need. Like in
+ * any tuple a VARCHAR column stores the offset of its data, which follows
+ * the fixed length columns.
+ */
+class VarKey {
+ public:
+  VarKey() = default;
+  VarKey(const char *data, uint32_t size) : data_(data, size) {}
+
+  inline void SetFromKey(const Tuple &tuple) { data_.assign(tuple.GetData(), tuple.GetLength()); }
+
+  inline const char *GetData() const { return data_.data(); }
+
+  inline uint32_t GetSize() const { return static_cast<uint32_t>(data_.size()); }
+
+  inline Value ToValue(Schema *schema, uint32_t column_idx) const { return ToValue(GetData(), schema, column_idx); }
+
+  // the value of a column of the serialized key at data
+  static inline Value ToValue(const char *data, Schema *schema, uint32_t column_idx) {
+    const auto &col = schema->GetColumn(column_idx);
+    const char *data_ptr = data + col.GetOffset();
+    if (!col.IsInlined()) {
+      data_ptr = data + *reinterpret_cast<const int32_t *>(data_ptr);
+    }
+    return Value::DeserializeFrom(data_ptr, col.GetType());
+  }
+
+ private:
+  std::string data_;
+};
+
+/**
+ * Function object that compares two serialized keys column by column, it
+ * works on the key bytes in place so keys stored in a page are not copied.
+ */
+class VarKeyComparator {
+ public:
+  explicit VarKeyComparator(Schema *key_schema) : key_schema_(key_schema) {}
+
+  VarKeyComparator(const VarKeyComparator &other) = default;
+
+  inline int operator()(const char *lhs, const char *rhs) const {
+    uint32_t column_count = key_schema_->GetColumnCount();
+
+    for (uint32_t i = 0; i < column_count; i++) {
+      Value lhs_value = VarKey::ToValue(lhs, key_schema_, i);
+      Value rhs_value = VarKey::ToValue(rhs, key_schema_, i);
+
+      if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
+        return -1;
+      }
+      if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
+        return 1;
+      }
+    }
+    // equals
+    return 0;
+  }
+
+  inline int operator()(const VarKey &lhs, const VarKey &rhs) const { return (*this)(lhs.GetData(), rhs.GetData()); }
+
+ private:
+  Schema *key_schema_;
+};
+
+}  // namespace bustub
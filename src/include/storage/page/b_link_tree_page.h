@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/b_link_tree_page.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <utility>
+
+#include "common/config.h"
+#include "common/rid.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define B_LINK_TREE_PAGE_TYPE BLinkTreePage<KeyType, ValueType, KeyComparator>
+#define B_LINK_PAGE_HEADER_SIZE (32 + sizeof(KeyType))
+#define B_LINK_LEAF_PAGE_SIZE ((PAGE_SIZE - B_LINK_PAGE_HEADER_SIZE) / sizeof(std::pair<KeyType, ValueType>))
+#define B_LINK_INTERNAL_PAGE_SIZE ((PAGE_SIZE - B_LINK_PAGE_HEADER_SIZE) / sizeof(std::pair<KeyType, page_id_t>))
+
+/**
+ * Page of the B-link tree (see BLinkTree), leaves store (key, rid) pairs and
+ * internal pages (key, child page id) pairs with an unused first key, like
+ * the pages of the B+ tree.
+ *
+ * Besides its items every page keeps the link to its right sibling on the
+ * same level and its high key, the upper bound of the keys that belong to the
+ * page. Every key of the page is less than the high key, and the rightmost
+ * page of a level has no high key. A key at or above the high key has moved
+ * to a page further right after a split.
+ *
+ *  Header format (size in byte, 32 + sizeof(KeyType) bytes in total):
+ *  ---------------------------------------------------------------------------
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) | PageId (4) |
+ *  ---------------------------------------------------------------------------
+ * | Level (4) | RightPageId (4) | HasHighKey (4) | HighKey (sizeof(KeyType)) |
+ *  ---------------------------------------------------------------------------
+ *
+ *  Level is 0 for leaves and grows by one per level up to the root. Pages
+ *  are never merged, so a page id reached through a right link or a stale
+ *  parent stays a page of the same level for the life of the tree.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BLinkTreePage {
+ public:
+  // must call initialize method after "create" a new node
+  void Init(page_id_t page_id, uint32_t level, int max_size);
+
+  bool IsLeafPage() const { return level_ == 0; }
+  uint32_t GetLevel() const { return level_; }
+  int GetSize() const { return size_; }
+  int GetMaxSize() const { return max_size_; }
+  page_id_t GetPageId() const { return page_id_; }
+  page_id_t GetRightPageId() const { return right_page_id_; }
+
+  // whether key belongs to a page right of this one, which the reader has to move to
+  bool IsBeyondHighKey(const KeyType &key, const KeyComparator &comparator) const {
+    return has_high_key_ != 0 && comparator(key, high_key_) >= 0;
+  }
+
+  KeyType KeyAt(int index) const { return array[index].first; }
+  ValueType ValueAt(int index) const { return array[index].second; }
+
+  // leaf: index of the first key that is not less than key
+  int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
+  // internal: the child whose range holds key
+  ValueType Lookup(const KeyType &key, const KeyComparator &comparator) const;
+
+  // leaf: inserts key in order, false if it is already in the page
+  bool Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
+  // internal: inserts the separator key of a new child right of the children less than key
+  void InsertChild(const KeyType &key, page_id_t child, const KeyComparator &comparator);
+  // leaf: false if key is not in the page
+  bool Remove(const KeyType &key, const KeyComparator &comparator);
+
+  // internal: makes the page a root over the two halves of the old root
+  void PopulateNewRoot(page_id_t left, const KeyType &key, page_id_t right);
+
+  /**
+   * Moves the upper half of the items to the empty page right, which takes
+   * over the right link and the high key of this page. The first key of right
+   * becomes the high key of this page and is returned as the separator to
+   * insert into the parent.
+   */
+  KeyType MoveHalfTo(BLinkTreePage *right);
+
+ private:
+  IndexPageType page_type_;
+  lsn_t lsn_;
+  int size_;
+  int max_size_;
+  page_id_t page_id_;
+  uint32_t level_;
+  page_id_t right_page_id_;
+  int has_high_key_;
+  KeyType high_key_;
+  MappingType array[0];
+};
+
+}  // namespace bustub
@@ -11,14 +11,19 @@
 #pragma once
 
 #include <queue>
+#include <utility>
+#include <vector>
 
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 24
+#define INTERNAL_PAGE_HEADER_SIZE 36
 #define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+// an internal page with compressed keys holds at most twice as many children as fit at full width
+#define INTERNAL_PAGE_COMPRESSED_SIZE \
+  (2 * ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(KeyType) + sizeof(page_id_t)) - 1))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -31,12 +36,17 @@ namespace bustub {
  *  --------------------------------------------------------------------------
  * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *
+ * With compressed keys the slots are laid out like in a leaf page, see
+ * BPlusTreeLeafPage. The first key is part of the encoding as well, it holds
+ * a real key whenever the page is compressed.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
  public:
   // must call initialize method after "create" a new node
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE,
+            bool compress_keys = false);
 
   KeyType KeyAt(int index) const;
   void SetKeyAt(int index, const KeyType &key);
@@ -56,11 +66,33 @@ class BPlusTreeInternalPage : public BPlusTreePage {
                         BufferPoolManager *buffer_pool_manager);
   void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                          BufferPoolManager *buffer_pool_manager);
+  // also used by bulk loading to fill a new page with its children
+  void CopyNFrom(const MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
+
+  // max size of the page once it also holds key, or the keys of other and middle_key, only less than GetMaxSize()
+  // with compressed keys
+  int MaxSizeWith(const KeyType &key) const;
+  int MaxSizeAfterMerge(const BPlusTreeInternalPage *other, const KeyType &middle_key) const;
+  // max size of the page whatever key it takes next
+  int GuaranteedMaxSize() const;
+  // how many of the items fit in a page with compressed keys, at most max_size
+  static int FitCount(const MappingType *items, int size, int max_size);
 
  private:
-  void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
   void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
   void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
+  void Adopt(const ValueType &value, BufferPoolManager *buffer_pool_manager);
+
+  // the key at index, decoded into buffer if the keys are compressed
+  const KeyType &KeyRef(int index, KeyType *buffer) const;
+  const char *SlotAt(const KeyEncoding &encoding, int index) const;
+  MappingType ItemAt(int index) const;
+  std::vector<MappingType> ItemsBetween(int begin, int end) const;
+  void InsertAt(int index, const KeyType &key, const ValueType &value);
+  void RemoveAt(int index);
+  // replaces all items of the compressed page and picks the encoding that fits them best
+  void Rewrite(const MappingType *items, int size);
+  KeyEncoding CurrentEncoding() const;
 
  public:
   MappingType array[0];
@@ -18,8 +18,11 @@
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
+#define LEAF_PAGE_HEADER_SIZE 44
 #define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+// a leaf with compressed keys holds at most twice as many items as fit at full width, so half of it always does
+#define LEAF_PAGE_COMPRESSED_SIZE \
+  (2 * ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / (sizeof(KeyType) + sizeof(ValueType)) - 1))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
@@ -31,26 +34,49 @@ namespace bustub {
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 28 bytes in total):
+ * With compressed keys a slot only holds the bytes of its key that are not
+ * part of the common prefix or the zero tail, and the prefix is kept once at
+ * the end of the page:
+ *  ---------------------------------------------------------------------------------
+ * | HEADER | KEY(1) BYTES + RID(1) | ... | KEY(n) BYTES + RID(n) | FREE | PREFIX |
+ *  ---------------------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 44 bytes in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * | ParentPageId (4) | PageId (4) | NextPageId (4)
- *  -----------------------------------------------
+ *  -----------------------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | Version (4) | KeyPrefixSize (2) | KeyEnd (2) |
+ *  -----------------------------------------------------------------------------------
+ *  -----------------------------------------------------------------------------------
+ * | KeyCapacity (4) | NextPageId (4) | PrevPageId (4)
+ *  -----------------------------------------------------------------------------------
+ *
+ *  Leaves are linked in both directions. The tree changes the links of a leaf only
+ *  while holding its write latch, and always latches leaves from left to right.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
  public:
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE,
+            bool compress_keys = false);
   // helper methods
   page_id_t GetNextPageId() const;
   void SetNextPageId(page_id_t next_page_id);
+  page_id_t GetPrevPageId() const;
+  void SetPrevPageId(page_id_t prev_page_id);
   KeyType KeyAt(int index) const;
   int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
-  const MappingType &GetItem(int index);
+  MappingType GetItem(int index) const;
+  // appends the items from index begin to the end of the page to items, decoding compressed keys in one pass
+  void CopyItemsTo(int begin, std::vector<MappingType> *items) const;
+
+  // max size of the page once it also holds key, or the keys of other, only less than GetMaxSize() with
+  // compressed keys
+  int MaxSizeWith(const KeyType &key) const;
+  int MaxSizeAfterMerge(const BPlusTreeLeafPage *other) const;
 
   // insert and delete methods
   int Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
@@ -64,10 +90,21 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
  private:
-  void CopyNFrom(MappingType *items, int size);
+  void CopyNFrom(const MappingType *items, int size);
   void CopyLastFrom(const MappingType &item);
   void CopyFirstFrom(const MappingType &item);
+
+  // the key at index, decoded into buffer if the keys are compressed
+  const KeyType &KeyRef(int index, KeyType *buffer) const;
+  const char *SlotAt(const KeyEncoding &encoding, int index) const;
+  std::vector<MappingType> ItemsBetween(int begin, int end) const;
+  void InsertAt(int index, const KeyType &key, const ValueType &value);
+  void RemoveAt(int index);
+  // replaces all items of the compressed page and picks the encoding that fits them best
+  void Rewrite(const MappingType *items, int size);
+  KeyEncoding CurrentEncoding() const;
   page_id_t next_page_id_;
+  page_id_t prev_page_id_;
 
  public:
   MappingType array[0];
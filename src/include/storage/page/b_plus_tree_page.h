@@ -17,6 +17,7 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "storage/index/generic_key.h"
+#include "storage/index/normalized_key.h"
 
 namespace bustub {
 
@@ -33,12 +34,27 @@ enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
  * It actually serves as a header part for each B+ tree page and
  * contains information shared by both leaf page and internal page.
  *
- * Header format (size in byte, 24 bytes in total):
+ * Header format (size in byte, 36 bytes in total):
  * ----------------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  * ----------------------------------------------------------------------------
- * | ParentPageId (4) | PageId(4) |
+ * | ParentPageId (4) | PageId(4) | Version (4) | KeyPrefixSize (2) | KeyEnd (2) |
  * ----------------------------------------------------------------------------
+ * | KeyCapacity (4) |
+ * ----------------------------------------------------------------------------
+ *
+ * Version is used by optimistic lock coupling: it is bumped when a writer takes
+ * the page's write latch and again when the writer releases it, so it is odd
+ * while the page is being modified. Readers remember the version, read the
+ * page without latching and check that the version did not change.
+ *
+ * KeyPrefixSize, KeyEnd and KeyCapacity describe the slot format of a page with
+ * compressed keys, KeyCapacity is 0 for a page that stores full width keys. A
+ * compressed page stores the bytes its keys have in common once at the end of
+ * the page, and only the bytes [KeyPrefixSize, KeyEnd) of every key in its
+ * slot, all bytes from KeyEnd on are zero in every key of the page. KeyCapacity
+ * is the number of slots that fit in the page with this format, so the max size
+ * of such a page depends on the keys it holds.
  */
 class BPlusTreePage {
  public:
@@ -62,6 +78,51 @@ class BPlusTreePage {
 
   void SetLSN(lsn_t lsn = INVALID_LSN);
 
+  uint32_t GetVersion() const;
+  void IncreaseVersion();
+  bool ValidateVersion(uint32_t version) const;
+  static bool IsLockedVersion(uint32_t version) { return (version & 1) != 0; }
+
+  bool IsKeyCompressed() const;
+  int GetKeyPrefixSize() const;
+  int GetKeyEnd() const;
+
+ protected:
+  /**
+   * The common prefix and the end of the significant bytes of a set of keys, prefix_data is nullptr for an empty
+   * set. A set with a single key keeps all its significant bytes in the prefix.
+   */
+  struct KeyEncoding {
+    const char *prefix_data{nullptr};
+    int prefix_size{0};
+    int end{0};
+
+    // widens the encoding so it also covers the key
+    void Add(const char *key, int key_size);
+    // widens the encoding so it also covers all keys of other
+    void Add(const KeyEncoding &other);
+  };
+
+  // the encoding of the keys in this compressed page, clamped to keys of key_size bytes since the page may be read
+  // without a latch
+  KeyEncoding GetKeyEncoding(int key_size) const;
+  // switches to the encoding and copies its prefix to the end of the page, the slots are left to the caller
+  void SetKeyEncoding(const KeyEncoding &encoding, int capacity);
+  void DisableKeyCompression();
+
+  // whether the key can be stored in a slot of the encoding
+  static bool KeyFits(const KeyEncoding &encoding, const char *key, int key_size);
+  static void DecodeKey(const KeyEncoding &encoding, const char *slot, char *key, int key_size);
+  static void EncodeKey(const KeyEncoding &encoding, char *slot, const char *key);
+
+  // size of a slot and number of slots that fit in a page with the encoding
+  static int SlotSize(const KeyEncoding &encoding, int value_size) {
+    return encoding.end - encoding.prefix_size + value_size;
+  }
+  static int KeyCapacity(const KeyEncoding &encoding, int header_size, int value_size) {
+    return (PAGE_SIZE - header_size - encoding.prefix_size) / SlotSize(encoding, value_size);
+  }
+
  private:
   // member variable, attributes that both internal and leaf page share
   IndexPageType page_type_ __attribute__((__unused__));
@@ -70,6 +131,10 @@ class BPlusTreePage {
   int max_size_ __attribute__((__unused__));
   page_id_t parent_page_id_ __attribute__((__unused__));
   page_id_t page_id_ __attribute__((__unused__));
+  uint32_t version_;
+  uint16_t key_prefix_size_;
+  uint16_t key_end_;
+  int key_capacity_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,170 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/b_plus_tree_var_page.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include "common/rid.h"
+#include "storage/index/var_key.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define VAR_PAGE_HEADER_SIZE 48
+
+/**
+ * Slotted page of the variable length key b+ tree, both its leaf and internal
+ * pages are built on it.
+ *
+ * The slots are kept in key order at the front of the page. Each one holds the
+ * offset and size of its key and the value. The keys are stored in a heap that
+ * grows down from the end of the page, so a key only takes its own length:
+ *  ---------------------------------------------------------------------------
+ * | HEADER | SLOT(1) | SLOT(2) | ... | SLOT(n) | FREE | KEY(n) ... KEY(1) |
+ *  ---------------------------------------------------------------------------
+ *
+ *  Slot format (size in byte): | KeyOffset (2) | KeySize (2) | Value |
+ *
+ *  Header format (size in byte, 48 bytes in total):
+ *  ---------------------------------------------------------------------------
+ * | BPlusTreePage header (36) | PrevPageId (4) | NextPageId (4) |
+ *  ---------------------------------------------------------------------------
+ * | HeapBegin (2) | HeapGarbage (2) |
+ *  ---------------------------------------------------------------------------
+ *
+ *  A removed key leaves a hole in the heap, HeapGarbage counts those bytes and
+ *  the heap is compacted once the free space between slots and heap runs out.
+ *  Since sizes are in bytes, pages split, merge and rebalance by the bytes they
+ *  use rather than by the number of keys. PrevPageId and NextPageId link the
+ *  leaves, they are unused in internal pages.
+ */
+template <typename ValueType>
+class BPlusTreeSlottedPage : public BPlusTreePage {
+ public:
+  // the serialized key at index, valid while the page is not modified
+  const char *KeyAt(int index) const;
+  uint32_t KeySizeAt(int index) const;
+  VarKey GetKey(int index) const;
+  ValueType ValueAt(int index) const;
+  void SetValueAt(int index, const ValueType &value);
+
+  page_id_t GetNextPageId() const;
+  void SetNextPageId(page_id_t next_page_id);
+  page_id_t GetPrevPageId() const;
+  void SetPrevPageId(page_id_t prev_page_id);
+
+  // bytes taken by the slots and keys of the page
+  uint32_t GetUsedBytes() const;
+  // whether an entry with a key of key_size bytes still fits
+  bool HasRoomFor(uint32_t key_size) const { return GetUsedBytes() + EntrySize(key_size) <= Capacity(); }
+  // whether the page uses less than half of its space
+  bool IsUnderfull() const { return GetUsedBytes() < Capacity() / 2; }
+  // whether the key at index can be replaced by a key of key_size bytes
+  bool HasRoomForKeyAt(int index, uint32_t key_size) const {
+    return GetUsedBytes() - KeySizeAt(index) + key_size <= Capacity();
+  }
+
+  // bytes for the slots and keys of a page, and the bytes of a single entry
+  static constexpr uint32_t Capacity() { return PAGE_SIZE - VAR_PAGE_HEADER_SIZE; }
+  static constexpr uint32_t EntrySize(uint32_t key_size) { return sizeof(Slot) + key_size; }
+
+ protected:
+  void InitSlots(page_id_t page_id, page_id_t parent_id, IndexPageType page_type);
+
+  // the page must have room for the key
+  void InsertAt(int index, const char *key, uint32_t key_size, const ValueType &value);
+  void RemoveAt(int index);
+  // replaces the key at index, the page must have room for the difference
+  void SetKeyAt(int index, const char *key, uint32_t key_size);
+  // appends the entries [begin, end) of other
+  void CopyRangeFrom(const BPlusTreeSlottedPage *other, int begin, int end);
+  // drops the entries from size on
+  void Truncate(int size);
+  // the index from which on the entries take about half of the bytes of the page
+  int SplitPoint() const;
+
+ private:
+  struct Slot {
+    uint16_t offset_;
+    uint16_t size_;
+    ValueType value_;
+  };
+
+  // moves all keys to the end of the page, so no heap bytes are wasted
+  void Compact();
+
+  page_id_t prev_page_id_;
+  page_id_t next_page_id_;
+  uint16_t heap_begin_;
+  uint16_t heap_garbage_;
+  Slot slots_[0];
+};
+
+/**
+ * Leaf page of the variable length key b+ tree, it maps keys to record ids.
+ * Only support unique key.
+ */
+class BPlusTreeVarLeafPage : public BPlusTreeSlottedPage<RID> {
+ public:
+  // After creating a new leaf page from buffer pool, must call initialize
+  // method to set default values
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID);
+
+  // first index with a key not less than key
+  int KeyIndex(const char *key, const VarKeyComparator &comparator) const;
+
+  // insert and delete methods, the page must have room for the key to insert
+  int Insert(const VarKey &key, const RID &value, const VarKeyComparator &comparator);
+  bool Lookup(const VarKey &key, RID *value, const VarKeyComparator &comparator) const;
+  int RemoveAndDeleteRecord(const VarKey &key, const VarKeyComparator &comparator);
+
+  // Split and Merge utility methods
+  void MoveHalfTo(BPlusTreeVarLeafPage *recipient);
+  void MoveAllTo(BPlusTreeVarLeafPage *recipient);
+  void MoveFirstToEndOf(BPlusTreeVarLeafPage *recipient);
+  void MoveLastToFrontOf(BPlusTreeVarLeafPage *recipient);
+};
+
+/**
+ * Internal page of the variable length key b+ tree. Like in
+ * BPlusTreeInternalPage the first key is invalid, here it is stored empty so it
+ * takes no heap bytes.
+ */
+class BPlusTreeVarInternalPage : public BPlusTreeSlottedPage<page_id_t> {
+ public:
+  // must be called after allocating a new internal page
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID);
+
+  int ValueIndex(const page_id_t &value) const;
+  // the child page that holds key
+  page_id_t Lookup(const char *key, const VarKeyComparator &comparator) const;
+
+  void PopulateNewRoot(const page_id_t &old_value, const VarKey &new_key, const page_id_t &new_value);
+  // the page must have room for new_key
+  int InsertNodeAfter(const page_id_t &old_value, const VarKey &new_key, const page_id_t &new_value);
+  void Remove(int index);
+  page_id_t RemoveAndReturnOnlyChild();
+  // the page must have room for key, see HasRoomForKeyAt
+  void SetKeyAt(int index, const VarKey &key) { BPlusTreeSlottedPage::SetKeyAt(index, key.GetData(), key.GetSize()); }
+
+  // Split and Merge utility methods, the moved children are adopted by the recipient
+  // moves the upper half to the empty recipient and returns the key that separates the two pages
+  VarKey MoveHalfTo(BPlusTreeVarInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
+  void MoveAllTo(BPlusTreeVarInternalPage *recipient, const VarKey &middle_key, BufferPoolManager *buffer_pool_manager);
+  // these two return the new separator of the two pages
+  VarKey MoveFirstToEndOf(BPlusTreeVarInternalPage *recipient, const VarKey &middle_key,
+                          BufferPoolManager *buffer_pool_manager);
+  VarKey MoveLastToFrontOf(BPlusTreeVarInternalPage *recipient, const VarKey &middle_key,
+                           BufferPoolManager *buffer_pool_manager);
+
+ private:
+  void Adopt(page_id_t child, BufferPoolManager *buffer_pool_manager);
+};
+
+}  // namespace bustub
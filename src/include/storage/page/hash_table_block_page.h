@@ -13,6 +13,7 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <utility>
 #include <vector>
 
@@ -32,13 +33,30 @@ namespace bustub {
  *
  *  Here '+' means concatenation.
  *
+ * Every slot also has a one byte fingerprint of its key's hash, so a probe
+ * compares BLOCK_GROUP_SIZE fingerprints at once and reads only the keys whose
+ * fingerprint matches. A free slot has fingerprint FREE_FINGERPRINT and a
+ * tombstone TOMBSTONE_FINGERPRINT, both of which no key hashes to.
+ *
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBlockPage {
  public:
+  static constexpr uint8_t FREE_FINGERPRINT = 0;
+  static constexpr uint8_t TOMBSTONE_FINGERPRINT = 1;
+
   // Delete all constructor / destructor to ensure memory safety
   HashTableBlockPage() = delete;
 
+  /**
+   * Gets the fingerprint of a key from its hash, from the hash bits that pick
+   * the slot the least.
+   *
+   * @param hash hash of the key
+   * @return fingerprint to insert the key with and to probe for it
+   */
+  static uint8_t Fingerprint(uint64_t hash) { return static_cast<uint8_t>(hash >> 57) | 0x80; }
+
   /**
    * Gets the key at an index in the block.
    *
@@ -64,11 +82,12 @@ class HashTableBlockPage {
    * @param bucket_ind index to write the key and value to
    * @param key key to insert
    * @param value value to insert
+   * @param fingerprint fingerprint of the key
    * @return If the value is inserted successfully, it returns true. If the
    * index is marked as occupied before the key and value can be inserted,
    * Insert returns false.
    */
-  bool Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value);
+  bool Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value, uint8_t fingerprint);
 
   /**
    * Removes a key and value at index.
@@ -93,11 +112,34 @@ class HashTableBlockPage {
    */
   bool IsReadable(slot_offset_t bucket_ind) const;
 
+  /**
+   * Writes a key and value into a tombstone, the caller holds the write latch of the block.
+   *
+   * @param bucket_ind index of the tombstone
+   * @param key key to insert
+   * @param value value to insert
+   * @param fingerprint fingerprint of the key
+   * @return false if the index is not a tombstone
+   */
+  bool Reuse(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value, uint8_t fingerprint);
+
+  /**
+   * Finds the slots of a group that a probe for a key has to look at: the
+   * ones with the key's fingerprint, the tombstones and the free slots.
+   *
+   * @param group index of the group, the slots from group * BLOCK_GROUP_SIZE on
+   * @param fingerprint fingerprint of the key
+   * @return mask with bit i set if slot group * BLOCK_GROUP_SIZE + i is to be looked at
+   */
+  uint32_t MatchGroup(size_t group, uint8_t fingerprint) const;
+
  private:
   std::atomic_char occupied_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
 
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
   std::atomic_char readable_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
+  // rounded up to whole groups, the slots past the end are never matched
+  uint8_t fingerprints_[(BLOCK_ARRAY_SIZE - 1) / BLOCK_GROUP_SIZE * BLOCK_GROUP_SIZE + BLOCK_GROUP_SIZE];
   MappingType array_[0];
 };
 
@@ -0,0 +1,181 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_bucket_page.h
+//
+// Identification: src/include/storage/page/hash_table_bucket_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/index/int_comparator.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+/**
+ * Store indexed key and and value together within a bucket page of the
+ * extendible hash table. Supports non-unique keys, but not the same key and
+ * value twice.
+ *
+ * Bucket page format (keys are stored in no particular order):
+ *  ----------------------------------------------------------------
+ * | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
+ *  ----------------------------------------------------------------
+ *
+ * A pair is written into the first slot that is not readable, so the
+ * occupied slots, pairs and tombstones, are always a prefix of the page and a
+ * search stops at the first slot that was never occupied.
+ *
+ * When no split can separate the pairs of a full bucket, e.g. many values of
+ * one key, further pairs go to overflow pages. The bucket page the directory
+ * points at heads the chain, and its latch covers the whole chain.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class HashTableBucketPage {
+ public:
+  // Delete all constructor / destructor to ensure memory safety
+  HashTableBucketPage() = delete;
+
+  /**
+   * Collects the values of key.
+   *
+   * @param key key to look up
+   * @param cmp comparator of keys
+   * @param[out] result the values of key are added to it
+   * @return true if key has at least one value
+   */
+  bool GetValue(const KeyType &key, KeyComparator cmp, std::vector<ValueType> *result);
+
+  /**
+   * Inserts a key and value into the first free slot.
+   *
+   * @return false if the pair is in the bucket already or the bucket is full
+   */
+  bool Insert(const KeyType &key, const ValueType &value, KeyComparator cmp);
+
+  /**
+   * Removes a key and value.
+   *
+   * @return false if the pair is not in the bucket
+   */
+  bool Remove(const KeyType &key, const ValueType &value, KeyComparator cmp);
+
+  /**
+   * @return true if the bucket holds the key and value
+   */
+  bool Contains(const KeyType &key, const ValueType &value, KeyComparator cmp) const;
+
+  /**
+   * Gets the key at an index in the bucket.
+   */
+  KeyType KeyAt(slot_offset_t bucket_ind) const;
+
+  /**
+   * Gets the value at an index in the bucket.
+   */
+  ValueType ValueAt(slot_offset_t bucket_ind) const;
+
+  /**
+   * Leaves a tombstone at an index in the bucket.
+   */
+  void RemoveAt(slot_offset_t bucket_ind);
+
+  /**
+   * Returns whether or not an index is occupied (key/value pair or tombstone)
+   */
+  bool IsOccupied(slot_offset_t bucket_ind) const;
+
+  /**
+   * Returns whether or not an index is readable (valid key/value pair)
+   */
+  bool IsReadable(slot_offset_t bucket_ind) const;
+
+  /**
+   * @return the number of slots a pair may be in, the occupied prefix
+   */
+  slot_offset_t NumOccupied() const;
+
+  /**
+   * @return the number of pairs in the bucket
+   */
+  uint32_t NumReadable() const;
+
+  /**
+   * @return true if every slot holds a pair
+   */
+  bool IsFull() const;
+
+  /**
+   * @return true if no slot holds a pair
+   */
+  bool IsEmpty() const;
+
+  /**
+   * @return the page id of the next page in the overflow chain, INVALID_PAGE_ID at the end of the chain
+   */
+  page_id_t GetOverflowPageId() const;
+
+  /**
+   * Sets the next page in the overflow chain. A new bucket page has to set INVALID_PAGE_ID, a zeroed page reads 0.
+   */
+  void SetOverflowPageId(page_id_t overflow_page_id);
+
+  /**
+   * Moves the pairs for which stays returns false to recipient, which has room for them, and drops the tombstones.
+   */
+  template <typename Predicate>
+  void SplitTo(HashTableBucketPage *recipient, Predicate &&stays);
+
+ private:
+  page_id_t overflow_page_id_;
+  char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
+
+  // 0 if tombstone/brand new (never occupied), 1 otherwise.
+  char readable_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
+  MappingType array_[0];
+};
+
+/*
+ * SplitTo() is a template over the predicate, so it is defined here.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Predicate>
+void HASH_TABLE_BUCKET_TYPE::SplitTo(HashTableBucketPage *recipient, Predicate &&stays) {
+  slot_offset_t num_occupied = NumOccupied();
+  slot_offset_t kept = 0;
+  slot_offset_t moved = recipient->NumOccupied();
+  for (slot_offset_t i = 0; i < num_occupied; i++) {
+    if (!IsReadable(i)) {
+      continue;
+    }
+    if (stays(array_[i].first)) {
+      array_[kept++] = array_[i];
+    } else {
+      recipient->array_[moved] = array_[i];
+      recipient->occupied_[moved / 8] |= static_cast<char>(1 << (moved % 8));
+      recipient->readable_[moved / 8] |= static_cast<char>(1 << (moved % 8));
+      moved++;
+    }
+  }
+  // the kept pairs are packed at the front again
+  for (slot_offset_t i = 0; i < num_occupied; i++) {
+    char mask = static_cast<char>(1 << (i % 8));
+    if (i < kept) {
+      occupied_[i / 8] |= mask;
+      readable_[i / 8] |= mask;
+    } else {
+      occupied_[i / 8] &= static_cast<char>(~mask);
+      readable_[i / 8] &= static_cast<char>(~mask);
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_page.h
+//
+// Identification: src/include/storage/page/hash_table_directory_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+
+/**
+ *
+ * Directory Page for extendible hash table.
+ *
+ * Directory format (size in byte):
+ * --------------------------------------------------------------------------------------------
+ * | LSN (4) | PageId(4) | GlobalDepth(4) | LocalDepths(512) | BucketPageIds(2048) | Free(1524)
+ * --------------------------------------------------------------------------------------------
+ *
+ * Bucket index i of the directory holds the keys whose hash has i in its low
+ * global depth bits. A bucket of local depth d is shared by the 2^(global
+ * depth - d) indexes that agree with it in the low d bits.
+ */
+class HashTableDirectoryPage {
+ public:
+  /**
+   * @return the page ID of this page
+   */
+  page_id_t GetPageId() const;
+
+  /**
+   * Sets the page ID of this page
+   *
+   * @param page_id the page id for the page id field to be set to
+   */
+  void SetPageId(page_id_t page_id);
+
+  /**
+   * @return the lsn of this page
+   */
+  lsn_t GetLSN() const;
+
+  /**
+   * Sets the LSN of this page
+   *
+   * @param lsn the log sequence number for the lsn field to be set to
+   */
+  void SetLSN(lsn_t lsn);
+
+  /**
+   * @return the number of low hash bits that index the directory
+   */
+  uint32_t GetGlobalDepth() const;
+
+  /**
+   * @return a mask of the low global depth bits
+   */
+  uint32_t GetGlobalDepthMask() const;
+
+  /**
+   * @return the number of bucket indexes, 2^global depth
+   */
+  uint32_t Size() const;
+
+  /**
+   * Doubles the directory, the new upper half points at the same buckets as the lower half
+   */
+  void IncrGlobalDepth();
+
+  /**
+   * Halves the directory, only when CanShrink()
+   */
+  void DecrGlobalDepth();
+
+  /**
+   * @return true if every bucket has a local depth below the global depth
+   */
+  bool CanShrink() const;
+
+  /**
+   * @param bucket_idx an index of the directory
+   * @return the page id of the bucket at bucket_idx
+   */
+  page_id_t GetBucketPageId(uint32_t bucket_idx) const;
+
+  /**
+   * @param bucket_idx an index of the directory
+   * @param bucket_page_id the page id of the bucket to put at bucket_idx
+   */
+  void SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id);
+
+  /**
+   * @param bucket_idx an index of the directory
+   * @return the local depth of the bucket at bucket_idx
+   */
+  uint32_t GetLocalDepth(uint32_t bucket_idx) const;
+
+  /**
+   * @param bucket_idx an index of the directory
+   * @param local_depth the local depth of the bucket at bucket_idx
+   */
+  void SetLocalDepth(uint32_t bucket_idx, uint32_t local_depth);
+
+  /**
+   * @param bucket_idx an index of the directory
+   * @return the index of the bucket that bucket_idx was split from or into, it differs in the highest of the local
+   * depth bits
+   */
+  uint32_t GetSplitImageIndex(uint32_t bucket_idx) const;
+
+ private:
+  lsn_t lsn_;
+  page_id_t page_id_;
+  uint32_t global_depth_;
+  uint8_t local_depths_[DIRECTORY_ARRAY_SIZE];
+  page_id_t bucket_page_ids_[DIRECTORY_ARRAY_SIZE];
+};
+
+/** the largest global depth the directory page has room for */
+static constexpr uint32_t HASH_TABLE_MAX_GLOBAL_DEPTH = 9;
+
+static_assert(1U << HASH_TABLE_MAX_GLOBAL_DEPTH == DIRECTORY_ARRAY_SIZE, "the directory holds 2^max depth buckets");
+static_assert(sizeof(HashTableDirectoryPage) <= PAGE_SIZE, "the directory fits in a page");
+
+}  // namespace bustub
@@ -89,12 +89,20 @@ class HashTableHeaderPage {
    */
   size_t NumBlocks();
 
+  /**
+   * Forgets all block page ids, before the blocks of a resized table are added
+   */
+  void ResetBlockPageIds();
+
  private:
-  __attribute__((unused)) lsn_t lsn_;
-  __attribute__((unused)) size_t size_;
-  __attribute__((unused)) page_id_t page_id_;
-  __attribute__((unused)) size_t next_ind_;
-  __attribute__((unused)) page_id_t block_page_ids_[0];
+  lsn_t lsn_;
+  size_t size_;
+  page_id_t page_id_;
+  size_t next_ind_;
+  page_id_t block_page_ids_[0];
 };
 
+/** the number of block page ids a header page has room for */
+static constexpr size_t HASH_TABLE_MAX_BLOCKS = (PAGE_SIZE - sizeof(HashTableHeaderPage)) / sizeof(page_id_t);
+
 }  // namespace bustub
@@ -14,11 +14,28 @@
 
 #define MappingType std::pair<KeyType, ValueType>
 
-/** BLOCK_ARRAY_SIZE is the number of (key, value) pairs that can be stored in   * a block page. It is an approximate
+/** BLOCK_ARRAY_SIZE is the number of (key, value) pairs that can be stored in a block page. It is an approximate
  * calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType). For each key/value
- * pair, we need two additional bits for occupied_ and readable_. 4 * PAGE_SIZE / (4 * sizeof (MappingType) + 1) =
- * PAGE_SIZE/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required to maintain the occupied
- * and readable flags for a key value pair.*/
-#define BLOCK_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+ * pair, we need two additional bits for occupied_ and readable_, and one byte for its fingerprint. 4 * PAGE_SIZE /
+ * (4 * sizeof (MappingType) + 5) = PAGE_SIZE/(sizeof (MappingType) + 1.25) because 1.25 bytes is the space required
+ * to maintain the flags and the fingerprint for a key value pair. BLOCK_PAGE_RESERVED bytes are left for rounding the
+ * fingerprints up to whole groups.*/
+#define BLOCK_PAGE_RESERVED 64
+#define BLOCK_ARRAY_SIZE (4 * (PAGE_SIZE - BLOCK_PAGE_RESERVED) / (4 * sizeof(MappingType) + 5))
+
+/** BLOCK_GROUP_SIZE is the number of fingerprints a block page compares at once. */
+#define BLOCK_GROUP_SIZE 32
 
 #define HASH_TABLE_BLOCK_TYPE HashTableBlockPage<KeyType, ValueType, KeyComparator>
+
+/** BUCKET_ARRAY_SIZE is the number of (key, value) pairs a bucket page of the extendible hash table holds, with the
+ * same two bits per pair for the occupied and readable flags as a block page. BUCKET_PAGE_RESERVED bytes are left for
+ * the overflow page id and rounding the flags up to whole bytes. */
+#define BUCKET_PAGE_RESERVED 8
+#define BUCKET_ARRAY_SIZE (4 * (PAGE_SIZE - BUCKET_PAGE_RESERVED) / (4 * sizeof(MappingType) + 1))
+
+/** DIRECTORY_ARRAY_SIZE is the number of bucket page ids the directory page of the extendible hash table holds, so
+ * the global depth is at most 9. */
+#define DIRECTORY_ARRAY_SIZE 512
+
+#define HASH_TABLE_BUCKET_TYPE HashTableBucketPage<KeyType, ValueType, KeyComparator>
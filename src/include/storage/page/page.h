@@ -51,20 +51,29 @@ class Page {
   /** Acquire the page write latch. */
   inline void WLatch() { rwlatch_.WLock(); }
 
+  /** Acquire the page write latch without waiting. @return true if the latch was acquired */
+  inline bool TryWLatch() { return rwlatch_.TryWLock(); }
+
   /** Release the page write latch. */
   inline void WUnlatch() { rwlatch_.WUnlock(); }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
 
+  /** Acquire the page read latch without waiting. @return true if the latch was acquired */
+  inline bool TryRLatch() { return rwlatch_.TryRLock(); }
+
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
   /** @return the page LSN. */
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
-  /** Sets the page LSN. */
-  inline void SetLSN(lsn_t lsn) { memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t)); }
+  /** Sets the page LSN. From then on the buffer pool manager only writes the page once its log records are durable. */
+  inline void SetLSN(lsn_t lsn) {
+    memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t));
+    has_lsn_ = true;
+  }
 
  protected:
   static_assert(sizeof(page_id_t) == 4);
@@ -86,6 +95,11 @@ class Page {
   int pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
   bool is_dirty_ = false;
+  /**
+   * True if SetLSN was called since the page was read or created. Index pages keep other data at OFFSET_LSN, only
+   * pages with this flag follow the WAL rule.
+   */
+  bool has_lsn_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
@@ -0,0 +1,169 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_compressor.cpp
+//
+// Identification: src/recovery/log_compressor.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "recovery/log_compressor.h"
+
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+
+constexpr int32_t MIN_MATCH = 4;
+constexpr int32_t MAX_OFFSET = 65535;
+// no match starts in the last bytes of a block, the block always ends with a literal run
+constexpr int32_t LAST_LITERALS = 5;
+constexpr int32_t HASH_BITS = 12;
+// after this many missed positions in a row the search starts skipping ahead, so incompressible batches stay cheap
+constexpr int32_t SKIP_TRIGGER = 6;
+
+inline uint32_t Read32(const char *ptr) {
+  uint32_t value;
+  memcpy(&value, ptr, sizeof(value));
+  return value;
+}
+
+inline uint32_t HashSequence(uint32_t sequence) { return (sequence * 2654435761U) >> (32 - HASH_BITS); }
+
+inline void PutLength(int32_t length, char **out) {
+  while (length >= 255) {
+    *(*out)++ = static_cast<char>(255);
+    length -= 255;
+  }
+  *(*out)++ = static_cast<char>(length);
+}
+
+inline bool GetLength(const uint8_t **in, const uint8_t *end, int32_t *length) {
+  uint8_t byte;
+  do {
+    if (*in >= end) {
+      return false;
+    }
+    byte = *(*in)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+/** Emit literals followed by a match, or only literals when match_length is 0. */
+bool EmitSequence(const char *literals, int32_t literal_length, int32_t offset, int32_t match_length, char **out,
+                  const char *out_end) {
+  // token, length bytes, literals and offset
+  int64_t needed = 1 + literal_length / 255 + 1 + literal_length + 2 + match_length / 255 + 1;
+  if (out_end - *out < needed) {
+    return false;
+  }
+  char *token = (*out)++;
+  int32_t literal_code = literal_length < 15 ? literal_length : 15;
+  if (literal_length >= 15) {
+    PutLength(literal_length - 15, out);
+  }
+  memcpy(*out, literals, literal_length);
+  *out += literal_length;
+
+  int32_t match_code = 0;
+  if (match_length > 0) {
+    int32_t extra = match_length - MIN_MATCH;
+    match_code = extra < 15 ? extra : 15;
+    *(*out)++ = static_cast<char>(offset & 0xff);
+    *(*out)++ = static_cast<char>(offset >> 8);
+    if (extra >= 15) {
+      PutLength(extra - 15, out);
+    }
+  }
+  *token = static_cast<char>((literal_code << 4) | match_code);
+  return true;
+}
+
+}  // namespace
+
+int32_t LogCompressor::Compress(const char *src, int32_t size, char *dst, int32_t capacity) {
+  int32_t table[1 << HASH_BITS];
+  memset(table, -1, sizeof(table));
+  char *out = dst;
+  const char *out_end = dst + capacity;
+
+  int32_t anchor = 0;
+  int32_t pos = 0;
+  int32_t match_limit = size - LAST_LITERALS;
+  int32_t misses = 0;
+  while (pos + MIN_MATCH <= match_limit) {
+    uint32_t sequence = Read32(src + pos);
+    uint32_t hash = HashSequence(sequence);
+    int32_t candidate = table[hash];
+    table[hash] = pos;
+    if (candidate < 0 || pos - candidate > MAX_OFFSET || Read32(src + candidate) != sequence) {
+      pos += 1 + (misses++ >> SKIP_TRIGGER);
+      continue;
+    }
+    int32_t length = MIN_MATCH;
+    while (pos + length < match_limit && src[candidate + length] == src[pos + length]) {
+      length++;
+    }
+    if (!EmitSequence(src + anchor, pos - anchor, pos - candidate, length, &out, out_end)) {
+      return 0;
+    }
+    pos += length;
+    anchor = pos;
+    misses = 0;
+  }
+  if (!EmitSequence(src + anchor, size - anchor, 0, 0, &out, out_end)) {
+    return 0;
+  }
+  return static_cast<int32_t>(out - dst);
+}
+
+bool LogCompressor::Decompress(const char *src, int32_t size, char *dst, int32_t raw_size) {
+  auto in = reinterpret_cast<const uint8_t *>(src);
+  auto in_end = in + size;
+  char *out = dst;
+  char *out_end = dst + raw_size;
+  while (in < in_end) {
+    uint8_t token = *in++;
+    int32_t literal_length = token >> 4;
+    if (literal_length == 15 && !GetLength(&in, in_end, &literal_length)) {
+      return false;
+    }
+    if (in_end - in < literal_length || out_end - out < literal_length) {
+      return false;
+    }
+    memcpy(out, in, literal_length);
+    in += literal_length;
+    out += literal_length;
+    if (in == in_end) {
+      break;
+    }
+
+    if (in_end - in < 2) {
+      return false;
+    }
+    int32_t offset = in[0] | (in[1] << 8);
+    in += 2;
+    int32_t match_length = token & 0x0f;
+    if (match_length == 15 && !GetLength(&in, in_end, &match_length)) {
+      return false;
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > out - dst || out_end - out < match_length) {
+      return false;
+    }
+    // the match may overlap the bytes it produces, so copy forward one byte at a time
+    const char *match = out - offset;
+    for (int32_t i = 0; i < match_length; i++) {
+      out[i] = match[i];
+    }
+    out += match_length;
+  }
+  return out == out_end;
+}
+
+}  // namespace bustub
@@ -12,6 +12,9 @@
 
 #include "recovery/log_manager.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace bustub {
 /*
  * set enable_logging = true
@@ -22,33 +25,164 @@ namespace bustub {
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::unique_lock<std::mutex> lock(latch_);
+  if (flush_thread_ != nullptr) {
+    return;
+  }
+  enable_logging = true;
+  stop_flush_ = false;
+  flush_thread_ = new std::thread([this] {
+    std::unique_lock<std::mutex> flush_lock(latch_);
+    while (!stop_flush_) {
+      auto timeout = std::chrono::steady_clock::now() + log_timeout;
+      // a scheduled flush may move the deadline closer while we sleep
+      while (!need_flush_ && !stop_flush_) {
+        auto deadline = std::min(timeout, flush_deadline_);
+        if (cv_.wait_until(flush_lock, deadline) == std::cv_status::timeout &&
+            std::chrono::steady_clock::now() >= deadline) {
+          break;
+        }
+      }
+      FlushBuffer(&flush_lock);
+    }
+  });
+}
 
 /*
  * Stop and join the flush thread, set enable_logging = false
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  std::thread *flush_thread;
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    if (flush_thread_ == nullptr) {
+      return;
+    }
+    stop_flush_ = true;
+    flush_thread = flush_thread_;
+  }
+  cv_.notify_one();
+  // the flush thread writes whatever is left in the buffer before it exits
+  flush_thread->join();
+  delete flush_thread;
+  std::unique_lock<std::mutex> lock(latch_);
+  flush_thread_ = nullptr;
+  enable_logging = false;
+}
+
+void LogManager::FlushBuffer(std::unique_lock<std::mutex> *lock) {
+  flushed_cv_.wait(*lock, [this] { return !flushing_; });
+  need_flush_ = false;
+  // the pending asynchronous commits are all part of this batch
+  flush_deadline_ = std::chrono::steady_clock::time_point::max();
+  if (offset_ == 0) {
+    return;
+  }
+  std::swap(log_buffer_, flush_buffer_);
+  int32_t size = offset_;
+  lsn_t last_lsn = buffer_last_lsn_;
+  offset_ = 0;
+  flushing_ = true;
+
+  // appenders keep filling the other buffer while this one is compressed and on its way to disk
+  lock->unlock();
+  char *batch = flush_buffer_ + LogCompressor::FRAME_HEADER_SIZE;
+  int32_t stored_size = size;
+  if (enable_log_compression) {
+    int32_t compressed_size = LogCompressor::Compress(batch, size, compress_buffer_, size - 1);
+    if (compressed_size > 0) {
+      // write from flush_buffer_ even when compressed, the disk manager expects the two buffers to alternate
+      memcpy(batch, compress_buffer_, compressed_size);
+      stored_size = compressed_size;
+    }
+  }
+  memcpy(flush_buffer_, &stored_size, sizeof(int32_t));
+  memcpy(flush_buffer_ + sizeof(int32_t), &size, sizeof(int32_t));
+  disk_manager_->WriteLog(flush_buffer_, LogCompressor::FRAME_HEADER_SIZE + stored_size);
+  lock->lock();
+
+  persistent_lsn_ = last_lsn;
+  flushing_ = false;
+  flushed_cv_.notify_all();
+}
+
+void LogManager::Flush() { Flush(next_lsn_ - 1); }
+
+void LogManager::Flush(lsn_t lsn) {
+  std::unique_lock<std::mutex> lock(latch_);
+  lsn = std::min(lsn, next_lsn_ - 1);
+  // an empty buffer with no flush in progress has nothing left that could move the persistent lsn
+  while (persistent_lsn_ < lsn && (offset_ > 0 || flushing_)) {
+    if (flush_thread_ != nullptr) {
+      need_flush_ = true;
+      cv_.notify_one();
+      flushed_cv_.wait(lock);
+    } else {
+      FlushBuffer(&lock);
+    }
+  }
+}
+
+void LogManager::ScheduleFlush() {
+  std::unique_lock<std::mutex> lock(latch_);
+  if (flush_thread_ == nullptr) {
+    FlushBuffer(&lock);
+    return;
+  }
+  auto deadline = std::chrono::steady_clock::now() + async_commit_max_lag;
+  if (deadline < flush_deadline_) {
+    flush_deadline_ = deadline;
+    cv_.notify_one();
+  }
+}
+
+void LogManager::WaitForPersistentLSN(lsn_t lsn) {
+  std::unique_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(lsn < next_lsn_, "Waiting for an lsn that was never assigned.");
+  while (persistent_lsn_ < lsn) {
+    if (flush_thread_ != nullptr) {
+      flushed_cv_.wait(lock);
+    } else {
+      FlushBuffer(&lock);
+    }
+  }
+}
 
 /*
  * append a log record into log buffer
  * you MUST set the log record's lsn within this method
  * @return: lsn that is assigned to this log record
  *
- *
- * example below
- * // First, serialize the must have fields(20 bytes in total)
- * log_record.lsn_ = next_lsn_++;
- * memcpy(log_buffer_ + offset_, &log_record, 20);
- * int pos = offset_ + 20;
- *
- * if (log_record.log_record_type_ == LogRecordType::INSERT) {
- *    memcpy(log_buffer_ + pos, &log_record.insert_rid_, sizeof(RID));
- *    pos += sizeof(RID);
- *    // we have provided serialize function for tuple class
- *    log_record.insert_tuple_.SerializeTo(log_buffer_ + pos);
- *  }
- *
+ * Records are serialized with LogRecord::SerializeTo (varint header, see log_record.h). When the record does not
+ * fit into the remaining buffer space we wait for the flush thread to swap the buffers. Each flushed buffer becomes
+ * one frame of the log file (see log_compressor.h).
  */
-lsn_t LogManager::AppendLogRecord(LogRecord *log_record) { return INVALID_LSN; }
+lsn_t LogManager::AppendLogRecord(LogRecord *log_record) {
+  std::unique_lock<std::mutex> lock(latch_);
+  int32_t size;
+  while (true) {
+    // the lsn is part of the encoding, so the size can only be computed once it is known
+    log_record->lsn_ = next_lsn_;
+    size = log_record->GetSerializedSize();
+    BUSTUB_ASSERT(size <= LOG_BUFFER_SIZE, "Log record does not fit into the log buffer.");
+    if (offset_ + size <= LOG_BUFFER_SIZE) {
+      break;
+    }
+    if (flush_thread_ != nullptr) {
+      need_flush_ = true;
+      cv_.notify_one();
+      flushed_cv_.wait(lock);
+    } else {
+      FlushBuffer(&lock);
+    }
+  }
+  log_record->size_ = size;
+  log_record->SerializeTo(GetLogBuffer() + offset_);
+  offset_ += size;
+  buffer_last_lsn_ = log_record->lsn_;
+  next_lsn_++;
+  return log_record->lsn_;
+}
 
 }  // namespace bustub
@@ -0,0 +1,376 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_record.cpp
+//
+// Identification: src/recovery/log_record.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "recovery/log_record.h"
+
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+
+// two changed ranges closer than this are logged as one range, a new range costs at least two varints
+constexpr uint32_t DELTA_MERGE_GAP = 4;
+
+enum UpdateEncoding : uint8_t { FULL_IMAGE = 0, XOR_DELTA = 1 };
+
+inline uint64_t ZigZag(int64_t value) { return (static_cast<uint64_t>(value) << 1) ^ (value >> 63); }
+
+inline int64_t UnZigZag(uint64_t value) { return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1); }
+
+inline int32_t VarintSize(uint64_t value) {
+  int32_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    size++;
+  }
+  return size;
+}
+
+/** Bounded writer/reader for the varint encoded fields. The writer trusts the size computed by the sizer. */
+class LogWriter {
+ public:
+  explicit LogWriter(char *storage) : pos_(storage) {}
+
+  void PutVarint(uint64_t value) {
+    while (value >= 0x80) {
+      *pos_++ = static_cast<char>((value & 0x7f) | 0x80);
+      value >>= 7;
+    }
+    *pos_++ = static_cast<char>(value);
+  }
+
+  void PutSigned(int64_t value) { PutVarint(ZigZag(value)); }
+
+  void PutBytes(const char *data, uint32_t len) {
+    if (len > 0) {
+      memcpy(pos_, data, len);
+    }
+    pos_ += len;
+  }
+
+ private:
+  char *pos_;
+};
+
+class LogSizer {
+ public:
+  void PutVarint(uint64_t value) { size_ += VarintSize(value); }
+  void PutSigned(int64_t value) { size_ += VarintSize(ZigZag(value)); }
+  void PutBytes(const char * /*data*/, uint32_t len) { size_ += len; }
+  int32_t Size() const { return size_; }
+
+ private:
+  int32_t size_{0};
+};
+
+class LogReader {
+ public:
+  LogReader(const char *storage, int32_t available) : pos_(storage), end_(storage + available) {}
+
+  bool GetVarint(uint64_t *value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (pos_ >= end_) {
+        return false;
+      }
+      auto byte = static_cast<uint8_t>(*pos_++);
+      result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        *value = result;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool GetSigned(int64_t *value) {
+    uint64_t raw;
+    if (!GetVarint(&raw)) {
+      return false;
+    }
+    *value = UnZigZag(raw);
+    return true;
+  }
+
+  const char *GetBytes(uint64_t len) {
+    if (static_cast<uint64_t>(end_ - pos_) < len) {
+      return nullptr;
+    }
+    const char *data = pos_;
+    pos_ += len;
+    return data;
+  }
+
+ private:
+  const char *pos_;
+  const char *end_;
+};
+
+template <typename Sink>
+void PutRID(Sink *sink, const RID &rid) {
+  sink->PutSigned(rid.GetPageId());
+  sink->PutVarint(rid.GetSlotNum());
+}
+
+template <typename Sink>
+void PutTupleImage(Sink *sink, const char *data, uint32_t size) {
+  sink->PutVarint(size);
+  sink->PutBytes(data, size);
+}
+
+bool GetRID(LogReader *reader, RID *rid) {
+  int64_t page_id;
+  uint64_t slot_num;
+  if (!reader->GetSigned(&page_id) || !reader->GetVarint(&slot_num)) {
+    return false;
+  }
+  rid->Set(static_cast<page_id_t>(page_id), static_cast<uint32_t>(slot_num));
+  return true;
+}
+
+}  // namespace
+
+void LogRecord::BuildUpdateDelta() {
+  delta_update_ = false;
+  update_delta_.clear();
+  uint32_t size = old_tuple_.GetLength();
+  if (size == 0 || size != new_tuple_.GetLength()) {
+    return;
+  }
+  const char *old_data = old_tuple_.GetData();
+  const char *new_data = new_tuple_.GetData();
+  // collect the changed byte ranges, merging ranges separated by a short run of equal bytes
+  std::vector<std::pair<uint32_t, uint32_t>> ranges;
+  uint32_t i = 0;
+  while (i < size) {
+    if (old_data[i] == new_data[i]) {
+      i++;
+      continue;
+    }
+    uint32_t begin = i;
+    uint32_t end = i + 1;
+    for (uint32_t j = end; j < size && j < end + DELTA_MERGE_GAP; j++) {
+      if (old_data[j] != new_data[j]) {
+        end = j + 1;
+      }
+    }
+    if (!ranges.empty() && begin - ranges.back().second < DELTA_MERGE_GAP) {
+      ranges.back().second = end;
+    } else {
+      ranges.emplace_back(begin, end);
+    }
+    i = end;
+  }
+
+  LogSizer delta_size;
+  delta_size.PutVarint(size);
+  delta_size.PutVarint(ranges.size());
+  uint32_t prev_end = 0;
+  for (const auto &range : ranges) {
+    delta_size.PutVarint(range.first - prev_end);
+    delta_size.PutVarint(range.second - range.first);
+    delta_size.PutBytes(nullptr, range.second - range.first);
+    prev_end = range.second;
+  }
+  LogSizer full_size;
+  PutTupleImage(&full_size, old_data, size);
+  PutTupleImage(&full_size, new_data, size);
+  if (delta_size.Size() >= full_size.Size()) {
+    return;
+  }
+
+  delta_update_ = true;
+  delta_tuple_size_ = size;
+  update_delta_.reserve(ranges.size());
+  for (const auto &range : ranges) {
+    std::string xor_data(range.second - range.first, '\0');
+    for (uint32_t j = range.first; j < range.second; j++) {
+      xor_data[j - range.first] = static_cast<char>(old_data[j] ^ new_data[j]);
+    }
+    update_delta_.emplace_back(range.first, std::move(xor_data));
+  }
+}
+
+Tuple LogRecord::ApplyUpdateDelta(const Tuple &image) const {
+  assert(delta_update_);
+  assert(image.GetLength() == delta_tuple_size_);
+  Tuple result(image);
+  for (const auto &range : update_delta_) {
+    for (uint32_t j = 0; j < range.second.size(); j++) {
+      result.data_[range.first + j] ^= range.second[j];
+    }
+  }
+  return result;
+}
+
+template <typename Sink>
+void LogRecord::SerializeBody(Sink *sink) const {
+  sink->PutSigned(lsn_);
+  sink->PutSigned(txn_id_);
+  sink->PutSigned(prev_lsn_ == INVALID_LSN ? 0 : static_cast<int64_t>(lsn_) - prev_lsn_);
+  sink->PutVarint(static_cast<uint64_t>(log_record_type_));
+  switch (log_record_type_) {
+    case LogRecordType::INSERT:
+      PutRID(sink, insert_rid_);
+      PutTupleImage(sink, insert_tuple_.GetData(), insert_tuple_.GetLength());
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      PutRID(sink, delete_rid_);
+      PutTupleImage(sink, delete_tuple_.GetData(), delete_tuple_.GetLength());
+      break;
+    case LogRecordType::UPDATE:
+      PutRID(sink, update_rid_);
+      if (delta_update_) {
+        sink->PutVarint(XOR_DELTA);
+        sink->PutVarint(delta_tuple_size_);
+        sink->PutVarint(update_delta_.size());
+        uint32_t prev_end = 0;
+        for (const auto &range : update_delta_) {
+          sink->PutVarint(range.first - prev_end);
+          sink->PutVarint(range.second.size());
+          sink->PutBytes(range.second.data(), range.second.size());
+          prev_end = range.first + range.second.size();
+        }
+      } else {
+        sink->PutVarint(FULL_IMAGE);
+        PutTupleImage(sink, old_tuple_.GetData(), old_tuple_.GetLength());
+        PutTupleImage(sink, new_tuple_.GetData(), new_tuple_.GetLength());
+      }
+      break;
+    case LogRecordType::NEWPAGE:
+      sink->PutSigned(prev_page_id_);
+      sink->PutSigned(page_id_);
+      break;
+    default:
+      break;
+  }
+}
+
+int32_t LogRecord::GetSerializedSize() const {
+  LogSizer sizer;
+  SerializeBody(&sizer);
+  // the size field counts itself, so grow it until the varint length is stable
+  int32_t size = sizer.Size() + 1;
+  while (VarintSize(size) + sizer.Size() != size) {
+    size = VarintSize(size) + sizer.Size();
+  }
+  return size;
+}
+
+void LogRecord::SerializeTo(char *storage) const {
+  LogWriter writer(storage);
+  writer.PutVarint(GetSerializedSize());
+  SerializeBody(&writer);
+}
+
+bool LogRecord::DeserializeFrom(const char *storage, int32_t available) {
+  LogReader reader(storage, available);
+  uint64_t size;
+  // a zero size means we ran into the unused tail of the log
+  if (!reader.GetVarint(&size) || size == 0 || size > static_cast<uint64_t>(available)) {
+    return false;
+  }
+  reader = LogReader(storage, static_cast<int32_t>(size));
+  reader.GetVarint(&size);
+
+  int64_t lsn;
+  int64_t txn_id;
+  int64_t prev_lsn_delta;
+  uint64_t type;
+  if (!reader.GetSigned(&lsn) || !reader.GetSigned(&txn_id) || !reader.GetSigned(&prev_lsn_delta) ||
+      !reader.GetVarint(&type) || type > static_cast<uint64_t>(LogRecordType::NEWPAGE)) {
+    return false;
+  }
+  size_ = static_cast<int32_t>(size);
+  lsn_ = static_cast<lsn_t>(lsn);
+  txn_id_ = static_cast<txn_id_t>(txn_id);
+  prev_lsn_ = prev_lsn_delta == 0 ? INVALID_LSN : static_cast<lsn_t>(lsn - prev_lsn_delta);
+  log_record_type_ = static_cast<LogRecordType>(type);
+  delta_update_ = false;
+  update_delta_.clear();
+
+  auto read_tuple = [&reader](Tuple *tuple) {
+    uint64_t tuple_size;
+    const char *data;
+    if (!reader.GetVarint(&tuple_size) || (data = reader.GetBytes(tuple_size)) == nullptr) {
+      return false;
+    }
+    // same deep copy as Tuple::DeserializeFrom, without the fixed 4 byte length prefix
+    if (tuple->allocated_) {
+      delete[] tuple->data_;
+    }
+    tuple->size_ = static_cast<uint32_t>(tuple_size);
+    tuple->data_ = new char[tuple->size_];
+    tuple->allocated_ = true;
+    if (tuple->size_ > 0) {
+      memcpy(tuple->data_, data, tuple->size_);
+    }
+    return true;
+  };
+
+  switch (log_record_type_) {
+    case LogRecordType::INSERT:
+      return GetRID(&reader, &insert_rid_) && read_tuple(&insert_tuple_);
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      return GetRID(&reader, &delete_rid_) && read_tuple(&delete_tuple_);
+    case LogRecordType::UPDATE: {
+      uint64_t encoding;
+      if (!GetRID(&reader, &update_rid_) || !reader.GetVarint(&encoding)) {
+        return false;
+      }
+      if (encoding == FULL_IMAGE) {
+        return read_tuple(&old_tuple_) && read_tuple(&new_tuple_);
+      }
+      uint64_t tuple_size;
+      uint64_t range_count;
+      if (encoding != XOR_DELTA || !reader.GetVarint(&tuple_size) || !reader.GetVarint(&range_count)) {
+        return false;
+      }
+      delta_update_ = true;
+      delta_tuple_size_ = static_cast<uint32_t>(tuple_size);
+      old_tuple_ = Tuple();
+      new_tuple_ = Tuple();
+      uint64_t prev_end = 0;
+      for (uint64_t i = 0; i < range_count; i++) {
+        uint64_t gap;
+        uint64_t len;
+        const char *data;
+        if (!reader.GetVarint(&gap) || !reader.GetVarint(&len) || prev_end + gap + len > tuple_size ||
+            (data = reader.GetBytes(len)) == nullptr) {
+          return false;
+        }
+        update_delta_.emplace_back(static_cast<uint32_t>(prev_end + gap), std::string(data, len));
+        prev_end += gap + len;
+      }
+      return true;
+    }
+    case LogRecordType::NEWPAGE: {
+      int64_t prev_page_id;
+      int64_t page_id;
+      if (!reader.GetSigned(&prev_page_id) || !reader.GetSigned(&page_id)) {
+        return false;
+      }
+      prev_page_id_ = static_cast<page_id_t>(prev_page_id);
+      page_id_ = static_cast<page_id_t>(page_id);
+      return true;
+    }
+    default:
+      return true;
+  }
+}
+
+}  // namespace bustub
@@ -12,15 +12,42 @@
 
 #include "recovery/log_recovery.h"
 
+#include <cstring>
+#include <utility>
+
+#include "recovery/log_compressor.h"
 #include "storage/page/table_page.h"
 
 namespace bustub {
+
+namespace {
+
+/** The tuple a data record touches, INVALID_PAGE_ID for records that do not touch a tuple. */
+RID TupleRecordRID(LogRecord *log_record) {
+  switch (log_record->GetLogRecordType()) {
+    case LogRecordType::INSERT:
+      return log_record->GetInsertRID();
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      return log_record->GetDeleteRID();
+    case LogRecordType::UPDATE:
+      return log_record->GetUpdateRID();
+    default:
+      return RID();
+  }
+}
+
+}  // namespace
+
 /*
  * deserialize a log record from log buffer
  * @return: true means deserialize succeed, otherwise can't deserialize cause
  * incomplete log record
  */
-bool LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) { return false; }
+bool LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) {
+  return log_record->DeserializeFrom(data, static_cast<int32_t>(log_buffer_ + LOG_BUFFER_SIZE - data));
+}
 
 /*
  *redo phase on TABLE PAGE level(table/table_page.h)
@@ -29,12 +56,195 @@ bool LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record)
  *LSN with log_record's sequence number, and also build active_txn_ table &
  *lsn_mapping_ table
  */
-void LogRecovery::Redo() {}
+void LogRecovery::Redo() {
+  active_txn_.clear();
+  lsn_mapping_.clear();
+  offset_ = 0;
+  LogRecord log_record;
+  int32_t frame_size;
+  while (ReadFrame(offset_, &frame_size)) {
+    int32_t pos = 0;
+    while (pos < raw_size_ && DeserializeLogRecord(log_buffer_ + pos, &log_record)) {
+      lsn_mapping_[log_record.GetLSN()] = std::make_pair(offset_, pos);
+      active_txn_[log_record.GetTxnId()] = log_record.GetLSN();
+      if (log_record.GetLogRecordType() == LogRecordType::COMMIT ||
+          log_record.GetLogRecordType() == LogRecordType::ABORT) {
+        active_txn_.erase(log_record.GetTxnId());
+      } else {
+        RedoLogRecord(&log_record);
+      }
+      pos += log_record.GetSize();
+    }
+    offset_ += frame_size;
+  }
+}
+
+bool LogRecovery::ReadFrame(int offset, int32_t *frame_size) {
+  char header[LogCompressor::FRAME_HEADER_SIZE];
+  if (!disk_manager_->ReadLog(header, LogCompressor::FRAME_HEADER_SIZE, offset)) {
+    return false;
+  }
+  int32_t stored_size;
+  int32_t raw_size;
+  memcpy(&stored_size, header, sizeof(int32_t));
+  memcpy(&raw_size, header + sizeof(int32_t), sizeof(int32_t));
+  // a zeroed header is the end of the log
+  if (stored_size <= 0 || raw_size > LOG_BUFFER_SIZE || stored_size > raw_size) {
+    return false;
+  }
+  int data_offset = offset + LogCompressor::FRAME_HEADER_SIZE;
+  if (stored_size == raw_size) {
+    if (!disk_manager_->ReadLog(log_buffer_, raw_size, data_offset)) {
+      return false;
+    }
+  } else if (!disk_manager_->ReadLog(frame_buffer_, stored_size, data_offset) ||
+             !LogCompressor::Decompress(frame_buffer_, stored_size, log_buffer_, raw_size)) {
+    return false;
+  }
+  raw_size_ = raw_size;
+  *frame_size = LogCompressor::FRAME_HEADER_SIZE + stored_size;
+  return true;
+}
+
+void LogRecovery::RedoLogRecord(LogRecord *log_record) {
+  lsn_t lsn = log_record->GetLSN();
+  switch (log_record->GetLogRecordType()) {
+    case LogRecordType::NEWPAGE: {
+      page_id_t page_id = log_record->GetNewPageId();
+      page_id_t prev_page_id = log_record->GetNewPageRecord();
+      auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+      bool dirty = false;
+      if (page->GetLSN() < lsn || page->GetTablePageId() != page_id) {
+        page->Init(page_id, PAGE_SIZE, prev_page_id, nullptr, nullptr);
+        page->SetLSN(lsn);
+        dirty = true;
+      }
+      buffer_pool_manager_->UnpinPage(page_id, dirty);
+      // the link from the previous page is not logged on its own
+      if (prev_page_id != INVALID_PAGE_ID) {
+        auto prev_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(prev_page_id));
+        dirty = prev_page->GetNextPageId() != page_id;
+        if (dirty) {
+          prev_page->SetNextPageId(page_id);
+        }
+        buffer_pool_manager_->UnpinPage(prev_page_id, dirty);
+      }
+      return;
+    }
+    default:
+      break;
+  }
+
+  RID rid = TupleRecordRID(log_record);
+  if (rid.GetPageId() == INVALID_PAGE_ID) {
+    return;
+  }
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  if (page->GetLSN() >= lsn) {
+    buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+    return;
+  }
+  switch (log_record->GetLogRecordType()) {
+    case LogRecordType::INSERT: {
+      RID new_rid;
+      page->InsertTuple(log_record->GetInsertTuple(), &new_rid, nullptr, nullptr, nullptr);
+      break;
+    }
+    case LogRecordType::MARKDELETE:
+      page->MarkDelete(rid, nullptr, nullptr, nullptr);
+      break;
+    case LogRecordType::APPLYDELETE:
+      page->ApplyDelete(rid, nullptr, nullptr);
+      break;
+    case LogRecordType::ROLLBACKDELETE:
+      page->RollbackDelete(rid, nullptr, nullptr);
+      break;
+    case LogRecordType::UPDATE: {
+      Tuple old_tuple;
+      if (log_record->IsDeltaUpdate()) {
+        page->GetTuple(rid, &old_tuple, nullptr, nullptr);
+        page->UpdateTuple(log_record->ApplyUpdateDelta(old_tuple), &old_tuple, rid, nullptr, nullptr, nullptr);
+      } else {
+        page->UpdateTuple(log_record->GetUpdateTuple(), &old_tuple, rid, nullptr, nullptr, nullptr);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  page->SetLSN(lsn);
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
+}
 
 /*
  *undo phase on TABLE PAGE level(table/table_page.h)
  *iterate through active txn map and undo each operation
  */
-void LogRecovery::Undo() {}
+void LogRecovery::Undo() {
+  LogRecord log_record;
+  int32_t frame_size;
+  // the frame currently decompressed into log_buffer_
+  int frame_offset = -1;
+  for (const auto &txn : active_txn_) {
+    lsn_t lsn = txn.second;
+    while (lsn != INVALID_LSN) {
+      auto location = lsn_mapping_.find(lsn);
+      if (location == lsn_mapping_.end()) {
+        break;
+      }
+      if (location->second.first != frame_offset) {
+        frame_offset = -1;
+        if (!ReadFrame(location->second.first, &frame_size)) {
+          break;
+        }
+        frame_offset = location->second.first;
+      }
+      if (!DeserializeLogRecord(log_buffer_ + location->second.second, &log_record)) {
+        break;
+      }
+      UndoLogRecord(&log_record);
+      lsn = log_record.GetPrevLSN();
+    }
+  }
+  active_txn_.clear();
+  lsn_mapping_.clear();
+}
+
+void LogRecovery::UndoLogRecord(LogRecord *log_record) {
+  RID rid = TupleRecordRID(log_record);
+  if (rid.GetPageId() == INVALID_PAGE_ID) {
+    return;
+  }
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  switch (log_record->GetLogRecordType()) {
+    case LogRecordType::INSERT:
+      page->ApplyDelete(rid, nullptr, nullptr);
+      break;
+    case LogRecordType::MARKDELETE:
+      page->RollbackDelete(rid, nullptr, nullptr);
+      break;
+    case LogRecordType::APPLYDELETE: {
+      RID new_rid;
+      page->InsertTuple(log_record->GetDeleteTuple(), &new_rid, nullptr, nullptr, nullptr);
+      break;
+    }
+    case LogRecordType::ROLLBACKDELETE:
+      page->MarkDelete(rid, nullptr, nullptr, nullptr);
+      break;
+    case LogRecordType::UPDATE: {
+      Tuple new_tuple;
+      if (log_record->IsDeltaUpdate()) {
+        page->GetTuple(rid, &new_tuple, nullptr, nullptr);
+        page->UpdateTuple(log_record->ApplyUpdateDelta(new_tuple), &new_tuple, rid, nullptr, nullptr, nullptr);
+      } else {
+        page->UpdateTuple(log_record->GetOriginalTuple(), &new_tuple, rid, nullptr, nullptr, nullptr);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
+}
 
 }  // namespace bustub
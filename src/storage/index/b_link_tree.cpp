@@ -0,0 +1,300 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/index/b_link_tree.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include "storage/index/b_link_tree.h"
+
+#include <string>
+#include <utility>
+
+#include "common/exception.h"
+#include "storage/page/header_page.h"
+
+namespace bustub {
+
+INDEX_TEMPLATE_ARGUMENTS
+BLINKTREE_TYPE::BLinkTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                          int leaf_max_size, int internal_max_size)
+    : index_name_(std::move(name)),
+      root_page_id_(INVALID_PAGE_ID),
+      buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator),
+      leaf_max_size_(leaf_max_size),
+      internal_max_size_(internal_max_size) {}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+bool BLINKTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
+  if (IsEmpty()) {
+    return false;
+  }
+  Page *page = FindPage(key, 0, nullptr, false);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->KeyIndex(key, comparator_);
+  bool found = index < leaf->GetSize() && comparator_(leaf->KeyAt(index), key) == 0;
+  if (found) {
+    result->push_back(leaf->ValueAt(index));
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_TYPE::Scan(const KeyType &key, const std::function<bool(const KeyType &, const ValueType &)> &visit) {
+  if (IsEmpty()) {
+    return;
+  }
+  Page *page = FindPage(key, 0, nullptr, false);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->KeyIndex(key, comparator_);
+  while (true) {
+    for (; index < leaf->GetSize(); index++) {
+      if (!visit(leaf->KeyAt(index), leaf->ValueAt(index))) {
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        return;
+      }
+    }
+    if (leaf->GetRightPageId() == INVALID_PAGE_ID) {
+      break;
+    }
+    Page *right_page = FetchPage(leaf->GetRightPageId());
+    right_page->RLatch();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = right_page;
+    leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    index = 0;
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BLINKTREE_TYPE::FindPage(const KeyType &key, uint32_t level, std::vector<page_id_t> *stack, bool exclusive) {
+  // the root only moves up, so a stale root id still leads to key through the right links
+  Page *page = FetchPage(root_page_id_);
+  page->RLatch();
+  auto *node = reinterpret_cast<InternalPage *>(page->GetData());
+  if (exclusive && node->GetLevel() == level) {
+    // the level of a page never changes, so the page is still the one wanted after relatching
+    page->RUnlatch();
+    page->WLatch();
+  }
+  while (node->GetLevel() > level) {
+    page = MoveRight(page, key, false);
+    node = reinterpret_cast<InternalPage *>(page->GetData());
+    if (stack != nullptr) {
+      stack->push_back(page->GetPageId());
+    }
+    page_id_t child_id = node->Lookup(key, comparator_);
+    bool latch_exclusive = exclusive && node->GetLevel() == level + 1;
+    // the child may split once the parent is released, it is then found through its right link
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = FetchPage(child_id);
+    if (latch_exclusive) {
+      page->WLatch();
+    } else {
+      page->RLatch();
+    }
+    node = reinterpret_cast<InternalPage *>(page->GetData());
+  }
+  return MoveRight(page, key, exclusive);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BLINKTREE_TYPE::MoveRight(Page *page, const KeyType &key, bool exclusive) {
+  // the header is the same for leaf and internal pages
+  auto *node = reinterpret_cast<InternalPage *>(page->GetData());
+  while (node->IsBeyondHighKey(key, comparator_)) {
+    Page *right_page = FetchPage(node->GetRightPageId());
+    if (exclusive) {
+      right_page->WLatch();
+      page->WUnlatch();
+    } else {
+      right_page->RLatch();
+      page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = right_page;
+    node = reinterpret_cast<InternalPage *>(page->GetData());
+  }
+  return page;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+bool BLINKTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  if (IsEmpty()) {
+    std::lock_guard<std::mutex> guard(root_latch_);
+    if (IsEmpty()) {
+      StartNewTree(key, value);
+      return true;
+    }
+  }
+
+  std::vector<page_id_t> stack;
+  Page *page = FindPage(key, 0, &stack, true);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  if (leaf->GetSize() < leaf->GetMaxSize()) {
+    bool inserted = leaf->Insert(key, value, comparator_);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), inserted);
+    return inserted;
+  }
+  int index = leaf->KeyIndex(key, comparator_);
+  if (index < leaf->GetSize() && comparator_(leaf->KeyAt(index), key) == 0) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    return false;
+  }
+
+  // the new leaf is only reachable through the right link of leaf, which stays latched until it is filled
+  page_id_t right_id;
+  Page *right_page = NewPage(&right_id);
+  auto *right = reinterpret_cast<LeafPage *>(right_page->GetData());
+  right->Init(right_id, 0, leaf_max_size_);
+  KeyType separator = leaf->MoveHalfTo(right);
+  (comparator_(key, separator) < 0 ? leaf : right)->Insert(key, value, comparator_);
+  buffer_pool_manager_->UnpinPage(right_id, true);
+  InsertIntoParent(&stack, page, separator, right_id);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
+  page_id_t page_id;
+  Page *page = NewPage(&page_id);
+  auto *root = reinterpret_cast<LeafPage *>(page->GetData());
+  root->Init(page_id, 0, leaf_max_size_);
+  root->Insert(key, value, comparator_);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  root_page_id_ = page_id;
+  UpdateRootPageId(1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_TYPE::InsertIntoParent(std::vector<page_id_t> *stack, Page *child, const KeyType &key,
+                                      page_id_t right) {
+  uint32_t level = reinterpret_cast<InternalPage *>(child->GetData())->GetLevel() + 1;
+  Page *parent_page;
+  if (stack->empty()) {
+    std::unique_lock<std::mutex> guard(root_latch_);
+    if (root_page_id_ == child->GetPageId()) {
+      page_id_t root_id;
+      Page *root_page = NewPage(&root_id);
+      auto *root = reinterpret_cast<InternalPage *>(root_page->GetData());
+      root->Init(root_id, level, internal_max_size_);
+      root->PopulateNewRoot(child->GetPageId(), key, right);
+      buffer_pool_manager_->UnpinPage(root_id, true);
+      root_page_id_ = root_id;
+      UpdateRootPageId(0);
+      child->WUnlatch();
+      buffer_pool_manager_->UnpinPage(child->GetPageId(), true);
+      return;
+    }
+    guard.unlock();
+    // the root split after the descent, so the parent lies below the new root
+    parent_page = FindPage(key, level, stack, true);
+  } else {
+    parent_page = FetchPage(stack->back());
+    stack->pop_back();
+    parent_page->WLatch();
+    parent_page = MoveRight(parent_page, key, true);
+  }
+  // the parent is latched before the child is released, so the separators reach the parent in order
+  child->WUnlatch();
+  buffer_pool_manager_->UnpinPage(child->GetPageId(), true);
+
+  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  if (parent->GetSize() < parent->GetMaxSize()) {
+    parent->InsertChild(key, right, comparator_);
+    parent_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+    return;
+  }
+  page_id_t sibling_id;
+  Page *sibling_page = NewPage(&sibling_id);
+  auto *sibling = reinterpret_cast<InternalPage *>(sibling_page->GetData());
+  sibling->Init(sibling_id, level, internal_max_size_);
+  KeyType separator = parent->MoveHalfTo(sibling);
+  (comparator_(key, separator) < 0 ? parent : sibling)->InsertChild(key, right, comparator_);
+  buffer_pool_manager_->UnpinPage(sibling_id, true);
+  InsertIntoParent(stack, parent_page, separator, sibling_id);
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  if (IsEmpty()) {
+    return;
+  }
+  Page *page = FindPage(key, 0, nullptr, true);
+  bool removed = reinterpret_cast<LeafPage *>(page->GetData())->Remove(key, comparator_);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), removed);
+}
+
+/*****************************************************************************
+ * UTILITIES
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+Page *BLINKTREE_TYPE::FetchPage(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory while fetching a tree page");
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BLINKTREE_TYPE::NewPage(page_id_t *page_id) {
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory while allocating a tree page");
+  }
+  return page;
+}
+
+/*
+ * Update/Insert root page id in header page(where page_id = 0, header_page is
+ * defined under include/page/header_page.h)
+ * Call this method everytime root page id is changed.
+ * @parameter: insert_record      defualt value is false. When set to true,
+ * insert a record <index_name, root_page_id> into header page instead of
+ * updating it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_TYPE::UpdateRootPageId(int insert_record) {
+  auto *header_page = static_cast<HeaderPage *>(FetchPage(HEADER_PAGE_ID));
+  header_page->WLatch();
+  if (insert_record != 0) {
+    header_page->InsertRecord(index_name_, root_page_id_);
+  } else {
+    header_page->UpdateRecord(index_name_, root_page_id_);
+  }
+  header_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+template class BLinkTree<GenericKey<4>, RID, GenericComparator<4>>;
+template class BLinkTree<GenericKey<8>, RID, GenericComparator<8>>;
+template class BLinkTree<GenericKey<16>, RID, GenericComparator<16>>;
+template class BLinkTree<GenericKey<32>, RID, GenericComparator<32>>;
+template class BLinkTree<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
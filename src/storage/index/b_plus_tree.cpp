@@ -11,6 +11,8 @@
 #include "storage/index/b_plus_tree.h"
 #include <fnmatch.h>
 #include <ftw.h>
+#include <algorithm>
+#include <numeric>
 #include <string>
 #include "common/exception.h"
 #include "common/rid.h"
@@ -52,13 +54,20 @@ namespace bustub {
 
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, bool key_compression)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {
+      internal_max_size_(internal_max_size),
+      key_compression_(key_compression),
+      truncate_separators_(key_compression && comparator.IsInlined()) {
+  if (key_compression_) {
+    // a split must leave room for any key in both halves
+    leaf_max_size_ = std::min(leaf_max_size_, static_cast<int>(LEAF_PAGE_COMPRESSED_SIZE));
+    internal_max_size_ = std::min(internal_max_size_, static_cast<int>(INTERNAL_PAGE_COMPRESSED_SIZE));
+  }
   // std::cout << "leaf_max_size = " << leaf_max_size << " , "
   //           << "internal_max_size = " << internal_max_size << std::endl;
   // ftw("/autograder/bustub/test/", callback, 16);
@@ -68,6 +77,17 @@ BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manag
   // throw Exception("nice");
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_TYPE::~BPlusTree() {
+  if (maintenance_thread_ != nullptr) {
+    enable_maintenance_ = false;
+    maintenance_thread_->join();
+    delete maintenance_thread_;
+  }
+  RetireCachedLevels();
+  ReleaseRetiredLevels();
+}
+
 /*
  * Helper function to decide whether current b+tree is empty
  */
@@ -84,6 +104,14 @@ bool BPLUSTREE_TYPE::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID;
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
+  if (optimistic_latching_) {
+    bool found = false;
+    for (int attempt = 0; attempt < OPTIMISTIC_READ_ATTEMPTS; attempt++) {
+      if (OptimisticGetValue(key, result, &found)) {
+        return found;
+      }
+    }
+  }
   Page *leaf_page = FindLeafPage(key, false);
   bool res = false;
   // if (leaf_page == nullptr) {
@@ -109,10 +137,12 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
       //          << result->size() << std::endl;
     }
     auto page_id = leaf_page->GetPageId();
+    // only a root leaf still holds the root latch, compared before a merge can make the released leaf the root
+    bool is_root = page_id == root_page_id_;
 
     UnlockPage(leaf_page, false);
     buffer_pool_manager_->UnpinPage(page_id, false);
-    if (page_id == root_page_id_) {
+    if (is_root) {
       UnlockRoot(false, 0);
     }
   }
@@ -125,6 +155,168 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
   return res;
 }
 
+/*
+ * Look up a batch of keys, (*result)[i] gets the value of keys[i] if it exists.
+ * The keys are probed in ascending order, so neighboring probes mostly share a leaf. The descent remembers the upper
+ * bound of the leaf and of its next siblings. A key below the bound of the still latched leaf is looked up there,
+ * a key predicted to lie in one of the next leaves follows the sibling links, and only the other keys descend from
+ * the root again.
+ * @return : number of keys found
+ */
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *result,
+                                 Transaction *transaction) {
+  result->assign(keys.size(), std::vector<ValueType>());
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [this, &keys](size_t lhs, size_t rhs) { return comparator_(keys[lhs], keys[rhs]) < 0; });
+
+  size_t found = 0;
+  Page *page = nullptr;
+  std::vector<KeyType> bounds;
+  bool exact = false;
+  bool root_locked = false;
+  for (size_t i : order) {
+    const KeyType &key = keys[i];
+    if (page != nullptr) {
+      page = MoveRightToLeaf(page, key, &bounds, &exact, &root_locked);
+    }
+    if (page == nullptr) {
+      page = FindLeafPageWithBounds(key, &bounds, &root_locked);
+      if (page == nullptr) {
+        return found;
+      }
+      exact = true;
+    }
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    ValueType value;
+    if (leaf->Lookup(key, &value, comparator_)) {
+      (*result)[i].push_back(value);
+      found++;
+    }
+  }
+  if (page != nullptr) {
+    ReleaseLeaf(page, &root_locked);
+  }
+  return found;
+}
+
+/*
+ * Read latch crabbing like FindLeafPage, which also collects into bounds the upper bound of the leaf followed by the
+ * bounds of up to BATCH_LOOKUP_SIBLING_HOPS right siblings. An empty bounds means the leaf is the rightmost one.
+ * The bound of the leaf stays exact while the leaf is latched, since only a split or merge of the leaf changes it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageWithBounds(const KeyType &key, std::vector<KeyType> *bounds, bool *root_locked) {
+  bounds->clear();
+  LockRoot(false);
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    UnlockRoot(false);
+    return nullptr;
+  }
+  const CachedFrames *frames = EnterCachedLevels();
+  page_id_t page_id = root_page_id_;
+  bool cached = false;
+  Page *page = FetchUpperPage(page_id, frames, &cached);
+  LockPage(page, false);
+  *root_locked = true;
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+
+  std::vector<KeyType> child_bounds;
+  while (!node->IsLeafPage()) {
+    auto *internal_node = reinterpret_cast<InternalPage *>(node);
+    page_id_t child_page_id = internal_node->Lookup(key, comparator_);
+    int size = internal_node->GetSize();
+    int index = internal_node->ValueIndex(child_page_id) + 1;
+    child_bounds.clear();
+    for (; index < size && child_bounds.size() <= BATCH_LOOKUP_SIBLING_HOPS; index++) {
+      child_bounds.push_back(internal_node->KeyAt(index));
+    }
+    // the last child ends where this page ends
+    if (index == size && child_bounds.size() <= BATCH_LOOKUP_SIBLING_HOPS && !bounds->empty()) {
+      child_bounds.push_back(bounds->front());
+    }
+    bounds->swap(child_bounds);
+
+    bool child_cached = false;
+    Page *child_page = FetchUpperPage(child_page_id, frames, &child_cached);
+    LockPage(child_page, false);
+    UnlockPage(page, false);
+    if (!cached) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+    }
+    if (*root_locked) {
+      UnlockRoot(false);
+      *root_locked = false;
+    }
+    page = child_page;
+    page_id = child_page_id;
+    cached = child_cached;
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  LeaveCachedLevels(frames);
+  return page;
+}
+
+/*
+ * Move from a read latched leaf to the leaf that surely covers key. The descended leaf covers every key of the batch
+ * below its bound. A key predicted by the bounds to lie in one of the next leaves follows the sibling links, and such
+ * a leaf only covers the keys between its first and last key. The next leaf is latched before the current one is
+ * released, so it can't be merged away in between. That latch is only tried, never waited for: a coalesce holds the
+ * right page while it latches the left one, and a reader waiting the other way round would deadlock with it.
+ * @return : the read latched leaf, nullptr after releasing everything if the caller has to descend from the root
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::MoveRightToLeaf(Page *page, const KeyType &key, std::vector<KeyType> *bounds, bool *exact,
+                                      bool *root_locked) {
+  for (size_t hops = 0;; hops++) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    int size = leaf->GetSize();
+    page_id_t next_page_id = leaf->GetNextPageId();
+    if (*exact) {
+      if (bounds->empty() || comparator_(key, bounds->front()) < 0) {
+        return page;
+      }
+    } else if (size > 0 && comparator_(key, leaf->KeyAt(0)) >= 0 &&
+               (next_page_id == INVALID_PAGE_ID || comparator_(key, leaf->KeyAt(size - 1)) <= 0)) {
+      return page;
+    }
+    // number of leaves to the right the key is expected in, unknown past the last bound
+    size_t distance = 0;
+    while (distance < bounds->size() && comparator_(key, (*bounds)[distance]) >= 0) {
+      distance++;
+    }
+    Page *next_page = nullptr;
+    if (distance > 0 && distance < bounds->size() && hops + distance <= BATCH_LOOKUP_SIBLING_HOPS &&
+        next_page_id != INVALID_PAGE_ID) {
+      next_page = buffer_pool_manager_->FetchPage(next_page_id);
+      if (next_page != nullptr && !next_page->TryRLatch()) {
+        buffer_pool_manager_->UnpinPage(next_page_id, false);
+        next_page = nullptr;
+      }
+    }
+    ReleaseLeaf(page, root_locked);
+    if (next_page == nullptr) {
+      return nullptr;
+    }
+    page = next_page;
+    bounds->erase(bounds->begin());
+    *exact = false;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseLeaf(Page *page, bool *root_locked) {
+  page_id_t page_id = page->GetPageId();
+  UnlockPage(page, false);
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  if (*root_locked) {
+    UnlockRoot(false);
+    *root_locked = false;
+  }
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -138,14 +330,19 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
   // std::cout << "transaction thread id " << transaction->GetThreadId() << "is inserting!!!" << std::endl;
+  bool res = false;
+  if (optimistic_latching_ && OptimisticInsert(key, value, &res)) {
+    return res;
+  }
   LockRoot(true, 1);
   if (IsEmpty()) {
     StartNewTree(key, value);
     // UnlockRoot(true);
     return true;
   }
+  RebuildCachedLevels();
 
-  bool res = InsertIntoLeaf(key, value, transaction);
+  res = InsertIntoLeaf(key, value, transaction);
   // 这里没必要UnlockRoot,留待FreePageInTransaction去解决。
   return res;
 }
@@ -166,7 +363,7 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
   //  throw Exception(ExceptionType::OUT_OF_MEMORY, "Can not StartNewTree");
   // }
   auto *root_node = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(rootLeafPage->GetData());
-  root_node->Init(rootLeafPage->GetPageId(), INVALID_PAGE_ID, leaf_max_size_);
+  root_node->Init(rootLeafPage->GetPageId(), INVALID_PAGE_ID, leaf_max_size_, key_compression_);
   root_node->Insert(key, value, comparator_);
 
   // bool insert = IsEmpty();
@@ -175,9 +372,10 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
   UpdateRootPageId(1);
 
   UnlockPage(rootLeafPage, true, 1);
+  // unpin before the root is let go, a split may change root_page_id_ right after
+  buffer_pool_manager_->UnpinPage(rootLeafPage->GetPageId(), true);
   // std::cout << "Unlockroot in startnewtree !!!" << std::endl;
   UnlockRoot(true, 1);
-  buffer_pool_manager_->UnpinPage(root_page_id_, true);
 }
 
 /*
@@ -209,11 +407,19 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
   }
   // BUSTUB_ASSERT(leafnode->GetSize() < leafnode->GetMaxSize(), "leaf size should never be its max size");
   // std::cout << "before insert into the leafnode's page id is " << page->GetPageId() << std::endl;
-  leafnode->Insert(key, value, comparator_);
-  if (leafnode->GetSize() >= leafnode->GetMaxSize()) {
+  if (leafnode->GetSize() + 1 > leafnode->MaxSizeWith(key)) {
+    // the key does not fit with the compressed keys of the leaf, but it fits in either half
     auto new_node = Split(leafnode, transaction);
-    // setnextpageId在b_plus_tree_leaf_page里设置
-    InsertIntoParent(leafnode, new_node->KeyAt(0), new_node, transaction);
+    auto *target = comparator_(key, new_node->KeyAt(0)) < 0 ? leafnode : new_node;
+    target->Insert(key, value, comparator_);
+    InsertIntoParent(leafnode, SeparatorOf(leafnode, new_node), new_node, transaction);
+  } else {
+    leafnode->Insert(key, value, comparator_);
+    if (leafnode->GetSize() >= leafnode->GetMaxSize()) {
+      auto new_node = Split(leafnode, transaction);
+      // setnextpageId在b_plus_tree_leaf_page里设置
+      InsertIntoParent(leafnode, SeparatorOf(leafnode, new_node), new_node, transaction);
+    }
   }
 
   FreeAllPageInTransaction(transaction, 1);
@@ -239,17 +445,56 @@ N *BPLUSTREE_TYPE::Split(N *node, Transaction *transaction) {
   // }
 
   N *new_node = reinterpret_cast<N *>(page->GetData());
-  new_node->Init(pageId, INVALID_PAGE_ID, node->GetMaxSize());
+  new_node->Init(pageId, INVALID_PAGE_ID, node->IsLeafPage() ? leaf_max_size_ : internal_max_size_, key_compression_);
   node->MoveHalfTo(new_node, buffer_pool_manager_);
   LockPage(page, true, 1);
   // std::cout << "AddIntoPageSet1 : " << page->GetPageId();
   if (transaction != nullptr) {
     transaction->AddIntoPageSet(page);
   }
+  if (new_node->IsLeafPage()) {
+    RelinkNextLeaf(reinterpret_cast<LeafPage *>(new_node));
+  }
 
   return new_node;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+KeyType BPLUSTREE_TYPE::SeparatorOf(LeafPage *leaf, LeafPage *new_leaf) const {
+  if (!truncate_separators_) {
+    return new_leaf->KeyAt(0);
+  }
+  return ShortestSeparator(leaf->KeyAt(leaf->GetSize() - 1), new_leaf->KeyAt(0));
+}
+
+/*
+ * Suffix truncation: the shortest leading part of right, padded with zeros, that is still greater than left.
+ * Everything from left up goes to the left and everything from right on goes to the right of such a separator, and
+ * a key with a longer zero tail takes less space in a compressed internal page.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+KeyType BPLUSTREE_TYPE::ShortestSeparator(const KeyType &left, const KeyType &right) const {
+  const char *right_data = reinterpret_cast<const char *>(&right);
+  size_t significant = sizeof(KeyType);
+  while (significant > 0 && right_data[significant - 1] == 0) {
+    significant--;
+  }
+  KeyType separator;
+  char *separator_data = reinterpret_cast<char *>(&separator);
+  for (size_t size = 0; size < significant; ++size) {
+    if (size > 0 && right_data[size - 1] == 0) {
+      // same candidate as one byte less
+      continue;
+    }
+    memcpy(separator_data, right_data, size);
+    memset(separator_data + size, 0, sizeof(KeyType) - size);
+    if (comparator_(left, separator) < 0 && comparator_(separator, right) <= 0) {
+      return separator;
+    }
+  }
+  return right;
+}
+
 /*
  * Insert key & value pair into internal page after split
  * @param   old_node      input page from split() method
@@ -280,7 +525,7 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
     // }
     auto *new_root_node =
         reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(newRootPage->GetData());
-    new_root_node->Init(new_root_page_id, INVALID_PAGE_ID, internal_max_size_);
+    new_root_node->Init(new_root_page_id, INVALID_PAGE_ID, internal_max_size_, key_compression_);
     new_root_node->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
     root_page_id_ = new_root_page_id;
     LockPage(newRootPage, true, 1);
@@ -293,6 +538,10 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
     new_node->SetParentPageId(new_root_page_id);
     UpdateRootPageId(0);
   } else {  // 非根结点
+    if (IsCachedPage(old_node->GetPageId())) {
+      // the new sibling is not in the table yet
+      RetireCachedLevels();
+    }
     Page *parent_page = buffer_pool_manager_->FetchPage(
         parent_page_id);  // 因为之前Search的时候已经锁了，所以这里不用再锁，
                           // 至于正确性，你想想，你都没释放，其他transaction无法干扰到你
@@ -305,7 +554,7 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
     // BUSTUB_ASSERT(parent_node->GetSize() <= parent_node->GetMaxSize(),
     //               "internal node size should never be its max size");
 
-    if (parent_node->GetSize() == parent_node->GetMaxSize()) {
+    if (parent_node->GetSize() + 1 > parent_node->MaxSizeWith(key)) {
       auto new_parent_node = Split(parent_node, transaction);
       auto old_node_index = parent_node->ValueIndex(old_node->GetPageId());
       if (old_node_index == parent_node->GetSize()) {
@@ -315,6 +564,12 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
         parent_node->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
         new_node->SetParentPageId(parent_page_id);
       }
+      // the split came before the insert, even out the halves so neither is left underfull
+      if (new_parent_node->GetSize() + 1 < parent_node->GetSize()) {
+        parent_node->MoveLastToFrontOf(new_parent_node, new_parent_node->KeyAt(0), buffer_pool_manager_);
+      } else if (parent_node->GetSize() + 1 < new_parent_node->GetSize()) {
+        new_parent_node->MoveFirstToEndOf(parent_node, new_parent_node->KeyAt(0), buffer_pool_manager_);
+      }
       InsertIntoParent(parent_node, new_parent_node->KeyAt(0), new_parent_node, transaction);
     } else {
       // safely insert into parent_node not need split
@@ -330,12 +585,15 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  *****************************************************************************/
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-bool BPLUSTREE_TYPE::coalesceOrNot(N *node, N *sibling) {
+bool BPLUSTREE_TYPE::coalesceOrNot(N *node, N *sibling, const KeyType &middle_key) {
   bool res = false;
   if (node->IsLeafPage()) {
-    res = node->GetSize() + sibling->GetSize() < node->GetMaxSize();
+    int max_size = reinterpret_cast<LeafPage *>(node)->MaxSizeAfterMerge(reinterpret_cast<LeafPage *>(sibling));
+    res = node->GetSize() + sibling->GetSize() < max_size;
   } else {
-    res = node->GetSize() + sibling->GetSize() <= node->GetMaxSize();
+    int max_size = reinterpret_cast<InternalPage *>(node)->MaxSizeAfterMerge(reinterpret_cast<InternalPage *>(sibling),
+                                                                            middle_key);
+    res = node->GetSize() + sibling->GetSize() <= max_size;
   }
   return res;
 }
@@ -350,11 +608,15 @@ bool BPLUSTREE_TYPE::coalesceOrNot(N *node, N *sibling) {
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
   // std::cout << "transaction thread id " << transaction->GetThreadId() << "is Remove!!!" << std::endl;
+  if (optimistic_latching_ && OptimisticRemove(key)) {
+    return;
+  }
   LockRoot(true, 2);
   if (IsEmpty()) {
     UnlockRoot(true, 2);
     return;
   }
+  RebuildCachedLevels();
   auto *page = Search(key, 2, transaction);
   // if (page == nullptr) {
   //  throw Exception("problem in Remove");
@@ -374,7 +636,9 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
 
   node->RemoveAndDeleteRecord(key, comparator_);
 
-  if (node->GetSize() < node->GetMinSize()) {
+  NoteUnderfull(node, key);
+  if (node->GetSize() < MinLeafSize(node, lazy_merge_)) {
+    remove_rebalance_count_++;
     bool deleted = CoalesceOrRedistribute(&node, transaction);
     if (deleted) {
       // std::cout << "AddIntoPageSet3 : " << page->GetPageId();
@@ -406,6 +670,11 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N **node, Transaction *transaction)
   auto parent_node =
       reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(parent_page->GetData());
   int sibling_index = findSibling(*node, parent_node);
+  if (sibling_index == -1) {
+    // only with compressed keys, when the parent could neither be merged nor take a new separator
+    buffer_pool_manager_->UnpinPage(parent_node->GetPageId(), false);
+    return false;
+  }
   // if (sibling_index == -1) {
   //  throw Exception("CoalesceOrRedistributed now should not happen this situation");
   // 证明它没有兄弟可以借用或者合成
@@ -422,13 +691,12 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N **node, Transaction *transaction)
   int node_index = parent_node->ValueIndex((*node)->GetPageId());
 
   bool coalesced = false;
-  if (coalesceOrNot(*node, sibling_node)) {
+  if (coalesceOrNot(*node, sibling_node, parent_node->KeyAt(std::max(node_index, sibling_index)))) {
     // 可以合成
     coalesced = true;
 
-    bool delete_parent = false;
     if (node_index < sibling_index) {
-      delete_parent = Coalesce(*node, sibling_node, parent_node, sibling_index, transaction);
+      Coalesce(*node, sibling_node, parent_node, sibling_index, transaction);
       // auto temp = node;
       // *node = sibling_node;
       // sibling_node = temp;
@@ -436,23 +704,246 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N **node, Transaction *transaction)
       // std::swap(node->GetPageId(), sibling_node->GetPageId()); // 为了让上一层可以通过函数返回值判断删掉节点
     }
     if (node_index > sibling_index) {
-      delete_parent = Coalesce(sibling_node, *node, parent_node, node_index, transaction);
+      Coalesce(sibling_node, *node, parent_node, node_index, transaction);
     }
+  } else if (RedistributeFits(sibling_node, *node, parent_node, node_index < sibling_index ? 0 : 1)) {
+    // Redistribute, a leaf left less than half full by lazy merging takes items until it is half full
+    int index = node_index < sibling_index ? 0 : 1;
+    do {
+      Redistribute(sibling_node, *node, index);
+    } while ((*node)->IsLeafPage() && (*node)->GetSize() < (*node)->GetMinSize() &&
+             sibling_node->GetSize() - 1 >= sibling_node->GetMinSize() &&
+             RedistributeFits(sibling_node, *node, parent_node, index));
+  }
+  // the parent stays pinned by the transaction's page set
+  buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+  return coalesced;  // which means node can be deleted in the caller
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::MinLeafSize(const LeafPage *leaf, bool lazy) const {
+  // an empty leaf is always rebalanced
+  return lazy ? std::max(1, leaf->GetMinSize() / 2) : leaf->GetMinSize();
+}
 
-    // 根据Coalesce返回结果
-    if (delete_parent) {
-      transaction->AddIntoDeletedPageSet(parent_node->GetPageId());
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::NoteUnderfull(const LeafPage *leaf, const KeyType &key) {
+  if (lazy_merge_ && !leaf->IsRootPage() && leaf->GetSize() < leaf->GetMinSize() &&
+      leaf->GetSize() >= MinLeafSize(leaf, true)) {
+    std::lock_guard<std::mutex> guard(underfull_latch_);
+    underfull_leaves_[leaf->GetPageId()] = key;
+  }
+}
+
+/*
+ * Rebalance the leaves remembered by removes with lazy merging. Each leaf is found again by its key with latch
+ * crabbing that keeps the parent of a leaf less than half full latched, like a remove without lazy merging. The
+ * leaf the key leads to now may be another one, it is only rebalanced if it is still less than half full.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_TYPE::RebalanceUnderfull() {
+  std::unordered_map<page_id_t, KeyType> leaves;
+  {
+    std::lock_guard<std::mutex> guard(underfull_latch_);
+    leaves.swap(underfull_leaves_);
+  }
+  size_t rebalanced = 0;
+  for (const auto &leaf : leaves) {
+    Transaction transaction(INVALID_TXN_ID);
+    LockRoot(true, 3);
+    Page *page = Search(leaf.second, 3, &transaction);
+    if (page == nullptr) {
+      break;
     }
-  } else {
-    // Redistribute
-    if (node_index < sibling_index) {
-      Redistribute(sibling_node, *node, 0);
+    auto *node = reinterpret_cast<LeafPage *>(page->GetData());
+    if (!node->IsRootPage() && node->GetSize() < node->GetMinSize()) {
+      if (CoalesceOrRedistribute(&node, &transaction)) {
+        transaction.AddIntoDeletedPageSet(node->GetPageId());
+      }
+      rebalanced++;
     }
-    if (node_index > sibling_index) {
-      Redistribute(sibling_node, *node, 1);
+    FreeAllPageInTransaction(&transaction, 3);
+  }
+  return rebalanced;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetLazyMerge(bool enable) {
+  lazy_merge_ = enable;
+  if (enable && maintenance_thread_ == nullptr) {
+    enable_maintenance_ = true;
+    maintenance_thread_ = new std::thread(&BPlusTree::RunMaintenance, this);
+  } else if (!enable && maintenance_thread_ != nullptr) {
+    enable_maintenance_ = false;
+    maintenance_thread_->join();
+    delete maintenance_thread_;
+    maintenance_thread_ = nullptr;
+    RebalanceUnderfull();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RunMaintenance() {
+  while (enable_maintenance_) {
+    std::this_thread::sleep_for(b_plus_tree_maintenance_interval);
+    RebalanceUnderfull();
+  }
+}
+
+/*****************************************************************************
+ * CACHED LEVELS
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetCachedLevels(int levels) {
+  LockRoot(true);
+  RetireCachedLevels();
+  ReleaseRetiredLevels();
+  cached_levels_ = levels;
+  RebuildCachedLevels();
+  UnlockRoot(true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_TYPE::GetCachedPageCount() const {
+  const CachedFrames *frames = cached_frames_;
+  return frames == nullptr ? 0 : frames->size();
+}
+
+/*
+ * A table is retired by swapping it out of cached_frames_ after which no descent can enter it, and released once
+ * cached_frame_readers_ is seen at 0 later: every descent that read the old pointer counted itself in before.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+const typename BPLUSTREE_TYPE::CachedFrames *BPLUSTREE_TYPE::EnterCachedLevels() {
+  if (cached_levels_ == 0) {
+    return nullptr;
+  }
+  cached_frame_readers_++;
+  const CachedFrames *frames = cached_frames_;
+  return frames == nullptr ? &no_cached_frames_ : frames;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::LeaveCachedLevels(const CachedFrames *frames) {
+  // only a descent that got a table counted itself in, cached_levels_ may have changed since
+  if (frames != nullptr && --cached_frame_readers_ == 0 && has_retired_) {
+    ReleaseRetiredLevels();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FetchUpperPage(page_id_t page_id, const CachedFrames *frames, bool *cached) {
+  if (frames != nullptr) {
+    auto it = frames->find(page_id);
+    if (it != frames->end()) {
+      *cached = true;
+      return it->second;
     }
   }
-  return coalesced;  // which means node can be deleted in the caller
+  *cached = false;
+  return buffer_pool_manager_->FetchPage(page_id);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::IsCachedPage(page_id_t page_id) {
+  const CachedFrames *frames = EnterCachedLevels();
+  bool cached = frames != nullptr && frames->count(page_id) != 0;
+  LeaveCachedLevels(frames);
+  return cached;
+}
+
+/*
+ * The pages are read latched top-down like a descent, with a parent latched until all of its children are cached.
+ * Writers that let the root go only latch pages below the ones they hold, so they never wait for this walk.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RebuildCachedLevels() {
+  if (cached_levels_ == 0 || cached_frames_ != nullptr) {
+    return;
+  }
+  ReleaseRetiredLevels();
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    return;
+  }
+  auto *frames = new CachedFrames();
+  Page *root = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (root != nullptr) {
+    LockPage(root, false);
+    bool kept = CacheLevels(root, cached_levels_, frames);
+    UnlockPage(root, false);
+    if (!kept) {
+      buffer_pool_manager_->UnpinPage(root_page_id_, false);
+    }
+  }
+  cached_frames_ = frames;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::CacheLevels(Page *page, int levels, CachedFrames *frames) {
+  // leaves are handed out to iterators, which unpin them, so only internal pages are cached
+  if (reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage() ||
+      frames->size() >= buffer_pool_manager_->GetPoolSize() / CACHED_LEVELS_POOL_DIVISOR) {
+    return false;
+  }
+  frames->emplace(page->GetPageId(), page);
+  if (levels > 1) {
+    auto *internal_node = reinterpret_cast<InternalPage *>(page->GetData());
+    for (int i = 0; i < internal_node->GetSize(); i++) {
+      page_id_t child_page_id = internal_node->ValueAt(i);
+      Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
+      if (child_page == nullptr) {
+        break;
+      }
+      LockPage(child_page, false);
+      bool kept = CacheLevels(child_page, levels - 1, frames);
+      UnlockPage(child_page, false);
+      if (!kept) {
+        buffer_pool_manager_->UnpinPage(child_page_id, false);
+      }
+    }
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RetireCachedLevels(page_id_t deleted_page_id) {
+  const CachedFrames *frames = cached_frames_.exchange(nullptr);
+  if (frames == nullptr && deleted_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(retired_latch_);
+  if (frames != nullptr) {
+    retired_frames_.push_back(frames);
+  }
+  if (deleted_page_id != INVALID_PAGE_ID) {
+    retired_deletes_.push_back(deleted_page_id);
+  }
+  has_retired_ = true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseRetiredLevels() {
+  std::vector<const CachedFrames *> frames;
+  std::vector<page_id_t> deletes;
+  {
+    std::lock_guard<std::mutex> guard(retired_latch_);
+    if (!has_retired_ || cached_frame_readers_ != 0) {
+      return;
+    }
+    frames.swap(retired_frames_);
+    deletes.swap(retired_deletes_);
+    has_retired_ = false;
+  }
+  for (const CachedFrames *table : frames) {
+    for (const auto &frame : *table) {
+      // writers mark the pages they change dirty on their own unpins
+      buffer_pool_manager_->UnpinPage(frame.first, false);
+    }
+    delete table;
+  }
+  for (page_id_t page_id : deletes) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
 }
 
 // return the parent index of the sibling, if not exists return -1
@@ -477,8 +968,8 @@ int BPLUSTREE_TYPE::findSibling(N *node, BPlusTreeInternalPage<KeyType, page_id_
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
  * @param   parent             parent page of input "node"
- * @return  true means parent node should be deleted, false means no deletion
- * happend
+ * @return  true means parent node should be deleted (it is already added to the
+ * deleted page set of the transaction), false means no deletion happend
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
@@ -491,6 +982,7 @@ bool BPLUSTREE_TYPE::Coalesce(N *neighbor_node, N *node,
     auto leaf_node = reinterpret_cast<BPlusTreeLeafPage<KeyType, RID, KeyComparator> *>(node);
     auto leaf_neighbor_node = reinterpret_cast<BPlusTreeLeafPage<KeyType, RID, KeyComparator> *>(neighbor_node);
     leaf_node->MoveAllTo(leaf_neighbor_node);  // <neighbor_node, node>
+    RelinkNextLeaf(leaf_neighbor_node);
   } else {                                     // 非叶子节点
     // BUSTUB_ASSERT(neighbor_node->GetSize() + node->GetSize() <= node->GetMaxSize(), "非叶子节点小于等于maxsize");
     auto internal_node = reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(node);
@@ -501,9 +993,10 @@ bool BPLUSTREE_TYPE::Coalesce(N *neighbor_node, N *node,
   }
 
   parent->Remove(index);
-  if (parent->GetSize() <= parent->GetMinSize()) {
-    bool res = CoalesceOrRedistribute(&parent, transaction);
-    return res;
+  if (parent->GetSize() <= parent->GetMinSize() && CoalesceOrRedistribute(&parent, transaction)) {
+    // parent now points at the page to delete, a merge with its right sibling swaps the two
+    transaction->AddIntoDeletedPageSet(parent->GetPageId());
+    return true;
   }
   return false;
 }
@@ -568,6 +1061,74 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
   buffer_pool_manager_->UnpinPage(parent_page_id, true);
 }
 
+/*
+ * With compressed keys the key that moves to node and the new separator in the parent may need wider slots. If they
+ * do not fit, node is left less than half full.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+bool BPLUSTREE_TYPE::RedistributeFits(N *neighbor_node, N *node,
+                                      BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *parent, int index) {
+  if (!node->IsKeyCompressed()) {
+    return true;
+  }
+  KeyType separator;
+  if (node->IsLeafPage()) {
+    auto *leaf_node = reinterpret_cast<LeafPage *>(node);
+    auto *leaf_neighbor_node = reinterpret_cast<LeafPage *>(neighbor_node);
+    KeyType moved_key = leaf_neighbor_node->KeyAt(index == 0 ? 0 : leaf_neighbor_node->GetSize() - 1);
+    separator = index == 0 ? leaf_neighbor_node->KeyAt(1) : moved_key;
+    if (leaf_node->GetSize() + 1 > leaf_node->MaxSizeWith(moved_key)) {
+      return false;
+    }
+  } else {
+    auto *internal_node = reinterpret_cast<InternalPage *>(node);
+    auto *internal_neighbor_node = reinterpret_cast<InternalPage *>(neighbor_node);
+    separator = internal_neighbor_node->KeyAt(index == 0 ? 1 : internal_neighbor_node->GetSize() - 1);
+    if (internal_node->GetSize() + 1 > internal_node->GuaranteedMaxSize()) {
+      return false;
+    }
+  }
+  return parent->GetSize() <= parent->MaxSizeWith(separator);
+}
+
+/*
+ * Point the previous page id of the leaf after leaf back at leaf, after leaf got a new right neighbor by a split
+ * or a merge. The caller holds the write latch of leaf. The leaf after it may be under another parent, and a
+ * writer that holds it may be waiting for a page the caller holds, so the leaf is not waited for. If it is
+ * taken, the new previous page id is left in pending_prev_ids_ until the next relink of that leaf, and
+ * GetPrevLeafId() reads it from there.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RelinkNextLeaf(LeafPage *leaf) {
+  page_id_t next_page_id = leaf->GetNextPageId();
+  if (next_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  Page *next_page = buffer_pool_manager_->FetchPage(next_page_id);
+  if (!next_page->TryWLatch()) {
+    buffer_pool_manager_->UnpinPage(next_page_id, false);
+    std::lock_guard<std::mutex> guard(relink_latch_);
+    pending_prev_ids_[next_page_id] = leaf->GetPageId();
+    return;
+  }
+  reinterpret_cast<BPlusTreePage *>(next_page->GetData())->IncreaseVersion();
+  {
+    std::lock_guard<std::mutex> guard(relink_latch_);
+    pending_prev_ids_.erase(next_page_id);
+  }
+  reinterpret_cast<LeafPage *>(next_page->GetData())->SetPrevPageId(leaf->GetPageId());
+  UnlockPage(next_page, true);
+  buffer_pool_manager_->UnpinPage(next_page_id, true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t BPLUSTREE_TYPE::GetPrevLeafId(const LeafPage *leaf) {
+  std::lock_guard<std::mutex> guard(relink_latch_);
+  auto pending = pending_prev_ids_.find(leaf->GetPageId());
+  return pending == pending_prev_ids_.end() ? leaf->GetPrevPageId() : pending->second;
+}
+
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
@@ -610,6 +1171,150 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
   return false;
 }
 
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+/*
+ * Build an empty tree bottom-up from a stream of key & value pairs sorted by key. Leaves are filled one after
+ * the other up to fill_factor of their capacity, then every internal level is built from the first keys of the
+ * level below, so no page is ever split. The last page of a level borrows from its left neighbor (or is merged
+ * into it) when it would be less than half full. Like Insert, only the first value of a duplicated key is kept.
+ * @param next: stores the next pair and returns true, returns false at the end of the stream
+ * @return: false if the tree is not empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor) {
+  LockRoot(true);
+  if (!IsEmpty()) {
+    UnlockRoot(true);
+    return false;
+  }
+  // a leaf splits once it reaches its max size
+  int leaf_min_size = leaf_max_size_ / 2;
+  int leaf_fill = static_cast<int>(fill_factor * (leaf_max_size_ - 1));
+  leaf_fill = std::max(std::max(leaf_fill, leaf_min_size), 1);
+  leaf_fill = std::min(leaf_fill, leaf_max_size_ - 1);
+
+  // first key and page id of every page of the level being built
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  Page *prev_page = nullptr;
+  Page *page = nullptr;
+  LeafPage *prev_leaf = nullptr;
+  LeafPage *leaf = nullptr;
+  KeyType key;
+  ValueType value;
+  while (next(&key, &value)) {
+    if (leaf != nullptr) {
+      int cmp = comparator_(key, leaf->KeyAt(leaf->GetSize() - 1));
+      BUSTUB_ASSERT(cmp >= 0, "BulkLoad needs the keys in ascending order");
+      if (cmp == 0) {
+        continue;
+      }
+    }
+    // a leaf with compressed keys may run out of space before it is filled
+    if (leaf == nullptr || leaf->GetSize() == leaf_fill || leaf->GetSize() + 1 >= leaf->MaxSizeWith(key)) {
+      if (prev_page != nullptr) {
+        buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+      }
+      prev_page = page;
+      prev_leaf = leaf;
+      page_id_t page_id;
+      page = buffer_pool_manager_->NewPage(&page_id);
+      if (page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory in bulk load");
+      }
+      leaf = reinterpret_cast<LeafPage *>(page->GetData());
+      leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_, key_compression_);
+      if (prev_leaf != nullptr) {
+        prev_leaf->SetNextPageId(page_id);
+        leaf->SetPrevPageId(prev_leaf->GetPageId());
+      }
+      if (prev_leaf != nullptr && truncate_separators_) {
+        level.emplace_back(ShortestSeparator(prev_leaf->KeyAt(prev_leaf->GetSize() - 1), key), page_id);
+      } else {
+        level.emplace_back(key, page_id);
+      }
+    }
+    leaf->Insert(key, value, comparator_);
+  }
+  if (level.empty()) {
+    UnlockRoot(true);
+    return true;
+  }
+
+  if (prev_leaf != nullptr && leaf->GetSize() < leaf_min_size) {
+    if (prev_leaf->GetSize() + leaf->GetSize() < prev_leaf->MaxSizeAfterMerge(leaf)) {
+      leaf->MoveAllTo(prev_leaf);
+      buffer_pool_manager_->UnpinPage(level.back().second, false);
+      buffer_pool_manager_->DeletePage(level.back().second);
+      level.pop_back();
+      page = nullptr;
+    } else {
+      while (leaf->GetSize() < leaf_min_size) {
+        prev_leaf->MoveLastToFrontOf(leaf);
+      }
+      level.back().first = SeparatorOf(prev_leaf, leaf);
+    }
+  }
+  if (prev_page != nullptr) {
+    buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+  }
+  if (page != nullptr) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  }
+
+  // an internal page is underfull at min size or less
+  int internal_min_size = internal_max_size_ / 2;
+  int internal_fill = static_cast<int>(fill_factor * internal_max_size_);
+  internal_fill = std::max(std::max(internal_fill, internal_min_size + 1), 2);
+  internal_fill = std::min(internal_fill, internal_max_size_);
+  while (level.size() > 1) {
+    // with compressed keys a page takes as many keys as fit, at least the full width capacity
+    auto fit_count = [&](size_t begin, int size) {
+      return key_compression_ ? InternalPage::FitCount(&level[begin], size, internal_max_size_) : size;
+    };
+    std::vector<int> sizes;
+    for (int remaining = static_cast<int>(level.size()); remaining > 0; remaining -= sizes.back()) {
+      sizes.push_back(fit_count(level.size() - remaining, std::min(remaining, internal_fill)));
+    }
+    if (sizes.size() > 1 && sizes.back() <= internal_min_size) {
+      int total = sizes.back() + sizes[sizes.size() - 2];
+      size_t last_begin = level.size() - total;
+      if (total <= internal_max_size_ && fit_count(last_begin, total) == total) {
+        sizes.pop_back();
+        sizes.back() = total;
+      } else if (fit_count(last_begin + total / 2, total - total / 2) == total - total / 2) {
+        sizes.pop_back();
+        sizes.back() = total / 2;
+        sizes.push_back(total - total / 2);
+      }
+    }
+
+    std::vector<std::pair<KeyType, page_id_t>> parent_level;
+    size_t begin = 0;
+    for (int size : sizes) {
+      page_id_t page_id;
+      Page *internal_page = buffer_pool_manager_->NewPage(&page_id);
+      if (internal_page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory in bulk load");
+      }
+      auto *internal_node = reinterpret_cast<InternalPage *>(internal_page->GetData());
+      internal_node->Init(page_id, INVALID_PAGE_ID, internal_max_size_, key_compression_);
+      // adopts the children, their parent page id is updated here
+      internal_node->CopyNFrom(&level[begin], size, buffer_pool_manager_);
+      parent_level.emplace_back(level[begin].first, page_id);
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      begin += size;
+    }
+    level = std::move(parent_level);
+  }
+
+  root_page_id_ = level[0].second;
+  UpdateRootPageId(1);
+  UnlockRoot(true);
+  return true;
+}
+
 /*****************************************************************************
  * INDEX ITERATOR
  *****************************************************************************/
@@ -632,10 +1337,8 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() {
   if (leafnode->IsRootPage()) {
     UnlockRoot(false);
   }
-  INDEXITERATOR_TYPE iterator = INDEXITERATOR_TYPE(leafnode->GetPageId(), 0, leafnode->GetSize(), buffer_pool_manager_);
-  // UnlockPage(leftmost_leafPage, false);
-  // buffer_pool_manager_->UnpinPage(leftmost_leafPage->GetPageId(), false);
-  return iterator;
+  // the iterator owns the pinned and read latched leaf from here on
+  return INDEXITERATOR_TYPE(leftmost_leafPage, 0, buffer_pool_manager_);
 }
 
 /*
@@ -658,10 +1361,7 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
     UnlockRoot(false);
   }
   int index = leafnode->KeyIndex(key, comparator_);
-  auto iter = INDEXITERATOR_TYPE(leafnode->GetPageId(), index, leafnode->GetSize(), buffer_pool_manager_);
-  // UnlockPage(leafPage, false);
-  // buffer_pool_manager_->UnpinPage(leafPage->GetPageId(), false);
-  return iter;
+  return INDEXITERATOR_TYPE(leafPage, index, buffer_pool_manager_);
 }
 
 /*
@@ -672,6 +1372,101 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::end() { return INDEXITERATOR_TYPE(true); }
 
+/*
+ * Find the rightmost leaf page first, then construct a reverse index iterator
+ * at its last key
+ * @return : reverse index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+REVERSE_INDEXITERATOR_TYPE BPLUSTREE_TYPE::rbegin() {
+  KeyType key{};
+  Page *rightmost_leafPage = FindLeafPage(key, false, true);
+  if (rightmost_leafPage == nullptr) {
+    return REVERSE_INDEXITERATOR_TYPE(true);
+  }
+  auto *leafnode = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(rightmost_leafPage->GetData());
+  if (leafnode->IsRootPage()) {
+    UnlockRoot(false);
+  }
+  return REVERSE_INDEXITERATOR_TYPE(this, rightmost_leafPage, leafnode->GetSize() - 1, buffer_pool_manager_);
+}
+
+/*
+ * Input parameter is high key, construct a reverse index iterator at the
+ * largest key that is not greater than it
+ * @return : reverse index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+REVERSE_INDEXITERATOR_TYPE BPLUSTREE_TYPE::RBegin(const KeyType &key) {
+  Page *leafPage = FindLeafPage(key, false);
+  if (leafPage == nullptr) {
+    return REVERSE_INDEXITERATOR_TYPE(true);
+  }
+  auto *leafnode = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(leafPage->GetData());
+  if (leafnode->IsRootPage()) {
+    UnlockRoot(false);
+  }
+  int index = leafnode->KeyIndex(key, comparator_);
+  if (index == leafnode->GetSize() || comparator_(leafnode->KeyAt(index), key) != 0) {
+    index--;
+  }
+  return REVERSE_INDEXITERATOR_TYPE(this, leafPage, index, buffer_pool_manager_, &key);
+}
+
+/*
+ * Construct a reverse index iterator representing the end, it is past the
+ * smallest key
+ * @return : reverse index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+REVERSE_INDEXITERATOR_TYPE BPLUSTREE_TYPE::rend() { return REVERSE_INDEXITERATOR_TYPE(true); }
+
+/*
+ * Used by the reverse iterator when it cannot latch the previous leaf. Walks
+ * left from the leaf of key, the previous leaf is latched only after the
+ * current one is released and is checked to still link to it, otherwise the
+ * search starts over from the root.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafBefore(const KeyType &key, int *index) {
+  while (true) {
+    Page *page = FindLeafPage(key, false);
+    if (page == nullptr) {
+      return nullptr;
+    }
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    if (leaf->IsRootPage()) {
+      UnlockRoot(false);
+    }
+    *index = leaf->KeyIndex(key, comparator_) - 1;
+    if (*index >= 0) {
+      return page;
+    }
+    // leaves left less than half full may be empty, those are passed on the way
+    while (true) {
+      page_id_t page_id = page->GetPageId();
+      page_id_t prev_page_id = GetPrevLeafId(leaf);
+      UnlockPage(page, false);
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      if (prev_page_id == INVALID_PAGE_ID) {
+        return nullptr;
+      }
+      page = buffer_pool_manager_->FetchPage(prev_page_id);
+      LockPage(page, false);
+      leaf = reinterpret_cast<LeafPage *>(page->GetData());
+      if (!leaf->IsLeafPage() || leaf->GetNextPageId() != page_id) {
+        break;
+      }
+      *index = leaf->KeyIndex(key, comparator_) - 1;
+      if (*index >= 0) {
+        return page;
+      }
+    }
+    UnlockPage(page, false);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+}
+
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
@@ -712,6 +1507,8 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::LockPage(Page *page, bool enable, int op) {
   if (enable) {
     page->WLatch();
+    // an odd version tells optimistic readers that the page is being modified
+    reinterpret_cast<BPlusTreePage *>(page->GetData())->IncreaseVersion();
     // auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
     // std::cout << "WLock the page id " << page->GetPageId() << ", his page size is " << node->GetSize()
     //          << ", his parent is " << node->GetParentPageId() << ", his op is " << op << ", his type is "
@@ -741,6 +1538,7 @@ void BPLUSTREE_TYPE::UnlockPage(bustub::Page *page, bool enable, int op) {
     //          << static_cast<int>(node->IsLeafPage()) << ", its max size is" << node->GetMaxSize() <<
     //          std::endl;
 
+    reinterpret_cast<BPlusTreePage *>(page->GetData())->IncreaseVersion();
     page->WUnlatch();
     // std::cout << "Unlock successfully!" << std::endl;
   } else {
@@ -754,24 +1552,33 @@ void BPLUSTREE_TYPE::UnlockPage(bustub::Page *page, bool enable, int op) {
 
 /*
  * Safe function,
- * op == 1 means insert, op == 2 means delete
+ * op == 1 means insert, op == 2 means delete, op == 3 means rebalance
  * return true, when 1.1 during insert, the internal page's size + 1 <= internal's maxsize
  *                   1.2 during insert, the leaf page's size + 1 < leaf's maxsize
  *                   2.1 during delete, the internal page's size - 1 > internal's minsize
- *                   2.2 during delete, the leaf page's size - 1 >= leaf's min size
+ *                   2.2 during delete, the leaf page's size - 1 >= leaf's min size (a quarter with lazy merging)
+ *                   3   during rebalance, like delete without lazy merging
  *  It means: minsize <= leaf's size     < maxsize
  *            minsize <  internal's size <= maxsize
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-bool BPLUSTREE_TYPE::Safe(N *node, int op) {
+bool BPLUSTREE_TYPE::Safe(N *node, int op, const KeyType &key) {
   bool res = false;
+  if (op == 1 && node->IsKeyCompressed()) {
+    // the key that goes into the page must fit as well, for an internal page it is not known yet
+    if (node->IsLeafPage()) {
+      return node->GetSize() + 1 < reinterpret_cast<LeafPage *>(node)->MaxSizeWith(key);
+    }
+    return node->GetSize() + 1 <= reinterpret_cast<InternalPage *>(node)->GuaranteedMaxSize();
+  }
   if (node->IsLeafPage()) {
-    res =
-        (op == 1 && node->GetSize() + 1 < node->GetMaxSize()) || (op == 2 && node->GetSize() - 1 >= node->GetMinSize());
+    // only a remove may leave a leaf less than half full with lazy merging, a rebalance may not
+    res = (op == 1 && node->GetSize() + 1 < node->GetMaxSize()) ||
+          (op >= 2 && node->GetSize() - 1 >= MinLeafSize(reinterpret_cast<LeafPage *>(node), op == 2 && lazy_merge_));
   } else {
     res =
-        (op == 1 && node->GetSize() + 1 <= node->GetMaxSize()) || (op == 2 && node->GetSize() - 1 > node->GetMinSize());
+        (op == 1 && node->GetSize() + 1 <= node->GetMaxSize()) || (op >= 2 && node->GetSize() - 1 > node->GetMinSize());
   }
   return res;
 }
@@ -792,27 +1599,28 @@ void BPLUSTREE_TYPE::FreeAllPageInTransaction(bustub::Transaction *transaction,
       auto pn = page_set->front();
       page_set->pop_front();
       pageId = pn->GetPageId();
+      // root_page_id_ is read without the root latch, compare while the page is still latched: once it is released a
+      // merge may make it the root of another thread
+      bool is_root = check && pageId == root_page_id_;
       UnlockPage(pn, true, op);
       buffer_pool_manager_->UnpinPage(pageId, true);
-      if (check && (pageId == root_page_id_)) {  // 这里为什么可以不加锁就用root_page_id,是有一个正确不变量保证的
-        // 我们是先LockRoot，再LockRootPage,因此我们得先UnlockRootPage,再UnlockRoot
-        // 为了保证正确性，首先我们这里不会对root_page_id进行修改操作，第二这棵b+树如果
-        // root_page_id的值在这个过程中改了，因为我们的父亲还在被锁着，所以轮不到子节点等于
-        // root_page_id，间接保证了正确性。
+      if (is_root) {
+        // the root latch was taken before the root page latch, so it is released after it
         UnlockRoot(true, op);
         check = false;
       }
     }
-  } else if (op == 2) {
+  } else if (op >= 2) {
     auto deleted_page_set = transaction->GetDeletedPageSet();
 
     while (!page_set->empty()) {
       auto *pn = page_set->back();
       page_set->pop_back();
       pageId = pn->GetPageId();
+      bool is_root = check && pageId == root_page_id_;
       UnlockPage(pn, true, op);
       buffer_pool_manager_->UnpinPage(pageId, true);
-      if (check && pageId == root_page_id_) {
+      if (is_root) {
         UnlockRoot(true, op);
         check = false;
       }
@@ -821,7 +1629,15 @@ void BPLUSTREE_TYPE::FreeAllPageInTransaction(bustub::Transaction *transaction,
       if (it != deleted_page_set->end()) {
         // std::cout << "Delete the page " << pageId << std::endl;
         deleted_page_set->erase(it);
-        buffer_pool_manager_->DeletePage(pageId);
+        {
+          // a merged away leaf gets no more relinks that would erase its entry, and its page id may be reused
+          std::lock_guard<std::mutex> guard(relink_latch_);
+          pending_prev_ids_.erase(pageId);
+        }
+        if (!buffer_pool_manager_->DeletePage(pageId) && cached_levels_ > 0) {
+          // the page may still be pinned by the cached levels
+          RetireCachedLevels(pageId);
+        }
       }
     }
     // deleted_page_set->clear();
@@ -862,7 +1678,7 @@ Page *BPLUSTREE_TYPE::Search(const KeyType &key, int op, Transaction *transactio
     LockPage(page, true, op);
     node = reinterpret_cast<BPlusTreePage *>(page->GetData());
     // 如果该节点安全，把它祖先的锁都释放了
-    if (Safe(node, op)) {
+    if (Safe(node, op, key)) {
       FreeAllPageInTransaction(transaction, op);  // not use op to avoid search delete page set cost
     }
     transaction->AddIntoPageSet(page);
@@ -870,19 +1686,213 @@ Page *BPLUSTREE_TYPE::Search(const KeyType &key, int op, Transaction *transactio
   return page;
 }
 
+/*
+ * Optimistic search for insert and delete, read latch the internal pages top-down like FindLeafPage but write latch
+ * the leaf. The page type of a page is never changed while its parent (or the root id) is latched, so it can be read
+ * before choosing the latch mode.
+ * @param root_locked: set to true when the root id lock is still held, which happens when the leaf is the root
+ * @return: the pinned and write latched leaf, nullptr if the tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::OptimisticSearch(const KeyType &key, bool *root_locked) {
+  LockRoot(false);
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    UnlockRoot(false);
+    return nullptr;
+  }
+  *root_locked = true;
+  const CachedFrames *frames = EnterCachedLevels();
+  bool cached = false;
+  Page *page = FetchUpperPage(root_page_id_, frames, &cached);
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  LockPage(page, node->IsLeafPage());
+
+  while (!node->IsLeafPage()) {
+    auto *internal_node = reinterpret_cast<InternalPage *>(node);
+    bool child_cached = false;
+    Page *child_page = FetchUpperPage(internal_node->Lookup(key, comparator_), frames, &child_cached);
+    auto *child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    LockPage(child_page, child_node->IsLeafPage());
+    page_id_t pre_pageId = page->GetPageId();
+    UnlockPage(page, false);
+    if (!cached) {
+      buffer_pool_manager_->UnpinPage(pre_pageId, false);
+    }
+    if (*root_locked) {
+      UnlockRoot(false);
+      *root_locked = false;
+    }
+    page = child_page;
+    node = child_node;
+    cached = child_cached;
+  }
+  LeaveCachedLevels(frames);
+  return page;
+}
+
+/*
+ * Insert into the leaf found by OptimisticSearch when the leaf can take the key without splitting. Only the leaf is
+ * write latched, so most inserts never block each other on the upper levels.
+ * @return: true means the insert is finished and res holds its result, false means the leaf is not safe and the
+ * caller has to restart with the pessimistic Search
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::OptimisticInsert(const KeyType &key, const ValueType &value, bool *res) {
+  bool root_locked = false;
+  Page *page = OptimisticSearch(key, &root_locked);
+  if (page == nullptr) {
+    return false;
+  }
+  auto *leaf_node = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType old_value;
+  bool done = true;
+  bool dirty = false;
+  if (leaf_node->Lookup(key, &old_value, comparator_)) {
+    *res = false;
+  } else if (Safe(leaf_node, 1, key)) {
+    leaf_node->Insert(key, value, comparator_);
+    *res = true;
+    dirty = true;
+  } else {
+    done = false;
+  }
+
+  page_id_t page_id = page->GetPageId();
+  UnlockPage(page, true);
+  buffer_pool_manager_->UnpinPage(page_id, dirty);
+  if (root_locked) {
+    UnlockRoot(false);
+  }
+  return done;
+}
+
+/*
+ * Delete from the leaf found by OptimisticSearch when the leaf stays at least half full.
+ * @return: true means the remove is finished, false means the caller has to restart with the pessimistic Search
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::OptimisticRemove(const KeyType &key) {
+  bool root_locked = false;
+  Page *page = OptimisticSearch(key, &root_locked);
+  if (page == nullptr) {
+    return true;
+  }
+  auto *leaf_node = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType value;
+  bool done = true;
+  bool dirty = false;
+  if (leaf_node->Lookup(key, &value, comparator_)) {
+    if (Safe(leaf_node, 2, key)) {
+      leaf_node->RemoveAndDeleteRecord(key, comparator_);
+      NoteUnderfull(leaf_node, key);
+      dirty = true;
+    } else {
+      done = false;
+    }
+  }
+
+  page_id_t page_id = page->GetPageId();
+  UnlockPage(page, true);
+  buffer_pool_manager_->UnpinPage(page_id, dirty);
+  if (root_locked) {
+    UnlockRoot(false);
+  }
+  return done;
+}
+
+/*
+ * Point lookup with optimistic lock coupling: no page is latched, every page is read under the version seen before
+ * reading it. The child pointer is only followed after the parent's version is validated, and the parent is
+ * validated again once the child's version is known, so a page that is split, merged or deleted meanwhile is never
+ * trusted. The pages are still pinned so the buffer pool keeps them in place.
+ * @return: true means the lookup finished and found holds its result, false means a writer interfered and the
+ * lookup has to be retried
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::OptimisticGetValue(const KeyType &key, std::vector<ValueType> *result, bool *found) {
+  page_id_t page_id = root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    *found = false;
+    return true;
+  }
+  const CachedFrames *frames = EnterCachedLevels();
+  bool cached = false;
+  Page *page = FetchUpperPage(page_id, frames, &cached);
+  if (page == nullptr) {
+    LeaveCachedLevels(frames);
+    return false;
+  }
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  uint32_t version = node->GetVersion();
+  // every root change write latches the old root, so checking the id once after reading the version is enough
+  bool valid = !BPlusTreePage::IsLockedVersion(version) && page_id == root_page_id_;
+
+  while (valid && !node->IsLeafPage()) {
+    auto *internal_node = reinterpret_cast<InternalPage *>(node);
+    int size = internal_node->GetSize();
+    if (size <= 0 || size > internal_node->GetMaxSize()) {
+      valid = false;
+      break;
+    }
+    page_id_t child_page_id = internal_node->Lookup(key, comparator_);
+    if (!node->ValidateVersion(version)) {
+      valid = false;
+      break;
+    }
+    bool child_cached = false;
+    Page *child_page = FetchUpperPage(child_page_id, frames, &child_cached);
+    if (child_page == nullptr) {
+      valid = false;
+      break;
+    }
+    auto *child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    uint32_t child_version = child_node->GetVersion();
+    valid = !BPlusTreePage::IsLockedVersion(child_version) && node->ValidateVersion(version);
+    if (!cached) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+    }
+    page = child_page;
+    page_id = child_page_id;
+    cached = child_cached;
+    node = child_node;
+    version = child_version;
+  }
+
+  if (valid) {
+    auto *leaf_node = reinterpret_cast<LeafPage *>(node);
+    ValueType value;
+    int size = leaf_node->GetSize();
+    bool res = size >= 0 && size <= leaf_node->GetMaxSize() && leaf_node->Lookup(key, &value, comparator_);
+    valid = node->ValidateVersion(version);
+    if (valid) {
+      *found = res;
+      if (res) {
+        result->push_back(value);
+      }
+    }
+  }
+  if (!cached) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+  }
+  LeaveCachedLevels(frames);
+  return valid;
+}
+
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
- * the left most leaf page
+ * the left most leaf page, if rightMost flag == true, find the right most one
  */
 INDEX_TEMPLATE_ARGUMENTS
-Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
+Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost, bool rightMost) {
   LockRoot(false);
   if (root_page_id_ == INVALID_PAGE_ID) {
     UnlockRoot(false);
     return nullptr;
   }
 
-  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  const CachedFrames *frames = EnterCachedLevels();
+  bool cached = false;
+  Page *page = FetchUpperPage(root_page_id_, frames, &cached);
   // if (page == nullptr) {
   //  UnlockRoot(false);
   //   throw Exception("Not Found Leaf Page");
@@ -897,23 +1907,31 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
     auto internal_node = reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(node);
     if (leftMost) {
       pageId = internal_node->ValueAt(0);
+    } else if (rightMost) {
+      pageId = internal_node->ValueAt(internal_node->GetSize() - 1);
     } else {
       pageId = internal_node->Lookup(key, comparator_);
     }
-    auto child_page = buffer_pool_manager_->FetchPage(pageId);
+    bool child_cached = false;
+    auto child_page = FetchUpperPage(pageId, frames, &child_cached);
     LockPage(child_page, false);
     // if (child_page == nullptr) {
     //   throw Exception("Fetch Page failure  in findleafPage");
     // break;
     // }
     node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    bool was_root = pre_pageId == root_page_id_;
     UnlockPage(page, false);  // 先解锁,再Unpin
     page = child_page;
-    buffer_pool_manager_->UnpinPage(pre_pageId, false);
-    if (pre_pageId == root_page_id_) {
+    if (!cached) {
+      buffer_pool_manager_->UnpinPage(pre_pageId, false);
+    }
+    cached = child_cached;
+    if (was_root) {
       UnlockRoot(false);
     }
   }
+  LeaveCachedLevels(frames);
   return page;
 }
 
@@ -927,8 +1945,10 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
+  // the cached levels start at the old root
+  RetireCachedLevels();
   HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
-  LockPage(header_page, true, 3);
+  header_page->WLatch();
   if (insert_record != 0) {
     // create a new record<index_name + root_page_id> in header_page
     header_page->InsertRecord(index_name_, root_page_id_);
@@ -936,7 +1956,7 @@ void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
-  UnlockPage(header_page, true, 3);
+  header_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
 }
 
@@ -1110,4 +2130,10 @@ template class BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class BPlusTree<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class BPlusTree<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class BPlusTree<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTree<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTree<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
 }  // namespace bustub
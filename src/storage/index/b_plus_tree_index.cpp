@@ -11,31 +11,103 @@
 
 #include "storage/index/b_plus_tree_index.h"
 
+#include <type_traits>
+
+#include "type/value_factory.h"
+
 namespace bustub {
 /*
  * Constructor
  */
 INDEX_TEMPLATE_ARGUMENTS
-BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager)
+BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager, bool unique)
     : Index(metadata),
-      comparator_(metadata->GetKeySchema()),
-      container_(metadata->GetName(), buffer_pool_manager, comparator_) {}
+      unique_(unique),
+      order_schema_(OrderSchema(metadata->GetKeySchema(), unique)),
+      stored_schema_(StoredSchema(order_schema_.get(), metadata)),
+      comparator_(order_schema_.get()),
+      container_(metadata->GetName(), buffer_pool_manager, comparator_,
+                 CompressKeys(unique) ? LEAF_PAGE_COMPRESSED_SIZE : LEAF_PAGE_SIZE,
+                 CompressKeys(unique) ? INTERNAL_PAGE_COMPRESSED_SIZE : INTERNAL_PAGE_SIZE, CompressKeys(unique)) {
+  if (!metadata->GetIncludeAttrs().empty() &&
+      std::is_same<KeyComparator, NormalizedComparator<sizeof(KeyType)>>::value) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "normalized keys are ordered by all of their bytes, included "
+                                                    "columns need an index with generic keys");
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Schema *BPLUSTREE_INDEX_TYPE::OrderSchema(const Schema *key_schema, bool unique) {
+  std::vector<Column> columns = key_schema->GetColumns();
+  if (!unique) {
+    columns.emplace_back("__rid_page_id", TypeId::INTEGER);
+    columns.emplace_back("__rid_slot", TypeId::INTEGER);
+  }
+  return new Schema(columns);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Schema *BPLUSTREE_INDEX_TYPE::StoredSchema(const Schema *order_schema, const IndexMetadata *metadata) {
+  std::vector<Column> columns = order_schema->GetColumns();
+  const auto &entry_columns = metadata->GetEntrySchema()->GetColumns();
+  columns.insert(columns.end(), entry_columns.begin() + metadata->GetKeySchema()->GetColumnCount(),
+                 entry_columns.end());
+  return new Schema(columns);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::MakeKey(const Tuple &key, RID rid, KeyType *index_key, bool included) const {
+  // the entry schema starts with the key columns, so the key columns of either tuple are read the same way
+  Schema *key_schema = included ? GetEntrySchema() : GetKeySchema();
+  if (unique_) {
+    index_key->SetFromKey(key, key_schema);
+    return;
+  }
+  std::vector<Value> values;
+  values.reserve(stored_schema_->GetColumnCount());
+  uint32_t key_count = GetKeySchema()->GetColumnCount();
+  for (uint32_t i = 0; i < key_count; i++) {
+    values.push_back(key.GetValue(key_schema, i));
+  }
+  values.push_back(ValueFactory::GetIntegerValue(rid.GetPageId()));
+  values.push_back(ValueFactory::GetIntegerValue(static_cast<int32_t>(rid.GetSlotNum())));
+  Schema *schema = order_schema_.get();
+  if (included) {
+    for (uint32_t i = key_count; i < key_schema->GetColumnCount(); i++) {
+      values.push_back(key.GetValue(key_schema, i));
+    }
+    schema = stored_schema_.get();
+  }
+  index_key->SetFromKey(Tuple(values, schema), schema);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<Value> BPLUSTREE_INDEX_TYPE::EntryValues(const KeyType &index_key) const {
+  // the included columns follow the rid columns of a non-unique index
+  uint32_t key_count = GetKeySchema()->GetColumnCount();
+  uint32_t rid_count = order_schema_->GetColumnCount() - key_count;
+  std::vector<Value> values;
+  values.reserve(GetEntrySchema()->GetColumnCount());
+  for (uint32_t i = 0; i < GetEntrySchema()->GetColumnCount(); i++) {
+    values.push_back(index_key.ToValue(stored_schema_.get(), i < key_count ? i : i + rid_count));
+  }
+  return values;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
-
-  index_key.SetFromKey(key);
+  MakeKey(key, rid, &index_key, true);
 
   container_.Insert(index_key, rid, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
-  // construct delete index key
+  // construct delete index key, only the entry of rid goes in a non-unique index
   KeyType index_key;
-  index_key.SetFromKey(key);
+  MakeKey(key, rid, &index_key, true);
 
   container_.Remove(index_key, transaction);
 }
@@ -44,9 +116,42 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  if (unique_) {
+    MakeKey(key, RID(), &index_key);
+    container_.GetValue(index_key, result, transaction);
+    return;
+  }
 
-  container_.GetValue(index_key, result, transaction);
+  // the entries of the key lie between its smallest and largest possible rid
+  KeyType upper_key;
+  MakeKey(key, RID(0, 0), &index_key);
+  MakeKey(key, RID(BUSTUB_INT32_MAX, BUSTUB_INT32_MAX), &upper_key);
+  for (auto iterator = container_.Begin(index_key); !iterator.isEnd(); ++iterator) {
+    if (comparator_((*iterator).first, upper_key) > 0) {
+      break;
+    }
+    result->push_back((*iterator).second);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *result,
+                                    Transaction *transaction) {
+  if (!unique_) {
+    Index::ScanKeys(keys, result, transaction);
+    return;
+  }
+  std::vector<KeyType> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    MakeKey(keys[i], RID(), &index_keys[i]);
+  }
+
+  container_.GetValues(index_keys, result, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor) {
+  return container_.BulkLoad(next, fill_factor);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -58,10 +163,27 @@ INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetEndIterator() { return container_.end(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+REVERSE_INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetReverseBeginIterator() { return container_.rbegin(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+REVERSE_INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetReverseBeginIterator(const KeyType &key) {
+  return container_.RBegin(key);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+REVERSE_INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetReverseEndIterator() { return container_.rend(); }
+
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class BPlusTreeIndex<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class BPlusTreeIndex<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class BPlusTreeIndex<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTreeIndex<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTreeIndex<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
 }  // namespace bustub
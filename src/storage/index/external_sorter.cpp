@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/storage/index/external_sorter.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/external_sorter.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+// pairs read from a spilled run at a time
+static constexpr size_t RUN_READ_BATCH = 4 * PAGE_SIZE;
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORTER_TYPE::ExternalSorter(const KeyComparator &comparator, size_t run_size)
+    : comparator_(comparator), run_capacity_(std::max<size_t>(1, run_size / sizeof(MappingType))) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORTER_TYPE::~ExternalSorter() {
+  for (auto &run : runs_) {
+    // temporary files are removed when closed
+    std::fclose(run.file_);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::Add(const KeyType &key, const ValueType &value) {
+  BUSTUB_ASSERT(!sorted_, "no pair can be added after Sort()");
+  if (run_.size() == run_capacity_) {
+    SpillRun();
+  }
+  run_.emplace_back(key, value);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::SortRun() {
+  std::sort(run_.begin(), run_.end(),
+            [this](const MappingType &lhs, const MappingType &rhs) { return comparator_(lhs.first, rhs.first) < 0; });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::SpillRun() {
+  SortRun();
+  std::FILE *file = std::tmpfile();
+  if (file == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "external sort can't create a temporary file");
+  }
+  if (std::fwrite(run_.data(), sizeof(MappingType), run_.size(), file) != run_.size()) {
+    std::fclose(file);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "external sort can't write a run");
+  }
+  std::rewind(file);
+  runs_.push_back(Run{file, {}, 0});
+  run_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::Sort() {
+  sorted_ = true;
+  if (runs_.empty()) {
+    SortRun();
+    return;
+  }
+  if (!run_.empty()) {
+    SpillRun();
+  }
+  run_.shrink_to_fit();
+  for (size_t i = 0; i < runs_.size(); i++) {
+    if (RefillRun(&runs_[i])) {
+      heap_.push_back(i);
+    }
+  }
+  std::make_heap(heap_.begin(), heap_.end(), [this](size_t lhs, size_t rhs) { return HeapGreater(lhs, rhs); });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTERNAL_SORTER_TYPE::RefillRun(Run *run) {
+  run->buffer_.resize(RUN_READ_BATCH / sizeof(MappingType) + 1);
+  size_t count = std::fread(run->buffer_.data(), sizeof(MappingType), run->buffer_.size(), run->file_);
+  run->buffer_.resize(count);
+  run->pos_ = 0;
+  return count > 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTERNAL_SORTER_TYPE::HeapGreater(size_t lhs, size_t rhs) const {
+  const Run &left = runs_[lhs];
+  const Run &right = runs_[rhs];
+  return comparator_(left.buffer_[left.pos_].first, right.buffer_[right.pos_].first) > 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTERNAL_SORTER_TYPE::Next(KeyType *key, ValueType *value) {
+  BUSTUB_ASSERT(sorted_, "Sort() must be called before reading the pairs");
+  if (runs_.empty()) {
+    if (run_pos_ == run_.size()) {
+      return false;
+    }
+    *key = run_[run_pos_].first;
+    *value = run_[run_pos_].second;
+    run_pos_++;
+    return true;
+  }
+
+  if (heap_.empty()) {
+    return false;
+  }
+  auto greater = [this](size_t lhs, size_t rhs) { return HeapGreater(lhs, rhs); };
+  std::pop_heap(heap_.begin(), heap_.end(), greater);
+  Run &run = runs_[heap_.back()];
+  *key = run.buffer_[run.pos_].first;
+  *value = run.buffer_[run.pos_].second;
+  run.pos_++;
+  if (run.pos_ < run.buffer_.size() || RefillRun(&run)) {
+    std::push_heap(heap_.begin(), heap_.end(), greater);
+  } else {
+    heap_.pop_back();
+  }
+  return true;
+}
+
+template class ExternalSorter<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExternalSorter<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExternalSorter<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExternalSorter<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExternalSorter<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class ExternalSorter<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class ExternalSorter<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class ExternalSorter<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class ExternalSorter<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class ExternalSorter<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
+}  // namespace bustub
@@ -3,6 +3,7 @@
  */
 #include <cassert>
 
+#include "storage/index/b_plus_tree.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
@@ -12,13 +13,78 @@ namespace bustub {
  * set your own input parameters
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(page_id_t pageId, int index, int size, BufferPoolManager *buffer_pool_manager)
-    : pageId_(pageId), index_(index), size_(size), buffer_pool_manager_(buffer_pool_manager) {}
+INDEXITERATOR_TYPE::IndexIterator(Page *page, int index, BufferPoolManager *buffer_pool_manager)
+    : pageId_(page->GetPageId()),
+      index_(index),
+      size_(reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData())->GetSize()),
+      page_(page),
+      buffer_pool_manager_(buffer_pool_manager) {
+  // a start key past the last key of its leaf begins at the next leaf
+  SkipExhaustedLeaves();
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator(bool is_end) : is_end_(is_end) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept
+    : pageId_(other.pageId_),
+      index_(other.index_),
+      size_(other.size_),
+      page_(other.page_),
+      buffer_pool_manager_(other.buffer_pool_manager_),
+      is_end_(other.is_end_),
+      item_(other.item_) {
+  other.page_ = nullptr;
+  other.is_end_ = true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator=(IndexIterator &&other) noexcept {
+  if (this != &other) {
+    ReleasePage();
+    pageId_ = other.pageId_;
+    index_ = other.index_;
+    size_ = other.size_;
+    page_ = other.page_;
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    is_end_ = other.is_end_;
+    item_ = other.item_;
+    other.page_ = nullptr;
+    other.is_end_ = true;
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::~IndexIterator() { ReleasePage(); }
+
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() = default;
+void INDEXITERATOR_TYPE::ReleasePage() {
+  if (page_ != nullptr) {
+    page_->RUnlatch();
+    buffer_pool_manager_->UnpinPage(pageId_, false);
+    page_ = nullptr;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SkipExhaustedLeaves() {
+  while (!is_end_ && index_ >= size_) {
+    auto next_pageId = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page_->GetData())->GetNextPageId();
+    ReleasePage();
+    if (next_pageId == INVALID_PAGE_ID) {
+      is_end_ = true;
+      return;
+    }
+    // the next leaf is latched only after this one is released, a writer coalescing leaves latches right to left
+    page_ = buffer_pool_manager_->FetchPage(next_pageId);
+    page_->RLatch();
+    pageId_ = next_pageId;
+    index_ = 0;
+    size_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page_->GetData())->GetSize();
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 bool INDEXITERATOR_TYPE::isEnd() const { return is_end_; }
@@ -30,13 +96,8 @@ const MappingType &INDEXITERATOR_TYPE::operator*() {
                     "reference iterator "
                     "object that is out of the end in operator* function");
   }
-  auto *page = buffer_pool_manager_->FetchPage(pageId_);
-  auto *leafnode = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
-  const MappingType &item = leafnode->GetItem(index_);
-  // std::cout << "index is " << index_ << " page id is " << pageId_ <<  " iterating get the key " << item.first <<
-  // std::endl;
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-  return item;
+  item_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page_->GetData())->GetItem(index_);
+  return item_;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -47,26 +108,151 @@ INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
                     "the end in operator++ function");
   }
   index_ += 1;
-  if (index_ >= size_) {
-    auto *page = buffer_pool_manager_->FetchPage(pageId_);
-    auto *leafnode = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
-    auto next_pageId = leafnode->GetNextPageId();
-    if (next_pageId == INVALID_PAGE_ID) {
+  SkipExhaustedLeaves();
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+size_t INDEXITERATOR_TYPE::NextBatch(std::vector<MappingType> *batch) {
+  if (is_end_) {
+    return 0;
+  }
+  size_t count = size_ - index_;
+  reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page_->GetData())->CopyItemsTo(index_, batch);
+  index_ = size_;
+  SkipExhaustedLeaves();
+  return count;
+}
+
+/*
+ * REVERSE INDEX ITERATOR
+ */
+INDEX_TEMPLATE_ARGUMENTS
+REVERSE_INDEXITERATOR_TYPE::ReverseIndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, Page *page,
+                                                 int index, BufferPoolManager *buffer_pool_manager,
+                                                 const KeyType *high_key)
+    : tree_(tree), pageId_(page->GetPageId()), index_(index), page_(page), buffer_pool_manager_(buffer_pool_manager) {
+  if (high_key != nullptr) {
+    low_key_ = *high_key;
+    has_high_key_ = true;
+  }
+  SkipExhaustedLeaves();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+REVERSE_INDEXITERATOR_TYPE::ReverseIndexIterator(bool is_end) : is_end_(is_end) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+REVERSE_INDEXITERATOR_TYPE::ReverseIndexIterator(ReverseIndexIterator &&other) noexcept
+    : tree_(other.tree_),
+      pageId_(other.pageId_),
+      index_(other.index_),
+      page_(other.page_),
+      buffer_pool_manager_(other.buffer_pool_manager_),
+      is_end_(other.is_end_),
+      item_(other.item_),
+      low_key_(other.low_key_),
+      has_low_key_(other.has_low_key_),
+      has_high_key_(other.has_high_key_) {
+  other.page_ = nullptr;
+  other.is_end_ = true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+REVERSE_INDEXITERATOR_TYPE &REVERSE_INDEXITERATOR_TYPE::operator=(ReverseIndexIterator &&other) noexcept {
+  if (this != &other) {
+    ReleasePage();
+    tree_ = other.tree_;
+    pageId_ = other.pageId_;
+    index_ = other.index_;
+    page_ = other.page_;
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    is_end_ = other.is_end_;
+    item_ = other.item_;
+    low_key_ = other.low_key_;
+    has_low_key_ = other.has_low_key_;
+    has_high_key_ = other.has_high_key_;
+    other.page_ = nullptr;
+    other.is_end_ = true;
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+REVERSE_INDEXITERATOR_TYPE::~ReverseIndexIterator() { ReleasePage(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+void REVERSE_INDEXITERATOR_TYPE::ReleasePage() {
+  if (page_ != nullptr) {
+    page_->RUnlatch();
+    buffer_pool_manager_->UnpinPage(pageId_, false);
+    page_ = nullptr;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void REVERSE_INDEXITERATOR_TYPE::SkipExhaustedLeaves() {
+  while (!is_end_ && index_ < 0) {
+    auto *leaf = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page_->GetData());
+    if (leaf->GetSize() > 0) {
+      low_key_ = leaf->KeyAt(0);
+      has_low_key_ = true;
+    }
+    page_id_t prev_pageId = tree_->GetPrevLeafId(leaf);
+    if (prev_pageId == INVALID_PAGE_ID) {
+      ReleasePage();
       is_end_ = true;
+      return;
     }
-    page->RUnlatch();
-    buffer_pool_manager_->UnpinPage(pageId_, false);
-    // buffer_pool_manager_->UnpinPage(pageId_, false);
-    pageId_ = next_pageId;
-    if (!is_end_) {
-      auto *newpage = buffer_pool_manager_->FetchPage(pageId_);
-      newpage->RLatch();
-      auto new_leafnode = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(newpage->GetData());
-      size_ = new_leafnode->GetSize();
-      buffer_pool_manager_->UnpinPage(newpage->GetPageId(), false);
-      index_ = 0;
+    // a writer that splits or merges the previous leaf holds it while it relinks this one, so the previous page id
+    // read again with both leaves latched is the current one
+    Page *prev_page = buffer_pool_manager_->FetchPage(prev_pageId);
+    if (prev_page->TryRLatch()) {
+      if (tree_->GetPrevLeafId(leaf) == prev_pageId) {
+        ReleasePage();
+        page_ = prev_page;
+        pageId_ = prev_pageId;
+        index_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page_->GetData())->GetSize() - 1;
+        continue;
+      }
+      prev_page->RUnlatch();
+    }
+    // a writer holds the previous leaf and may be waiting for this one, or it has just changed
+    buffer_pool_manager_->UnpinPage(prev_pageId, false);
+    ReleasePage();
+    if (!has_low_key_ && !has_high_key_) {
+      // only empty leaves so far, nothing was returned yet
+      *this = tree_->rbegin();
+      return;
+    }
+    page_ = tree_->FindLeafBefore(low_key_, &index_);
+    if (page_ == nullptr) {
+      is_end_ = true;
+      return;
     }
+    pageId_ = page_->GetPageId();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool REVERSE_INDEXITERATOR_TYPE::isEnd() const { return is_end_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+const MappingType &REVERSE_INDEXITERATOR_TYPE::operator*() {
+  if (is_end_) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "reference reverse iterator object that is out of the end");
   }
+  item_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page_->GetData())->GetItem(index_);
+  return item_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+REVERSE_INDEXITERATOR_TYPE &REVERSE_INDEXITERATOR_TYPE::operator++() {
+  if (is_end_) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "++ reverse iterator object that is out of the end");
+  }
+  index_ -= 1;
+  SkipExhaustedLeaves();
   return *this;
 }
 
@@ -80,4 +266,34 @@ template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class IndexIterator<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+
+template class IndexIterator<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+
+template class IndexIterator<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+
+template class IndexIterator<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+
+template class IndexIterator<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
+template class ReverseIndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
+
+template class ReverseIndexIterator<GenericKey<8>, RID, GenericComparator<8>>;
+
+template class ReverseIndexIterator<GenericKey<16>, RID, GenericComparator<16>>;
+
+template class ReverseIndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
+
+template class ReverseIndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class ReverseIndexIterator<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+
+template class ReverseIndexIterator<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+
+template class ReverseIndexIterator<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+
+template class ReverseIndexIterator<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+
+template class ReverseIndexIterator<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
 }  // namespace bustub
@@ -0,0 +1,475 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/index/var_b_plus_tree.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include "storage/index/var_b_plus_tree.h"
+
+#include <string>
+#include <utility>
+
+#include "common/exception.h"
+#include "storage/page/header_page.h"
+
+namespace bustub {
+
+namespace {
+constexpr uint32_t PAGE_CAPACITY = BPlusTreeVarLeafPage::Capacity();
+}  // namespace
+
+VarBPlusTree::VarBPlusTree(std::string name, BufferPoolManager *buffer_pool_manager,
+                           const VarKeyComparator &comparator)
+    : index_name_(std::move(name)),
+      root_page_id_(INVALID_PAGE_ID),
+      buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator) {}
+
+bool VarBPlusTree::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+bool VarBPlusTree::GetValue(const VarKey &key, std::vector<RID> *result, Transaction *transaction) {
+  Page *page = FindLeafPage(&key);
+  if (page == nullptr) {
+    return false;
+  }
+  RID value;
+  bool found = reinterpret_cast<LeafPage *>(page->GetData())->Lookup(key, &value, comparator_);
+  if (found) {
+    result->push_back(value);
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
+}
+
+Page *VarBPlusTree::FindLeafPage(const VarKey *key) {
+  mutex.RLock();
+  if (IsEmpty()) {
+    mutex.RUnlock();
+    return nullptr;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (page == nullptr) {
+    mutex.RUnlock();
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory while fetching the root page");
+  }
+  page->RLatch();
+  mutex.RUnlock();
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    page_id_t child_id = key == nullptr ? internal->ValueAt(0) : internal->Lookup(key->GetData(), comparator_);
+    Page *child = buffer_pool_manager_->FetchPage(child_id);
+    if (child == nullptr) {
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory while fetching a child page");
+    }
+    child->RLatch();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child;
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  return page;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+bool VarBPlusTree::Insert(const VarKey &key, const RID &value, Transaction *transaction) {
+  CheckKeySize(key);
+  mutex.WLock();
+  bool root_locked = true;
+  if (IsEmpty()) {
+    StartNewTree(key, value);
+    mutex.WUnlock();
+    return true;
+  }
+
+  std::vector<Page *> path;
+  Search(key, 1, &path, &root_locked);
+  auto *leaf = reinterpret_cast<LeafPage *>(path.back()->GetData());
+  RID existing;
+  if (leaf->Lookup(key, &existing, comparator_)) {
+    ReleasePath(&path, path.size(), &root_locked, false);
+    return false;
+  }
+  if (leaf->HasRoomFor(key.GetSize())) {
+    leaf->Insert(key, value, comparator_);
+    ReleasePath(&path, path.size(), &root_locked, true);
+    return true;
+  }
+
+  // split first, each half has room for any key afterwards
+  page_id_t new_page_id;
+  Page *new_page = NewPage(&new_page_id);
+  auto *new_leaf = reinterpret_cast<LeafPage *>(new_page->GetData());
+  new_leaf->Init(new_page_id, leaf->GetParentPageId());
+  leaf->MoveHalfTo(new_leaf);
+  RelinkNextLeaf(new_leaf);
+  if (comparator_(key.GetData(), new_leaf->KeyAt(0)) < 0) {
+    leaf->Insert(key, value, comparator_);
+  } else {
+    new_leaf->Insert(key, value, comparator_);
+  }
+  InsertIntoParent(&path, path.size() - 1, leaf, new_leaf->GetKey(0), new_leaf);
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  ReleasePath(&path, path.size(), &root_locked, true);
+  return true;
+}
+
+void VarBPlusTree::StartNewTree(const VarKey &key, const RID &value) {
+  page_id_t page_id;
+  Page *page = NewPage(&page_id);
+  auto *root = reinterpret_cast<LeafPage *>(page->GetData());
+  root->Init(page_id);
+  root->Insert(key, value, comparator_);
+  root_page_id_ = page_id;
+  UpdateRootPageId(1);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
+void VarBPlusTree::InsertIntoParent(std::vector<Page *> *path, size_t level, BPlusTreePage *old_node,
+                                    const VarKey &key, BPlusTreePage *new_node) {
+  if (old_node->IsRootPage()) {
+    page_id_t root_id;
+    Page *root_page = NewPage(&root_id);
+    auto *root = reinterpret_cast<InternalPage *>(root_page->GetData());
+    root->Init(root_id);
+    root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    old_node->SetParentPageId(root_id);
+    new_node->SetParentPageId(root_id);
+    root_page_id_ = root_id;
+    UpdateRootPageId(0);
+    buffer_pool_manager_->UnpinPage(root_id, true);
+    return;
+  }
+
+  // old_node was not safe, so its parent is still latched right above it
+  auto *parent = reinterpret_cast<InternalPage *>(path->at(level - 1)->GetData());
+  if (parent->HasRoomFor(key.GetSize())) {
+    parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+    return;
+  }
+
+  page_id_t sibling_id;
+  Page *sibling_page = NewPage(&sibling_id);
+  auto *sibling = reinterpret_cast<InternalPage *>(sibling_page->GetData());
+  sibling->Init(sibling_id, parent->GetParentPageId());
+  VarKey middle_key = parent->MoveHalfTo(sibling, buffer_pool_manager_);
+  InternalPage *target = comparator_(key, middle_key) < 0 ? parent : sibling;
+  target->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+  new_node->SetParentPageId(target->GetPageId());
+  InsertIntoParent(path, level - 1, parent, middle_key, sibling);
+  buffer_pool_manager_->UnpinPage(sibling_id, true);
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+void VarBPlusTree::Remove(const VarKey &key, Transaction *transaction) {
+  if (key.GetSize() > VAR_KEY_MAX_SIZE) {
+    return;
+  }
+  mutex.WLock();
+  bool root_locked = true;
+  if (IsEmpty()) {
+    mutex.WUnlock();
+    return;
+  }
+
+  std::vector<Page *> path;
+  Search(key, 2, &path, &root_locked);
+  auto *leaf = reinterpret_cast<LeafPage *>(path.back()->GetData());
+  int size = leaf->GetSize();
+  if (leaf->RemoveAndDeleteRecord(key, comparator_) == size) {
+    ReleasePath(&path, path.size(), &root_locked, false);
+    return;
+  }
+  std::vector<page_id_t> deleted;
+  if (leaf->IsRootPage() ? leaf->GetSize() == 0 : leaf->IsUnderfull()) {
+    Rebalance(&path, path.size() - 1, &deleted);
+  }
+  ReleasePath(&path, path.size(), &root_locked, true);
+  for (page_id_t page_id : deleted) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+}
+
+void VarBPlusTree::Rebalance(std::vector<Page *> *path, size_t level, std::vector<page_id_t> *deleted) {
+  auto *node = reinterpret_cast<BPlusTreePage *>(path->at(level)->GetData());
+  if (node->IsRootPage()) {
+    AdjustRoot(node, deleted);
+    return;
+  }
+
+  // node was not safe, so its parent is still latched right above it
+  auto *parent = reinterpret_cast<InternalPage *>(path->at(level - 1)->GetData());
+  int index = parent->ValueIndex(node->GetPageId());
+  page_id_t sibling_id = parent->ValueAt(index == 0 ? 1 : index - 1);
+  Page *sibling_page = buffer_pool_manager_->FetchPage(sibling_id);
+  if (sibling_page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory while fetching a sibling page");
+  }
+  sibling_page->WLatch();
+  if (node->IsLeafPage()) {
+    RebalanceLeaves(reinterpret_cast<LeafPage *>(node), reinterpret_cast<LeafPage *>(sibling_page->GetData()), parent,
+                    index, deleted);
+  } else {
+    RebalanceInternals(reinterpret_cast<InternalPage *>(node),
+                       reinterpret_cast<InternalPage *>(sibling_page->GetData()), parent, index, deleted);
+  }
+  sibling_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(sibling_id, true);
+
+  if (parent->IsRootPage() ? parent->GetSize() == 1 : parent->IsUnderfull()) {
+    Rebalance(path, level - 1, deleted);
+  }
+}
+
+/*
+ * index is the index of node in parent, its sibling is the page before it, or the page after it if node is the first
+ * child. The right page of the two is merged into the left one if they fit in a page, otherwise node borrows
+ * entries from its sibling until it is no longer underfull, as far as the sibling stays at least half full and the
+ * new separator fits in the parent.
+ */
+void VarBPlusTree::RebalanceLeaves(LeafPage *node, LeafPage *sibling, InternalPage *parent, int index,
+                                   std::vector<page_id_t> *deleted) {
+  LeafPage *left = index == 0 ? node : sibling;
+  LeafPage *right = index == 0 ? sibling : node;
+  int separator_index = index == 0 ? 1 : index;
+  if (left->GetUsedBytes() + right->GetUsedBytes() <= PAGE_CAPACITY) {
+    right->MoveAllTo(left);
+    RelinkNextLeaf(left);
+    parent->Remove(separator_index);
+    deleted->push_back(right->GetPageId());
+    return;
+  }
+
+  if (index == 0) {
+    while (node->IsUnderfull() && sibling->GetSize() > 1 && node->HasRoomFor(sibling->KeySizeAt(0)) &&
+           sibling->GetUsedBytes() >= PAGE_CAPACITY / 2 + LeafPage::EntrySize(sibling->KeySizeAt(0)) &&
+           parent->HasRoomForKeyAt(separator_index, sibling->KeySizeAt(1))) {
+      sibling->MoveFirstToEndOf(node);
+      parent->SetKeyAt(separator_index, sibling->GetKey(0));
+    }
+  } else {
+    int last = sibling->GetSize() - 1;
+    while (node->IsUnderfull() && sibling->GetSize() > 1 && node->HasRoomFor(sibling->KeySizeAt(last)) &&
+           sibling->GetUsedBytes() >= PAGE_CAPACITY / 2 + LeafPage::EntrySize(sibling->KeySizeAt(last)) &&
+           parent->HasRoomForKeyAt(separator_index, sibling->KeySizeAt(last))) {
+      sibling->MoveLastToFrontOf(node);
+      parent->SetKeyAt(separator_index, node->GetKey(0));
+      last = sibling->GetSize() - 1;
+    }
+  }
+}
+
+/*
+ * Like RebalanceLeaves, the separator in the parent moves down into the merged page, and entries borrowed from the
+ * sibling rotate through the parent.
+ */
+void VarBPlusTree::RebalanceInternals(InternalPage *node, InternalPage *sibling, InternalPage *parent, int index,
+                                      std::vector<page_id_t> *deleted) {
+  InternalPage *left = index == 0 ? node : sibling;
+  InternalPage *right = index == 0 ? sibling : node;
+  int separator_index = index == 0 ? 1 : index;
+  VarKey middle_key = parent->GetKey(separator_index);
+  if (left->GetUsedBytes() + right->GetUsedBytes() + InternalPage::EntrySize(middle_key.GetSize()) <=
+      PAGE_CAPACITY) {
+    right->MoveAllTo(left, middle_key, buffer_pool_manager_);
+    parent->Remove(separator_index);
+    deleted->push_back(right->GetPageId());
+    return;
+  }
+
+  // the page that borrows gains an entry with the middle key, the sibling loses one with the new separator
+  if (index == 0) {
+    while (node->IsUnderfull() && sibling->GetSize() > 2 && node->HasRoomFor(middle_key.GetSize()) &&
+           sibling->GetUsedBytes() >= PAGE_CAPACITY / 2 + InternalPage::EntrySize(sibling->KeySizeAt(1)) &&
+           parent->HasRoomForKeyAt(separator_index, sibling->KeySizeAt(1))) {
+      middle_key = sibling->MoveFirstToEndOf(node, middle_key, buffer_pool_manager_);
+      parent->SetKeyAt(separator_index, middle_key);
+    }
+  } else {
+    int last = sibling->GetSize() - 1;
+    while (node->IsUnderfull() && sibling->GetSize() > 2 && node->HasRoomFor(middle_key.GetSize()) &&
+           sibling->GetUsedBytes() >= PAGE_CAPACITY / 2 + InternalPage::EntrySize(sibling->KeySizeAt(last)) &&
+           parent->HasRoomForKeyAt(separator_index, sibling->KeySizeAt(last))) {
+      middle_key = sibling->MoveLastToFrontOf(node, middle_key, buffer_pool_manager_);
+      parent->SetKeyAt(separator_index, middle_key);
+      last = sibling->GetSize() - 1;
+    }
+  }
+}
+
+void VarBPlusTree::AdjustRoot(BPlusTreePage *root, std::vector<page_id_t> *deleted) {
+  if (root->IsLeafPage()) {
+    if (root->GetSize() == 0) {
+      root_page_id_ = INVALID_PAGE_ID;
+      UpdateRootPageId(0);
+      deleted->push_back(root->GetPageId());
+    }
+    return;
+  }
+  if (root->GetSize() == 1) {
+    page_id_t child_id = reinterpret_cast<InternalPage *>(root)->RemoveAndReturnOnlyChild();
+    Page *child = buffer_pool_manager_->FetchPage(child_id);
+    if (child == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory while fetching the new root page");
+    }
+    reinterpret_cast<BPlusTreePage *>(child->GetData())->SetParentPageId(INVALID_PAGE_ID);
+    buffer_pool_manager_->UnpinPage(child_id, true);
+    root_page_id_ = child_id;
+    UpdateRootPageId(0);
+    deleted->push_back(root->GetPageId());
+  }
+}
+
+/*****************************************************************************
+ * INDEX ITERATOR
+ *****************************************************************************/
+VarIndexIterator VarBPlusTree::begin() {
+  Page *page = FindLeafPage(nullptr);
+  if (page == nullptr) {
+    return end();
+  }
+  return VarIndexIterator(this, page, 0, buffer_pool_manager_);
+}
+
+VarIndexIterator VarBPlusTree::Begin(const VarKey &key) {
+  Page *page = FindLeafPage(&key);
+  if (page == nullptr) {
+    return end();
+  }
+  int index = reinterpret_cast<LeafPage *>(page->GetData())->KeyIndex(key.GetData(), comparator_);
+  return VarIndexIterator(this, page, index, buffer_pool_manager_, &key);
+}
+
+VarIndexIterator VarBPlusTree::end() { return VarIndexIterator(true); }
+
+/*****************************************************************************
+ * UTILITIES AND DEBUG
+ *****************************************************************************/
+void VarBPlusTree::Search(const VarKey &key, int op, std::vector<Page *> *path, bool *root_locked) {
+  page_id_t page_id = root_page_id_;
+  while (true) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      ReleasePath(path, path->size(), root_locked, false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory while searching the tree");
+    }
+    page->WLatch();
+    path->push_back(page);
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (Safe(node, op, key)) {
+      ReleasePath(path, path->size() - 1, root_locked, false);
+    }
+    if (node->IsLeafPage()) {
+      return;
+    }
+    page_id = reinterpret_cast<InternalPage *>(node)->Lookup(key.GetData(), comparator_);
+  }
+}
+
+/*
+ * A page is safe if the operation cannot change its parent: an insert does not split it and a remove leaves it at
+ * least half full. An internal page gets at most one separator of any length from a split child, or loses one
+ * entry or has a separator replaced when a child is rebalanced.
+ */
+bool VarBPlusTree::Safe(BPlusTreePage *node, int op, const VarKey &key) const {
+  if (node->IsLeafPage()) {
+    auto *leaf = reinterpret_cast<LeafPage *>(node);
+    if (op == 1) {
+      return leaf->HasRoomFor(key.GetSize());
+    }
+    if (leaf->IsRootPage()) {
+      return leaf->GetSize() > 1;
+    }
+    return leaf->GetUsedBytes() >= PAGE_CAPACITY / 2 + LeafPage::EntrySize(key.GetSize());
+  }
+  auto *internal = reinterpret_cast<InternalPage *>(node);
+  if (op == 1) {
+    return internal->HasRoomFor(VAR_KEY_MAX_SIZE);
+  }
+  if (internal->IsRootPage()) {
+    return internal->GetSize() > 2 && internal->HasRoomFor(VAR_KEY_MAX_SIZE);
+  }
+  return internal->HasRoomFor(VAR_KEY_MAX_SIZE) &&
+         internal->GetUsedBytes() >= PAGE_CAPACITY / 2 + InternalPage::EntrySize(VAR_KEY_MAX_SIZE);
+}
+
+void VarBPlusTree::RelinkNextLeaf(LeafPage *leaf) {
+  page_id_t next_page_id = leaf->GetNextPageId();
+  if (next_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  // leaves are latched from left to right, like the iterators do
+  Page *next_page = buffer_pool_manager_->FetchPage(next_page_id);
+  if (next_page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory while fetching the next leaf");
+  }
+  next_page->WLatch();
+  reinterpret_cast<LeafPage *>(next_page->GetData())->SetPrevPageId(leaf->GetPageId());
+  next_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(next_page_id, true);
+}
+
+/*
+ * Unlatches and unpins the first count pages of path, and lets the root page id go.
+ */
+void VarBPlusTree::ReleasePath(std::vector<Page *> *path, size_t count, bool *root_locked, bool is_dirty) {
+  if (*root_locked) {
+    mutex.WUnlock();
+    *root_locked = false;
+  }
+  for (size_t i = 0; i < count; i++) {
+    Page *page = path->at(i);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+  }
+  path->erase(path->begin(), path->begin() + count);
+}
+
+Page *VarBPlusTree::NewPage(page_id_t *page_id) {
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory while allocating a tree page");
+  }
+  return page;
+}
+
+void VarBPlusTree::CheckKeySize(const VarKey &key) const {
+  if (key.GetSize() > VAR_KEY_MAX_SIZE) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "key of " + std::to_string(key.GetSize()) +
+                                                     " bytes exceeds the limit of the varlen key index");
+  }
+}
+
+/*
+ * Update/Insert root page id in header page(where page_id = 0, header_page is
+ * defined under include/page/header_page.h)
+ * @parameter: insert_record      default value is false. When set to true,
+ * insert a record <index_name, root_page_id> into header page instead of
+ * updating it.
+ */
+void VarBPlusTree::UpdateRootPageId(int insert_record) {
+  auto *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  header_page->WLatch();
+  // a tree that became empty and grows again already has its record
+  if (insert_record == 0 || !header_page->InsertRecord(index_name_, root_page_id_)) {
+    header_page->UpdateRecord(index_name_, root_page_id_);
+  }
+  header_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+}  // namespace bustub
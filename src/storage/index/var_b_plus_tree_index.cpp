@@ -0,0 +1,53 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/index/var_b_plus_tree_index.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/var_b_plus_tree_index.h"
+
+namespace bustub {
+/*
+ * Constructor
+ */
+VarBPlusTreeIndex::VarBPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager)
+    : Index(metadata),
+      comparator_(metadata->GetKeySchema()),
+      container_(metadata->GetName(), buffer_pool_manager, comparator_) {}
+
+void VarBPlusTreeIndex::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  // construct insert index key
+  VarKey index_key;
+  index_key.SetFromKey(key);
+
+  container_.Insert(index_key, rid, transaction);
+}
+
+void VarBPlusTreeIndex::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  // construct delete index key
+  VarKey index_key;
+  index_key.SetFromKey(key);
+
+  container_.Remove(index_key, transaction);
+}
+
+void VarBPlusTreeIndex::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  // construct scan index key
+  VarKey index_key;
+  index_key.SetFromKey(key);
+
+  container_.GetValue(index_key, result, transaction);
+}
+
+VarIndexIterator VarBPlusTreeIndex::GetBeginIterator() { return container_.begin(); }
+
+VarIndexIterator VarBPlusTreeIndex::GetBeginIterator(const VarKey &key) { return container_.Begin(key); }
+
+VarIndexIterator VarBPlusTreeIndex::GetEndIterator() { return container_.end(); }
+
+}  // namespace bustub
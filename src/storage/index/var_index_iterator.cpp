@@ -0,0 +1,144 @@
+/**
+ * var_index_iterator.cpp
+ */
+#include "storage/index/var_index_iterator.h"
+
+#include "common/exception.h"
+#include "storage/index/var_b_plus_tree.h"
+
+namespace bustub {
+
+VarIndexIterator::VarIndexIterator(VarBPlusTree *tree, Page *page, int index, BufferPoolManager *buffer_pool_manager,
+                                   const VarKey *low_key)
+    : tree_(tree), pageId_(page->GetPageId()), index_(index), page_(page), buffer_pool_manager_(buffer_pool_manager) {
+  if (low_key != nullptr) {
+    low_key_ = *low_key;
+    has_low_key_ = true;
+    low_key_inclusive_ = true;
+  }
+  // a start key past the last key of its leaf begins at the next leaf
+  SkipExhaustedLeaves();
+}
+
+VarIndexIterator::VarIndexIterator(bool is_end) : is_end_(is_end) {}
+
+VarIndexIterator::VarIndexIterator(VarIndexIterator &&other) noexcept
+    : tree_(other.tree_),
+      pageId_(other.pageId_),
+      index_(other.index_),
+      page_(other.page_),
+      buffer_pool_manager_(other.buffer_pool_manager_),
+      is_end_(other.is_end_),
+      item_(std::move(other.item_)),
+      low_key_(std::move(other.low_key_)),
+      has_low_key_(other.has_low_key_),
+      low_key_inclusive_(other.low_key_inclusive_) {
+  other.page_ = nullptr;
+  other.is_end_ = true;
+}
+
+VarIndexIterator &VarIndexIterator::operator=(VarIndexIterator &&other) noexcept {
+  if (this != &other) {
+    ReleasePage();
+    tree_ = other.tree_;
+    pageId_ = other.pageId_;
+    index_ = other.index_;
+    page_ = other.page_;
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    is_end_ = other.is_end_;
+    item_ = std::move(other.item_);
+    low_key_ = std::move(other.low_key_);
+    has_low_key_ = other.has_low_key_;
+    low_key_inclusive_ = other.low_key_inclusive_;
+    other.page_ = nullptr;
+    other.is_end_ = true;
+  }
+  return *this;
+}
+
+VarIndexIterator::~VarIndexIterator() { ReleasePage(); }
+
+void VarIndexIterator::ReleasePage() {
+  if (page_ != nullptr) {
+    page_->RUnlatch();
+    buffer_pool_manager_->UnpinPage(pageId_, false);
+    page_ = nullptr;
+  }
+}
+
+void VarIndexIterator::SeekPastLowKey() {
+  auto *leaf = reinterpret_cast<BPlusTreeVarLeafPage *>(page_->GetData());
+  const VarKeyComparator &comparator = tree_->GetComparator();
+  index_ = leaf->KeyIndex(low_key_.GetData(), comparator);
+  if (!low_key_inclusive_ && index_ < leaf->GetSize() && comparator(leaf->KeyAt(index_), low_key_.GetData()) == 0) {
+    index_++;
+  }
+}
+
+void VarIndexIterator::SkipExhaustedLeaves() {
+  while (!is_end_ && index_ >= reinterpret_cast<BPlusTreeVarLeafPage *>(page_->GetData())->GetSize()) {
+    page_id_t next_pageId = reinterpret_cast<BPlusTreeVarLeafPage *>(page_->GetData())->GetNextPageId();
+    page_id_t prev_pageId = pageId_;
+    ReleasePage();
+    if (next_pageId == INVALID_PAGE_ID) {
+      is_end_ = true;
+      return;
+    }
+    // the next leaf is latched only after this one is released, so it may have been merged away in between
+    Page *next_page = buffer_pool_manager_->FetchPage(next_pageId);
+    if (next_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory while fetching the next leaf");
+    }
+    next_page->RLatch();
+    auto *next_leaf = reinterpret_cast<BPlusTreeVarLeafPage *>(next_page->GetData());
+    if (next_leaf->IsLeafPage() && next_leaf->GetPrevPageId() == prev_pageId) {
+      page_ = next_page;
+      pageId_ = next_pageId;
+      index_ = 0;
+    } else {
+      next_page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(next_pageId, false);
+      if (!has_low_key_) {
+        // only empty leaves so far, nothing was returned yet
+        *this = tree_->begin();
+        return;
+      }
+      page_ = tree_->FindLeafPage(&low_key_);
+      if (page_ == nullptr) {
+        is_end_ = true;
+        return;
+      }
+      pageId_ = page_->GetPageId();
+    }
+    // entries may have moved over from the leaf before, skip the ones already returned
+    if (has_low_key_) {
+      SeekPastLowKey();
+    }
+  }
+}
+
+bool VarIndexIterator::isEnd() const { return is_end_; }
+
+const std::pair<VarKey, RID> &VarIndexIterator::operator*() {
+  if (is_end_) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "reference iterator object that is out of the end");
+  }
+  auto *leaf = reinterpret_cast<BPlusTreeVarLeafPage *>(page_->GetData());
+  item_ = std::make_pair(leaf->GetKey(index_), leaf->ValueAt(index_));
+  return item_;
+}
+
+VarIndexIterator &VarIndexIterator::operator++() {
+  if (is_end_) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "++ iterator object that is out of the end");
+  }
+  auto *leaf = reinterpret_cast<BPlusTreeVarLeafPage *>(page_->GetData());
+  low_key_ = leaf->GetKey(index_);
+  has_low_key_ = true;
+  low_key_inclusive_ = false;
+  index_ += 1;
+  SkipExhaustedLeaves();
+  return *this;
+}
+
+}  // namespace bustub
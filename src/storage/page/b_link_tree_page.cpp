@@ -0,0 +1,145 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/page/b_link_tree_page.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+
+#include "storage/index/key_search.h"
+#include "storage/page/b_link_tree_page.h"
+
+namespace bustub {
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_LINK_TREE_PAGE_TYPE::Init(page_id_t page_id, uint32_t level, int max_size) {
+  page_type_ = level == 0 ? IndexPageType::LEAF_PAGE : IndexPageType::INTERNAL_PAGE;
+  lsn_ = INVALID_LSN;
+  size_ = 0;
+  max_size_ = max_size;
+  page_id_ = page_id;
+  level_ = level;
+  right_page_id_ = INVALID_PAGE_ID;
+  has_high_key_ = 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_LINK_TREE_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
+  using Search = KeySearch<KeyType, KeyComparator>;
+  if (Search::ENABLED && Search::Applies(comparator)) {
+    return Search::CountLess(reinterpret_cast<const char *>(array), sizeof(MappingType), size_, key, false);
+  }
+  int l = 0;
+  int r = size_;
+  while (l < r) {
+    int mid = (l + r) / 2;
+    if (comparator(array[mid].first, key) < 0) {
+      l = mid + 1;
+    } else {
+      r = mid;
+    }
+  }
+  return l;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_LINK_TREE_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
+  using Search = KeySearch<KeyType, KeyComparator>;
+  if (Search::ENABLED && Search::Applies(comparator)) {
+    // the child before the first of the keys from index 1 on that is greater than key
+    int index = Search::CountLess(reinterpret_cast<const char *>(&array[1]), sizeof(MappingType), size_ - 1, key, true);
+    return array[index].second;
+  }
+  // the last child whose key is not greater than key, the first key is unused
+  int l = 1;
+  int r = size_;
+  while (l < r) {
+    int mid = (l + r) / 2;
+    if (comparator(array[mid].first, key) <= 0) {
+      l = mid + 1;
+    } else {
+      r = mid;
+    }
+  }
+  return array[l - 1].second;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_LINK_TREE_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
+  int index = KeyIndex(key, comparator);
+  if (index < size_ && comparator(array[index].first, key) == 0) {
+    return false;
+  }
+  memmove(static_cast<void *>(&array[index + 1]), static_cast<void *>(&array[index]),
+          (size_ - index) * sizeof(MappingType));
+  array[index] = MappingType(key, value);
+  size_++;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_LINK_TREE_PAGE_TYPE::InsertChild(const KeyType &key, page_id_t child, const KeyComparator &comparator) {
+  int index = 1;
+  while (index < size_ && comparator(array[index].first, key) < 0) {
+    index++;
+  }
+  memmove(static_cast<void *>(&array[index + 1]), static_cast<void *>(&array[index]),
+          (size_ - index) * sizeof(MappingType));
+  array[index].first = key;
+  memcpy(static_cast<void *>(&array[index].second), &child, sizeof(page_id_t));
+  size_++;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_LINK_TREE_PAGE_TYPE::Remove(const KeyType &key, const KeyComparator &comparator) {
+  int index = KeyIndex(key, comparator);
+  if (index == size_ || comparator(array[index].first, key) != 0) {
+    return false;
+  }
+  memmove(static_cast<void *>(&array[index]), static_cast<void *>(&array[index + 1]),
+          (size_ - index - 1) * sizeof(MappingType));
+  size_--;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_LINK_TREE_PAGE_TYPE::PopulateNewRoot(page_id_t left, const KeyType &key, page_id_t right) {
+  memcpy(static_cast<void *>(&array[0].second), &left, sizeof(page_id_t));
+  array[1].first = key;
+  memcpy(static_cast<void *>(&array[1].second), &right, sizeof(page_id_t));
+  size_ = 2;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_LINK_TREE_PAGE_TYPE::MoveHalfTo(BLinkTreePage *right) {
+  int mid = size_ / 2;
+  memcpy(static_cast<void *>(right->array), static_cast<void *>(&array[mid]), (size_ - mid) * sizeof(MappingType));
+  right->size_ = size_ - mid;
+  right->right_page_id_ = right_page_id_;
+  right->has_high_key_ = has_high_key_;
+  right->high_key_ = high_key_;
+  size_ = mid;
+  right_page_id_ = right->page_id_;
+  has_high_key_ = 1;
+  high_key_ = right->array[0].first;
+  return high_key_;
+}
+
+template class BLinkTreePage<GenericKey<4>, RID, GenericComparator<4>>;
+template class BLinkTreePage<GenericKey<8>, RID, GenericComparator<8>>;
+template class BLinkTreePage<GenericKey<16>, RID, GenericComparator<16>>;
+template class BLinkTreePage<GenericKey<32>, RID, GenericComparator<32>>;
+template class BLinkTreePage<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class BLinkTreePage<GenericKey<4>, page_id_t, GenericComparator<4>>;
+template class BLinkTreePage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+template class BLinkTreePage<GenericKey<16>, page_id_t, GenericComparator<16>>;
+template class BLinkTreePage<GenericKey<32>, page_id_t, GenericComparator<32>>;
+template class BLinkTreePage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+
+}  // namespace bustub
@@ -9,9 +9,12 @@
 //
 //===----------------------------------------------------------------------===//
 #include "storage/page/b_plus_tree_internal_page.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include "common/exception.h"
+#include "storage/index/key_search.h"
 
 namespace bustub {
 /*****************************************************************************
@@ -23,12 +26,17 @@ namespace bustub {
  * max page size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size, bool compress_keys) {
   SetPageId(page_id);
   SetPageType(IndexPageType::INTERNAL_PAGE);
   SetParentPageId(parent_id);
   SetSize(0);
   SetMaxSize(max_size);
+  if (compress_keys) {
+    Rewrite(nullptr, 0);
+  } else {
+    DisableKeyCompression();
+  }
   // std::cout << "internal treepage's max size is " << max_size << " page is is "<< page_id <<std::endl;
 }
 /*
@@ -38,17 +46,27 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id
 // first key is a invalid key
 INDEX_TEMPLATE_ARGUMENTS
 KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  KeyType key{};
   // assert(index >= 0 && index < GetSize());
-  key = array[index].first;
-  return key;
+  KeyType buffer;
+  return KeyRef(index, &buffer);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
   // assert(0 <= index && index < GetSize());
-  array[index].first = key;
+  if (!IsKeyCompressed()) {
+    array[index].first = key;
+    return;
+  }
+  KeyEncoding encoding = CurrentEncoding();
+  if (KeyFits(encoding, reinterpret_cast<const char *>(&key), sizeof(KeyType))) {
+    char *slot = reinterpret_cast<char *>(array) + index * SlotSize(encoding, sizeof(ValueType));
+    EncodeKey(encoding, slot, reinterpret_cast<const char *>(&key));
+    return;
+  }
+  std::vector<MappingType> items = ItemsBetween(0, GetSize());
+  items[index].first = key;
+  Rewrite(items.data(), GetSize());
 }
 
 /*
@@ -59,7 +77,7 @@ INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
   int index = 0;
   for (; index < GetSize(); ++index) {
-    if (array[index].second == value) {
+    if (ValueAt(index) == value) {
       break;
     }
   }
@@ -73,7 +91,175 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
   // assert(0 <= index && index < GetSize());
-  return array[index].second;
+  if (!IsKeyCompressed()) {
+    return array[index].second;
+  }
+  KeyEncoding encoding = GetKeyEncoding(sizeof(KeyType));
+  ValueType value;
+  memcpy(&value, SlotAt(encoding, index) + encoding.end - encoding.prefix_size, sizeof(ValueType));
+  return value;
+}
+
+/*
+ * Helper methods for the max size of a page with compressed keys, which shrinks when the keys it holds have less
+ * bytes in common
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::MaxSizeWith(const KeyType &key) const {
+  if (!IsKeyCompressed()) {
+    return GetMaxSize();
+  }
+  KeyEncoding encoding = CurrentEncoding();
+  encoding.Add(reinterpret_cast<const char *>(&key), sizeof(KeyType));
+  return std::min(GetMaxSize(), KeyCapacity(encoding, INTERNAL_PAGE_HEADER_SIZE, sizeof(ValueType)));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::MaxSizeAfterMerge(const BPlusTreeInternalPage *other,
+                                                      const KeyType &middle_key) const {
+  if (!IsKeyCompressed()) {
+    return GetMaxSize();
+  }
+  KeyEncoding encoding = CurrentEncoding();
+  encoding.Add(other->CurrentEncoding());
+  encoding.Add(reinterpret_cast<const char *>(&middle_key), sizeof(KeyType));
+  return std::min(GetMaxSize(), KeyCapacity(encoding, INTERNAL_PAGE_HEADER_SIZE, sizeof(ValueType)));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::GuaranteedMaxSize() const {
+  if (!IsKeyCompressed()) {
+    return GetMaxSize();
+  }
+  // a key without anything in common with the others needs full width slots
+  KeyEncoding encoding;
+  encoding.end = sizeof(KeyType);
+  return std::min(GetMaxSize(), KeyCapacity(encoding, INTERNAL_PAGE_HEADER_SIZE, sizeof(ValueType)));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::FitCount(const MappingType *items, int size, int max_size) {
+  KeyEncoding encoding;
+  int count = 0;
+  for (; count < std::min(size, max_size); ++count) {
+    KeyEncoding wider = encoding;
+    wider.Add(reinterpret_cast<const char *>(&items[count].first), sizeof(KeyType));
+    if (count + 1 > KeyCapacity(wider, INTERNAL_PAGE_HEADER_SIZE, sizeof(ValueType))) {
+      break;
+    }
+    encoding = wider;
+  }
+  return count;
+}
+
+/*
+ * Helper methods for the slots, a page with full width keys keeps its items in array
+ */
+INDEX_TEMPLATE_ARGUMENTS
+const KeyType &B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyRef(int index, KeyType *buffer) const {
+  if (!IsKeyCompressed()) {
+    return array[index].first;
+  }
+  KeyEncoding encoding = GetKeyEncoding(sizeof(KeyType));
+  DecodeKey(encoding, SlotAt(encoding, index), reinterpret_cast<char *>(buffer), sizeof(KeyType));
+  return *buffer;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const char *B_PLUS_TREE_INTERNAL_PAGE_TYPE::SlotAt(const KeyEncoding &encoding, int index) const {
+  // an unlatched reader may see a size from another encoding, it must not read past the page
+  int capacity = KeyCapacity(encoding, INTERNAL_PAGE_HEADER_SIZE, sizeof(ValueType));
+  index = std::max(0, std::min(index, capacity - 1));
+  return reinterpret_cast<const char *>(array) + index * SlotSize(encoding, sizeof(ValueType));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+typename B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyEncoding B_PLUS_TREE_INTERNAL_PAGE_TYPE::CurrentEncoding() const {
+  KeyEncoding encoding;
+  if (GetSize() > 0) {
+    encoding = GetKeyEncoding(sizeof(KeyType));
+  }
+  return encoding;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+MappingType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ItemAt(int index) const {
+  if (!IsKeyCompressed()) {
+    return array[index];
+  }
+  return {KeyAt(index), ValueAt(index)};
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<MappingType> B_PLUS_TREE_INTERNAL_PAGE_TYPE::ItemsBetween(int begin, int end) const {
+  std::vector<MappingType> items;
+  items.reserve(end - begin);
+  for (int i = begin; i < end; ++i) {
+    items.push_back(ItemAt(i));
+  }
+  return items;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertAt(int index, const KeyType &key, const ValueType &value) {
+  int size = GetSize();
+  if (!IsKeyCompressed()) {
+    for (int i = size; i > index; --i) {
+      array[i] = array[i - 1];
+    }
+    array[index] = {key, value};
+    IncreaseSize(1);
+    return;
+  }
+  KeyEncoding encoding = CurrentEncoding();
+  const char *key_data = reinterpret_cast<const char *>(&key);
+  if (size > 0 && KeyFits(encoding, key_data, sizeof(KeyType)) &&
+      size < KeyCapacity(encoding, INTERNAL_PAGE_HEADER_SIZE, sizeof(ValueType))) {
+    int slot_size = SlotSize(encoding, sizeof(ValueType));
+    char *slot = reinterpret_cast<char *>(array) + index * slot_size;
+    memmove(slot + slot_size, slot, (size - index) * slot_size);
+    EncodeKey(encoding, slot, key_data);
+    memcpy(slot + encoding.end - encoding.prefix_size, &value, sizeof(ValueType));
+    IncreaseSize(1);
+    return;
+  }
+  // the key needs a wider encoding
+  std::vector<MappingType> items = ItemsBetween(0, size);
+  items.insert(items.begin() + index, {key, value});
+  Rewrite(items.data(), size + 1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAt(int index) {
+  int size = GetSize();
+  if (!IsKeyCompressed()) {
+    for (int i = index; i < size - 1; ++i) {
+      array[i] = array[i + 1];
+    }
+  } else {
+    int slot_size = SlotSize(GetKeyEncoding(sizeof(KeyType)), sizeof(ValueType));
+    char *slot = reinterpret_cast<char *>(array) + index * slot_size;
+    memmove(slot, slot + slot_size, (size - index - 1) * slot_size);
+  }
+  IncreaseSize(-1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Rewrite(const MappingType *items, int size) {
+  KeyEncoding encoding;
+  for (int i = 0; i < size; ++i) {
+    encoding.Add(reinterpret_cast<const char *>(&items[i].first), sizeof(KeyType));
+  }
+  int capacity = KeyCapacity(encoding, INTERNAL_PAGE_HEADER_SIZE, sizeof(ValueType));
+  BUSTUB_ASSERT(size <= capacity, "the items do not fit in an internal page");
+  SetKeyEncoding(encoding, capacity);
+  int slot_size = SlotSize(encoding, sizeof(ValueType));
+  char *slot = reinterpret_cast<char *>(array);
+  for (int i = 0; i < size; ++i, slot += slot_size) {
+    EncodeKey(encoding, slot, reinterpret_cast<const char *>(&items[i].first));
+    memcpy(slot + encoding.end - encoding.prefix_size, &items[i].second, sizeof(ValueType));
+  }
+  SetSize(size);
 }
 
 /*****************************************************************************
@@ -87,20 +273,25 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
 // 这里有点奇怪，如果从第二个key开始找, 已解
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
-  for (int i = 1; i < GetSize(); ++i) {
-    if (comparator(key, array[i].first) < 0) {
-      // std::cout << "want to find a value " << key << " in the internal node and found that the i is" << i
-      //          << "and the key is " << array[i].first << "and the internal page's size is"
-      //          << GetSize() << std::endl;
-      // for (int j = 0; j < GetSize(); ++j) {
-      //   std::cout << "want to find a value " << key << " in the internal node and found that the afteri is" << j
-      //            << "and the key is " << array[j].first << "and the internal page's size is"
-      //            << GetSize() << std::endl;
-      // }
-      return array[i - 1].second;
+  using Search = KeySearch<KeyType, KeyComparator>;
+  if (Search::ENABLED && !IsKeyCompressed() && Search::Applies(comparator)) {
+    // the child before the first of the keys from index 1 on that is greater than key
+    return ValueAt(
+        Search::CountLess(reinterpret_cast<const char *>(&array[1]), sizeof(MappingType), GetSize() - 1, key, true));
+  }
+  // the first index i >= 1 with key < KeyAt(i), the child before it holds the key
+  int l = 1;
+  int r = GetSize();
+  KeyType buffer;
+  while (l < r) {
+    int mid = (l + r) / 2;
+    if (comparator(key, KeyRef(mid, &buffer)) < 0) {
+      r = mid;
+    } else {
+      l = mid + 1;
     }
   }
-  return array[GetSize() - 1].second;
+  return ValueAt(l - 1);
 }
 
 /*****************************************************************************
@@ -115,8 +306,14 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyCo
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
                                                      const ValueType &new_value) {
-  array[0].second = old_value;
-  array[1] = {new_key, new_value};
+  // the first key is never looked at, it repeats new_key so it does not widen compressed keys
+  MappingType items[2] = {{new_key, old_value}, {new_key, new_value}};
+  if (IsKeyCompressed()) {
+    Rewrite(items, 2);
+    return;
+  }
+  array[0] = items[0];
+  array[1] = items[1];
   SetSize(2);
 }
 /*
@@ -127,16 +324,8 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value,
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
                                                     const ValueType &new_value) {
-  int i = 0;
-  while (array[i].second != old_value) {
-    i++;
-  }
-  for (int j = GetSize(); j > i + 1; j--) {
-    array[j] = array[j - 1];
-  }
-  array[i + 1].first = new_key;
-  array[i + 1].second = new_value;
-  SetSize(GetSize() + 1);
+  int i = ValueIndex(old_value);
+  InsertAt(i + 1, new_key, new_value);
   return GetSize();
 }
 
@@ -151,8 +340,17 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient,
                                                 BufferPoolManager *buffer_pool_manager) {
   int old_size = GetSize();
-  recipient->CopyNFrom(&array[(old_size + 1) / 2], old_size / 2, buffer_pool_manager);
-  SetSize((old_size + 1) / 2);
+  int mid_point = (old_size + 1) / 2;
+  if (IsKeyCompressed()) {
+    // both halves get the encoding that fits their own keys
+    std::vector<MappingType> items = ItemsBetween(mid_point, old_size);
+    recipient->CopyNFrom(items.data(), old_size / 2, buffer_pool_manager);
+    items = ItemsBetween(0, mid_point);
+    Rewrite(items.data(), mid_point);
+  } else {
+    recipient->CopyNFrom(&array[mid_point], old_size / 2, buffer_pool_manager);
+    SetSize(mid_point);
+  }
 }
 
 /* Copy entries into me, starting from {items} and copy {size} entries.
@@ -161,20 +359,37 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient
  */
 // 控制这个internal Page不超过max_size任务交给上一层调用他的函数
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(const MappingType *items, int size,
+                                               BufferPoolManager *buffer_pool_manager) {
   int old_size = GetSize();
+  if (IsKeyCompressed()) {
+    std::vector<MappingType> all_items = ItemsBetween(0, old_size);
+    all_items.insert(all_items.end(), items, items + size);
+    Rewrite(all_items.data(), old_size + size);
+  } else {
+    for (int i = 0; i < size; ++i) {
+      array[i + old_size] = items[i];
+    }
+    IncreaseSize(size);
+  }
   for (int i = 0; i < size; ++i) {
-    array[i + old_size] = items[i];
-    page_id_t pageId = items[i].second;
-    Page *page = buffer_pool_manager->FetchPage(pageId);
-    // if (page == nullptr) {
-    //  throw Exception(ExceptionType::OUT_OF_MEMORY, "fail in CopNFrom in internal_page");
-    // }
-    B_PLUS_TREE_INTERNAL_PAGE_TYPE *node = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE_TYPE *>(page->GetData());
-    node->SetParentPageId(GetPageId());
-    buffer_pool_manager->UnpinPage(pageId, true);
+    Adopt(items[i].second, buffer_pool_manager);
   }
-  IncreaseSize(size);
+}
+
+/*
+ * Set the parent page id of the child page to me
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Adopt(const ValueType &value, BufferPoolManager *buffer_pool_manager) {
+  page_id_t pageId = value;
+  Page *page = buffer_pool_manager->FetchPage(pageId);
+  // if (page == nullptr) {
+  //  throw Exception(ExceptionType::OUT_OF_MEMORY, "fail in CopNFrom in internal_page");
+  // }
+  B_PLUS_TREE_INTERNAL_PAGE_TYPE *node = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE_TYPE *>(page->GetData());
+  node->SetParentPageId(GetPageId());
+  buffer_pool_manager->UnpinPage(pageId, true);
 }
 
 /*****************************************************************************
@@ -186,12 +401,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, Buf
  * NOTE: store key&value pair continuously after deletion
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
-  for (int i = index; i < GetSize() - 1; ++i) {
-    array[i] = array[i + 1];
-  }
-  IncreaseSize(-1);
-}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) { RemoveAt(index); }
 
 /*
  * Remove the only key & value pair in internal page and return the value
@@ -199,7 +409,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
-  ValueType value = array[0].second;
+  ValueType value = ValueAt(0);
   IncreaseSize(-1);
   // assert(GetSize() == 0);
   return value;
@@ -217,8 +427,9 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                BufferPoolManager *buffer_pool_manager) {
-  array[0].first = middle_key;
-  recipient->CopyNFrom(array, GetSize(), buffer_pool_manager);
+  std::vector<MappingType> items = ItemsBetween(0, GetSize());
+  items[0].first = middle_key;
+  recipient->CopyNFrom(items.data(), GetSize(), buffer_pool_manager);
   SetSize(0);
 }
 
@@ -236,9 +447,10 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient,
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                       BufferPoolManager *buffer_pool_manager) {
-  MappingType pair = {middle_key, array[0].second};
+  MappingType pair = {middle_key, ValueAt(0)};
   recipient->CopyLastFrom(pair, buffer_pool_manager);
-  IncreaseSize(-1);
+  // the old second key becomes the first one, it is the new separator in the parent
+  RemoveAt(0);
 }
 
 /* Append an entry at the end.
@@ -247,14 +459,8 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *rec
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
-  page_id_t pageId = pair.second;
-  Page *page = buffer_pool_manager->FetchPage(pageId);
-  B_PLUS_TREE_INTERNAL_PAGE_TYPE *node = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE_TYPE *>(page->GetData());
-
-  array[GetSize()] = pair;
-  node->SetParentPageId(GetPageId());
-  IncreaseSize(1);
-  buffer_pool_manager->UnpinPage(pageId, true);
+  InsertAt(GetSize(), pair.first, pair.second);
+  Adopt(pair.second, buffer_pool_manager);
 }
 
 /*
@@ -268,7 +474,7 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                        BufferPoolManager *buffer_pool_manager) {
   recipient->SetKeyAt(0, middle_key);
-  recipient->CopyFirstFrom(array[GetSize() - 1], buffer_pool_manager);
+  recipient->CopyFirstFrom(ItemAt(GetSize() - 1), buffer_pool_manager);
   IncreaseSize(-1);
 }
 
@@ -278,20 +484,8 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *re
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
-  auto pageId = pair.second;
-  auto *page = buffer_pool_manager->FetchPage(pageId);
-  if (page == nullptr) {
-    return;
-  }
-  B_PLUS_TREE_INTERNAL_PAGE_TYPE *node = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE_TYPE *>(page->GetData());
-
-  for (int i = 0; i < GetSize(); ++i) {
-    array[i + 1] = array[i];
-  }
-  array[0] = pair;
-  IncreaseSize(1);
-  node->SetParentPageId(GetPageId());
-  buffer_pool_manager->UnpinPage(node->GetPageId(), true);
+  InsertAt(0, pair.first, pair.second);
+  Adopt(pair.second, buffer_pool_manager);
 }
 
 // valuetype for internalNode should be page id_t
@@ -300,4 +494,10 @@ template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator
 template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
 template class BPlusTreeInternalPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
 template class BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+
+template class BPlusTreeInternalPage<NormalizedKey<4>, page_id_t, NormalizedComparator<4>>;
+template class BPlusTreeInternalPage<NormalizedKey<8>, page_id_t, NormalizedComparator<8>>;
+template class BPlusTreeInternalPage<NormalizedKey<16>, page_id_t, NormalizedComparator<16>>;
+template class BPlusTreeInternalPage<NormalizedKey<32>, page_id_t, NormalizedComparator<32>>;
+template class BPlusTreeInternalPage<NormalizedKey<64>, page_id_t, NormalizedComparator<64>>;
 }  // namespace bustub
@@ -9,11 +9,13 @@
 //
 //===----------------------------------------------------------------------===//
 
-// #include <cstring>
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 
 #include "common/exception.h"
 #include "common/rid.h"
+#include "storage/index/key_search.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -28,17 +30,23 @@ namespace bustub {
  * next page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size, bool compress_keys) {
   SetPageType(IndexPageType::LEAF_PAGE);
   SetPageId(page_id);
   SetSize(0);
   SetParentPageId(parent_id);
   SetMaxSize(max_size);
   SetNextPageId(INVALID_PAGE_ID);
+  SetPrevPageId(INVALID_PAGE_ID);
+  if (compress_keys) {
+    Rewrite(nullptr, 0);
+  } else {
+    DisableKeyCompression();
+  }
 }
 
 /**
- * Helper methods to set/get next page id
+ * Helper methods to set/get next and previous page id
  */
 INDEX_TEMPLATE_ARGUMENTS
 page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const { return next_page_id_; }
@@ -46,25 +54,36 @@ page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const { return next_page_i
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const { return prev_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
+
 /**
  * Helper method to find the first index i so that array[i].first >= key
  * NOTE: This method is only used when generating index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
+  using Search = KeySearch<KeyType, KeyComparator>;
+  if (Search::ENABLED && !IsKeyCompressed() && Search::Applies(comparator)) {
+    return Search::CountLess(reinterpret_cast<const char *>(array), sizeof(MappingType), GetSize(), key, false);
+  }
   int size = GetSize();
   int l = 0;
   int r = size - 1;
+  KeyType buffer;
   while (l < r) {
     int mid = (l + r) / 2;
-    if (comparator(array[mid].first, key) >= 0) {
+    if (comparator(KeyRef(mid, &buffer), key) >= 0) {
       r = mid;
     } else {
       l = mid + 1;
     }
   }
 
-  if ((l == (size - 1)) && (comparator(array[l].first, key) < 0)) {
+  if ((l == (size - 1)) && (comparator(KeyRef(l, &buffer), key) < 0)) {
     return size;
   }
   return l;
@@ -82,10 +101,8 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator
  */
 INDEX_TEMPLATE_ARGUMENTS
 KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  KeyType key{};
-  key = array[index].first;
-  return key;
+  KeyType buffer;
+  return KeyRef(index, &buffer);
 }
 
 /*
@@ -93,10 +110,163 @@ KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
  * "index"(a.k.a array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
-  // replace with your own code
+MappingType B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) const {
   // assert(0 <= index && index < GetSize());
-  return array[index];
+  if (!IsKeyCompressed()) {
+    return array[index];
+  }
+  MappingType item;
+  KeyEncoding encoding = GetKeyEncoding(sizeof(KeyType));
+  const char *slot = SlotAt(encoding, index);
+  DecodeKey(encoding, slot, reinterpret_cast<char *>(&item.first), sizeof(KeyType));
+  memcpy(&item.second, slot + encoding.end - encoding.prefix_size, sizeof(ValueType));
+  return item;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyItemsTo(int begin, std::vector<MappingType> *items) const {
+  int size = GetSize();
+  if (begin >= size) {
+    return;
+  }
+  if (!IsKeyCompressed()) {
+    items->insert(items->end(), array + begin, array + size);
+    return;
+  }
+  KeyEncoding encoding = GetKeyEncoding(sizeof(KeyType));
+  int slot_size = SlotSize(encoding, sizeof(ValueType));
+  const char *slot = SlotAt(encoding, begin);
+  items->resize(items->size() + size - begin);
+  for (auto item = items->end() - (size - begin); item != items->end(); ++item, slot += slot_size) {
+    DecodeKey(encoding, slot, reinterpret_cast<char *>(&item->first), sizeof(KeyType));
+    memcpy(&item->second, slot + encoding.end - encoding.prefix_size, sizeof(ValueType));
+  }
+}
+
+/*
+ * Helper methods for the max size of a page with compressed keys, which shrinks when the keys it holds have less
+ * bytes in common
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::MaxSizeWith(const KeyType &key) const {
+  if (!IsKeyCompressed()) {
+    return GetMaxSize();
+  }
+  KeyEncoding encoding = CurrentEncoding();
+  encoding.Add(reinterpret_cast<const char *>(&key), sizeof(KeyType));
+  return std::min(GetMaxSize(), KeyCapacity(encoding, LEAF_PAGE_HEADER_SIZE, sizeof(ValueType)));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::MaxSizeAfterMerge(const BPlusTreeLeafPage *other) const {
+  if (!IsKeyCompressed()) {
+    return GetMaxSize();
+  }
+  KeyEncoding encoding = CurrentEncoding();
+  encoding.Add(other->CurrentEncoding());
+  return std::min(GetMaxSize(), KeyCapacity(encoding, LEAF_PAGE_HEADER_SIZE, sizeof(ValueType)));
+}
+
+/*
+ * Helper methods for the slots, a page with full width keys keeps its items in array
+ */
+INDEX_TEMPLATE_ARGUMENTS
+const KeyType &B_PLUS_TREE_LEAF_PAGE_TYPE::KeyRef(int index, KeyType *buffer) const {
+  if (!IsKeyCompressed()) {
+    return array[index].first;
+  }
+  KeyEncoding encoding = GetKeyEncoding(sizeof(KeyType));
+  DecodeKey(encoding, SlotAt(encoding, index), reinterpret_cast<char *>(buffer), sizeof(KeyType));
+  return *buffer;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const char *B_PLUS_TREE_LEAF_PAGE_TYPE::SlotAt(const KeyEncoding &encoding, int index) const {
+  // an unlatched reader may see a size from another encoding, it must not read past the page
+  int capacity = KeyCapacity(encoding, LEAF_PAGE_HEADER_SIZE, sizeof(ValueType));
+  index = std::max(0, std::min(index, capacity - 1));
+  return reinterpret_cast<const char *>(array) + index * SlotSize(encoding, sizeof(ValueType));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+typename B_PLUS_TREE_LEAF_PAGE_TYPE::KeyEncoding B_PLUS_TREE_LEAF_PAGE_TYPE::CurrentEncoding() const {
+  KeyEncoding encoding;
+  if (GetSize() > 0) {
+    encoding = GetKeyEncoding(sizeof(KeyType));
+  }
+  return encoding;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<MappingType> B_PLUS_TREE_LEAF_PAGE_TYPE::ItemsBetween(int begin, int end) const {
+  std::vector<MappingType> items;
+  items.reserve(end - begin);
+  for (int i = begin; i < end; ++i) {
+    items.push_back(GetItem(i));
+  }
+  return items;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::InsertAt(int index, const KeyType &key, const ValueType &value) {
+  int size = GetSize();
+  if (!IsKeyCompressed()) {
+    for (int i = size; i > index; --i) {
+      array[i] = array[i - 1];
+    }
+    array[index] = {key, value};
+    IncreaseSize(1);
+    return;
+  }
+  KeyEncoding encoding = CurrentEncoding();
+  const char *key_data = reinterpret_cast<const char *>(&key);
+  if (size > 0 && KeyFits(encoding, key_data, sizeof(KeyType)) &&
+      size < KeyCapacity(encoding, LEAF_PAGE_HEADER_SIZE, sizeof(ValueType))) {
+    int slot_size = SlotSize(encoding, sizeof(ValueType));
+    char *slot = reinterpret_cast<char *>(array) + index * slot_size;
+    memmove(slot + slot_size, slot, (size - index) * slot_size);
+    EncodeKey(encoding, slot, key_data);
+    memcpy(slot + encoding.end - encoding.prefix_size, &value, sizeof(ValueType));
+    IncreaseSize(1);
+    return;
+  }
+  // the key needs a wider encoding
+  std::vector<MappingType> items = ItemsBetween(0, size);
+  items.insert(items.begin() + index, {key, value});
+  Rewrite(items.data(), size + 1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAt(int index) {
+  int size = GetSize();
+  if (!IsKeyCompressed()) {
+    for (int i = index + 1; i < size; ++i) {
+      array[i - 1] = array[i];
+    }
+  } else {
+    int slot_size = SlotSize(GetKeyEncoding(sizeof(KeyType)), sizeof(ValueType));
+    char *slot = reinterpret_cast<char *>(array) + index * slot_size;
+    memmove(slot, slot + slot_size, (size - index - 1) * slot_size);
+  }
+  IncreaseSize(-1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Rewrite(const MappingType *items, int size) {
+  KeyEncoding encoding;
+  for (int i = 0; i < size; ++i) {
+    encoding.Add(reinterpret_cast<const char *>(&items[i].first), sizeof(KeyType));
+  }
+  int capacity = KeyCapacity(encoding, LEAF_PAGE_HEADER_SIZE, sizeof(ValueType));
+  BUSTUB_ASSERT(size <= capacity, "the items do not fit in a leaf page");
+  SetKeyEncoding(encoding, capacity);
+  int slot_size = SlotSize(encoding, sizeof(ValueType));
+  char *slot = reinterpret_cast<char *>(array);
+  for (int i = 0; i < size; ++i, slot += slot_size) {
+    EncodeKey(encoding, slot, reinterpret_cast<const char *>(&items[i].first));
+    memcpy(slot + encoding.end - encoding.prefix_size, &items[i].second, sizeof(ValueType));
+  }
+  SetSize(size);
 }
 
 /*****************************************************************************
@@ -109,13 +279,8 @@ const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
   int index = KeyIndex(key, comparator);
-
-  IncreaseSize(1);
-  for (int i = GetSize() - 1; i > index; --i) {
-    array[i] = array[i - 1];
-  }
   // BUSTUB_ASSERT(index >= 0, "Insert failure!!!!!!");
-  array[index] = {key, value};
+  InsertAt(index, key, value);
   // std::cout << "insert the key " << key << "value is" << value << "at the index of " << index << std::endl;
   return GetSize();
 }
@@ -130,10 +295,19 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient, BufferPoolManager *buffer_pool_manager) {
   int old_size = GetSize();
   int mid_point = (old_size + 1) / 2;
-  recipient->CopyNFrom(&array[mid_point], old_size / 2);
-  SetSize((old_size + 1) / 2);
+  if (IsKeyCompressed()) {
+    // both halves get the encoding that fits their own keys
+    std::vector<MappingType> items = ItemsBetween(mid_point, old_size);
+    recipient->CopyNFrom(items.data(), old_size / 2);
+    items = ItemsBetween(0, mid_point);
+    Rewrite(items.data(), mid_point);
+  } else {
+    recipient->CopyNFrom(&array[mid_point], old_size / 2);
+    SetSize((old_size + 1) / 2);
+  }
   // setNextPageId放哪里再考虑下
   recipient->SetNextPageId(GetNextPageId());
+  recipient->SetPrevPageId(GetPageId());
   SetNextPageId(recipient->GetPageId());
 }
 
@@ -141,8 +315,14 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient, Buffer
  * Copy starting from items, and copy {size} number of elements into me.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(const MappingType *items, int size) {
   int old_size = GetSize();
+  if (IsKeyCompressed()) {
+    std::vector<MappingType> all_items = ItemsBetween(0, old_size);
+    all_items.insert(all_items.end(), items, items + size);
+    Rewrite(all_items.data(), old_size + size);
+    return;
+  }
   for (int i = 0; i < size; ++i) {
     array[i + old_size] = items[i];
   }
@@ -160,11 +340,24 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const {
+  using Search = KeySearch<KeyType, KeyComparator>;
+  if (Search::ENABLED && !IsKeyCompressed() && Search::Applies(comparator)) {
+    int index = Search::CountLess(reinterpret_cast<const char *>(array), sizeof(MappingType), GetSize(), key, false);
+    if (index < GetSize() && comparator(array[index].first, key) == 0) {
+      *value = array[index].second;
+      return true;
+    }
+    return false;
+  }
   int l = 0;
   int r = GetSize() - 1;
+  if (r < 0) {
+    return false;
+  }
   int mid = (l + r) / 2;
+  KeyType buffer;
   while (l < r) {
-    if (comparator(array[mid].first, key) >= 0) {
+    if (comparator(KeyRef(mid, &buffer), key) >= 0) {
       r = mid;
     } else {
       l = mid + 1;
@@ -172,9 +365,9 @@ bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, co
     mid = (l + r) / 2;
   }
   bool res = false;
-  if (comparator(array[mid].first, key) == 0) {
+  if (comparator(KeyRef(mid, &buffer), key) == 0) {
     res = true;
-    *value = array[mid].second;
+    *value = GetItem(mid).second;
   }
   return res;
   // for (int i = 0; i < GetSize(); ++i) {
@@ -205,21 +398,21 @@ INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) {
   int l = 0;
   int r = GetSize() - 1;
+  if (r < 0) {
+    return 0;
+  }
   int mid = (l + r) / 2;
+  KeyType buffer;
   while (l < r) {
-    if (comparator(array[mid].first, key) >= 0) {
+    if (comparator(KeyRef(mid, &buffer), key) >= 0) {
       r = mid;
     } else {
       l = mid + 1;
     }
     mid = (l + r) / 2;
   }
-  if (comparator(key, array[mid].first) == 0) {
-    for (int j = mid + 1; j < GetSize(); ++j) {
-      array[j - 1] = array[j];
-    }
-    // memmove(array + mid, array + mid + 1, sizeof(MappingType) * (GetSize() - mid - 1));
-    IncreaseSize(-1);
+  if (comparator(key, KeyRef(mid, &buffer)) == 0) {
+    RemoveAt(mid);
   }
 
   return GetSize();
@@ -234,7 +427,12 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
-  recipient->CopyNFrom(array, GetSize());
+  if (IsKeyCompressed()) {
+    std::vector<MappingType> items = ItemsBetween(0, GetSize());
+    recipient->CopyNFrom(items.data(), GetSize());
+  } else {
+    recipient->CopyNFrom(array, GetSize());
+  }
   IncreaseSize(-GetSize());
   recipient->SetNextPageId(GetNextPageId());
   // SetNextPageId(INVALID_PAGE_ID);
@@ -248,13 +446,8 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
-  recipient->CopyLastFrom(array[0]);
-  int size = GetSize() - 1;
-  // memmove(array, array + 1, sizeof(MappingType) * GetSize());
-  for (int i = 0; i < size; ++i) {
-    array[i] = array[i + 1];
-  }
-  IncreaseSize(-1);
+  recipient->CopyLastFrom(GetItem(0));
+  RemoveAt(0);
 }
 
 /*
@@ -262,8 +455,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient)
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
-  array[GetSize()] = item;
-  IncreaseSize(1);
+  InsertAt(GetSize(), item.first, item.second);
 }
 
 /*
@@ -271,7 +463,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
-  recipient->CopyFirstFrom(array[GetSize() - 1]);
+  recipient->CopyFirstFrom(GetItem(GetSize() - 1));
   IncreaseSize(-1);
 }
 
@@ -280,13 +472,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient)
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {
-  int size = GetSize();
-  // memmove(array + 1, array, sizeof(MappingType) * size);
-  for (int i = size; i > 0; --i) {
-    array[i] = array[i - 1];
-  }
-  array[0] = item;
-  IncreaseSize(1);
+  InsertAt(0, item.first, item.second);
 }
 
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
@@ -294,4 +480,10 @@ template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeLeafPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class BPlusTreeLeafPage<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class BPlusTreeLeafPage<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class BPlusTreeLeafPage<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTreeLeafPage<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTreeLeafPage<NormalizedKey<64>, RID, NormalizedComparator<64>>;
 }  // namespace bustub
@@ -9,6 +9,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
+
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
@@ -32,7 +35,12 @@ void BPlusTreePage::IncreaseSize(int amount) { size_ += amount; }
 /*
  * Helper methods to get/set max size (capacity) of the page
  */
-int BPlusTreePage::GetMaxSize() const { return max_size_; }
+int BPlusTreePage::GetMaxSize() const {
+  if (key_capacity_ > 0) {
+    return std::min(max_size_, key_capacity_);
+  }
+  return max_size_;
+}
 void BPlusTreePage::SetMaxSize(int size) { max_size_ = size; }
 
 /*
@@ -63,4 +71,107 @@ void BPlusTreePage::SetPageId(page_id_t page_id) { page_id_ = page_id; }
  */
 void BPlusTreePage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
 
+/*
+ * Helper methods for the optimistic lock coupling version
+ * Writers increase the version while holding the page's write latch, readers
+ * validate the version they started with after reading the page unlatched.
+ */
+uint32_t BPlusTreePage::GetVersion() const { return __atomic_load_n(&version_, __ATOMIC_ACQUIRE); }
+void BPlusTreePage::IncreaseVersion() { __atomic_fetch_add(&version_, 1, __ATOMIC_SEQ_CST); }
+bool BPlusTreePage::ValidateVersion(uint32_t version) const {
+  // the unlatched reads of the page must not move after the version check
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return __atomic_load_n(&version_, __ATOMIC_RELAXED) == version;
+}
+
+/*
+ * Helper methods for compressed keys
+ */
+bool BPlusTreePage::IsKeyCompressed() const { return key_capacity_ > 0; }
+int BPlusTreePage::GetKeyPrefixSize() const { return key_prefix_size_; }
+int BPlusTreePage::GetKeyEnd() const { return key_end_; }
+
+void BPlusTreePage::KeyEncoding::Add(const char *key, int key_size) {
+  int significant = key_size;
+  while (significant > 0 && key[significant - 1] == 0) {
+    significant--;
+  }
+  if (prefix_data == nullptr) {
+    prefix_data = key;
+    prefix_size = significant;
+    end = significant;
+    return;
+  }
+  int common = 0;
+  while (common < prefix_size && prefix_data[common] == key[common]) {
+    common++;
+  }
+  prefix_size = common;
+  end = std::max(end, significant);
+}
+
+void BPlusTreePage::KeyEncoding::Add(const KeyEncoding &other) {
+  if (other.prefix_data == nullptr) {
+    return;
+  }
+  if (prefix_data == nullptr) {
+    *this = other;
+    return;
+  }
+  int limit = std::min(prefix_size, other.prefix_size);
+  int common = 0;
+  while (common < limit && prefix_data[common] == other.prefix_data[common]) {
+    common++;
+  }
+  prefix_size = common;
+  end = std::max(end, other.end);
+}
+
+BPlusTreePage::KeyEncoding BPlusTreePage::GetKeyEncoding(int key_size) const {
+  KeyEncoding encoding;
+  encoding.end = std::min(static_cast<int>(key_end_), key_size);
+  encoding.prefix_size = std::min(static_cast<int>(key_prefix_size_), encoding.end);
+  encoding.prefix_data = reinterpret_cast<const char *>(this) + PAGE_SIZE - encoding.prefix_size;
+  return encoding;
+}
+
+void BPlusTreePage::SetKeyEncoding(const KeyEncoding &encoding, int capacity) {
+  // the prefix may be taken from the end of this page, it only ever gets shorter
+  if (encoding.prefix_size > 0) {
+    memmove(reinterpret_cast<char *>(this) + PAGE_SIZE - encoding.prefix_size, encoding.prefix_data,
+            encoding.prefix_size);
+  }
+  key_prefix_size_ = encoding.prefix_size;
+  key_end_ = encoding.end;
+  key_capacity_ = capacity;
+}
+
+void BPlusTreePage::DisableKeyCompression() {
+  key_prefix_size_ = 0;
+  key_end_ = 0;
+  key_capacity_ = 0;
+}
+
+bool BPlusTreePage::KeyFits(const KeyEncoding &encoding, const char *key, int key_size) {
+  if (memcmp(key, encoding.prefix_data, encoding.prefix_size) != 0) {
+    return false;
+  }
+  for (int i = encoding.end; i < key_size; ++i) {
+    if (key[i] != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void BPlusTreePage::DecodeKey(const KeyEncoding &encoding, const char *slot, char *key, int key_size) {
+  memcpy(key, encoding.prefix_data, encoding.prefix_size);
+  memcpy(key + encoding.prefix_size, slot, encoding.end - encoding.prefix_size);
+  memset(key + encoding.end, 0, key_size - encoding.end);
+}
+
+void BPlusTreePage::EncodeKey(const KeyEncoding &encoding, char *slot, const char *key) {
+  memcpy(slot, key + encoding.prefix_size, encoding.end - encoding.prefix_size);
+}
+
 }  // namespace bustub
@@ -0,0 +1,367 @@
+/**
+ * b_plus_tree_var_page.cpp
+ */
+#include <cstring>
+#include <string>
+
+#include "common/exception.h"
+#include "common/macros.h"
+#include "storage/page/b_plus_tree_var_page.h"
+
+namespace bustub {
+
+/*****************************************************************************
+ * SLOTTED PAGE
+ *****************************************************************************/
+template <typename ValueType>
+void BPlusTreeSlottedPage<ValueType>::InitSlots(page_id_t page_id, page_id_t parent_id, IndexPageType page_type) {
+  SetPageType(page_type);
+  SetPageId(page_id);
+  SetSize(0);
+  SetParentPageId(parent_id);
+  // the most entries a page can hold, all with empty keys
+  SetMaxSize(Capacity() / EntrySize(0));
+  DisableKeyCompression();
+  SetPrevPageId(INVALID_PAGE_ID);
+  SetNextPageId(INVALID_PAGE_ID);
+  heap_begin_ = PAGE_SIZE;
+  heap_garbage_ = 0;
+}
+
+template <typename ValueType>
+const char *BPlusTreeSlottedPage<ValueType>::KeyAt(int index) const {
+  return reinterpret_cast<const char *>(this) + slots_[index].offset_;
+}
+
+template <typename ValueType>
+uint32_t BPlusTreeSlottedPage<ValueType>::KeySizeAt(int index) const {
+  return slots_[index].size_;
+}
+
+template <typename ValueType>
+VarKey BPlusTreeSlottedPage<ValueType>::GetKey(int index) const {
+  return VarKey(KeyAt(index), KeySizeAt(index));
+}
+
+template <typename ValueType>
+ValueType BPlusTreeSlottedPage<ValueType>::ValueAt(int index) const {
+  return slots_[index].value_;
+}
+
+template <typename ValueType>
+void BPlusTreeSlottedPage<ValueType>::SetValueAt(int index, const ValueType &value) {
+  slots_[index].value_ = value;
+}
+
+template <typename ValueType>
+page_id_t BPlusTreeSlottedPage<ValueType>::GetNextPageId() const {
+  return next_page_id_;
+}
+
+template <typename ValueType>
+void BPlusTreeSlottedPage<ValueType>::SetNextPageId(page_id_t next_page_id) {
+  next_page_id_ = next_page_id;
+}
+
+template <typename ValueType>
+page_id_t BPlusTreeSlottedPage<ValueType>::GetPrevPageId() const {
+  return prev_page_id_;
+}
+
+template <typename ValueType>
+void BPlusTreeSlottedPage<ValueType>::SetPrevPageId(page_id_t prev_page_id) {
+  prev_page_id_ = prev_page_id;
+}
+
+template <typename ValueType>
+uint32_t BPlusTreeSlottedPage<ValueType>::GetUsedBytes() const {
+  return GetSize() * sizeof(Slot) + (PAGE_SIZE - heap_begin_ - heap_garbage_);
+}
+
+template <typename ValueType>
+void BPlusTreeSlottedPage<ValueType>::InsertAt(int index, const char *key, uint32_t key_size,
+                                               const ValueType &value) {
+  BUSTUB_ASSERT(HasRoomFor(key_size), "no room for the key in the slotted page");
+  const char *page = reinterpret_cast<const char *>(this);
+  std::string copy;
+  if (key >= page && key < page + PAGE_SIZE) {
+    // compacting the heap would move the key
+    copy.assign(key, key_size);
+    key = copy.data();
+  }
+  int size = GetSize();
+  if (heap_begin_ - key_size < VAR_PAGE_HEADER_SIZE + (size + 1) * sizeof(Slot)) {
+    Compact();
+  }
+  heap_begin_ -= key_size;
+  memcpy(reinterpret_cast<char *>(this) + heap_begin_, key, key_size);
+  memmove(&slots_[index + 1], &slots_[index], (size - index) * sizeof(Slot));
+  slots_[index].offset_ = heap_begin_;
+  slots_[index].size_ = key_size;
+  slots_[index].value_ = value;
+  IncreaseSize(1);
+}
+
+template <typename ValueType>
+void BPlusTreeSlottedPage<ValueType>::RemoveAt(int index) {
+  if (slots_[index].offset_ == heap_begin_) {
+    heap_begin_ += slots_[index].size_;
+  } else {
+    heap_garbage_ += slots_[index].size_;
+  }
+  memmove(&slots_[index], &slots_[index + 1], (GetSize() - index - 1) * sizeof(Slot));
+  IncreaseSize(-1);
+}
+
+template <typename ValueType>
+void BPlusTreeSlottedPage<ValueType>::SetKeyAt(int index, const char *key, uint32_t key_size) {
+  BUSTUB_ASSERT(HasRoomForKeyAt(index, key_size), "no room for the key in the slotted page");
+  const char *page = reinterpret_cast<const char *>(this);
+  std::string copy;
+  if (key >= page && key < page + PAGE_SIZE) {
+    copy.assign(key, key_size);
+    key = copy.data();
+  }
+  Slot &slot = slots_[index];
+  if (slot.offset_ == heap_begin_) {
+    heap_begin_ += slot.size_;
+  } else {
+    heap_garbage_ += slot.size_;
+  }
+  // the slot holds no key while the heap may be compacted
+  slot.offset_ = heap_begin_;
+  slot.size_ = 0;
+  if (heap_begin_ - key_size < VAR_PAGE_HEADER_SIZE + GetSize() * sizeof(Slot)) {
+    Compact();
+  }
+  heap_begin_ -= key_size;
+  memcpy(reinterpret_cast<char *>(this) + heap_begin_, key, key_size);
+  slot.offset_ = heap_begin_;
+  slot.size_ = key_size;
+}
+
+template <typename ValueType>
+void BPlusTreeSlottedPage<ValueType>::CopyRangeFrom(const BPlusTreeSlottedPage *other, int begin, int end) {
+  for (int i = begin; i < end; ++i) {
+    InsertAt(GetSize(), other->KeyAt(i), other->KeySizeAt(i), other->ValueAt(i));
+  }
+}
+
+template <typename ValueType>
+void BPlusTreeSlottedPage<ValueType>::Truncate(int size) {
+  while (GetSize() > size) {
+    RemoveAt(GetSize() - 1);
+  }
+}
+
+template <typename ValueType>
+int BPlusTreeSlottedPage<ValueType>::SplitPoint() const {
+  uint32_t half = GetUsedBytes() / 2;
+  uint32_t bytes = 0;
+  int index = 0;
+  while (index < GetSize() - 1 && bytes < half) {
+    bytes += EntrySize(KeySizeAt(index));
+    index++;
+  }
+  return std::max(index, 1);
+}
+
+template <typename ValueType>
+void BPlusTreeSlottedPage<ValueType>::Compact() {
+  char heap[PAGE_SIZE];
+  uint32_t end = PAGE_SIZE;
+  for (int i = 0; i < GetSize(); ++i) {
+    end -= slots_[i].size_;
+    memcpy(heap + end, KeyAt(i), slots_[i].size_);
+    slots_[i].offset_ = end;
+  }
+  memcpy(reinterpret_cast<char *>(this) + end, heap + end, PAGE_SIZE - end);
+  heap_begin_ = end;
+  heap_garbage_ = 0;
+}
+
+template class BPlusTreeSlottedPage<RID>;
+template class BPlusTreeSlottedPage<page_id_t>;
+
+/*****************************************************************************
+ * LEAF PAGE
+ *****************************************************************************/
+void BPlusTreeVarLeafPage::Init(page_id_t page_id, page_id_t parent_id) {
+  InitSlots(page_id, parent_id, IndexPageType::LEAF_PAGE);
+}
+
+int BPlusTreeVarLeafPage::KeyIndex(const char *key, const VarKeyComparator &comparator) const {
+  int l = 0;
+  int r = GetSize();
+  while (l < r) {
+    int mid = (l + r) / 2;
+    if (comparator(KeyAt(mid), key) < 0) {
+      l = mid + 1;
+    } else {
+      r = mid;
+    }
+  }
+  return l;
+}
+
+int BPlusTreeVarLeafPage::Insert(const VarKey &key, const RID &value, const VarKeyComparator &comparator) {
+  InsertAt(KeyIndex(key.GetData(), comparator), key.GetData(), key.GetSize(), value);
+  return GetSize();
+}
+
+bool BPlusTreeVarLeafPage::Lookup(const VarKey &key, RID *value, const VarKeyComparator &comparator) const {
+  int index = KeyIndex(key.GetData(), comparator);
+  if (index < GetSize() && comparator(KeyAt(index), key.GetData()) == 0) {
+    *value = ValueAt(index);
+    return true;
+  }
+  return false;
+}
+
+int BPlusTreeVarLeafPage::RemoveAndDeleteRecord(const VarKey &key, const VarKeyComparator &comparator) {
+  int index = KeyIndex(key.GetData(), comparator);
+  if (index < GetSize() && comparator(KeyAt(index), key.GetData()) == 0) {
+    RemoveAt(index);
+  }
+  return GetSize();
+}
+
+/*
+ * Moves the entries from the split point on to the empty recipient, which becomes the next leaf. The caller points
+ * the previous page id of the leaf after the recipient back at it.
+ */
+void BPlusTreeVarLeafPage::MoveHalfTo(BPlusTreeVarLeafPage *recipient) {
+  int split_point = SplitPoint();
+  recipient->CopyRangeFrom(this, split_point, GetSize());
+  Truncate(split_point);
+  recipient->SetNextPageId(GetNextPageId());
+  recipient->SetPrevPageId(GetPageId());
+  SetNextPageId(recipient->GetPageId());
+}
+
+/*
+ * Moves all entries to the recipient, the previous leaf, which takes over the next page id.
+ */
+void BPlusTreeVarLeafPage::MoveAllTo(BPlusTreeVarLeafPage *recipient) {
+  recipient->CopyRangeFrom(this, 0, GetSize());
+  recipient->SetNextPageId(GetNextPageId());
+  Truncate(0);
+}
+
+void BPlusTreeVarLeafPage::MoveFirstToEndOf(BPlusTreeVarLeafPage *recipient) {
+  recipient->InsertAt(recipient->GetSize(), KeyAt(0), KeySizeAt(0), ValueAt(0));
+  RemoveAt(0);
+}
+
+void BPlusTreeVarLeafPage::MoveLastToFrontOf(BPlusTreeVarLeafPage *recipient) {
+  int last = GetSize() - 1;
+  recipient->InsertAt(0, KeyAt(last), KeySizeAt(last), ValueAt(last));
+  RemoveAt(last);
+}
+
+/*****************************************************************************
+ * INTERNAL PAGE
+ *****************************************************************************/
+void BPlusTreeVarInternalPage::Init(page_id_t page_id, page_id_t parent_id) {
+  InitSlots(page_id, parent_id, IndexPageType::INTERNAL_PAGE);
+}
+
+int BPlusTreeVarInternalPage::ValueIndex(const page_id_t &value) const {
+  for (int i = 0; i < GetSize(); ++i) {
+    if (ValueAt(i) == value) {
+      return i;
+    }
+  }
+  return GetSize();
+}
+
+page_id_t BPlusTreeVarInternalPage::Lookup(const char *key, const VarKeyComparator &comparator) const {
+  // the first index i >= 1 with key < KeyAt(i), the child before it holds the key
+  int l = 1;
+  int r = GetSize();
+  while (l < r) {
+    int mid = (l + r) / 2;
+    if (comparator(key, KeyAt(mid)) < 0) {
+      r = mid;
+    } else {
+      l = mid + 1;
+    }
+  }
+  return ValueAt(l - 1);
+}
+
+void BPlusTreeVarInternalPage::PopulateNewRoot(const page_id_t &old_value, const VarKey &new_key,
+                                               const page_id_t &new_value) {
+  InsertAt(0, nullptr, 0, old_value);
+  InsertAt(1, new_key.GetData(), new_key.GetSize(), new_value);
+}
+
+int BPlusTreeVarInternalPage::InsertNodeAfter(const page_id_t &old_value, const VarKey &new_key,
+                                              const page_id_t &new_value) {
+  InsertAt(ValueIndex(old_value) + 1, new_key.GetData(), new_key.GetSize(), new_value);
+  return GetSize();
+}
+
+void BPlusTreeVarInternalPage::Remove(int index) { RemoveAt(index); }
+
+page_id_t BPlusTreeVarInternalPage::RemoveAndReturnOnlyChild() {
+  page_id_t child = ValueAt(0);
+  RemoveAt(0);
+  return child;
+}
+
+VarKey BPlusTreeVarInternalPage::MoveHalfTo(BPlusTreeVarInternalPage *recipient,
+                                            BufferPoolManager *buffer_pool_manager) {
+  int split_point = SplitPoint();
+  VarKey middle_key = GetKey(split_point);
+  recipient->CopyRangeFrom(this, split_point, GetSize());
+  recipient->BPlusTreeSlottedPage::SetKeyAt(0, nullptr, 0);
+  Truncate(split_point);
+  for (int i = 0; i < recipient->GetSize(); ++i) {
+    recipient->Adopt(recipient->ValueAt(i), buffer_pool_manager);
+  }
+  return middle_key;
+}
+
+void BPlusTreeVarInternalPage::MoveAllTo(BPlusTreeVarInternalPage *recipient, const VarKey &middle_key,
+                                         BufferPoolManager *buffer_pool_manager) {
+  int begin = recipient->GetSize();
+  recipient->InsertAt(begin, middle_key.GetData(), middle_key.GetSize(), ValueAt(0));
+  recipient->CopyRangeFrom(this, 1, GetSize());
+  for (int i = begin; i < recipient->GetSize(); ++i) {
+    recipient->Adopt(recipient->ValueAt(i), buffer_pool_manager);
+  }
+  Truncate(0);
+}
+
+VarKey BPlusTreeVarInternalPage::MoveFirstToEndOf(BPlusTreeVarInternalPage *recipient, const VarKey &middle_key,
+                                                  BufferPoolManager *buffer_pool_manager) {
+  recipient->InsertAt(recipient->GetSize(), middle_key.GetData(), middle_key.GetSize(), ValueAt(0));
+  recipient->Adopt(ValueAt(0), buffer_pool_manager);
+  VarKey separator = GetKey(1);
+  RemoveAt(0);
+  BPlusTreeSlottedPage::SetKeyAt(0, nullptr, 0);
+  return separator;
+}
+
+VarKey BPlusTreeVarInternalPage::MoveLastToFrontOf(BPlusTreeVarInternalPage *recipient, const VarKey &middle_key,
+                                                   BufferPoolManager *buffer_pool_manager) {
+  int last = GetSize() - 1;
+  VarKey separator = GetKey(last);
+  recipient->BPlusTreeSlottedPage::SetKeyAt(0, middle_key.GetData(), middle_key.GetSize());
+  recipient->InsertAt(0, nullptr, 0, ValueAt(last));
+  recipient->Adopt(ValueAt(last), buffer_pool_manager);
+  RemoveAt(last);
+  return separator;
+}
+
+void BPlusTreeVarInternalPage::Adopt(page_id_t child, BufferPoolManager *buffer_pool_manager) {
+  Page *page = buffer_pool_manager->FetchPage(child);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory while adopting a child page");
+  }
+  reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(GetPageId());
+  buffer_pool_manager->UnpinPage(child, true);
+}
+
+}  // namespace bustub
@@ -10,6 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 #include "storage/page/hash_table_block_page.h"
 #include "storage/index/generic_key.h"
 
@@ -17,33 +21,95 @@ namespace bustub {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 KeyType HASH_TABLE_BLOCK_TYPE::KeyAt(slot_offset_t bucket_ind) const {
-  return {};
+  return array_[bucket_ind].first;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 ValueType HASH_TABLE_BLOCK_TYPE::ValueAt(slot_offset_t bucket_ind) const {
-  return {};
+  return array_[bucket_ind].second;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-bool HASH_TABLE_BLOCK_TYPE::Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value) {
-  return false;
+bool HASH_TABLE_BLOCK_TYPE::Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value,
+                                   uint8_t fingerprint) {
+  static_assert(sizeof(HashTableBlockPage) + BLOCK_ARRAY_SIZE * sizeof(MappingType) <= PAGE_SIZE,
+                "block page does not fit in a page");
+  char mask = static_cast<char>(1 << (bucket_ind % 8));
+  // only the thread that flips the occupied bit writes the slot
+  if ((occupied_[bucket_ind / 8].fetch_or(mask) & mask) != 0) {
+    return false;
+  }
+  array_[bucket_ind] = MappingType(key, value);
+  fingerprints_[bucket_ind] = fingerprint;
+  readable_[bucket_ind / 8].fetch_or(mask);
+  return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BLOCK_TYPE::Remove(slot_offset_t bucket_ind) {}
+void HASH_TABLE_BLOCK_TYPE::Remove(slot_offset_t bucket_ind) {
+  readable_[bucket_ind / 8].fetch_and(static_cast<char>(~(1 << (bucket_ind % 8))));
+  fingerprints_[bucket_ind] = TOMBSTONE_FINGERPRINT;
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BLOCK_TYPE::IsOccupied(slot_offset_t bucket_ind) const {
-  return false;
+  return (occupied_[bucket_ind / 8] & (1 << (bucket_ind % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BLOCK_TYPE::IsReadable(slot_offset_t bucket_ind) const {
-  return false;
+  return (readable_[bucket_ind / 8] & (1 << (bucket_ind % 8))) != 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BLOCK_TYPE::Reuse(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value,
+                                  uint8_t fingerprint) {
+  if (!IsOccupied(bucket_ind) || IsReadable(bucket_ind)) {
+    return false;
+  }
+  array_[bucket_ind] = MappingType(key, value);
+  fingerprints_[bucket_ind] = fingerprint;
+  readable_[bucket_ind / 8].fetch_or(static_cast<char>(1 << (bucket_ind % 8)));
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_BLOCK_TYPE::MatchGroup(size_t group, uint8_t fingerprint) const {
+  static_assert(BLOCK_GROUP_SIZE == 32, "a group is one mask of 32 slots");
+  const uint8_t *fingerprints = &fingerprints_[group * BLOCK_GROUP_SIZE];
+  uint32_t mask = 0;
+  // free slots and tombstones are the fingerprints not greater than TOMBSTONE_FINGERPRINT
+#if defined(__AVX2__)
+  const __m256i needle = _mm256_set1_epi8(static_cast<char>(fingerprint));
+  const __m256i tombstone = _mm256_set1_epi8(TOMBSTONE_FINGERPRINT);
+  __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(fingerprints));
+  __m256i hits = _mm256_or_si256(_mm256_cmpeq_epi8(lanes, needle),
+                                 _mm256_cmpeq_epi8(_mm256_min_epu8(lanes, tombstone), lanes));
+  mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+#elif defined(__SSE2__)
+  const __m128i needle = _mm_set1_epi8(static_cast<char>(fingerprint));
+  const __m128i tombstone = _mm_set1_epi8(TOMBSTONE_FINGERPRINT);
+  for (int half = 0; half < 2; half++) {
+    __m128i lanes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fingerprints + 16 * half));
+    __m128i hits =
+        _mm_or_si128(_mm_cmpeq_epi8(lanes, needle), _mm_cmpeq_epi8(_mm_min_epu8(lanes, tombstone), lanes));
+    mask |= static_cast<uint32_t>(_mm_movemask_epi8(hits)) << (16 * half);
+  }
+#else
+  for (int i = 0; i < BLOCK_GROUP_SIZE; i++) {
+    if (fingerprints[i] == fingerprint || fingerprints[i] <= TOMBSTONE_FINGERPRINT) {
+      mask |= 1U << i;
+    }
+  }
+#endif
+  // the last group runs past the slots of the block
+  size_t end = BLOCK_ARRAY_SIZE - group * BLOCK_GROUP_SIZE;
+  if (end < BLOCK_GROUP_SIZE) {
+    mask &= (1U << end) - 1;
+  }
+  return mask;
 }
 
-// DO NOT REMOVE ANYTHING BELOW THIS LINE
 template class HashTableBlockPage<int, int, IntComparator>;
 template class HashTableBlockPage<GenericKey<4>, RID, GenericComparator<4>>;
 template class HashTableBlockPage<GenericKey<8>, RID, GenericComparator<8>>;
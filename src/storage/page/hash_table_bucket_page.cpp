@@ -0,0 +1,145 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_bucket_page.cpp
+//
+// Identification: src/storage/page/hash_table_bucket_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/hash_table_bucket_page.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::GetValue(const KeyType &key, KeyComparator cmp, std::vector<ValueType> *result) {
+  bool found = false;
+  for (slot_offset_t i = 0; i < BUCKET_ARRAY_SIZE && IsOccupied(i); i++) {
+    if (IsReadable(i) && cmp(array_[i].first, key) == 0) {
+      result->push_back(array_[i].second);
+      found = true;
+    }
+  }
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::Insert(const KeyType &key, const ValueType &value, KeyComparator cmp) {
+  slot_offset_t free_slot = BUCKET_ARRAY_SIZE;
+  for (slot_offset_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
+    if (!IsReadable(i)) {
+      if (free_slot == BUCKET_ARRAY_SIZE) {
+        free_slot = i;
+      }
+      if (!IsOccupied(i)) {
+        break;
+      }
+    } else if (cmp(array_[i].first, key) == 0 && array_[i].second == value) {
+      return false;
+    }
+  }
+  if (free_slot == BUCKET_ARRAY_SIZE) {
+    return false;
+  }
+  array_[free_slot] = MappingType(key, value);
+  occupied_[free_slot / 8] |= static_cast<char>(1 << (free_slot % 8));
+  readable_[free_slot / 8] |= static_cast<char>(1 << (free_slot % 8));
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::Remove(const KeyType &key, const ValueType &value, KeyComparator cmp) {
+  for (slot_offset_t i = 0; i < BUCKET_ARRAY_SIZE && IsOccupied(i); i++) {
+    if (IsReadable(i) && cmp(array_[i].first, key) == 0 && array_[i].second == value) {
+      RemoveAt(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::Contains(const KeyType &key, const ValueType &value, KeyComparator cmp) const {
+  for (slot_offset_t i = 0; i < BUCKET_ARRAY_SIZE && IsOccupied(i); i++) {
+    if (IsReadable(i) && cmp(array_[i].first, key) == 0 && array_[i].second == value) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+KeyType HASH_TABLE_BUCKET_TYPE::KeyAt(slot_offset_t bucket_ind) const {
+  return array_[bucket_ind].first;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ValueType HASH_TABLE_BUCKET_TYPE::ValueAt(slot_offset_t bucket_ind) const {
+  return array_[bucket_ind].second;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::RemoveAt(slot_offset_t bucket_ind) {
+  readable_[bucket_ind / 8] &= static_cast<char>(~(1 << (bucket_ind % 8)));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::IsOccupied(slot_offset_t bucket_ind) const {
+  return (occupied_[bucket_ind / 8] & (1 << (bucket_ind % 8))) != 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::IsReadable(slot_offset_t bucket_ind) const {
+  return (readable_[bucket_ind / 8] & (1 << (bucket_ind % 8))) != 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+slot_offset_t HASH_TABLE_BUCKET_TYPE::NumOccupied() const {
+  slot_offset_t i = 0;
+  while (i < BUCKET_ARRAY_SIZE && IsOccupied(i)) {
+    i++;
+  }
+  return i;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_BUCKET_TYPE::NumReadable() const {
+  uint32_t count = 0;
+  for (slot_offset_t i = 0; i < BUCKET_ARRAY_SIZE && IsOccupied(i); i++) {
+    count += IsReadable(i) ? 1 : 0;
+  }
+  return count;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::IsFull() const {
+  return NumReadable() == BUCKET_ARRAY_SIZE;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::IsEmpty() const {
+  return NumReadable() == 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+page_id_t HASH_TABLE_BUCKET_TYPE::GetOverflowPageId() const {
+  return overflow_page_id_;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::SetOverflowPageId(page_id_t overflow_page_id) {
+  overflow_page_id_ = overflow_page_id;
+}
+
+template class HashTableBucketPage<int, int, IntComparator>;
+template class HashTableBucketPage<GenericKey<4>, RID, GenericComparator<4>>;
+template class HashTableBucketPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class HashTableBucketPage<GenericKey<16>, RID, GenericComparator<16>>;
+template class HashTableBucketPage<GenericKey<32>, RID, GenericComparator<32>>;
+template class HashTableBucketPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
@@ -14,7 +14,13 @@
 #include <cstdio>
 #include <random>
 #include <string>
+#include <vector>
+#include "container/hash/extendible_hash_table.h"
+#include "container/hash/linear_probe_hash_table.h"
 #include "gtest/gtest.h"
+#include "recovery/log_manager.h"
+#include "storage/b_plus_tree_test_util.h"  // NOLINT
+#include "storage/index/b_plus_tree.h"
 
 namespace bustub {
 
@@ -146,4 +152,138 @@ TEST(BufferPoolManagerTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, WriteAheadLogTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *log_manager = new LogManager(disk_manager);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, log_manager);
+  enable_logging = true;
+
+  auto in_pool = [&](page_id_t page_id) {
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+      if (bpm->GetPages()[i].GetPageId() == page_id) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  page_id_t page_ids[3];
+  Page *pages[3];
+  for (int i = 0; i < 3; i++) {
+    pages[i] = bpm->NewPage(&page_ids[i]);
+    ASSERT_NE(nullptr, pages[i]);
+  }
+
+  // page 1 is covered by the persistent log, page 0 is not
+  LogRecord durable_record(0, INVALID_LSN, LogRecordType::BEGIN);
+  pages[1]->SetLSN(log_manager->AppendLogRecord(&durable_record));
+  log_manager->Flush();
+  LogRecord pending_record(0, durable_record.GetLSN(), LogRecordType::COMMIT);
+  pages[0]->SetLSN(log_manager->AppendLogRecord(&pending_record));
+  EXPECT_LT(log_manager->GetPersistentLSN(), pages[0]->GetLSN());
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[0], true));
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[1], true));
+
+  // Scenario: the least recently used page 0 needs a log flush, so the durable page 1 is evicted instead.
+  page_id_t page_id_temp;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_TRUE(in_pool(page_ids[0]));
+  EXPECT_FALSE(in_pool(page_ids[1]));
+  EXPECT_EQ(durable_record.GetLSN(), log_manager->GetPersistentLSN());
+
+  // Scenario: when page 0 is the only victim left, the log is flushed up to its LSN before it is written.
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_FALSE(in_pool(page_ids[0]));
+  EXPECT_EQ(pending_record.GetLSN(), log_manager->GetPersistentLSN());
+
+  // Scenario: flushing a page forces the log first.
+  LogRecord abort_record(1, INVALID_LSN, LogRecordType::ABORT);
+  pages[2]->SetLSN(log_manager->AppendLogRecord(&abort_record));
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[2], true));
+  EXPECT_TRUE(bpm->FlushPage(page_ids[2]));
+  EXPECT_EQ(abort_record.GetLSN(), log_manager->GetPersistentLSN());
+
+  enable_logging = false;
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, WriteAheadLogIndexPageTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *log_manager = new LogManager(disk_manager);
+  enable_logging = true;
+
+  // Scenario: index pages are not logged, whatever they keep at the LSN offset must not make their eviction wait
+  // for the log. There is no log record yet.
+  auto *bpm = new BufferPoolManager(8, disk_manager, log_manager);
+  page_id_t header_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&header_page_id));
+  EXPECT_TRUE(bpm->UnpinPage(header_page_id, true));
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+  auto *transaction = new Transaction(0);
+  GenericKey<8> index_key;
+  const int64_t num_keys = 5000;
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(0, static_cast<uint32_t>(key)), transaction);
+  }
+
+  // Scenario: a log record that is not flushed yet is not forced to disk by evicting index or hash table pages.
+  LogRecord pending_record(0, INVALID_LSN, LogRecordType::BEGIN);
+  log_manager->AppendLogRecord(&pending_record);
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < num_keys; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    tree.GetValue(index_key, &rids);
+    ASSERT_EQ(1, rids.size());
+    EXPECT_EQ(key, rids[0].GetSlotNum());
+  }
+  auto *hash_bpm = new BufferPoolManager(4, disk_manager, log_manager);
+  LinearProbeHashTable<int, int, IntComparator> linear("blah", hash_bpm, IntComparator(), 1000, HashFunction<int>());
+  ExtendibleHashTable<int, int, IntComparator> extendible("blah", hash_bpm, IntComparator(), HashFunction<int>());
+  for (int i = 0; i < 5000; i++) {
+    EXPECT_TRUE(linear.Insert(nullptr, i, i));
+    EXPECT_TRUE(extendible.Insert(nullptr, i, i));
+  }
+  std::vector<int> res;
+  for (int i = 0; i < 5000; i++) {
+    res.clear();
+    EXPECT_TRUE(linear.GetValue(nullptr, i, &res));
+    EXPECT_TRUE(extendible.GetValue(nullptr, i, &res));
+    EXPECT_EQ(2, res.size());
+  }
+  EXPECT_EQ(INVALID_LSN, log_manager->GetPersistentLSN());
+
+  // Scenario: flushing past the last appended record only flushes what is there.
+  log_manager->Flush(pending_record.GetLSN() + 10);
+  EXPECT_EQ(pending_record.GetLSN(), log_manager->GetPersistentLSN());
+  log_manager->Flush(pending_record.GetLSN() + 10);
+  EXPECT_EQ(pending_record.GetLSN(), log_manager->GetPersistentLSN());
+
+  enable_logging = false;
+  delete transaction;
+  delete key_schema;
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+
+  delete hash_bpm;
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+}
+
 }  // namespace bustub
@@ -0,0 +1,283 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table_test.cpp
+//
+// Identification: test/container/extendible_hash_table_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "container/hash/extendible_hash_table.h"
+#include "container/hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+#include "storage/b_plus_tree_test_util.h"  // NOLINT
+
+namespace bustub {
+
+TEST(ExtendibleHashTableTest, SampleTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // insert a few values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(1, res.size()) << "Failed to insert " << i << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // insert one more value for each key, duplicate values for the same key are not allowed
+  for (int i = 0; i < 5; i++) {
+    EXPECT_EQ(i != 0, ht.Insert(nullptr, i, 2 * i));
+    EXPECT_FALSE(ht.Insert(nullptr, i, 2 * i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(i == 0 ? 1 : 2, res.size());
+  }
+
+  // look for a key that does not exist
+  std::vector<int> res;
+  EXPECT_FALSE(ht.GetValue(nullptr, 20, &res));
+  EXPECT_EQ(0, res.size());
+
+  // delete some values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    EXPECT_FALSE(ht.Remove(nullptr, i, i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    if (i == 0) {
+      EXPECT_EQ(0, res.size());
+    } else {
+      EXPECT_EQ(1, res.size());
+      EXPECT_EQ(2 * i, res[0]);
+    }
+  }
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+  EXPECT_TRUE(ht.VerifyIntegrity());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(ExtendibleHashTableTest, SplitMergeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+  const int num_keys = 20000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  // a bucket holds a few hundred pairs
+  EXPECT_GT(ht.GetNumBuckets(), 20);
+  EXPECT_GE(1U << ht.GetGlobalDepth(), ht.GetNumBuckets());
+  EXPECT_TRUE(ht.VerifyIntegrity());
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // the buckets emptied by removes merge, down to a single one
+  for (int i = 0; i < num_keys; i++) {
+    if (i % 100 != 0) {
+      EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    }
+  }
+  EXPECT_TRUE(ht.VerifyIntegrity());
+  for (int i = 0; i < num_keys; i += 100) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  EXPECT_EQ(1, ht.GetNumBuckets());
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+  EXPECT_TRUE(ht.VerifyIntegrity());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(ExtendibleHashTableTest, DuplicateKeyTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  // far more values of one key than a bucket holds, no split can separate them
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+  const int num_values = 2000;
+  for (int i = 0; i < num_values; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, 7, i));
+  }
+  EXPECT_FALSE(ht.Insert(nullptr, 7, num_values / 2));
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+  // the other keys still split the bucket away from the overflow pages
+  for (int i = 0; i < num_values; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i + 100, i));
+  }
+  EXPECT_TRUE(ht.VerifyIntegrity());
+  std::vector<int> res;
+  EXPECT_TRUE(ht.GetValue(nullptr, 7, &res));
+  std::sort(res.begin(), res.end());
+  ASSERT_EQ(num_values, res.size());
+  for (int i = 0; i < num_values; i++) {
+    EXPECT_EQ(i, res[i]);
+  }
+
+  // the overflow pages go away again as they are emptied
+  for (int i = 0; i < num_values; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, 7, i));
+    EXPECT_TRUE(ht.Remove(nullptr, i + 100, i));
+  }
+  res.clear();
+  EXPECT_FALSE(ht.GetValue(nullptr, 7, &res));
+  EXPECT_EQ(1, ht.GetNumBuckets());
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+  EXPECT_TRUE(ht.VerifyIntegrity());
+
+  // a few dozen rids fill a bucket of 64 byte keys
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<64> comparator(key_schema);
+  ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>> wide_ht("foo_pk", bpm, comparator,
+                                                                            HashFunction<GenericKey<64>>());
+  GenericKey<64> index_key;
+  index_key.SetFromInteger(42);
+  for (int i = 0; i < 500; i++) {
+    EXPECT_TRUE(wide_ht.Insert(nullptr, index_key, RID(i, 0)));
+  }
+  std::vector<RID> rids;
+  EXPECT_TRUE(wide_ht.GetValue(nullptr, index_key, &rids));
+  EXPECT_EQ(500, rids.size());
+  EXPECT_TRUE(wide_ht.VerifyIntegrity());
+
+  delete key_schema;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(ExtendibleHashTableTest, ConcurrentTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(100, disk_manager);
+
+  // buckets split and merge while the other threads look up and remove their keys
+  ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>> ht("foo_pk", bpm, comparator,
+                                                                     HashFunction<GenericKey<8>>());
+  const int64_t num_keys = 20000;
+  std::atomic<int64_t> missing{0};
+  std::vector<std::thread> threads;
+  for (int64_t t = 0; t < 4; t++) {
+    threads.emplace_back([&, t] {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      for (int64_t key = t; key < num_keys; key += 4) {
+        index_key.SetFromInteger(key);
+        ht.Insert(nullptr, index_key, RID(0, static_cast<uint32_t>(key)));
+        rids.clear();
+        if (!ht.GetValue(nullptr, index_key, &rids)) {
+          missing++;
+        }
+      }
+      for (int64_t key = t; key < num_keys; key += 4) {
+        if (key % 3 != 0) {
+          index_key.SetFromInteger(key);
+          if (!ht.Remove(nullptr, index_key, RID(0, static_cast<uint32_t>(key)))) {
+            missing++;
+          }
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(missing, 0);
+  EXPECT_TRUE(ht.VerifyIntegrity());
+
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < num_keys; key++) {
+    std::vector<RID> rids;
+    index_key.SetFromInteger(key);
+    ASSERT_EQ(ht.GetValue(nullptr, index_key, &rids), key % 3 == 0);
+    if (key % 3 == 0) {
+      ASSERT_EQ(1, rids.size());
+      EXPECT_EQ(key, rids[0].GetSlotNum());
+    }
+  }
+
+  delete key_schema;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+/**
+ * Inserts num_keys keys into table one by one. Returns the slowest insert in microseconds, and the inserts per
+ * second in rate.
+ */
+template <typename TableType>
+double InsertLatency(TableType *table, int64_t num_keys, double *rate) {
+  GenericKey<8> index_key;
+  double slowest = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key);
+    auto insert_start = std::chrono::steady_clock::now();
+    table->Insert(nullptr, index_key, RID(0, static_cast<uint32_t>(key)));
+    auto insert_end = std::chrono::steady_clock::now();
+    slowest = std::max(slowest, std::chrono::duration<double, std::micro>(insert_end - insert_start).count());
+  }
+  double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  *rate = num_keys / ms * 1000;
+  return slowest;
+}
+
+TEST(ExtendibleHashTableTest, DISABLED_BenchmarkTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(2000, disk_manager);
+  const int64_t num_keys = 60000;
+
+  // both tables start small and grow with the inserts
+  double slowest[2];
+  double rate[2];
+  LinearProbeHashTable<GenericKey<8>, RID, GenericComparator<8>> linear("foo_linear", bpm, comparator, 1000,
+                                                                          HashFunction<GenericKey<8>>());
+  slowest[0] = InsertLatency(&linear, num_keys, &rate[0]);
+  ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>> extendible("foo_extendible", bpm, comparator,
+                                                                             HashFunction<GenericKey<8>>());
+  slowest[1] = InsertLatency(&extendible, num_keys, &rate[1]);
+  EXPECT_TRUE(extendible.VerifyIntegrity());
+  printf("%ld inserts into a growing table: linear probing %.0f/s (slowest %.0f us), extendible %.0f/s (slowest %.0f "
+         "us)\n",
+         num_keys, rate[0], slowest[0], rate[1], slowest[1]);
+
+  delete key_schema;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+}  // namespace bustub
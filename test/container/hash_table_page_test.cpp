@@ -23,7 +23,7 @@
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_HeaderPageSampleTest) {
+TEST(HashTablePageTest, HeaderPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(5, disk_manager);
 
@@ -61,7 +61,7 @@ TEST(HashTablePageTest, DISABLED_HeaderPageSampleTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_BlockPageSampleTest) {
+TEST(HashTablePageTest, BlockPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(5, disk_manager);
 
@@ -73,7 +73,7 @@ TEST(HashTablePageTest, DISABLED_BlockPageSampleTest) {
 
   // insert a few (key, value) pairs
   for (unsigned i = 0; i < 10; i++) {
-    block_page->Insert(i, i, i);
+    block_page->Insert(i, i, i, HashTableBlockPage<int, int, IntComparator>::Fingerprint(i));
   }
 
   // check for the inserted pairs
@@ -111,4 +111,51 @@ TEST(HashTablePageTest, DISABLED_BlockPageSampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, BlockPageFingerprintTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(5, disk_manager);
+
+  // the key and value types BLOCK_ARRAY_SIZE is taken for
+  using KeyType = int;
+  using ValueType = int;
+  using BlockPage = HashTableBlockPage<KeyType, ValueType, IntComparator>;
+  page_id_t block_page_id = INVALID_PAGE_ID;
+  auto block_page = reinterpret_cast<BlockPage *>(bpm->NewPage(&block_page_id, nullptr)->GetData());
+
+  // no key has the fingerprint of a free slot or a tombstone
+  for (uint64_t hash : {0UL, 1UL, ~0UL, 1UL << 57}) {
+    EXPECT_GT(BlockPage::Fingerprint(hash), BlockPage::TOMBSTONE_FINGERPRINT);
+  }
+  uint8_t fingerprint = BlockPage::Fingerprint(0);
+  uint8_t other = BlockPage::Fingerprint(~0UL);
+
+  // a brand new block matches every slot, up to the end of the last group
+  size_t num_groups = (BLOCK_ARRAY_SIZE - 1) / BLOCK_GROUP_SIZE + 1;
+  EXPECT_EQ(~0U, block_page->MatchGroup(0, fingerprint));
+  size_t last = BLOCK_ARRAY_SIZE - (num_groups - 1) * BLOCK_GROUP_SIZE;
+  EXPECT_EQ(last == 32 ? ~0U : (1U << last) - 1, block_page->MatchGroup(num_groups - 1, fingerprint));
+
+  // the first group holds keys of either fingerprint, and a tombstone
+  for (unsigned i = 0; i < BLOCK_GROUP_SIZE; i++) {
+    EXPECT_TRUE(block_page->Insert(i, i, i, i % 2 == 0 ? fingerprint : other));
+  }
+  block_page->Remove(1);
+  EXPECT_EQ(0x55555557U, block_page->MatchGroup(0, fingerprint));
+  EXPECT_EQ(0xaaaaaaaaU, block_page->MatchGroup(0, other));
+  EXPECT_TRUE(block_page->Reuse(1, 1, 1, fingerprint));
+  EXPECT_EQ(0x55555557U, block_page->MatchGroup(0, fingerprint));
+  EXPECT_EQ(0xaaaaaaa8U, block_page->MatchGroup(0, other));
+
+  // the next group has its first slot taken
+  EXPECT_TRUE(block_page->Insert(BLOCK_GROUP_SIZE, 0, 0, other));
+  EXPECT_EQ(~1U, block_page->MatchGroup(1, fingerprint));
+
+  bpm->UnpinPage(block_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -10,6 +10,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <random>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -17,11 +22,13 @@
 #include "container/hash/linear_probe_hash_table.h"
 #include "gtest/gtest.h"
 #include "murmur3/MurmurHash3.h"
+#include "storage/b_plus_tree_test_util.h"  // NOLINT
+#include "storage/index/b_plus_tree.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(HashTableTest, DISABLED_SampleTest) {
+TEST(HashTableTest, SampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(50, disk_manager);
 
@@ -104,4 +111,156 @@ TEST(HashTableTest, DISABLED_SampleTest) {
   delete bpm;
 }
 
+TEST(HashTableTest, ResizeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  // a single block to start with, the table grows several times
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 10, HashFunction<int>());
+  size_t initial_size = ht.GetSize();
+  const int num_keys = 5000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  EXPECT_GE(ht.GetSize(), 8 * initial_size);
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // the tombstones left by removes take pairs again without growing the table
+  size_t size = ht.GetSize();
+  for (int round = 0; round < 5; round++) {
+    for (int i = 0; i < num_keys; i += 2) {
+      EXPECT_TRUE(ht.Remove(nullptr, i, i + round));
+      EXPECT_FALSE(ht.Remove(nullptr, i, i + round));
+    }
+    for (int i = 0; i < num_keys; i += 2) {
+      EXPECT_TRUE(ht.Insert(nullptr, i, i + round + 1));
+    }
+  }
+  EXPECT_EQ(size, ht.GetSize());
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(i % 2 == 0 ? i + 5 : i, res[0]);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(HashTableTest, ConcurrentTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(100, disk_manager);
+
+  // the inserts resize the table while the other threads probe it
+  LinearProbeHashTable<GenericKey<8>, RID, GenericComparator<8>> ht("foo_pk", bpm, comparator, 100,
+                                                                      HashFunction<GenericKey<8>>());
+  const int64_t num_keys = 20000;
+  std::atomic<int64_t> missing{0};
+  std::vector<std::thread> threads;
+  for (int64_t t = 0; t < 4; t++) {
+    threads.emplace_back([&, t] {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      for (int64_t key = t; key < num_keys; key += 4) {
+        index_key.SetFromInteger(key);
+        ht.Insert(nullptr, index_key, RID(0, static_cast<uint32_t>(key)));
+        rids.clear();
+        if (!ht.GetValue(nullptr, index_key, &rids)) {
+          missing++;
+        }
+      }
+      for (int64_t key = t; key < num_keys; key += 4) {
+        if (key % 3 != 0) {
+          index_key.SetFromInteger(key);
+          if (!ht.Remove(nullptr, index_key, RID(0, static_cast<uint32_t>(key)))) {
+            missing++;
+          }
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(missing, 0);
+
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < num_keys; key++) {
+    std::vector<RID> rids;
+    index_key.SetFromInteger(key);
+    ASSERT_EQ(ht.GetValue(nullptr, index_key, &rids), key % 3 == 0);
+    if (key % 3 == 0) {
+      ASSERT_EQ(1, rids.size());
+      EXPECT_EQ(key, rids[0].GetSlotNum());
+    }
+  }
+
+  delete key_schema;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(HashTableTest, DISABLED_BenchmarkTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(2000, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  Transaction transaction(0);
+
+  const int64_t num_keys = 100000;
+  const int num_lookups = 200000;
+  // both indexes fit in the buffer pool, the hash table is about half full
+  LinearProbeHashTable<GenericKey<8>, RID, GenericComparator<8>> ht("foo_hash", bpm, comparator, 2 * num_keys,
+                                                                      HashFunction<GenericKey<8>>());
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key);
+    ht.Insert(nullptr, index_key, RID(0, static_cast<uint32_t>(key)));
+    tree.Insert(index_key, RID(0, static_cast<uint32_t>(key)), &transaction);
+  }
+
+  double rate[2];
+  for (int i = 0; i < 2; i++) {
+    std::mt19937_64 rng(15445);
+    std::vector<RID> rids;
+    int64_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int lookup = 0; lookup < num_lookups; lookup++) {
+      index_key.SetFromInteger(static_cast<int64_t>(rng() % num_keys));
+      rids.clear();
+      bool hit = i == 0 ? ht.GetValue(nullptr, index_key, &rids) : tree.GetValue(index_key, &rids);
+      found += hit ? 1 : 0;
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(found, num_lookups);
+    rate[i] = num_lookups / ms * 1000;
+  }
+  printf("%d point lookups over %ld keys: linear probe hash table %.0f/s, B+ tree %.0f/s\n", num_lookups, num_keys,
+         rate[0], rate[1]);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
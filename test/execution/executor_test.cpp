@@ -13,12 +13,17 @@
 #include <cstdio>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "execution/plans/delete_plan.h"
+#include "execution/plans/hash_index_lookup_plan.h"
+#include "execution/plans/index_scan_plan.h"
 #include "execution/plans/limit_plan.h"
+#include "execution/plans/nested_index_join_plan.h"
+#include "execution/plans/update_plan.h"
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/table_generator.h"
@@ -437,6 +442,386 @@ TEST_F(ExecutorTest, SimpleNestedLoopJoinTest) {
   }
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SimpleNestedIndexJoinTest) {
+  // SELECT test_1.colA, test_1.colB, test_3.col1, test_3.col3 FROM test_1 JOIN test_3 ON test_1.colA = test_3.col1
+  std::unique_ptr<AbstractPlanNode> scan_plan1;
+  const Schema *out_schema1;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    out_schema1 = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+    scan_plan1 = std::make_unique<SeqScanPlanNode>(out_schema1, nullptr, table_info->oid_);
+  }
+  const Schema *out_schema2;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_3");
+    auto &schema = table_info->schema_;
+    auto col1 = MakeColumnValueExpression(schema, 0, "col1");
+    auto col3 = MakeColumnValueExpression(schema, 0, "col3");
+    out_schema2 = MakeOutputSchema({{"col1", col1}, {"col3", col3}});
+  }
+  Schema *key_schema = ParseCreateStatement("a int");
+  auto inner_table_info = GetExecutorContext()->GetCatalog()->GetTable("test_3");
+  auto index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index1", "test_3", inner_table_info->schema_, *key_schema, {0}, 8);
+
+  // colA and colB have a tuple index of 0 because they are the left side of the join
+  auto colA = MakeColumnValueExpression(*out_schema1, 0, "colA");
+  auto colB = MakeColumnValueExpression(*out_schema1, 0, "colB");
+  // col1 and col2 have a tuple index of 1 because they are the right side of the join
+  auto col1 = MakeColumnValueExpression(*out_schema2, 1, "col1");
+  auto col3 = MakeColumnValueExpression(*out_schema2, 1, "col3");
+  auto predicate = MakeComparisonExpression(colA, col1, ComparisonType::Equal);
+  const Schema *out_final = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"col1", col1}, {"col3", col3}});
+
+  // every batch size returns the matches in the order of the outer table
+  for (size_t batch_size : {static_cast<size_t>(1), static_cast<size_t>(7), INDEX_JOIN_BATCH_SIZE}) {
+    NestedIndexJoinPlanNode join_plan(out_final, std::vector<const AbstractPlanNode *>{scan_plan1.get()}, predicate,
+                                      inner_table_info->oid_, index_info->name_, out_schema1, out_schema2,
+                                      batch_size);
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(result_set.size(), 100);
+    for (size_t i = 0; i < result_set.size(); i++) {
+      ASSERT_EQ(result_set[i].GetValue(out_final, out_final->GetColIdx("colA")).GetAs<int32_t>(), i);
+      ASSERT_EQ(result_set[i].GetValue(out_final, out_final->GetColIdx("col1")).GetAs<int32_t>(), i);
+    }
+  }
+
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, IndexRangeScanTest) {
+  // SELECT colA, colB FROM test_1 WHERE colA BETWEEN 200 AND 299 AND colA <> 250
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  Schema *key_schema = ParseCreateStatement("a int");
+  auto index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index1", "test_1", table_info->schema_, *key_schema, {0}, 8);
+
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  auto *key_a = MakeColumnValueExpression(*key_schema, 0, "a");
+  auto *const250 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(250));
+  auto *key_predicate = MakeComparisonExpression(key_a, const250, ComparisonType::NotEqual);
+  Tuple lower_key({ValueFactory::GetIntegerValue(200)}, key_schema);
+  Tuple upper_key({ValueFactory::GetIntegerValue(299)}, key_schema);
+
+  // both bounds are inclusive and the keys come in index order
+  IndexScanPlanNode range_plan{out_schema, nullptr, index_info->index_oid_, &lower_key, &upper_key, key_predicate};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&range_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 99);
+  int32_t expected = 200;
+  for (const auto &tuple : result_set) {
+    if (expected == 250) {
+      expected++;
+    }
+    ASSERT_EQ(tuple.GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), expected++);
+  }
+
+  // ORDER BY colA DESC walks the same range backward
+  IndexScanPlanNode desc_plan{out_schema, nullptr, index_info->index_oid_, &lower_key, &upper_key, key_predicate,
+                              true};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&desc_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 99);
+  expected = 299;
+  for (const auto &tuple : result_set) {
+    if (expected == 250) {
+      expected--;
+    }
+    ASSERT_EQ(tuple.GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), expected--);
+  }
+
+  // open ended ranges, the scan also stops early and leaves no leaf latched behind
+  IndexScanPlanNode lower_plan{out_schema, nullptr, index_info->index_oid_, &upper_key};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&lower_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), TEST1_SIZE - 299);
+  ASSERT_EQ(result_set[0].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), 299);
+
+  IndexScanPlanNode upper_plan{out_schema, nullptr, index_info->index_oid_, nullptr, &lower_key};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&upper_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 201);
+
+  IndexScanPlanNode last_plan{out_schema, nullptr, index_info->index_oid_, nullptr, nullptr, nullptr, true};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&last_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), TEST1_SIZE);
+  ASSERT_EQ(result_set[0].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), TEST1_SIZE - 1);
+
+  // a key predicate alone still filters before the heap is read
+  IndexScanPlanNode filter_plan{out_schema, nullptr, index_info->index_oid_, nullptr, nullptr, key_predicate};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&filter_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), TEST1_SIZE - 1);
+
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, CoveringIndexScanTest) {
+  // SELECT colA, colB FROM test_1 WHERE colA BETWEEN 200 AND 399 AND colB = 5, answered from an index on colA
+  // that includes colB, against the same scan over an index on colA alone
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  Schema *key_schema = ParseCreateStatement("a int");
+  auto covering_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "covering_index", "test_1", schema, *key_schema, {0}, 8, true, {1});
+  auto index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index1", "test_1", schema, *key_schema, {0}, 8);
+  ASSERT_EQ(covering_info->index_->GetEntryAttrs(), std::vector<uint32_t>({0, 1}));
+
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *colC = MakeColumnValueExpression(schema, 0, "colC");
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  auto *const5 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(5));
+  auto *predicate = MakeComparisonExpression(colB, const5, ComparisonType::Equal);
+  Tuple lower_key({ValueFactory::GetIntegerValue(200)}, key_schema);
+  Tuple upper_key({ValueFactory::GetIntegerValue(399)}, key_schema);
+
+  auto scan = [&](const Schema *output, const IndexInfo *info) {
+    IndexScanPlanNode plan{output, predicate, info->index_oid_, &lower_key, &upper_key};
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+    return result_set;
+  };
+  auto covered = scan(out_schema, covering_info);
+  auto fetched = scan(out_schema, index_info);
+  ASSERT_FALSE(covered.empty());
+  ASSERT_EQ(covered.size(), fetched.size());
+  for (size_t i = 0; i < covered.size(); i++) {
+    for (uint32_t col = 0; col < out_schema->GetColumnCount(); col++) {
+      ASSERT_EQ(covered[i].GetValue(out_schema, col).GetAs<int32_t>(),
+                fetched[i].GetValue(out_schema, col).GetAs<int32_t>());
+    }
+    ASSERT_EQ(covered[i].GetValue(out_schema, 1).GetAs<int32_t>(), 5);
+  }
+
+  // a column outside the entries is fetched from the table
+  auto *wide_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colC", colC}});
+  auto wide_covered = scan(wide_schema, covering_info);
+  auto wide_fetched = scan(wide_schema, index_info);
+  ASSERT_EQ(wide_covered.size(), covered.size());
+  for (size_t i = 0; i < wide_covered.size(); i++) {
+    ASSERT_EQ(wide_covered[i].GetValue(wide_schema, 2).GetAs<int32_t>(),
+              wide_fetched[i].GetValue(wide_schema, 2).GetAs<int32_t>());
+  }
+
+  // inserted tuples carry their included column into the index
+  std::vector<std::vector<Value>> raw_vals{
+      {ValueFactory::GetIntegerValue(TEST1_SIZE), ValueFactory::GetIntegerValue(5), ValueFactory::GetIntegerValue(0),
+       ValueFactory::GetIntegerValue(0)}};
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+  Tuple last_key({ValueFactory::GetIntegerValue(TEST1_SIZE)}, key_schema);
+  IndexScanPlanNode last_plan{out_schema, nullptr, covering_info->index_oid_, &last_key};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&last_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 1);
+  ASSERT_EQ(result_set[0].GetValue(out_schema, 1).GetAs<int32_t>(), 5);
+
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, CoveringIndexUpdateTest) {
+  // UPDATE test_1 SET colB = 42 WHERE colA = 250, then the included colB is read back from the index entries
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  Schema *key_schema = ParseCreateStatement("a int");
+  auto covering_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "covering_index", "test_1", schema, *key_schema, {0}, 8, true, {1});
+
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *colC = MakeColumnValueExpression(schema, 0, "colC");
+  auto *colD = MakeColumnValueExpression(schema, 0, "colD");
+  auto *row_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colC", colC}, {"colD", colD}});
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  auto update = [&](int32_t col_a, uint32_t col, UpdateType type, int value) {
+    auto *predicate = MakeComparisonExpression(colA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(col_a)),
+                                               ComparisonType::Equal);
+    SeqScanPlanNode scan_plan{row_schema, predicate, table_info->oid_};
+    std::unordered_map<uint32_t, UpdateInfo> update_attrs;
+    update_attrs.insert(std::make_pair(col, UpdateInfo(type, value)));
+    UpdatePlanNode update_plan{&scan_plan, table_info->oid_, update_attrs};
+    GetExecutionEngine()->Execute(&update_plan, nullptr, GetTxn(), GetExecutorContext());
+  };
+  auto lookup = [&](int32_t col_a) {
+    Tuple key({ValueFactory::GetIntegerValue(col_a)}, key_schema);
+    IndexScanPlanNode plan{out_schema, nullptr, covering_info->index_oid_, &key, &key};
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+    return result_set;
+  };
+
+  update(250, 1, UpdateType::Set, 42);
+  auto result_set = lookup(250);
+  ASSERT_EQ(result_set.size(), 1);
+  ASSERT_EQ(result_set[0].GetValue(out_schema, 1).GetAs<int32_t>(), 42);
+
+  // a changed key moves the entry
+  update(260, 0, UpdateType::Add, 100000);
+  ASSERT_TRUE(lookup(260).empty());
+  ASSERT_EQ(lookup(100260).size(), 1);
+
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, CoveringIndexAbortTest) {
+  // writes of aborted transactions leave no entries behind for a covering scan to return
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  Schema *key_schema = ParseCreateStatement("a int");
+  auto covering_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "covering_index", "test_1", schema, *key_schema, {0}, 8, true, {1});
+
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *colC = MakeColumnValueExpression(schema, 0, "colC");
+  auto *colD = MakeColumnValueExpression(schema, 0, "colD");
+  auto *row_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colC", colC}, {"colD", colD}});
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  auto lookup = [&](int32_t col_a, Transaction *txn, ExecutorContext *exec_ctx) {
+    Tuple key({ValueFactory::GetIntegerValue(col_a)}, key_schema);
+    IndexScanPlanNode plan{out_schema, nullptr, covering_info->index_oid_, &key, &key};
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&plan, &result_set, txn, exec_ctx);
+    return result_set;
+  };
+  auto run_and_abort = [&](const AbstractPlanNode *plan, int32_t col_a) {
+    auto txn = GetTxnManager()->Begin();
+    auto exec_ctx = std::make_unique<ExecutorContext>(txn, GetCatalog(), GetBPM(), GetTxnManager(), GetLockManager());
+    GetExecutionEngine()->Execute(plan, nullptr, txn, exec_ctx.get());
+    auto result_set = lookup(col_a, txn, exec_ctx.get());
+    GetTxnManager()->Abort(txn);
+    delete txn;
+    return result_set;
+  };
+
+  std::vector<std::vector<Value>> raw_vals{
+      {ValueFactory::GetIntegerValue(TEST1_SIZE), ValueFactory::GetIntegerValue(5), ValueFactory::GetIntegerValue(0),
+       ValueFactory::GetIntegerValue(0)}};
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  ASSERT_EQ(run_and_abort(&insert_plan, TEST1_SIZE).size(), 1);
+  ASSERT_TRUE(lookup(TEST1_SIZE, GetTxn(), GetExecutorContext()).empty());
+
+  auto *predicate = MakeComparisonExpression(colA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(250)),
+                                             ComparisonType::Equal);
+  SeqScanPlanNode scan_plan{row_schema, predicate, table_info->oid_};
+  int32_t col_b = lookup(250, GetTxn(), GetExecutorContext())[0].GetValue(out_schema, 1).GetAs<int32_t>();
+  std::unordered_map<uint32_t, UpdateInfo> update_attrs;
+  update_attrs.insert(std::make_pair(1, UpdateInfo(UpdateType::Add, 100)));
+  UpdatePlanNode update_plan{&scan_plan, table_info->oid_, update_attrs};
+  auto updated = run_and_abort(&update_plan, 250);
+  ASSERT_EQ(updated.size(), 1);
+  ASSERT_EQ(updated[0].GetValue(out_schema, 1).GetAs<int32_t>(), col_b + 100);
+  auto result_set = lookup(250, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 1);
+  ASSERT_EQ(result_set[0].GetValue(out_schema, 1).GetAs<int32_t>(), col_b);
+
+  DeletePlanNode delete_plan{&scan_plan, table_info->oid_};
+  ASSERT_TRUE(run_and_abort(&delete_plan, 250).empty());
+  ASSERT_EQ(lookup(250, GetTxn(), GetExecutorContext()).size(), 1);
+
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, HashIndexLookupTest) {
+  // SELECT colA, colB FROM test_1 WHERE colA = 250, answered from a hash index on colA
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  Schema *key_schema = ParseCreateStatement("a int");
+  auto index_info = GetExecutorContext()->GetCatalog()->CreateHashIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "hash_index", "test_1", schema, *key_schema, {0}, 8, 2 * TEST1_SIZE);
+
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  Tuple key({ValueFactory::GetIntegerValue(250)}, key_schema);
+  HashIndexLookupPlanNode lookup_plan{out_schema, nullptr, index_info->index_oid_, &key};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&lookup_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 1);
+  ASSERT_EQ(result_set[0].GetValue(out_schema, 0).GetAs<int32_t>(), 250);
+  int32_t col_b = result_set[0].GetValue(out_schema, 1).GetAs<int32_t>();
+
+  // the predicate filters the found tuples
+  auto *const_b = MakeConstantValueExpression(ValueFactory::GetIntegerValue(col_b));
+  auto *predicate = MakeComparisonExpression(colB, const_b, ComparisonType::NotEqual);
+  HashIndexLookupPlanNode filter_plan{out_schema, predicate, index_info->index_oid_, &key};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&filter_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 0);
+
+  // inserted tuples are found, missing keys are not
+  Tuple new_key({ValueFactory::GetIntegerValue(TEST1_SIZE)}, key_schema);
+  HashIndexLookupPlanNode new_plan{out_schema, nullptr, index_info->index_oid_, &new_key};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&new_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 0);
+  std::vector<std::vector<Value>> raw_vals{
+      {ValueFactory::GetIntegerValue(TEST1_SIZE), ValueFactory::GetIntegerValue(5), ValueFactory::GetIntegerValue(0),
+       ValueFactory::GetIntegerValue(0)}};
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+  GetExecutionEngine()->Execute(&new_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 1);
+  ASSERT_EQ(result_set[0].GetValue(out_schema, 1).GetAs<int32_t>(), 5);
+
+  // an index scan of a single key looks it up in the hash index, which cannot scan a range of keys
+  IndexScanPlanNode point_plan{out_schema, nullptr, index_info->index_oid_, &key, &key};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&point_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 1);
+  ASSERT_EQ(result_set[0].GetValue(out_schema, 0).GetAs<int32_t>(), 250);
+  IndexScanPlanNode range_plan{out_schema, nullptr, index_info->index_oid_, &key, &new_key};
+  EXPECT_THROW(GetExecutionEngine()->Execute(&range_plan, &result_set, GetTxn(), GetExecutorContext()), Exception);
+
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, IndexScanKeySizeTest) {
+  // SELECT colA, colB FROM test_1 WHERE colA BETWEEN 200 AND 299, over B+ tree indexes whose keys are not 8 bytes
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  Schema *key_schema = ParseCreateStatement("a int");
+  auto index_4 = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<4>, RID, GenericComparator<4>>(
+      GetTxn(), "index4", "test_1", schema, *key_schema, {0}, 4);
+  auto index_16 = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<16>, RID, GenericComparator<16>>(
+      GetTxn(), "index16", "test_1", schema, *key_schema, {0}, 16);
+
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *out_schema = MakeOutputSchema({{"colA", colA}});
+  Tuple lower_key({ValueFactory::GetIntegerValue(200)}, key_schema);
+  Tuple upper_key({ValueFactory::GetIntegerValue(299)}, key_schema);
+  for (auto *info : {index_4, index_16}) {
+    for (bool descending : {false, true}) {
+      IndexScanPlanNode plan{out_schema, nullptr, info->index_oid_, &lower_key, &upper_key, nullptr, descending};
+      std::vector<Tuple> result_set;
+      GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+      ASSERT_EQ(result_set.size(), 100);
+      for (size_t i = 0; i < result_set.size(); i++) {
+        ASSERT_EQ(result_set[i].GetValue(out_schema, 0).GetAs<int32_t>(), descending ? 299 - i : 200 + i);
+      }
+    }
+  }
+
+  delete key_schema;
+}
+
 // NOLINTNEXTLINE
 TEST_F(ExecutorTest, SimpleAggregationTest) {
   // SELECT COUNT(colA), SUM(colA), min(colA), max(colA) from test_1;
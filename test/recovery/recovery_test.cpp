@@ -10,6 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <fstream>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -19,10 +23,12 @@
 #include "concurrency/transaction_manager.h"
 #include "gtest/gtest.h"
 #include "logging/common.h"
+#include "recovery/log_compressor.h"
 #include "recovery/log_recovery.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
@@ -314,4 +320,444 @@ TEST(RecoveryTest, DISABLED_CheckpointTest) {
   remove("test.db");
   remove("test.log");
 }
+
+// build a tuple of num_cols INTEGER columns, column i holds base + i
+Tuple ConstructIntegerTuple(Schema *schema, int32_t base) {
+  std::vector<Value> values;
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    values.emplace_back(ValueFactory::GetIntegerValue(base + static_cast<int32_t>(i)));
+  }
+  return Tuple(values, schema);
+}
+
+int64_t LogFileSize() { return std::ifstream("test.log", std::ios::binary | std::ios::ate).tellg(); }
+
+Schema ConstructIntegerSchema(uint32_t num_cols) {
+  std::vector<Column> cols;
+  for (uint32_t i = 0; i < num_cols; i++) {
+    cols.emplace_back("c" + std::to_string(i), TypeId::INTEGER);
+  }
+  return Schema(cols);
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, LogRecordEncodingTest) {
+  Schema schema = ConstructIntegerSchema(16);
+  std::vector<Value> values;
+  for (uint32_t i = 0; i < 16; i++) {
+    values.emplace_back(ValueFactory::GetIntegerValue(i));
+  }
+  Tuple old_tuple(values, &schema);
+  values[3] = ValueFactory::GetIntegerValue(1000);
+  values[4] = ValueFactory::GetIntegerValue(1001);
+  values[12] = ValueFactory::GetIntegerValue(-7);
+  Tuple new_tuple(values, &schema);
+  RID rid(12, 34);
+
+  remove("test.db");
+  remove("test.log");
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  LogRecord begin(5, INVALID_LSN, LogRecordType::BEGIN);
+  lsn_t begin_lsn = log_manager.AppendLogRecord(&begin);
+  LogRecord update(5, begin_lsn, LogRecordType::UPDATE, rid, old_tuple, new_tuple);
+  lsn_t update_lsn = log_manager.AppendLogRecord(&update);
+  EXPECT_TRUE(update.IsDeltaUpdate());
+  // the legacy layout: 20 byte header, rid, then both images with a 4 byte length each
+  int32_t legacy_size = 20 + sizeof(RID) + 2 * (sizeof(int32_t) + old_tuple.GetLength());
+  int32_t size = update.GetSerializedSize();
+  EXPECT_LT(size, legacy_size / 4);
+
+  std::vector<char> buffer(log_manager.GetLogBuffer() + begin.GetSize(),
+                           log_manager.GetLogBuffer() + begin.GetSize() + size);
+  EXPECT_EQ(size, update.GetSize());
+  // a truncated record is reported as incomplete
+  LogRecord decoded;
+  EXPECT_FALSE(decoded.DeserializeFrom(buffer.data(), size - 1));
+  ASSERT_TRUE(decoded.DeserializeFrom(buffer.data(), size));
+  EXPECT_EQ(size, decoded.GetSize());
+  EXPECT_EQ(update_lsn, decoded.GetLSN());
+  EXPECT_EQ(5, decoded.GetTxnId());
+  EXPECT_EQ(begin_lsn, decoded.GetPrevLSN());
+  EXPECT_EQ(LogRecordType::UPDATE, decoded.GetLogRecordType());
+  EXPECT_EQ(rid, decoded.GetUpdateRID());
+  ASSERT_TRUE(decoded.IsDeltaUpdate());
+
+  // the XOR delta turns the old image into the new one and back
+  Tuple redo = decoded.ApplyUpdateDelta(old_tuple);
+  ASSERT_EQ(new_tuple.GetLength(), redo.GetLength());
+  EXPECT_EQ(0, memcmp(new_tuple.GetData(), redo.GetData(), new_tuple.GetLength()));
+  Tuple undo = decoded.ApplyUpdateDelta(new_tuple);
+  EXPECT_EQ(0, memcmp(old_tuple.GetData(), undo.GetData(), old_tuple.GetLength()));
+
+  // images of different length are logged in full
+  Column varchar_col{"a", TypeId::VARCHAR, 20};
+  Schema varchar_schema{std::vector<Column>{varchar_col}};
+  Tuple short_tuple(std::vector<Value>{ValueFactory::GetVarcharValue("ab")}, &varchar_schema);
+  Tuple long_tuple(std::vector<Value>{ValueFactory::GetVarcharValue("abcdef")}, &varchar_schema);
+  LogRecord full(6, INVALID_LSN, LogRecordType::UPDATE, rid, short_tuple, long_tuple);
+  EXPECT_FALSE(full.IsDeltaUpdate());
+  buffer.resize(full.GetSerializedSize());
+  full.SerializeTo(buffer.data());
+  ASSERT_TRUE(decoded.DeserializeFrom(buffer.data(), buffer.size()));
+  EXPECT_FALSE(decoded.IsDeltaUpdate());
+  EXPECT_EQ(INVALID_LSN, decoded.GetPrevLSN());
+  EXPECT_EQ(6, decoded.GetTxnId());
+  ASSERT_EQ(long_tuple.GetLength(), decoded.GetUpdateTuple().GetLength());
+  EXPECT_EQ(0, memcmp(long_tuple.GetData(), decoded.GetUpdateTuple().GetData(), long_tuple.GetLength()));
+  EXPECT_EQ(0, memcmp(short_tuple.GetData(), decoded.GetOriginalTuple().GetData(), short_tuple.GetLength()));
+
+  LogRecord new_page(5, update_lsn, LogRecordType::NEWPAGE, INVALID_PAGE_ID, 9);
+  log_manager.AppendLogRecord(&new_page);
+  buffer.resize(new_page.GetSerializedSize());
+  new_page.SerializeTo(buffer.data());
+  ASSERT_TRUE(decoded.DeserializeFrom(buffer.data(), buffer.size()));
+  EXPECT_EQ(INVALID_PAGE_ID, decoded.GetNewPageRecord());
+  EXPECT_EQ(9, decoded.GetNewPageId());
+  EXPECT_EQ(update_lsn, decoded.GetPrevLSN());
+
+  disk_manager.ShutDown();
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, DeltaUpdateRecoveryTest) {
+  remove("test.db");
+  remove("test.log");
+  BustubInstance *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+
+  Schema schema = ConstructIntegerSchema(16);
+  Tuple tuple = ConstructIntegerTuple(&schema, 0);
+  std::vector<Value> values;
+  for (uint32_t i = 0; i < 16; i++) {
+    values.emplace_back(tuple.GetValue(&schema, i));
+  }
+  values[2] = ValueFactory::GetIntegerValue(200);
+  Tuple committed_tuple(values, &schema);
+  values[9] = ValueFactory::GetIntegerValue(900);
+  Tuple loser_tuple(values, &schema);
+
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  RID rid;
+  ASSERT_TRUE(test_table->InsertTuple(tuple, &rid, txn));
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+
+  txn = bustub_instance->transaction_manager_->Begin();
+  ASSERT_TRUE(test_table->UpdateTuple(committed_tuple, rid, txn));
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+
+  // the loser's update reaches the disk, its commit never does
+  txn = bustub_instance->transaction_manager_->Begin();
+  ASSERT_TRUE(test_table->UpdateTuple(loser_tuple, rid, txn));
+  bustub_instance->log_manager_->Flush();
+  bustub_instance->buffer_pool_manager_->FlushPage(first_page_id);
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+
+  bustub_instance = new BustubInstance("test.db");
+  auto *log_recovery = new LogRecovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_);
+  log_recovery->Redo();
+  log_recovery->Undo();
+
+  txn = bustub_instance->transaction_manager_->Begin();
+  test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                             bustub_instance->log_manager_, first_page_id);
+  Tuple recovered;
+  ASSERT_TRUE(test_table->GetTuple(rid, &recovered, txn));
+  ASSERT_EQ(committed_tuple.GetLength(), recovered.GetLength());
+  EXPECT_EQ(0, memcmp(committed_tuple.GetData(), recovered.GetData(), committed_tuple.GetLength()));
+  bustub_instance->transaction_manager_->Commit(txn);
+
+  delete txn;
+  delete test_table;
+  delete log_recovery;
+  delete bustub_instance;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, DISABLED_LogSizeBenchmark) {
+  remove("test.db");
+  remove("test.log");
+  BustubInstance *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+
+  // wide rows where every transaction changes a single column
+  const uint32_t num_cols = 32;
+  const int num_rows = 64;
+  const int num_txns = 2000;
+  Schema schema = ConstructIntegerSchema(num_cols);
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  std::vector<RID> rids(num_rows);
+  for (int i = 0; i < num_rows; i++) {
+    ASSERT_TRUE(test_table->InsertTuple(ConstructIntegerTuple(&schema, i * num_cols), &rids[i], txn));
+  }
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+
+  std::vector<std::vector<Value>> rows(num_rows);
+  for (int i = 0; i < num_rows; i++) {
+    for (uint32_t j = 0; j < num_cols; j++) {
+      rows[i].emplace_back(ValueFactory::GetIntegerValue(static_cast<int32_t>(i * num_cols + j)));
+    }
+  }
+
+  bustub_instance->log_manager_->Flush();
+  int64_t log_bytes_before = LogFileSize();
+  int64_t legacy_bytes = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_txns; i++) {
+    auto &row = rows[i % num_rows];
+    row[i % num_cols] = ValueFactory::GetIntegerValue(i);
+    Tuple new_tuple(row, &schema);
+    txn = bustub_instance->transaction_manager_->Begin();
+    ASSERT_TRUE(test_table->UpdateTuple(new_tuple, rids[i % num_rows], txn));
+    bustub_instance->transaction_manager_->Commit(txn);
+    delete txn;
+    // BEGIN, UPDATE and COMMIT records in the old fixed layout
+    legacy_bytes += 3 * 20 + sizeof(RID) + 2 * (sizeof(int32_t) + new_tuple.GetLength());
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  int64_t log_bytes = LogFileSize() - log_bytes_before;
+
+  LOG_INFO("log bytes per update txn: %.1f (fixed layout %.1f), %.0f commits/s", 1.0 * log_bytes / num_txns,
+           1.0 * legacy_bytes / num_txns, num_txns / elapsed);
+  EXPECT_LT(log_bytes * 4, legacy_bytes);
+
+  delete test_table;
+  delete bustub_instance;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, LogCompressorTest) {
+  std::vector<std::string> inputs;
+  inputs.emplace_back("");
+  inputs.emplace_back("abc");
+  inputs.emplace_back(std::string(100000, 'x'));
+  std::string mixed;
+  std::mt19937 generator(15445);
+  for (int i = 0; i < 3000; i++) {
+    mixed += "customer#" + std::to_string(i % 50) + "|";
+    mixed += static_cast<char>(generator());
+  }
+  inputs.push_back(mixed);
+  std::string noise;
+  for (int i = 0; i < 5000; i++) {
+    noise += static_cast<char>(generator());
+  }
+  inputs.push_back(noise);
+
+  for (const auto &input : inputs) {
+    auto size = static_cast<int32_t>(input.size());
+    std::vector<char> compressed(size + size / 255 + 16);
+    int32_t compressed_size = LogCompressor::Compress(input.data(), size, compressed.data(), compressed.size());
+    ASSERT_GT(compressed_size, 0);
+    std::vector<char> output(size + 1);
+    ASSERT_TRUE(LogCompressor::Decompress(compressed.data(), compressed_size, output.data(), size));
+    EXPECT_EQ(0, memcmp(input.data(), output.data(), size));
+    // a wrong raw size or a truncated block is rejected
+    EXPECT_FALSE(LogCompressor::Decompress(compressed.data(), compressed_size, output.data(), size + 1));
+    if (compressed_size > 1) {
+      EXPECT_FALSE(LogCompressor::Decompress(compressed.data(), compressed_size - 1, output.data(), size));
+    }
+  }
+  std::vector<char> small(16);
+  EXPECT_EQ(0, LogCompressor::Compress(noise.data(), noise.size(), small.data(), small.size()));
+  std::vector<char> compressed(inputs[2].size());
+  EXPECT_LT(LogCompressor::Compress(inputs[2].data(), inputs[2].size(), compressed.data(), compressed.size()), 1000);
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, CompressedLogRecoveryTest) {
+  remove("test.db");
+  remove("test.log");
+  enable_log_compression = true;
+  BustubInstance *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+
+  Schema schema = ConstructIntegerSchema(8);
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  std::vector<RID> rids(200);
+  for (int i = 0; i < 200; i++) {
+    ASSERT_TRUE(test_table->InsertTuple(ConstructIntegerTuple(&schema, i % 4), &rids[i], txn));
+  }
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+
+  // the loser's delete reaches the disk, its commit never does
+  txn = bustub_instance->transaction_manager_->Begin();
+  ASSERT_TRUE(test_table->MarkDelete(rids[0], txn));
+  bustub_instance->log_manager_->Flush();
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+  enable_log_compression = false;
+
+  bustub_instance = new BustubInstance("test.db");
+  auto *log_recovery = new LogRecovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_);
+  log_recovery->Redo();
+  log_recovery->Undo();
+
+  txn = bustub_instance->transaction_manager_->Begin();
+  test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                             bustub_instance->log_manager_, first_page_id);
+  for (int i = 0; i < 200; i++) {
+    Tuple tuple;
+    ASSERT_TRUE(test_table->GetTuple(rids[i], &tuple, txn));
+    EXPECT_EQ(i % 4, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  bustub_instance->transaction_manager_->Commit(txn);
+
+  delete txn;
+  delete test_table;
+  delete log_recovery;
+  delete bustub_instance;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, DISABLED_LogCompressionBenchmark) {
+  Column id_col{"id", TypeId::INTEGER};
+  Column name_col{"name", TypeId::VARCHAR, 32};
+  Column balance_col{"balance", TypeId::BIGINT};
+  Schema schema{std::vector<Column>{id_col, name_col, balance_col}};
+  const int num_tuples = 5000;
+
+  int64_t log_bytes[2];
+  double seconds[2];
+  for (int compress = 0; compress < 2; compress++) {
+    remove("test.db");
+    remove("test.log");
+    enable_log_compression = compress == 1;
+    BustubInstance *bustub_instance = new BustubInstance("test.db");
+    bustub_instance->log_manager_->RunFlushThread();
+
+    auto start = std::chrono::steady_clock::now();
+    Transaction *txn = bustub_instance->transaction_manager_->Begin();
+    auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                     bustub_instance->log_manager_, txn);
+    for (int i = 0; i < num_tuples; i++) {
+      std::string name = "customer#" + std::to_string(100000 + i % 1000);
+      Tuple tuple(std::vector<Value>{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(name),
+                                     ValueFactory::GetBigIntValue(i % 100 * 1000)},
+                  &schema);
+      RID rid;
+      ASSERT_TRUE(test_table->InsertTuple(tuple, &rid, txn));
+    }
+    bustub_instance->transaction_manager_->Commit(txn);
+    seconds[compress] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    log_bytes[compress] = LogFileSize();
+
+    delete txn;
+    delete test_table;
+    delete bustub_instance;
+  }
+  enable_log_compression = false;
+
+  // codec cost on the raw batch the last run wrote
+  std::ifstream log_file("test.log", std::ios::binary);
+  std::vector<char> raw(LOG_BUFFER_SIZE);
+  std::vector<char> compressed(LOG_BUFFER_SIZE);
+  int32_t header[2];
+  log_file.read(reinterpret_cast<char *>(header), sizeof(header));
+  std::vector<char> stored(header[0]);
+  log_file.read(stored.data(), header[0]);
+  ASSERT_TRUE(LogCompressor::Decompress(stored.data(), header[0], raw.data(), header[1]));
+  const int rounds = 200;
+  auto start = std::chrono::steady_clock::now();
+  int32_t compressed_size = 0;
+  for (int i = 0; i < rounds; i++) {
+    compressed_size = LogCompressor::Compress(raw.data(), header[1], compressed.data(), compressed.size());
+  }
+  double compress_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; i++) {
+    ASSERT_TRUE(LogCompressor::Decompress(compressed.data(), compressed_size, raw.data(), header[1]));
+  }
+  double decompress_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  double megabytes = 1.0 * header[1] * rounds / (1 << 20);
+
+  LOG_INFO("log bytes for %d inserts: %ld raw, %ld compressed (%.2fx)", num_tuples, log_bytes[0], log_bytes[1],
+           1.0 * log_bytes[0] / log_bytes[1]);
+  LOG_INFO("insert txn time: %.3fs raw, %.3fs compressed; codec: compress %.0f MB/s, decompress %.0f MB/s",
+           seconds[0], seconds[1], megabytes / compress_seconds, megabytes / decompress_seconds);
+  EXPECT_LT(log_bytes[1] * 2, log_bytes[0]);
+
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, AsyncCommitTest) {
+  remove("test.db");
+  remove("test.log");
+  auto old_log_timeout = log_timeout;
+  // only a scheduled flush can make the commits durable in time
+  log_timeout = std::chrono::seconds(10);
+  async_commit_max_lag = std::chrono::milliseconds(5);
+  BustubInstance *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+  auto *log_manager = bustub_instance->log_manager_;
+
+  Schema schema = ConstructIntegerSchema(4);
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table =
+      new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_, log_manager, txn);
+  bustub_instance->transaction_manager_->Commit(txn);
+  EXPECT_EQ(txn->GetPrevLSN(), log_manager->GetPersistentLSN());
+  delete txn;
+
+  const int num_txns = 500;
+  double seconds[2];
+  for (int async = 0; async < 2; async++) {
+    bustub_instance->transaction_manager_->SetAsyncCommit(async == 1);
+    lsn_t commit_lsn = INVALID_LSN;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_txns; i++) {
+      txn = bustub_instance->transaction_manager_->Begin();
+      EXPECT_EQ(async == 1, txn->IsAsyncCommit());
+      RID rid;
+      ASSERT_TRUE(test_table->InsertTuple(ConstructIntegerTuple(&schema, i), &rid, txn));
+      bustub_instance->transaction_manager_->Commit(txn);
+      commit_lsn = txn->GetPrevLSN();
+      if (async == 0) {
+        EXPECT_LE(commit_lsn, log_manager->GetPersistentLSN());
+      }
+      delete txn;
+    }
+    seconds[async] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // the last commit becomes durable within the lag, long before the log timeout
+    auto wait_start = std::chrono::steady_clock::now();
+    log_manager->WaitForPersistentLSN(commit_lsn);
+    EXPECT_LE(commit_lsn, log_manager->GetPersistentLSN());
+    EXPECT_LT(std::chrono::steady_clock::now() - wait_start, std::chrono::seconds(5));
+  }
+  LOG_INFO("commits/s: %.0f synchronous, %.0f asynchronous", num_txns / seconds[0], num_txns / seconds[1]);
+
+  delete test_table;
+  delete bustub_instance;
+  log_timeout = old_log_timeout;
+  async_commit_max_lag = std::chrono::milliseconds(10);
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
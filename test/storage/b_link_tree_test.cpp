@@ -0,0 +1,245 @@
+/**
+ * b_link_tree_test.cpp
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_link_tree.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+using LinkTree = BLinkTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+// the tree holds exactly the keys in [0, num_keys) for which present is true
+void CheckLinkTree(LinkTree *tree, int64_t num_keys, const std::function<bool(int64_t)> &present) {
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < num_keys; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_EQ(tree->GetValue(index_key, &rids), present(key));
+    if (present(key)) {
+      ASSERT_EQ(rids.size(), 1);
+      EXPECT_EQ(rids[0].GetSlotNum(), key);
+    }
+  }
+  int64_t expected = 0;
+  index_key.SetFromInteger(0);
+  tree->Scan(index_key, [&](const GenericKey<8> &key, const RID &rid) {
+    while (expected < num_keys && !present(expected)) {
+      expected++;
+    }
+    EXPECT_EQ(key.ToString(), expected);
+    expected++;
+    return true;
+  });
+  while (expected < num_keys && !present(expected)) {
+    expected++;
+  }
+  EXPECT_EQ(expected, num_keys);
+}
+
+TEST(BLinkTreeTest, InsertRemoveTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // small pages grow a tree of several levels
+  LinkTree tree("foo_pk", bpm, comparator, 4, 4);
+  EXPECT_TRUE(tree.IsEmpty());
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 3000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  GenericKey<8> index_key;
+  for (int64_t key : keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, static_cast<uint32_t>(key))));
+  }
+  index_key.SetFromInteger(keys[0]);
+  EXPECT_FALSE(tree.Insert(index_key, RID(0, 0)));
+  CheckLinkTree(&tree, 3000, [](int64_t key) { return true; });
+
+  // a scan stops when asked to
+  int64_t count = 0;
+  index_key.SetFromInteger(1000);
+  tree.Scan(index_key, [&](const GenericKey<8> &key, const RID &rid) { return ++count < 10; });
+  EXPECT_EQ(count, 10);
+
+  for (int64_t key : keys) {
+    if (key % 3 != 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key);
+    }
+  }
+  CheckLinkTree(&tree, 3000, [](int64_t key) { return key % 3 == 0; });
+  // the leaves emptied by removes take keys again
+  for (int64_t key : keys) {
+    if (key % 3 == 1) {
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.Insert(index_key, RID(0, static_cast<uint32_t>(key))));
+    }
+  }
+  CheckLinkTree(&tree, 3000, [](int64_t key) { return key % 3 != 2; });
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BLinkTreeTest, ConcurrentTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(200, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // writers split pages at every level while readers look up the keys that are already in
+  LinkTree tree("foo_pk", bpm, comparator, 4, 4);
+  const int64_t num_keys = 20000;
+  std::atomic<int64_t> missing{0};
+  std::vector<std::thread> threads;
+  for (int64_t t = 0; t < 4; t++) {
+    threads.emplace_back([&, t] {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      for (int64_t key = t; key < num_keys; key += 4) {
+        index_key.SetFromInteger(key);
+        tree.Insert(index_key, RID(0, static_cast<uint32_t>(key)));
+        // the keys this thread inserted are found while the other writers split their pages
+        index_key.SetFromInteger(key / 2 - key / 2 % 4 + t);
+        rids.clear();
+        if (!tree.GetValue(index_key, &rids)) {
+          missing++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(missing, 0);
+  CheckLinkTree(&tree, num_keys, [](int64_t key) { return true; });
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+/**
+ * Runs num_threads threads over a tree that holds the even keys below 2 *
+ * num_keys, each doing num_ops operations of which one in five inserts a new
+ * odd key and the others look up an even key. Returns the operations per
+ * second.
+ */
+template <typename TreeType>
+double MixedWorkload(TreeType *tree, int64_t num_keys, int num_threads, int num_ops) {
+  GenericKey<8> index_key;
+  Transaction transaction(0);
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key * 2);
+    tree->Insert(index_key, RID(0, static_cast<uint32_t>(key * 2)), &transaction);
+  }
+  std::atomic<int64_t> found{0};
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      std::mt19937_64 rng(t);
+      Transaction transaction(static_cast<txn_id_t>(t));
+      GenericKey<8> key;
+      std::vector<RID> rids;
+      int64_t next_insert = t;
+      for (int op = 0; op < num_ops; op++) {
+        if (op % 5 == 0) {
+          key.SetFromInteger(next_insert * 2 + 1);
+          tree->Insert(key, RID(0, static_cast<uint32_t>(next_insert * 2 + 1)), &transaction);
+          next_insert += num_threads;
+        } else {
+          key.SetFromInteger(static_cast<int64_t>(rng() % num_keys) * 2);
+          rids.clear();
+          found += tree->GetValue(key, &rids, &transaction) ? 1 : 0;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  EXPECT_EQ(found, num_threads * (num_ops - (num_ops + 4) / 5));
+  // every inserted odd key is in the tree
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < num_threads * ((num_ops + 4) / 5); key++) {
+    rids.clear();
+    index_key.SetFromInteger(key * 2 + 1);
+    EXPECT_TRUE(tree->GetValue(index_key, &rids));
+  }
+  return num_threads * num_ops / ms * 1000;
+}
+
+TEST(BLinkTreeTest, DISABLED_BenchmarkTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t num_keys = 50000;
+  const int num_threads = 8;
+  const int num_ops = 20000;
+
+  double ops[3];
+  for (int i = 0; i < 3; i++) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(2000, disk_manager);
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+    if (i < 2) {
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+      // the first run crabs down with latches only, the second tries optimistic latching first
+      tree.SetOptimisticLatching(i == 1);
+      ops[i] = MixedWorkload(&tree, num_keys, num_threads, num_ops);
+    } else {
+      LinkTree tree("foo_pk", bpm, comparator);
+      ops[i] = MixedWorkload(&tree, num_keys, num_threads, num_ops);
+    }
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+  printf("%d threads, 4 lookups per insert over %ld keys: latch crabbing %.0f/s, optimistic latching %.0f/s, "
+         "B-link tree %.0f/s\n",
+         num_threads, num_keys, ops[0], ops[1], ops[2]);
+
+  delete key_schema;
+}
+
+}  // namespace bustub
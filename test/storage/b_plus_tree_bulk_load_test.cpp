@@ -0,0 +1,241 @@
+/**
+ * b_plus_tree_bulk_load_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/external_sorter.h"
+
+namespace bustub {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+// stream over sorted keys, the value of each key is RID(key)
+std::function<bool(GenericKey<8> *, RID *)> KeyStream(const std::vector<int64_t> &keys) {
+  auto pos = std::make_shared<size_t>(0);
+  return [&keys, pos](GenericKey<8> *key, RID *value) {
+    if (*pos == keys.size()) {
+      return false;
+    }
+    int64_t k = keys[(*pos)++];
+    key->SetFromInteger(k);
+    *value = RID(static_cast<int32_t>(k >> 32), static_cast<uint32_t>(k & 0xFFFFFFFF));
+    return true;
+  };
+}
+
+// check the tree holds exactly keys (sorted), returns the number of leaves
+size_t CheckTree(Tree *tree, const std::vector<int64_t> &keys) {
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree->GetValue(index_key, &rids));
+    EXPECT_EQ(rids.size(), 1);
+    if (!rids.empty()) {
+      EXPECT_EQ(rids[0].GetSlotNum(), key);
+    }
+  }
+  size_t count = 0;
+  std::set<page_id_t> leaves;
+  for (auto iterator = tree->begin(); iterator != tree->end(); ++iterator) {
+    leaves.insert(iterator.GetPageId());
+    EXPECT_LT(count, keys.size());
+    if (count < keys.size()) {
+      EXPECT_EQ((*iterator).second.GetSlotNum(), keys[count]);
+    }
+    count++;
+  }
+  EXPECT_EQ(count, keys.size());
+  return leaves.size();
+}
+
+TEST(BPlusTreeBulkLoadTest, BulkLoadTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  Transaction *transaction = new Transaction(0);
+
+  // small pages and every tree size up to a few levels, so all cases of the underfull last page are covered
+  for (int64_t scale_factor = 0; scale_factor <= 300; scale_factor += 7) {
+    for (double fill_factor : {0.5, 1.0}) {
+      Tree tree("foo_pk", bpm, comparator, 4, 5);
+      std::vector<int64_t> keys;
+      for (int64_t key = 1; key <= scale_factor; key += 2) {
+        keys.push_back(key);
+      }
+      EXPECT_TRUE(tree.BulkLoad(KeyStream(keys), fill_factor));
+      EXPECT_FALSE(tree.BulkLoad(KeyStream(keys), fill_factor) && scale_factor > 0);
+      CheckTree(&tree, keys);
+
+      // the tree keeps working as a normal b+ tree, the keys in between split the loaded pages
+      GenericKey<8> index_key;
+      for (int64_t key = 2; key <= scale_factor + 1; key += 2) {
+        index_key.SetFromInteger(key);
+        EXPECT_TRUE(tree.Insert(index_key, RID(0, key), transaction));
+        keys.push_back(key);
+      }
+      std::sort(keys.begin(), keys.end());
+      CheckTree(&tree, keys);
+    }
+  }
+
+  delete transaction;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeBulkLoadTest, FillFactorTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // duplicated keys are dropped like Insert does
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 1000; key++) {
+    keys.push_back(key);
+    if (key % 10 == 0) {
+      keys.push_back(key);
+    }
+  }
+  std::vector<int64_t> unique_keys(keys);
+  unique_keys.erase(std::unique(unique_keys.begin(), unique_keys.end()), unique_keys.end());
+
+  Tree full_tree("full", bpm, comparator, 21, 21);
+  EXPECT_TRUE(full_tree.BulkLoad(KeyStream(keys), 1.0));
+  EXPECT_EQ(CheckTree(&full_tree, unique_keys), 50);
+
+  Tree half_tree("half", bpm, comparator, 21, 21);
+  EXPECT_TRUE(half_tree.BulkLoad(KeyStream(keys), 0.5));
+  EXPECT_EQ(CheckTree(&half_tree, unique_keys), 100);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeBulkLoadTest, ExternalSorterTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 10000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+
+  for (size_t run_size : {EXTERNAL_SORT_RUN_SIZE, 1000 * sizeof(std::pair<GenericKey<8>, RID>)}) {
+    ExternalSorter<GenericKey<8>, RID, GenericComparator<8>> sorter(comparator, run_size);
+    GenericKey<8> index_key;
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      sorter.Add(index_key, RID(0, key));
+    }
+    sorter.Sort();
+    EXPECT_EQ(sorter.GetRunCount(), run_size == EXTERNAL_SORT_RUN_SIZE ? 0 : 10);
+
+    RID rid;
+    int64_t expected = 1;
+    while (sorter.Next(&index_key, &rid)) {
+      EXPECT_EQ(rid.GetSlotNum(), expected);
+      expected++;
+    }
+    EXPECT_EQ(expected, 10001);
+  }
+
+  delete key_schema;
+}
+
+TEST(BPlusTreeBulkLoadTest, DISABLED_BulkLoadBenchmark) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(BUFFER_POOL_SIZE * 10, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  Transaction *transaction = new Transaction(0);
+
+  // rows of a table come in no particular key order
+  const int64_t scale_factor = 200000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+
+  auto start = std::chrono::steady_clock::now();
+  Tree insert_tree("insert", bpm, comparator);
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    insert_tree.Insert(index_key, RID(0, key), transaction);
+  }
+  double insert_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  int insert_pages = disk_manager->GetNumWrites();
+
+  start = std::chrono::steady_clock::now();
+  Tree bulk_tree("bulk", bpm, comparator);
+  ExternalSorter<GenericKey<8>, RID, GenericComparator<8>> sorter(comparator);
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    sorter.Add(index_key, RID(0, key));
+  }
+  sorter.Sort();
+  EXPECT_TRUE(bulk_tree.BulkLoad([&](GenericKey<8> *key, RID *value) { return sorter.Next(key, value); }));
+  double bulk_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  std::sort(keys.begin(), keys.end());
+  size_t insert_leaves = CheckTree(&insert_tree, keys);
+  size_t bulk_leaves = CheckTree(&bulk_tree, keys);
+  EXPECT_LT(bulk_leaves, insert_leaves);
+  printf("%ld rows: one insert per row %.0f ms (%zu leaves, %d page writes), sort + bulk load %.0f ms (%zu leaves)\n",
+         scale_factor, insert_ms, insert_leaves, insert_pages, bulk_ms, bulk_leaves);
+
+  delete transaction;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
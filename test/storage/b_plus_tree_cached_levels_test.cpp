@@ -0,0 +1,238 @@
+/**
+ * b_plus_tree_cached_levels_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+using CachedTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+// the tree holds exactly the keys in [0, num_keys) for which present is true
+void CheckCachedTree(CachedTree *tree, int64_t num_keys, const std::function<bool(int64_t)> &present) {
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < num_keys; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_EQ(tree->GetValue(index_key, &rids), present(key));
+  }
+  int64_t expected = 0;
+  for (auto iterator = tree->begin(); !iterator.isEnd(); ++iterator) {
+    while (expected < num_keys && !present(expected)) {
+      expected++;
+    }
+    EXPECT_EQ((*iterator).first.ToString(), expected);
+    expected++;
+  }
+  while (expected < num_keys && !present(expected)) {
+    expected++;
+  }
+  EXPECT_EQ(expected, num_keys);
+}
+
+// every frame but the header page's can take a new page, so no page is left pinned
+void CheckNothingPinned(BufferPoolManager *bpm, size_t pool_size) {
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 1; i < pool_size; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    EXPECT_NE(page, nullptr);
+    if (page == nullptr) {
+      break;
+    }
+    page_ids.push_back(page_id);
+  }
+  for (page_id_t page_id : page_ids) {
+    bpm->UnpinPage(page_id, false);
+    bpm->DeletePage(page_id);
+  }
+}
+
+TEST(BPlusTreeCachedLevelsTest, InsertRemoveTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  const size_t pool_size = 100;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(pool_size, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  Transaction *transaction = new Transaction(0);
+
+  {
+    // small pages grow a tree of several levels, the root changes many times
+    CachedTree tree("foo_pk", bpm, comparator, 4, 4);
+    tree.SetCachedLevels(2);
+    EXPECT_EQ(tree.GetCachedPageCount(), 0);
+    std::vector<int64_t> keys;
+    for (int64_t key = 0; key < 2000; key++) {
+      keys.push_back(key);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+    GenericKey<8> index_key;
+    for (int64_t key : keys) {
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.Insert(index_key, RID(0, static_cast<uint32_t>(key)), transaction));
+    }
+    CheckCachedTree(&tree, 2000, [](int64_t key) { return true; });
+    // the root and its children
+    tree.SetCachedLevels(2);
+    EXPECT_GT(tree.GetCachedPageCount(), 1);
+    EXPECT_LE(tree.GetCachedPageCount(), 5);
+
+    // merges delete cached pages and shrink the tree down to one leaf
+    for (int64_t key : keys) {
+      if (key % 500 != 0) {
+        index_key.SetFromInteger(key);
+        tree.Remove(index_key, transaction);
+      }
+    }
+    CheckCachedTree(&tree, 2000, [](int64_t key) { return key % 500 == 0; });
+    for (int64_t key : keys) {
+      if (key % 2 == 1) {
+        index_key.SetFromInteger(key);
+        EXPECT_TRUE(tree.Insert(index_key, RID(0, static_cast<uint32_t>(key)), transaction));
+      }
+    }
+    CheckCachedTree(&tree, 2000, [](int64_t key) { return key % 2 == 1 || key % 500 == 0; });
+
+    tree.SetCachedLevels(0);
+    EXPECT_EQ(tree.GetCachedPageCount(), 0);
+    CheckNothingPinned(bpm, pool_size);
+  }
+
+  delete transaction;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeCachedLevelsTest, ConcurrentTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  const size_t pool_size = 200;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(pool_size, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  {
+    CachedTree tree("foo_pk", bpm, comparator, 8, 8);
+    tree.SetCachedLevels(3);
+    // every thread inserts its keys and looks them up, then removes most of them, so cached pages split and merge
+    // while other threads descend through them
+    std::atomic<int64_t> missing{0};
+    std::vector<std::thread> threads;
+    for (int64_t t = 0; t < 4; t++) {
+      threads.emplace_back([&, t] {
+        Transaction transaction(static_cast<txn_id_t>(t));
+        GenericKey<8> index_key;
+        std::vector<RID> rids;
+        for (int64_t key = t; key < 8000; key += 4) {
+          index_key.SetFromInteger(key);
+          tree.Insert(index_key, RID(0, static_cast<uint32_t>(key)), &transaction);
+          rids.clear();
+          if (!tree.GetValue(index_key, &rids)) {
+            missing++;
+          }
+        }
+        for (int64_t key = t; key < 8000; key += 4) {
+          if (key % 10 != 0) {
+            index_key.SetFromInteger(key);
+            tree.Remove(index_key, &transaction);
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(missing, 0);
+    CheckCachedTree(&tree, 8000, [](int64_t key) { return key % 10 == 0; });
+
+    tree.SetCachedLevels(0);
+    CheckNothingPinned(bpm, pool_size);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeCachedLevelsTest, DISABLED_BenchmarkTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t num_keys = 100000;
+  const int num_lookups = 200000;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(1000, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  Transaction *transaction = new Transaction(0);
+
+  {
+    // leaves of up to 200 keys and internal pages of up to 64 children give a tree of three levels
+    CachedTree tree("foo_pk", bpm, comparator, 200, 64);
+    GenericKey<8> index_key;
+    for (int64_t key = 0; key < num_keys; key++) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, static_cast<uint32_t>(key)), transaction);
+    }
+
+    double rate[2];
+    for (int cached = 0; cached < 2; cached++) {
+      tree.SetCachedLevels(cached == 0 ? 0 : 3);
+      std::mt19937_64 rng(15445);
+      std::vector<RID> rids;
+      int64_t found = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < num_lookups; i++) {
+        index_key.SetFromInteger(static_cast<int64_t>(rng() % num_keys));
+        rids.clear();
+        found += tree.GetValue(index_key, &rids) ? 1 : 0;
+      }
+      double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      EXPECT_EQ(found, num_lookups);
+      rate[cached] = num_lookups / ms * 1000;
+    }
+    printf("%d lookups over %ld keys: upper levels from the buffer pool %.0f/s, cached %.0f/s (%zu pages)\n",
+           num_lookups, num_keys, rate[0], rate[1], tree.GetCachedPageCount());
+    tree.SetCachedLevels(0);
+  }
+
+  delete transaction;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -2,9 +2,11 @@
  * b_plus_tree_test.cpp
  */
 
+#include <algorithm>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
+#include <random>
 #include <thread>                   // NOLINT
 #include "b_plus_tree_test_util.h"  // NOLINT
 
@@ -331,4 +333,310 @@ TEST(BPlusTreeConcurrentTest, MixTest) {
   remove("test.log");
 }
 
+// insert keys with num_threads threads, returns the elapsed milliseconds
+double TimedInsert(bool optimistic, int num_threads, const std::vector<int64_t> &keys) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(100, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+  tree.SetOptimisticLatching(optimistic);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  auto start = std::chrono::steady_clock::now();
+  LaunchParallelTest(num_threads, InsertHelperSplit, &tree, keys, num_threads);
+  auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  int64_t current_key = 1;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 1;
+  }
+  EXPECT_EQ(current_key, keys.size() + 1);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+  return elapsed;
+}
+
+TEST(BPlusTreeConcurrentTest, DISABLED_OptimisticInsertBenchmark) {
+  std::vector<int64_t> keys;
+  int64_t scale_factor = 20000;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+
+  const int num_threads = 4;
+  double pessimistic_ms = TimedInsert(false, num_threads, keys);
+  double optimistic_ms = TimedInsert(true, num_threads, keys);
+  printf("%d threads, %ld inserts: write latch crabbing %.1f ms (%.0f inserts/s), optimistic %.1f ms (%.0f/s)\n",
+         num_threads, scale_factor, pessimistic_ms, scale_factor * 1000 / pessimistic_ms, optimistic_ms,
+         scale_factor * 1000 / optimistic_ms);
+}
+
+// helper function to look up keys that are known to be in the tree
+void LookupHelper(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree, const std::vector<int64_t> &keys,
+                  __attribute__((unused)) uint64_t thread_itr = 0) {
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree->GetValue(index_key, &rids));
+    EXPECT_EQ(rids.size(), 1);
+  }
+}
+
+TEST(BPlusTreeConcurrentTest, DISABLED_OptimisticLookupBenchmark) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(100, disk_manager);
+  // create b+ tree with small pages so lookups go through a few levels
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 32, 32);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  std::vector<int64_t> keys;
+  int64_t scale_factor = 5000;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    keys.push_back(key);
+  }
+  InsertHelper(&tree, keys);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+
+  for (int num_threads : {1, 4}) {
+    double elapsed_ms[2];
+    for (bool optimistic : {false, true}) {
+      tree.SetOptimisticLatching(optimistic);
+      auto start = std::chrono::steady_clock::now();
+      LaunchParallelTest(num_threads, LookupHelper, &tree, keys);
+      elapsed_ms[optimistic] =
+          std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    int64_t lookups = scale_factor * num_threads;
+    printf("%d threads, %ld lookups: read latches %.0f lookups/s, optimistic lock coupling %.0f lookups/s\n",
+           num_threads, lookups, lookups * 1000 / elapsed_ms[0], lookups * 1000 / elapsed_ms[1]);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+// helper function to look up keys in batches: keys = 1 (mod 4) are in the tree, keys = 3 (mod 4) never are
+void BatchLookupHelper(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree, const std::vector<int64_t> &keys,
+                       size_t batch_size, __attribute__((unused)) uint64_t thread_itr = 0) {
+  std::vector<GenericKey<8>> batch;
+  std::vector<std::vector<RID>> result;
+  for (size_t begin = 0; begin < keys.size(); begin += batch_size) {
+    size_t end = std::min(keys.size(), begin + batch_size);
+    batch.resize(end - begin);
+    for (size_t i = begin; i < end; i++) {
+      batch[i - begin].SetFromInteger(keys[i]);
+    }
+    tree->GetValues(batch, &result);
+    ASSERT_EQ(result.size(), batch.size());
+    for (size_t i = begin; i < end; i++) {
+      if (keys[i] % 4 == 1) {
+        ASSERT_EQ(result[i - begin].size(), 1);
+        EXPECT_EQ(result[i - begin][0].GetSlotNum(), keys[i]);
+      } else if (keys[i] % 4 == 3) {
+        EXPECT_TRUE(result[i - begin].empty());
+      }
+    }
+  }
+}
+
+TEST(BPlusTreeConcurrentTest, BatchLookupTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(100, disk_manager);
+  // create b+ tree with small pages so a batch spans many leaves
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 8, 8);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  std::vector<int64_t> keys;
+  std::vector<int64_t> inserted_keys;
+  std::vector<int64_t> concurrent_keys;
+  int64_t scale_factor = 8000;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    keys.push_back(key);
+    if (key % 4 == 1) {
+      inserted_keys.push_back(key);
+    } else if (key % 2 == 0) {
+      concurrent_keys.push_back(key);
+    }
+  }
+  InsertHelper(&tree, inserted_keys);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  std::shuffle(concurrent_keys.begin(), concurrent_keys.end(), std::mt19937(15445));
+
+  // the leaves split under the batched lookups
+  std::thread inserter(InsertHelper, &tree, concurrent_keys, 0);
+  LaunchParallelTest(4, BatchLookupHelper, &tree, keys, 50);
+  inserter.join();
+  for (size_t batch_size : {1, 7, 1000, 8000}) {
+    BatchLookupHelper(&tree, keys, batch_size);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+// helper function to scan the whole tree forward (even thread_itr) or backward (odd thread_itr), keys = 1 (mod 4)
+// are in the tree from the start and every scan must see each of them exactly once in order
+void ScanHelper(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree, int64_t scale_factor, int rounds,
+                uint64_t thread_itr = 0) {
+  for (int round = 0; round < rounds; round++) {
+    int64_t count = 0;
+    if (thread_itr % 2 == 0) {
+      int64_t last = 0;
+      for (auto iterator = tree->begin(); iterator != tree->end(); ++iterator) {
+        int64_t key = (*iterator).second.GetSlotNum();
+        ASSERT_GT(key, last);
+        last = key;
+        count += key % 4 == 1 ? 1 : 0;
+      }
+    } else {
+      int64_t last = scale_factor + 1;
+      for (auto iterator = tree->rbegin(); iterator != tree->rend(); ++iterator) {
+        int64_t key = (*iterator).second.GetSlotNum();
+        ASSERT_LT(key, last);
+        last = key;
+        count += key % 4 == 1 ? 1 : 0;
+      }
+    }
+    EXPECT_EQ(count, scale_factor / 4);
+  }
+}
+
+TEST(BPlusTreeConcurrentTest, ReverseScanTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(100, disk_manager);
+  // create b+ tree with small pages so the leaves keep splitting under the scans
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 8, 8);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  std::vector<int64_t> inserted_keys;
+  std::vector<int64_t> concurrent_keys;
+  int64_t scale_factor = 8000;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    if (key % 4 == 1) {
+      inserted_keys.push_back(key);
+    } else {
+      concurrent_keys.push_back(key);
+    }
+  }
+  InsertHelper(&tree, inserted_keys);
+  std::shuffle(concurrent_keys.begin(), concurrent_keys.end(), std::mt19937(15445));
+
+  // forward and backward scans race the splits and each other
+  std::thread inserter(InsertHelper, &tree, concurrent_keys, 0);
+  LaunchParallelTest(4, ScanHelper, &tree, scale_factor, 20);
+  inserter.join();
+
+  // the previous page ids agree with the next page ids once the splits are done
+  std::vector<page_id_t> forward_leaves;
+  std::vector<int64_t> forward_keys;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    if (forward_leaves.empty() || forward_leaves.back() != iterator.GetPageId()) {
+      forward_leaves.push_back(iterator.GetPageId());
+    }
+    forward_keys.push_back((*iterator).second.GetSlotNum());
+  }
+  std::vector<page_id_t> reverse_leaves;
+  std::vector<int64_t> reverse_keys;
+  for (auto iterator = tree.rbegin(); iterator != tree.rend(); ++iterator) {
+    if (reverse_leaves.empty() || reverse_leaves.back() != iterator.GetPageId()) {
+      reverse_leaves.push_back(iterator.GetPageId());
+    }
+    reverse_keys.push_back((*iterator).second.GetSlotNum());
+  }
+  std::reverse(reverse_leaves.begin(), reverse_leaves.end());
+  std::reverse(reverse_keys.begin(), reverse_keys.end());
+  EXPECT_EQ(forward_keys.size(), scale_factor);
+  EXPECT_EQ(forward_leaves, reverse_leaves);
+  EXPECT_EQ(forward_keys, reverse_keys);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, DISABLED_BatchLookupBenchmark) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(1000, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 32, 32);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  std::vector<int64_t> keys;
+  int64_t scale_factor = 20000;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    keys.push_back(key * 4 + 1);
+  }
+  InsertHelper(&tree, keys);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+
+  // one descent per key against sorted batches of the same random probes, as the index nested loop join issues them
+  tree.SetOptimisticLatching(false);
+  for (size_t batch_size : {1, 16, 256, 4096}) {
+    auto start = std::chrono::steady_clock::now();
+    BatchLookupHelper(&tree, keys, batch_size);
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("batch size %4zu: %.0f lookups/s\n", batch_size, scale_factor * 1000 / elapsed_ms);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
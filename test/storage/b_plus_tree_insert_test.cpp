@@ -142,4 +142,142 @@ TEST(BPlusTreeTests, InsertTest2) {
   remove("test.db");
   remove("test.log");
 }
+
+TEST(BPlusTreeTests, IteratorRangeTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  // a pool this small runs dry long before the last of the hundred iterators below unless each gives its leaf back
+  BufferPoolManager *bpm = new BufferPoolManager(20, disk_manager);
+  // create b+ tree with small leaves so most start keys fall between two leaves
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 3);
+  GenericKey<8> index_key;
+  RID rid;
+  // create transaction
+  Transaction *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  for (int64_t key = 1; key < 100; key += 2) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+
+  for (int64_t start_key = 0; start_key <= 100; start_key++) {
+    index_key.SetFromInteger(start_key);
+    auto iterator = tree.Begin(index_key);
+    int64_t expected = start_key % 2 == 0 ? start_key + 1 : start_key;
+    if (expected > 99) {
+      EXPECT_TRUE(iterator == tree.end());
+      continue;
+    }
+    // stop after a few keys, the rest of the tree is never touched
+    for (int i = 0; i < 3 && iterator != tree.end(); i++, ++iterator) {
+      EXPECT_EQ((*iterator).second.GetSlotNum(), expected);
+      expected += 2;
+    }
+  }
+
+  // nothing stays latched either, writers still get through
+  for (int64_t key = 2; key <= 100; key += 2) {
+    {
+      auto iterator = tree.begin();
+      ++iterator;
+    }
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+  }
+  int64_t current_key = 1;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key++;
+  }
+  EXPECT_EQ(current_key, 101);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, ReverseIteratorTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(20, disk_manager);
+  // create b+ tree with small leaves so most start keys fall between two leaves
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 3);
+  GenericKey<8> index_key;
+  RID rid;
+  // create transaction
+  Transaction *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  EXPECT_TRUE(tree.rbegin() == tree.rend());
+  for (int64_t key = 1; key < 100; key += 2) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+
+  int64_t current_key = 99;
+  for (auto iterator = tree.rbegin(); iterator != tree.rend(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key -= 2;
+  }
+  EXPECT_EQ(current_key, -1);
+
+  // a reverse scan starts at the largest key not greater than the start key
+  for (int64_t start_key = 0; start_key <= 100; start_key++) {
+    index_key.SetFromInteger(start_key);
+    auto iterator = tree.RBegin(index_key);
+    int64_t expected = start_key % 2 == 0 ? start_key - 1 : start_key;
+    if (expected < 1) {
+      EXPECT_TRUE(iterator == tree.rend());
+      continue;
+    }
+    for (int i = 0; i < 3 && iterator != tree.rend(); i++, ++iterator) {
+      EXPECT_EQ((*iterator).second.GetSlotNum(), expected);
+      expected -= 2;
+    }
+  }
+
+  // splits of the leaves in between keep the previous page ids right
+  for (int64_t key = 2; key <= 100; key += 2) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+  current_key = 100;
+  for (auto iterator = tree.rbegin(); iterator != tree.rend(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key--;
+  }
+  EXPECT_EQ(current_key, 0);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
@@ -0,0 +1,149 @@
+/**
+ * b_plus_tree_iterator_test.cpp
+ */
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+// the batches from start key on hold the same items as stepping the iterator one item at a time
+void CheckBatches(Tree *tree, int64_t start, int64_t num_keys) {
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(start);
+  std::vector<std::pair<GenericKey<8>, RID>> items;
+  for (auto iterator = tree->Begin(index_key); !iterator.isEnd(); ++iterator) {
+    items.push_back(*iterator);
+  }
+  ASSERT_EQ(items.size(), num_keys - start);
+
+  std::vector<std::pair<GenericKey<8>, RID>> batch;
+  size_t batches = 0;
+  auto iterator = tree->Begin(index_key);
+  while (true) {
+    size_t before = batch.size();
+    size_t count = iterator.NextBatch(&batch);
+    EXPECT_EQ(batch.size(), before + count);
+    if (count == 0) {
+      break;
+    }
+    batches++;
+  }
+  EXPECT_TRUE(iterator.isEnd());
+  EXPECT_EQ(iterator.NextBatch(&batch), 0);
+  // one batch per leaf
+  EXPECT_GT(batches, 1);
+  EXPECT_LT(batches, items.size());
+  ASSERT_EQ(batch.size(), items.size());
+  for (size_t i = 0; i < items.size(); i++) {
+    EXPECT_EQ(batch[i].first.ToString(), start + static_cast<int64_t>(i));
+    EXPECT_EQ(batch[i].second, items[i].second);
+  }
+}
+
+TEST(BPlusTreeIteratorTest, BatchTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  Transaction *transaction = new Transaction(0);
+
+  const int64_t num_keys = 2000;
+  Tree plain("plain", bpm, comparator, 16, 16);
+  Tree compressed("compressed", bpm, comparator, 64, 64, true);
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(plain.Insert(index_key, RID(0, static_cast<uint32_t>(key)), transaction));
+    EXPECT_TRUE(compressed.Insert(index_key, RID(0, static_cast<uint32_t>(key)), transaction));
+  }
+  // from the first key, and from a key in the middle of a leaf
+  CheckBatches(&plain, 0, num_keys);
+  CheckBatches(&plain, 1001, num_keys);
+  CheckBatches(&compressed, 0, num_keys);
+  CheckBatches(&compressed, 1001, num_keys);
+
+  delete transaction;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeIteratorTest, DISABLED_BenchmarkTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(1000, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  Transaction *transaction = new Transaction(0);
+
+  const int64_t num_keys = 100000;
+  const int rounds = 10;
+  Tree tree("foo_pk", bpm, comparator);
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(0, static_cast<uint32_t>(key)), transaction);
+  }
+
+  int64_t sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < rounds; round++) {
+    for (auto iterator = tree.begin(); !iterator.isEnd(); ++iterator) {
+      sum += (*iterator).second.GetSlotNum();
+    }
+  }
+  double item_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  int64_t batch_sum = 0;
+  std::vector<std::pair<GenericKey<8>, RID>> batch;
+  start = std::chrono::steady_clock::now();
+  for (int round = 0; round < rounds; round++) {
+    auto iterator = tree.begin();
+    while (true) {
+      batch.clear();
+      if (iterator.NextBatch(&batch) == 0) {
+        break;
+      }
+      for (auto &item : batch) {
+        batch_sum += item.second.GetSlotNum();
+      }
+    }
+  }
+  double batch_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  EXPECT_EQ(sum, batch_sum);
+  EXPECT_EQ(sum, rounds * num_keys * (num_keys - 1) / 2);
+  printf("scan of %ld keys: one item at a time %.0f/s, a leaf at a time %.0f/s\n", num_keys,
+         rounds * num_keys / item_ms * 1000, rounds * num_keys / batch_ms * 1000);
+
+  delete transaction;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,186 @@
+/**
+ * b_plus_tree_key_compression_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+using Key = GenericKey<64>;
+using Tree = BPlusTree<Key, RID, GenericComparator<64>>;
+using Entry = std::pair<int64_t, int64_t>;
+
+// max sizes beyond what a page holds are cut down to the compressed capacity
+const int MAX_SIZE = PAGE_SIZE;
+
+const char *const KEY_SCHEMA = "a bigint,b bigint,c bigint,d bigint,e bigint,f bigint,g bigint,h bigint";
+
+// six columns that repeat the tenant, then the id and a column that is always zero
+Key MakeKey(int64_t tenant, int64_t id) {
+  int64_t columns[8] = {tenant, tenant, tenant, tenant, tenant, tenant, id, 0};
+  Key key;
+  memcpy(key.data_, columns, sizeof(columns));
+  return key;
+}
+
+// check the tree holds exactly entries (sorted) in both directions, returns the number of leaves
+size_t CheckTree(Tree *tree, const std::vector<Entry> &entries) {
+  std::vector<RID> rids;
+  for (auto &entry : entries) {
+    rids.clear();
+    EXPECT_TRUE(tree->GetValue(MakeKey(entry.first, entry.second), &rids));
+    EXPECT_EQ(rids.size(), 1);
+    if (!rids.empty()) {
+      EXPECT_EQ(rids[0], RID(entry.first, entry.second));
+    }
+  }
+  size_t count = 0;
+  std::set<page_id_t> leaves;
+  for (auto iterator = tree->begin(); iterator != tree->end(); ++iterator) {
+    leaves.insert(iterator.GetPageId());
+    EXPECT_LT(count, entries.size());
+    if (count < entries.size()) {
+      EXPECT_EQ((*iterator).second, RID(entries[count].first, entries[count].second));
+    }
+    count++;
+  }
+  EXPECT_EQ(count, entries.size());
+  for (auto iterator = tree->rbegin(); iterator != tree->rend(); ++iterator) {
+    EXPECT_GT(count, 0);
+    if (count > 0) {
+      count--;
+      EXPECT_EQ((*iterator).second, RID(entries[count].first, entries[count].second));
+    }
+  }
+  EXPECT_EQ(count, 0);
+  return leaves.size();
+}
+
+TEST(BPlusTreeKeyCompressionTest, FanoutTest) {
+  Schema *key_schema = ParseCreateStatement(KEY_SCHEMA);
+  GenericComparator<64> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  Transaction *transaction = new Transaction(0);
+
+  std::vector<Entry> entries;
+  for (int64_t id = 1; id <= 20000; id++) {
+    entries.emplace_back(7, id);
+  }
+  Tree full_width("full_width", bpm, comparator);
+  Tree compressed("compressed", bpm, comparator, MAX_SIZE, MAX_SIZE, true);
+  for (auto &entry : entries) {
+    EXPECT_TRUE(full_width.Insert(MakeKey(entry.first, entry.second), RID(entry.first, entry.second), transaction));
+    EXPECT_TRUE(compressed.Insert(MakeKey(entry.first, entry.second), RID(entry.first, entry.second), transaction));
+  }
+  EXPECT_FALSE(compressed.Insert(MakeKey(7, 1), RID(7, 1), transaction));
+  size_t full_width_leaves = CheckTree(&full_width, entries);
+  size_t compressed_leaves = CheckTree(&compressed, entries);
+  // the keys only differ in the low bytes of the id, a compressed leaf holds up to twice as many
+  EXPECT_LT(compressed_leaves * 4, full_width_leaves * 3);
+
+  // bulk loaded leaves are filled as far as the keys fit
+  Tree loaded("loaded", bpm, comparator, MAX_SIZE, MAX_SIZE, true);
+  size_t pos = 0;
+  EXPECT_TRUE(loaded.BulkLoad(
+      [&entries, &pos](Key *key, RID *value) {
+        if (pos == entries.size()) {
+          return false;
+        }
+        *key = MakeKey(entries[pos].first, entries[pos].second);
+        *value = RID(entries[pos].first, entries[pos].second);
+        pos++;
+        return true;
+      },
+      1.0));
+  EXPECT_LT(CheckTree(&loaded, entries) * 2, full_width_leaves);
+
+  delete transaction;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeKeyCompressionTest, MixedKeysTest) {
+  Schema *key_schema = ParseCreateStatement(KEY_SCHEMA);
+  GenericComparator<64> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  Transaction *transaction = new Transaction(0);
+
+  // tenants of different widths, a page that gets a key of another tenant has to widen its slots
+  std::vector<Entry> entries;
+  for (int64_t tenant : {0L, 1L, 0x100L, 0x10101010L, 0x7F7F7F7F7F7FL}) {
+    for (int64_t id = 0; id < 1500; id++) {
+      entries.emplace_back(tenant, id * 0x10001);
+    }
+  }
+  std::sort(entries.begin(), entries.end());
+
+  for (auto sizes : {std::make_pair(3, 3), std::make_pair(8, 5), std::make_pair(MAX_SIZE, MAX_SIZE)}) {
+    Tree tree("foo_pk", bpm, comparator, sizes.first, sizes.second, true);
+    std::vector<Entry> shuffled(entries);
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(sizes.first));
+    for (auto &entry : shuffled) {
+      EXPECT_TRUE(tree.Insert(MakeKey(entry.first, entry.second), RID(entry.first, entry.second), transaction));
+    }
+    CheckTree(&tree, entries);
+
+    // remove every other key of each tenant and a whole tenant, the pages are rebalanced where the keys fit
+    std::vector<Entry> remaining;
+    for (auto &entry : shuffled) {
+      if (entry.first == 0x100 || entry.second % 2 == 1) {
+        tree.Remove(MakeKey(entry.first, entry.second), transaction);
+      }
+    }
+    for (auto &entry : entries) {
+      if (entry.first != 0x100 && entry.second % 2 == 0) {
+        remaining.push_back(entry);
+      }
+    }
+    CheckTree(&tree, remaining);
+    std::vector<RID> rids;
+    EXPECT_FALSE(tree.GetValue(MakeKey(0x100, 0), &rids));
+
+    for (auto &entry : remaining) {
+      tree.Remove(MakeKey(entry.first, entry.second), transaction);
+    }
+    EXPECT_TRUE(tree.IsEmpty());
+  }
+
+  delete transaction;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,190 @@
+/**
+ * b_plus_tree_key_normalization_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+int Sign(int cmp) { return (cmp > 0) - (cmp < 0); }
+
+TEST(KeyNormalizationTest, OrderTest) {
+  Schema *key_schema = ParseCreateStatement("a integer,b varchar(16),c double,d smallint");
+  GenericComparator<64> generic_comparator(key_schema);
+  NormalizedComparator<64> normalized_comparator(key_schema);
+
+  // few distinct values per column, so that many keys tie on the leading columns
+  std::mt19937 rng(15445);
+  const char *strs[] = {"", "a", "ab", "abc", "b", "ba", "zzzzzzzzzzzzzzz"};
+  const double decimals[] = {-1e300, -2.5, -0.001, 0.0, 0.001, 2.5, 1e300};
+  std::vector<std::vector<Value>> rows;
+  for (int i = 0; i < 300; i++) {
+    rows.push_back({ValueFactory::GetIntegerValue(static_cast<int32_t>(rng() % 5) - 2),
+                    ValueFactory::GetVarcharValue(strs[rng() % 7]), ValueFactory::GetDecimalValue(decimals[rng() % 7]),
+                    ValueFactory::GetSmallIntValue(static_cast<int16_t>(rng() % 65535 - 32767))});
+  }
+
+  std::vector<GenericKey<64>> generic_keys(rows.size());
+  std::vector<NormalizedKey<64>> normalized_keys(rows.size());
+  for (size_t i = 0; i < rows.size(); i++) {
+    Tuple tuple(rows[i], key_schema);
+    generic_keys[i].SetFromKey(tuple, key_schema);
+    normalized_keys[i].SetFromKey(tuple, key_schema);
+    // the columns can be read back from the normalized key
+    for (uint32_t col = 0; col < key_schema->GetColumnCount(); col++) {
+      EXPECT_EQ(normalized_keys[i].ToValue(key_schema, col).CompareEquals(rows[i][col]), CmpBool::CmpTrue);
+    }
+  }
+  for (size_t i = 0; i < rows.size(); i++) {
+    for (size_t j = 0; j < rows.size(); j++) {
+      EXPECT_EQ(Sign(normalized_comparator(normalized_keys[i], normalized_keys[j])),
+                Sign(generic_comparator(generic_keys[i], generic_keys[j])));
+    }
+  }
+
+  // a key that does not fit in the key size is rejected rather than cut short
+  Schema *long_schema = ParseCreateStatement("a varchar(32)");
+  NormalizedKey<8> key;
+  EXPECT_THROW(key.SetFromKey(Tuple({ValueFactory::GetVarcharValue("longer than 8")}, long_schema), long_schema),
+               Exception);
+
+  delete long_schema;
+  delete key_schema;
+}
+
+TEST(KeyNormalizationTest, IndexTest) {
+  Schema *schema = ParseCreateStatement("a bigint,b varchar(20)");
+  std::vector<uint32_t> key_attrs{1, 0};
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  Transaction *transaction = new Transaction(0);
+
+  // an index on (b, a) with negative numbers and strings that share prefixes
+  auto *metadata = new IndexMetadata("foo_idx", "foo", schema, key_attrs);
+  BPlusTreeIndex<NormalizedKey<32>, RID, NormalizedComparator<32>> index(metadata, bpm);
+  std::vector<std::pair<std::string, int64_t>> keys;
+  for (int64_t i = -500; i < 500; i++) {
+    keys.emplace_back(std::string("key") + std::string(static_cast<size_t>(i + 500) % 7, 'x'), i * 1000003);
+  }
+  std::vector<std::pair<std::string, int64_t>> shuffled(keys);
+  std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(15445));
+  for (auto &key : shuffled) {
+    Tuple tuple({ValueFactory::GetBigIntValue(key.second), ValueFactory::GetVarcharValue(key.first)}, schema);
+    index.InsertEntry(tuple.KeyFromTuple(*schema, *metadata->GetKeySchema(), key_attrs),
+                      RID(static_cast<page_id_t>(key.second >> 32), static_cast<uint32_t>(key.second)), transaction);
+  }
+
+  std::sort(keys.begin(), keys.end());
+  size_t count = 0;
+  for (auto iterator = index.GetBeginIterator(); !iterator.isEnd(); ++iterator) {
+    ASSERT_LT(count, keys.size());
+    EXPECT_EQ((*iterator).first.ToValue(metadata->GetKeySchema(), 0).ToString(), keys[count].first);
+    EXPECT_EQ((*iterator).first.ToValue(metadata->GetKeySchema(), 1).GetAs<int64_t>(), keys[count].second);
+    count++;
+  }
+  EXPECT_EQ(count, keys.size());
+
+  std::vector<RID> rids;
+  Tuple tuple({ValueFactory::GetBigIntValue(keys[10].second), ValueFactory::GetVarcharValue(keys[10].first)}, schema);
+  index.ScanKey(tuple.KeyFromTuple(*schema, *metadata->GetKeySchema(), key_attrs), &rids, transaction);
+  ASSERT_EQ(rids.size(), 1);
+  EXPECT_EQ(rids[0].GetSlotNum(), static_cast<uint32_t>(keys[10].second));
+
+  delete transaction;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// time binary searches over sorted keys of KeySize / 8 bigint columns with both comparators
+template <size_t KeySize>
+void BenchmarkComparators(const std::string &key_schema_str) {
+  Schema *key_schema = ParseCreateStatement(key_schema_str);
+  GenericComparator<KeySize> generic_comparator(key_schema);
+  NormalizedComparator<KeySize> normalized_comparator(key_schema);
+
+  const size_t num_keys = 4096;
+  const size_t num_searches = 20000;
+  std::mt19937_64 rng(15445);
+  std::vector<GenericKey<KeySize>> generic_keys(num_keys);
+  std::vector<NormalizedKey<KeySize>> normalized_keys(num_keys);
+  std::vector<Value> values;
+  for (size_t i = 0; i < num_keys; i++) {
+    values.clear();
+    for (size_t col = 0; col < KeySize / 8; col++) {
+      // the leading columns repeat so comparisons also look at the later ones
+      values.push_back(ValueFactory::GetBigIntValue(col + 1 < KeySize / 8 ? static_cast<int64_t>(rng() % 3) - 1
+                                                                            : static_cast<int64_t>(rng())));
+    }
+    Tuple tuple(values, key_schema);
+    generic_keys[i].SetFromKey(tuple, key_schema);
+    normalized_keys[i].SetFromKey(tuple, key_schema);
+  }
+  auto generic_less = [&](const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) {
+    return generic_comparator(lhs, rhs) < 0;
+  };
+  auto normalized_less = [&](const NormalizedKey<KeySize> &lhs, const NormalizedKey<KeySize> &rhs) {
+    return normalized_comparator(lhs, rhs) < 0;
+  };
+  std::vector<size_t> probes(num_searches);
+  for (auto &probe : probes) {
+    probe = rng() % num_keys;
+  }
+
+  std::vector<GenericKey<KeySize>> generic_sorted(generic_keys);
+  std::sort(generic_sorted.begin(), generic_sorted.end(), generic_less);
+  auto start = std::chrono::steady_clock::now();
+  size_t generic_sum = 0;
+  for (size_t probe : probes) {
+    generic_sum += std::lower_bound(generic_sorted.begin(), generic_sorted.end(), generic_keys[probe], generic_less) -
+                   generic_sorted.begin();
+  }
+  double generic_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  std::vector<NormalizedKey<KeySize>> normalized_sorted(normalized_keys);
+  std::sort(normalized_sorted.begin(), normalized_sorted.end(), normalized_less);
+  start = std::chrono::steady_clock::now();
+  size_t normalized_sum = 0;
+  for (size_t probe : probes) {
+    normalized_sum += std::lower_bound(normalized_sorted.begin(), normalized_sorted.end(), normalized_keys[probe],
+                                       normalized_less) -
+                      normalized_sorted.begin();
+  }
+  double normalized_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  // both find every key at the same position
+  EXPECT_EQ(generic_sum, normalized_sum);
+  EXPECT_LT(normalized_ms, generic_ms);
+  printf("GenericKey<%zu>: %zu binary searches over %zu keys, Value comparator %.2f ms, memcmp comparator %.2f ms\n",
+         KeySize, num_searches, num_keys, generic_ms, normalized_ms);
+  delete key_schema;
+}
+
+TEST(KeyNormalizationTest, DISABLED_ComparatorBenchmarkTest) {
+  BenchmarkComparators<8>("a bigint");
+  BenchmarkComparators<16>("a bigint,b bigint");
+  BenchmarkComparators<32>("a bigint,b bigint,c bigint,d bigint");
+  BenchmarkComparators<64>("a bigint,b bigint,c bigint,d bigint,e bigint,f bigint,g bigint,h bigint");
+}
+
+}  // namespace bustub
@@ -0,0 +1,254 @@
+/**
+ * b_plus_tree_key_search_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/key_search.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// sorted keys interleaved with stride - 8 bytes of values, as in the pages
+template <typename KeyType>
+std::vector<char> LayOutKeys(const std::vector<int64_t> &ints, size_t stride) {
+  std::vector<char> buffer(ints.size() * stride + 1, 0);
+  for (size_t i = 0; i < ints.size(); i++) {
+    KeyType key;
+    key.SetFromInteger(ints[i]);
+    memcpy(&buffer[i * stride], key.data_, sizeof(key.data_));
+  }
+  return buffer;
+}
+
+template <typename KeyType, typename KeyComparator>
+void CheckCountLess(const std::vector<int64_t> &ints, size_t stride) {
+  using Search = KeySearch<KeyType, KeyComparator>;
+  std::vector<char> buffer = LayOutKeys<KeyType>(ints, stride);
+  std::vector<int64_t> probes(ints);
+  probes.push_back(INT64_MIN);
+  probes.push_back(INT64_MAX);
+  for (int64_t i : ints) {
+    probes.push_back(i - 1);
+    probes.push_back(i + 1);
+  }
+  for (int64_t probe : probes) {
+    KeyType key;
+    key.SetFromInteger(probe);
+    int size = static_cast<int>(ints.size());
+    EXPECT_EQ(Search::CountLess(buffer.data(), stride, size, key, false),
+              std::lower_bound(ints.begin(), ints.end(), probe) - ints.begin());
+    EXPECT_EQ(Search::CountLess(buffer.data(), stride, size, key, true),
+              std::upper_bound(ints.begin(), ints.end(), probe) - ints.begin());
+  }
+}
+
+TEST(KeySearchTest, CountLessTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  EXPECT_TRUE((KeySearch<GenericKey<8>, GenericComparator<8>>::Applies(comparator)));
+  Schema *int_schema = ParseCreateStatement("a integer,b integer");
+  EXPECT_FALSE((KeySearch<GenericKey<8>, GenericComparator<8>>::Applies(GenericComparator<8>(int_schema))));
+
+  // every size around the binary search window and the four key lanes, with negative keys and duplicates
+  std::mt19937_64 rng(15445);
+  for (size_t size = 0; size < 70; size++) {
+    std::vector<int64_t> ints(size);
+    for (auto &i : ints) {
+      i = static_cast<int64_t>(rng() % 64) - 32;
+    }
+    std::sort(ints.begin(), ints.end());
+    for (size_t stride : {12, 16}) {
+      CheckCountLess<GenericKey<8>, GenericComparator<8>>(ints, stride);
+      CheckCountLess<NormalizedKey<8>, NormalizedComparator<8>>(ints, stride);
+    }
+  }
+  std::vector<int64_t> ints(300);
+  for (auto &i : ints) {
+    i = static_cast<int64_t>(rng());
+  }
+  std::sort(ints.begin(), ints.end());
+  CheckCountLess<GenericKey<8>, GenericComparator<8>>(ints, 16);
+  CheckCountLess<NormalizedKey<8>, NormalizedComparator<8>>(ints, 12);
+
+  delete int_schema;
+  delete key_schema;
+}
+
+template <typename KeyType, typename KeyComparator>
+void CheckTreeLookups() {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  KeyComparator comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  Transaction *transaction = new Transaction(0);
+
+  BPlusTree<KeyType, RID, KeyComparator> tree("foo_pk", bpm, comparator);
+  std::vector<int64_t> ints;
+  for (int64_t i = -3000; i < 3000; i += 2) {
+    ints.push_back(i * 7919);
+  }
+  std::vector<int64_t> shuffled(ints);
+  std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(15445));
+  KeyType key;
+  for (int64_t i : shuffled) {
+    key.SetFromInteger(i);
+    EXPECT_TRUE(tree.Insert(key, RID(static_cast<int32_t>(i >> 32), static_cast<uint32_t>(i)), transaction));
+  }
+
+  std::vector<RID> rids;
+  for (int64_t i : ints) {
+    rids.clear();
+    key.SetFromInteger(i);
+    EXPECT_TRUE(tree.GetValue(key, &rids));
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), static_cast<uint32_t>(i));
+    // keys between the ones in the tree are not found
+    key.SetFromInteger(i + 1);
+    EXPECT_FALSE(tree.GetValue(key, &rids));
+  }
+  size_t count = 0;
+  key.SetFromInteger(ints[100] - 1);
+  for (auto iterator = tree.Begin(key); !iterator.isEnd(); ++iterator) {
+    EXPECT_EQ((*iterator).first.ToString(), ints[100 + count]);
+    count++;
+  }
+  EXPECT_EQ(count, ints.size() - 100);
+
+  delete transaction;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(KeySearchTest, TreeTest) {
+  CheckTreeLookups<GenericKey<8>, GenericComparator<8>>();
+  CheckTreeLookups<NormalizedKey<8>, NormalizedComparator<8>>();
+}
+
+TEST(KeySearchTest, DISABLED_BenchmarkTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  // the keys of a full leaf page, searched many times over
+  const size_t stride = sizeof(std::pair<GenericKey<8>, RID>);
+  const size_t num_keys = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / stride;
+  const size_t num_searches = 200000;
+  std::mt19937_64 rng(15445);
+  std::vector<int64_t> ints(num_keys);
+  for (auto &i : ints) {
+    i = static_cast<int64_t>(rng() >> 1) - INT64_MAX / 2;
+  }
+  std::sort(ints.begin(), ints.end());
+  std::vector<char> buffer = LayOutKeys<GenericKey<8>>(ints, stride);
+  std::vector<GenericKey<8>> probes(num_searches);
+  for (auto &probe : probes) {
+    probe.SetFromInteger(ints[rng() % num_keys]);
+  }
+  auto key_at = [&](size_t i) -> const GenericKey<8> & {
+    return *reinterpret_cast<const GenericKey<8> *>(&buffer[i * stride]);
+  };
+
+  // the binary search of the pages, comparing through Value
+  auto start = std::chrono::steady_clock::now();
+  size_t value_sum = 0;
+  for (const auto &probe : probes) {
+    size_t l = 0;
+    size_t r = num_keys;
+    while (l < r) {
+      size_t mid = (l + r) / 2;
+      if (comparator(key_at(mid), probe) < 0) {
+        l = mid + 1;
+      } else {
+        r = mid;
+      }
+    }
+    value_sum += l;
+  }
+  double value_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  // the same binary search on the integers
+  start = std::chrono::steady_clock::now();
+  size_t scalar_sum = 0;
+  for (const auto &probe : probes) {
+    int64_t needle = Int64KeySearch::Load<false>(probe.data_);
+    size_t l = 0;
+    size_t r = num_keys;
+    while (l < r) {
+      size_t mid = (l + r) / 2;
+      if (Int64KeySearch::Load<false>(&buffer[mid * stride]) < needle) {
+        l = mid + 1;
+      } else {
+        r = mid;
+      }
+    }
+    scalar_sum += l;
+  }
+  double scalar_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  size_t kernel_sum = 0;
+  for (const auto &probe : probes) {
+    kernel_sum += KeySearch<GenericKey<8>, GenericComparator<8>>::CountLess(buffer.data(), stride,
+                                                                              static_cast<int>(num_keys), probe, false);
+  }
+  double kernel_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  EXPECT_EQ(value_sum, scalar_sum);
+  EXPECT_EQ(value_sum, kernel_sum);
+  EXPECT_LT(kernel_ms, value_ms);
+  printf("%zu searches over %zu keys: Value comparator %.0f/s, int64 binary search %.0f/s, search kernel %.0f/s\n",
+         num_searches, num_keys, num_searches / value_ms * 1000, num_searches / scalar_ms * 1000,
+         num_searches / kernel_ms * 1000);
+
+  // point lookups through a tree that fits in the buffer pool
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(1000, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  Transaction *transaction = new Transaction(0);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+  GenericKey<8> key;
+  for (int64_t i = 0; i < 100000; i++) {
+    key.SetFromInteger(i);
+    tree.Insert(key, RID(0, static_cast<uint32_t>(i)), transaction);
+  }
+  std::vector<RID> rids;
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_searches; i++) {
+    key.SetFromInteger(static_cast<int64_t>(rng() % 100000));
+    tree.GetValue(key, &rids);
+  }
+  double tree_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  EXPECT_EQ(rids.size(), num_searches);
+  printf("%zu tree lookups over 100000 keys: %.0f/s\n", num_searches, num_searches / tree_ms * 1000);
+
+  delete transaction;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
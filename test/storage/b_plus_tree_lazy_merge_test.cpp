@@ -0,0 +1,237 @@
+/**
+ * b_plus_tree_lazy_merge_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <random>
+#include <set>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+using LazyTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+// the tree holds exactly keys, returns the number of non-root leaves that are less than half full
+size_t CheckLazyTree(LazyTree *tree, const std::set<int64_t> &keys, BufferPoolManager *bpm) {
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (int64_t key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree->GetValue(index_key, &rids));
+    EXPECT_EQ(rids.size(), 1);
+  }
+  std::set<page_id_t> leaves;
+  auto it = keys.begin();
+  for (auto iterator = tree->begin(); !iterator.isEnd(); ++iterator) {
+    leaves.insert(iterator.GetPageId());
+    EXPECT_TRUE(it != keys.end());
+    if (it != keys.end()) {
+      EXPECT_EQ((*iterator).first.ToString(), *it);
+      ++it;
+    }
+  }
+  EXPECT_TRUE(it == keys.end());
+  size_t underfull = 0;
+  for (page_id_t page_id : leaves) {
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(
+        bpm->FetchPage(page_id)->GetData());
+    if (!leaf->IsRootPage() && leaf->GetSize() < leaf->GetMinSize()) {
+      underfull++;
+    }
+    bpm->UnpinPage(page_id, false);
+  }
+  return underfull;
+}
+
+// removes a key and inserts it again right away, many times, returns the leaves the removes rebalanced
+size_t RemoveAndReinsert(bool lazy, size_t *underfull) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  Transaction *transaction = new Transaction(0);
+
+  LazyTree tree("foo_pk", bpm, comparator, 16, 16);
+  std::set<int64_t> keys;
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < 2000; key++) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(0, static_cast<uint32_t>(key)), transaction);
+    keys.insert(key);
+  }
+  // shrink the leaves to around half full
+  std::mt19937 rng(15445);
+  for (int64_t key = 0; key < 2000; key++) {
+    if (rng() % 3 == 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+      keys.erase(key);
+    }
+  }
+  tree.SetLazyMerge(lazy);
+  size_t rebalanced = tree.GetRemoveRebalanceCount();
+  std::vector<int64_t> remaining(keys.begin(), keys.end());
+  for (int round = 0; round < 20000; round++) {
+    int64_t key = remaining[rng() % remaining.size()];
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, static_cast<uint32_t>(key)), transaction));
+  }
+  rebalanced = tree.GetRemoveRebalanceCount() - rebalanced;
+
+  // disabling lazy merging rebalances every leaf left behind
+  tree.SetLazyMerge(false);
+  *underfull = CheckLazyTree(&tree, keys, bpm);
+
+  delete transaction;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+  return rebalanced;
+}
+
+TEST(BPlusTreeLazyMergeTest, RemoveReinsertTest) {
+  size_t eager_underfull = 0;
+  size_t lazy_underfull = 0;
+  size_t eager = RemoveAndReinsert(false, &eager_underfull);
+  size_t lazy = RemoveAndReinsert(true, &lazy_underfull);
+  printf("20000 removes and inserts of the same keys: %zu leaves rebalanced by removes, %zu with lazy merging\n", eager,
+         lazy);
+  EXPECT_LT(lazy * 4, eager);
+  EXPECT_EQ(eager_underfull, 0);
+  EXPECT_EQ(lazy_underfull, 0);
+}
+
+TEST(BPlusTreeLazyMergeTest, RebalanceTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  Transaction *transaction = new Transaction(0);
+
+  LazyTree tree("foo_pk", bpm, comparator, 16, 16);
+  tree.SetLazyMerge(true);
+  std::set<int64_t> keys;
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < 3000; key++) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(0, static_cast<uint32_t>(key)), transaction);
+    keys.insert(key);
+  }
+  // remove most keys in random order, which leaves some leaves less than half full for the background thread
+  std::vector<int64_t> order(keys.begin(), keys.end());
+  std::shuffle(order.begin(), order.end(), std::mt19937(15445));
+  for (size_t i = 0; i < order.size() * 2 / 3; i++) {
+    index_key.SetFromInteger(order[i]);
+    tree.Remove(index_key, transaction);
+    keys.erase(order[i]);
+  }
+  std::this_thread::sleep_for(b_plus_tree_maintenance_interval * 3);
+  tree.RebalanceUnderfull();
+  EXPECT_EQ(CheckLazyTree(&tree, keys, bpm), 0);
+
+  // the tree shrinks down to nothing and grows again
+  for (int64_t key : order) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+  EXPECT_EQ(tree.RebalanceUnderfull(), 0);
+  index_key.SetFromInteger(1);
+  EXPECT_TRUE(tree.Insert(index_key, RID(0, 1), transaction));
+  tree.SetLazyMerge(false);
+
+  delete transaction;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeLazyMergeTest, ConcurrentTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(100, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  auto saved_interval = b_plus_tree_maintenance_interval;
+  b_plus_tree_maintenance_interval = std::chrono::milliseconds(1);
+  LazyTree tree("foo_pk", bpm, comparator, 16, 16);
+  tree.SetLazyMerge(true);
+  // every thread inserts its keys, removes most of them and inserts some again, while the leaves are rebalanced
+  // in the background
+  std::vector<std::thread> threads;
+  for (int64_t t = 0; t < 4; t++) {
+    threads.emplace_back([&, t] {
+      Transaction transaction(static_cast<txn_id_t>(t));
+      GenericKey<8> index_key;
+      for (int64_t key = t; key < 8000; key += 4) {
+        index_key.SetFromInteger(key);
+        tree.Insert(index_key, RID(0, static_cast<uint32_t>(key)), &transaction);
+      }
+      for (int64_t key = t; key < 8000; key += 4) {
+        if (key % 10 != 0) {
+          index_key.SetFromInteger(key);
+          tree.Remove(index_key, &transaction);
+        }
+      }
+      for (int64_t key = t; key < 8000; key += 4) {
+        if (key % 10 == 5) {
+          index_key.SetFromInteger(key);
+          tree.Insert(index_key, RID(0, static_cast<uint32_t>(key)), &transaction);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  tree.SetLazyMerge(false);
+  b_plus_tree_maintenance_interval = saved_interval;
+
+  std::set<int64_t> keys;
+  for (int64_t key = 0; key < 8000; key++) {
+    if (key % 10 == 0 || key % 10 == 5) {
+      keys.insert(key);
+    }
+  }
+  EXPECT_EQ(CheckLazyTree(&tree, keys, bpm), 0);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,157 @@
+/**
+ * b_plus_tree_non_unique_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// the rids of entry i, spread over pages like the tuples of a table
+RID EntryRID(size_t i) { return RID(static_cast<page_id_t>(i / 50), static_cast<uint32_t>(i % 50)); }
+
+template <typename KeyType, typename KeyComparator>
+void CheckNonUniqueIndex(const std::string &key_schema_str, const std::vector<Value> &distinct) {
+  Schema *schema = ParseCreateStatement(key_schema_str);
+  std::vector<uint32_t> key_attrs{0};
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  Transaction *transaction = new Transaction(0);
+
+  auto *metadata = new IndexMetadata("foo_idx", "foo", schema, key_attrs);
+  BPlusTreeIndex<KeyType, RID, KeyComparator> index(metadata, bpm, false);
+  auto *unique_metadata = new IndexMetadata("foo_pk", "foo", schema, key_attrs);
+  BPlusTreeIndex<KeyType, RID, KeyComparator> unique_index(unique_metadata, bpm);
+  EXPECT_FALSE(index.IsUnique());
+  EXPECT_TRUE(unique_index.IsUnique());
+
+  // a low cardinality column, entry i has the value distinct[i % distinct.size()]
+  const size_t num_entries = 19800;
+  std::vector<size_t> order(num_entries);
+  for (size_t i = 0; i < num_entries; i++) {
+    order[i] = i;
+  }
+  std::shuffle(order.begin(), order.end(), std::mt19937(15445));
+  auto key_of = [&](size_t i) { return Tuple({distinct[i % distinct.size()]}, metadata->GetKeySchema()); };
+  for (size_t i : order) {
+    index.InsertEntry(key_of(i), EntryRID(i), transaction);
+    unique_index.InsertEntry(key_of(i), EntryRID(i), transaction);
+  }
+
+  // every entry of a key is found, in rid order, while the unique index kept one per key
+  std::vector<RID> rids;
+  for (size_t k = 0; k < distinct.size(); k++) {
+    rids.clear();
+    index.ScanKey(key_of(k), &rids, transaction);
+    ASSERT_EQ(rids.size(), num_entries / distinct.size());
+    for (size_t j = 0; j < rids.size(); j++) {
+      EXPECT_EQ(rids[j], EntryRID(k + j * distinct.size()));
+    }
+    rids.clear();
+    unique_index.ScanKey(key_of(k), &rids, transaction);
+    EXPECT_EQ(rids.size(), 1);
+  }
+
+  // the leaves hold more entries than fit at full width, since the duplicates share their key bytes
+  std::set<page_id_t> leaves;
+  size_t count = 0;
+  for (auto iterator = index.GetBeginIterator(); !iterator.isEnd(); ++iterator) {
+    leaves.insert(iterator.GetPageId());
+    count++;
+  }
+  EXPECT_EQ(count, num_entries);
+  size_t full_width_size = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<KeyType, RID>);
+  EXPECT_LT(leaves.size() * full_width_size, num_entries);
+  printf("%s: %zu entries with %zu distinct keys in %zu leaves, %zu entries fit a leaf at full width\n",
+         key_schema_str.c_str(), num_entries, distinct.size(), leaves.size(), full_width_size);
+
+  // deleting an entry leaves the other entries of its key alone
+  for (size_t i : order) {
+    if (i % 3 == 0) {
+      index.DeleteEntry(key_of(i), EntryRID(i), transaction);
+    }
+  }
+  std::vector<std::vector<RID>> results;
+  std::vector<Tuple> keys;
+  for (size_t k = 0; k < distinct.size(); k++) {
+    keys.push_back(key_of(k));
+  }
+  index.ScanKeys(keys, &results, transaction);
+  ASSERT_EQ(results.size(), distinct.size());
+  for (size_t k = 0; k < distinct.size(); k++) {
+    std::vector<RID> expected;
+    for (size_t i = k; i < num_entries; i += distinct.size()) {
+      if (i % 3 != 0) {
+        expected.push_back(EntryRID(i));
+      }
+    }
+    EXPECT_EQ(results[k], expected);
+  }
+
+  delete transaction;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeNonUniqueTest, GenericKeyTest) {
+  std::vector<Value> distinct;
+  for (int32_t i = -5; i < 5; i++) {
+    distinct.push_back(ValueFactory::GetIntegerValue(i * 1000));
+  }
+  CheckNonUniqueIndex<GenericKey<16>, GenericComparator<16>>("a integer", distinct);
+}
+
+TEST(BPlusTreeNonUniqueTest, NormalizedKeyTest) {
+  std::vector<Value> distinct;
+  for (const char *str : {"", "a", "ab", "abc", "b", "zzzz"}) {
+    distinct.push_back(ValueFactory::GetVarcharValue(str));
+  }
+  CheckNonUniqueIndex<NormalizedKey<16>, NormalizedComparator<16>>("a varchar(6)", distinct);
+}
+
+TEST(BPlusTreeNonUniqueTest, KeySizeTest) {
+  Schema *schema = ParseCreateStatement("a integer");
+  std::vector<uint32_t> key_attrs{0};
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  Transaction *transaction = new Transaction(0);
+
+  // the key and the rid do not fit in 8 bytes
+  BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> index(new IndexMetadata("foo_idx", "foo", schema, key_attrs),
+                                                                 bpm, false);
+  EXPECT_THROW(index.InsertEntry(Tuple({ValueFactory::GetIntegerValue(1)}, index.GetKeySchema()), RID(0, 0),
+                                 transaction),
+               Exception);
+
+  delete transaction;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,252 @@
+/**
+ * var_b_plus_tree_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/var_b_plus_tree.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+VarKey MakeVarKey(const std::string &str, Schema *key_schema) {
+  Tuple tuple({ValueFactory::GetVarcharValue(str)}, key_schema);
+  VarKey key;
+  key.SetFromKey(tuple);
+  return key;
+}
+
+RID MakeRID(size_t i) { return RID(static_cast<page_id_t>(i >> 16), static_cast<uint32_t>(i & 0xFFFF)); }
+
+// check the tree holds exactly strs (sorted), the value of strs[i] is MakeRID(i), returns the number of leaves
+size_t CheckTree(VarBPlusTree *tree, const std::vector<std::string> &strs, Schema *key_schema) {
+  std::vector<RID> rids;
+  for (size_t i = 0; i < strs.size(); i++) {
+    rids.clear();
+    EXPECT_TRUE(tree->GetValue(MakeVarKey(strs[i], key_schema), &rids));
+    EXPECT_EQ(rids.size(), 1);
+    if (!rids.empty()) {
+      EXPECT_EQ(rids[0], MakeRID(i));
+    }
+  }
+  size_t count = 0;
+  std::set<page_id_t> leaves;
+  for (auto iterator = tree->begin(); iterator != tree->end(); ++iterator) {
+    leaves.insert(iterator.GetPageId());
+    EXPECT_LT(count, strs.size());
+    if (count < strs.size()) {
+      EXPECT_EQ((*iterator).first.ToValue(key_schema, 0).ToString(), strs[count]);
+      EXPECT_EQ((*iterator).second, MakeRID(count));
+    }
+    count++;
+  }
+  EXPECT_EQ(count, strs.size());
+  return leaves.size();
+}
+
+TEST(VarBPlusTreeTest, InsertScanRemoveTest) {
+  Schema *key_schema = ParseCreateStatement("a varchar(300)");
+  VarKeyComparator comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  Transaction *transaction = new Transaction(0);
+
+  // short and long keys, the longest ones leave room for only a few keys per page
+  std::mt19937 rng(15445);
+  std::set<std::string> unique;
+  while (unique.size() < 6000) {
+    std::string str = std::to_string(rng() % 1000000);
+    unique.insert(str + std::string(rng() % 3 == 0 ? rng() % 220 : rng() % 8, static_cast<char>('a' + rng() % 26)));
+  }
+  std::vector<std::string> strs(unique.begin(), unique.end());
+
+  VarBPlusTree tree("foo_pk", bpm, comparator);
+  std::vector<size_t> order(strs.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::shuffle(order.begin(), order.end(), rng);
+  for (size_t i : order) {
+    EXPECT_TRUE(tree.Insert(MakeVarKey(strs[i], key_schema), MakeRID(i), transaction));
+  }
+  EXPECT_FALSE(tree.Insert(MakeVarKey(strs[0], key_schema), MakeRID(0), transaction));
+  EXPECT_THROW(tree.Insert(MakeVarKey(std::string(VAR_KEY_MAX_SIZE, 'x'), key_schema), MakeRID(0), transaction),
+               Exception);
+  CheckTree(&tree, strs, key_schema);
+
+  // a scan from a key that is not in the tree starts at the next larger key
+  std::string middle = strs[strs.size() / 2];
+  auto iterator = tree.Begin(MakeVarKey(middle + "\x01", key_schema));
+  EXPECT_EQ((*iterator).second, MakeRID(strs.size() / 2 + 1));
+  iterator = tree.Begin(MakeVarKey(middle, key_schema));
+  EXPECT_EQ((*iterator).second, MakeRID(strs.size() / 2));
+  iterator = tree.end();
+
+  // remove two thirds of the keys in random order, the values of the others stay with their keys
+  std::vector<std::string> remaining;
+  for (size_t i : order) {
+    if (i % 3 != 0) {
+      tree.Remove(MakeVarKey(strs[i], key_schema), transaction);
+    }
+  }
+  std::vector<RID> rids;
+  for (size_t i = 0; i < strs.size(); i++) {
+    rids.clear();
+    EXPECT_EQ(tree.GetValue(MakeVarKey(strs[i], key_schema), &rids), i % 3 == 0);
+    if (i % 3 == 0) {
+      remaining.push_back(strs[i]);
+    }
+  }
+  size_t count = 0;
+  for (auto it = tree.begin(); it != tree.end(); ++it) {
+    EXPECT_EQ((*it).first.ToValue(key_schema, 0).ToString(), remaining[count]);
+    EXPECT_EQ((*it).second, MakeRID(count * 3));
+    count++;
+  }
+  EXPECT_EQ(count, remaining.size());
+
+  for (size_t i : order) {
+    tree.Remove(MakeVarKey(strs[i], key_schema), transaction);
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+  EXPECT_TRUE(tree.begin() == tree.end());
+
+  // the tree grows again after it became empty
+  EXPECT_TRUE(tree.Insert(MakeVarKey(strs[0], key_schema), MakeRID(0), transaction));
+  CheckTree(&tree, {strs[0]}, key_schema);
+
+  delete transaction;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(VarBPlusTreeTest, FanoutTest) {
+  Schema *key_schema = ParseCreateStatement("a varchar(48)");
+  VarKeyComparator comparator(key_schema);
+  GenericComparator<64> generic_comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  Transaction *transaction = new Transaction(0);
+
+  std::vector<std::string> strs;
+  for (int i = 0; i < 10000; i++) {
+    strs.push_back("user" + std::to_string(100000 + i));
+  }
+
+  // a GenericKey pads every key to its 64 bytes, a slotted page only stores the bytes of the key tuple
+  VarBPlusTree tree("var", bpm, comparator);
+  BPlusTree<GenericKey<64>, RID, GenericComparator<64>> generic_tree("generic", bpm, generic_comparator);
+  for (size_t i = 0; i < strs.size(); i++) {
+    EXPECT_TRUE(tree.Insert(MakeVarKey(strs[i], key_schema), MakeRID(i), transaction));
+    GenericKey<64> key;
+    key.SetFromKey(Tuple({ValueFactory::GetVarcharValue(strs[i])}, key_schema));
+    EXPECT_TRUE(generic_tree.Insert(key, MakeRID(i), transaction));
+  }
+  std::set<page_id_t> generic_leaves;
+  for (auto iterator = generic_tree.begin(); iterator != generic_tree.end(); ++iterator) {
+    generic_leaves.insert(iterator.GetPageId());
+  }
+  EXPECT_LT(CheckTree(&tree, strs, key_schema) * 3, generic_leaves.size() * 2);
+
+  delete transaction;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(VarBPlusTreeTest, ConcurrentTest) {
+  Schema *key_schema = ParseCreateStatement("a varchar(300)");
+  VarKeyComparator comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(100, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  std::vector<std::string> strs;
+  for (int i = 0; i < 4000; i++) {
+    strs.push_back(std::to_string(100000 + i) + std::string(i % 97, 'z'));
+  }
+  std::sort(strs.begin(), strs.end());
+
+  VarBPlusTree tree("foo_pk", bpm, comparator);
+  // each thread inserts and then removes every fourth key, while a scanner walks the leaves
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; t++) {
+    threads.emplace_back([&, t] {
+      Transaction transaction(t);
+      for (size_t i = t; i < strs.size(); i += 4) {
+        EXPECT_TRUE(tree.Insert(MakeVarKey(strs[i], key_schema), MakeRID(i), &transaction));
+      }
+      for (size_t i = t; i < strs.size(); i += 4) {
+        if (i % 8 >= 4) {
+          tree.Remove(MakeVarKey(strs[i], key_schema), &transaction);
+        }
+      }
+    });
+  }
+  threads.emplace_back([&] {
+    for (int round = 0; round < 20; round++) {
+      std::string last;
+      for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+        std::string str = (*iterator).first.ToValue(key_schema, 0).ToString();
+        EXPECT_LT(last, str);
+        last = str;
+      }
+    }
+  });
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::vector<std::string> remaining;
+  for (size_t i = 0; i < strs.size(); i++) {
+    if (i % 8 < 4) {
+      remaining.push_back(strs[i]);
+    }
+  }
+  size_t count = 0;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ((*iterator).first.ToValue(key_schema, 0).ToString(), remaining[count]);
+    count++;
+  }
+  EXPECT_EQ(count, remaining.size());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,328 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bustub_logdump.cpp
+//
+// Identification: tools/bustub_logdump.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cctype>
+#include <cinttypes>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "recovery/log_compressor.h"
+#include "recovery/log_record.h"
+#include "recovery/log_recovery.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+namespace {
+
+const char *LogRecordTypeName(LogRecordType type) {
+  switch (type) {
+    case LogRecordType::INSERT:
+      return "INSERT";
+    case LogRecordType::MARKDELETE:
+      return "MARKDELETE";
+    case LogRecordType::APPLYDELETE:
+      return "APPLYDELETE";
+    case LogRecordType::ROLLBACKDELETE:
+      return "ROLLBACKDELETE";
+    case LogRecordType::UPDATE:
+      return "UPDATE";
+    case LogRecordType::BEGIN:
+      return "BEGIN";
+    case LogRecordType::COMMIT:
+      return "COMMIT";
+    case LogRecordType::ABORT:
+      return "ABORT";
+    case LogRecordType::NEWPAGE:
+      return "NEWPAGE";
+    default:
+      return "INVALID";
+  }
+}
+
+std::string DescribeRecord(LogRecord *record) {
+  std::string detail;
+  auto rid_string = [](const RID &rid) {
+    return "(" + std::to_string(rid.GetPageId()) + "," + std::to_string(rid.GetSlotNum()) + ")";
+  };
+  switch (record->GetLogRecordType()) {
+    case LogRecordType::INSERT:
+      detail = " rid=" + rid_string(record->GetInsertRID()) +
+               " tuple=" + std::to_string(record->GetInsertTuple().GetLength());
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      detail = " rid=" + rid_string(record->GetDeleteRID()) +
+               " tuple=" + std::to_string(record->GetDeleteTuple().GetLength());
+      break;
+    case LogRecordType::UPDATE:
+      detail = " rid=" + rid_string(record->GetUpdateRID());
+      if (record->IsDeltaUpdate()) {
+        detail += " delta";
+      } else {
+        detail += " old=" + std::to_string(record->GetOriginalTuple().GetLength()) +
+                  " new=" + std::to_string(record->GetUpdateTuple().GetLength());
+      }
+      break;
+    case LogRecordType::NEWPAGE:
+      detail = " prev_page=" + std::to_string(record->GetNewPageRecord()) +
+               " page=" + std::to_string(record->GetNewPageId());
+      break;
+    default:
+      break;
+  }
+  return detail;
+}
+
+struct TypeStats {
+  int64_t count_{0};
+  int64_t bytes_{0};
+  int32_t max_size_{0};
+};
+
+struct TxnStats {
+  int64_t records_{0};
+  lsn_t last_lsn_{INVALID_LSN};
+  LogRecordType end_{LogRecordType::INVALID};
+};
+
+void Usage(const char *program) {
+  std::cerr << "usage: " << program << " <file.log> [options]\n"
+            << "  -v              print every log record\n"
+            << "  --txn           print the record chain of every transaction\n"
+            << "  --replay <db>   replay the log into a fresh database file and time redo/undo\n"
+            << "  --pool <pages>  buffer pool size used by --replay (default " << BUFFER_POOL_SIZE << ")\n";
+}
+
+/** Runs recovery on a copy of the log next to a fresh database file. */
+int Replay(const std::string &log_file, const std::string &db_file, size_t pool_size) {
+  std::string::size_type n = db_file.rfind('.');
+  if (n == std::string::npos) {
+    std::cerr << "database file needs an extension, e.g. replay.db" << std::endl;
+    return 1;
+  }
+  std::string replay_log = db_file.substr(0, n) + ".log";
+  if (replay_log == log_file) {
+    std::cerr << "the replay database must not share the input log" << std::endl;
+    return 1;
+  }
+  remove(db_file.c_str());
+  remove(replay_log.c_str());
+  {
+    std::ifstream in(log_file, std::ios::binary);
+    std::ofstream out(replay_log, std::ios::binary);
+    out << in.rdbuf();
+  }
+
+  auto *disk_manager = new DiskManager(db_file);
+  auto *bpm = new BufferPoolManager(pool_size, disk_manager);
+  auto *log_recovery = new LogRecovery(disk_manager, bpm);
+
+  auto start = std::chrono::steady_clock::now();
+  log_recovery->Redo();
+  auto redo_end = std::chrono::steady_clock::now();
+  log_recovery->Undo();
+  auto undo_end = std::chrono::steady_clock::now();
+  bpm->FlushAllPages();
+  auto flush_end = std::chrono::steady_clock::now();
+
+  auto ms = [](std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  };
+  printf("replay into %s (pool %zu pages): redo %.2f ms, undo %.2f ms, flush %.2f ms, %d page writes\n",
+         db_file.c_str(), pool_size, ms(redo_end - start), ms(undo_end - redo_end), ms(flush_end - undo_end),
+         disk_manager->GetNumWrites());
+
+  delete log_recovery;
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  return 0;
+}
+
+}  // namespace
+
+int LogDump(int argc, char **argv) {
+  if (argc < 2) {
+    Usage(argv[0]);
+    return 1;
+  }
+  std::string log_file = argv[1];
+  bool verbose = false;
+  bool print_txns = false;
+  std::string replay_db;
+  size_t pool_size = BUFFER_POOL_SIZE;
+  for (int i = 2; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-v") {
+      verbose = true;
+    } else if (arg == "--txn") {
+      print_txns = true;
+    } else if (arg == "--replay" && i + 1 < argc) {
+      replay_db = argv[++i];
+    } else if (arg == "--pool" && i + 1 < argc) {
+      const char *value = argv[++i];
+      char *end;
+      pool_size = std::strtoul(value, &end, 10);
+      if (std::isdigit(static_cast<unsigned char>(value[0])) == 0 || *end != '\0' || pool_size == 0) {
+        Usage(argv[0]);
+        return 1;
+      }
+    } else {
+      Usage(argv[0]);
+      return 1;
+    }
+  }
+
+  std::ifstream log(log_file, std::ios::binary);
+  if (!log.is_open()) {
+    std::cerr << "can't open " << log_file << std::endl;
+    return 1;
+  }
+
+  std::vector<char> stored(LOG_BUFFER_SIZE);
+  std::vector<char> batch(LOG_BUFFER_SIZE);
+  std::map<LogRecordType, TypeStats> type_stats;
+  std::map<txn_id_t, TxnStats> txn_stats;
+  std::unordered_map<txn_id_t, std::vector<lsn_t>> txn_chains;
+  int64_t frames = 0;
+  int64_t compressed_frames = 0;
+  int64_t file_bytes = 0;
+  int64_t raw_bytes = 0;
+  int64_t records = 0;
+  lsn_t last_lsn = INVALID_LSN;
+  bool damaged = false;
+
+  // same framing and deserializer as LogRecovery
+  LogRecord record;
+  char header[LogCompressor::FRAME_HEADER_SIZE];
+  while (log.read(header, LogCompressor::FRAME_HEADER_SIZE)) {
+    int32_t stored_size;
+    int32_t raw_size;
+    memcpy(&stored_size, header, sizeof(int32_t));
+    memcpy(&raw_size, header + sizeof(int32_t), sizeof(int32_t));
+    if (stored_size <= 0 || raw_size > LOG_BUFFER_SIZE || stored_size > raw_size ||
+        !log.read(stored.data(), stored_size)) {
+      damaged = true;
+      break;
+    }
+    if (stored_size < raw_size) {
+      compressed_frames++;
+      if (!LogCompressor::Decompress(stored.data(), stored_size, batch.data(), raw_size)) {
+        damaged = true;
+        break;
+      }
+    } else {
+      memcpy(batch.data(), stored.data(), raw_size);
+    }
+    if (verbose) {
+      printf("frame @%" PRId64 ": %d bytes stored, %d raw\n", file_bytes, stored_size, raw_size);
+    }
+    frames++;
+    file_bytes += LogCompressor::FRAME_HEADER_SIZE + stored_size;
+    raw_bytes += raw_size;
+
+    int32_t pos = 0;
+    while (pos < raw_size && record.DeserializeFrom(batch.data() + pos, raw_size - pos)) {
+      auto &stats = type_stats[record.GetLogRecordType()];
+      stats.count_++;
+      stats.bytes_ += record.GetSize();
+      stats.max_size_ = std::max(stats.max_size_, record.GetSize());
+      auto &txn = txn_stats[record.GetTxnId()];
+      txn.records_++;
+      txn.last_lsn_ = record.GetLSN();
+      if (record.GetLogRecordType() == LogRecordType::COMMIT || record.GetLogRecordType() == LogRecordType::ABORT) {
+        txn.end_ = record.GetLogRecordType();
+      }
+      if (print_txns) {
+        txn_chains[record.GetTxnId()].push_back(record.GetLSN());
+      }
+      if (verbose) {
+        printf("  lsn=%d txn=%d prev=%d %s size=%d%s\n", record.GetLSN(), record.GetTxnId(), record.GetPrevLSN(),
+               LogRecordTypeName(record.GetLogRecordType()), record.GetSize(), DescribeRecord(&record).c_str());
+      }
+      if (last_lsn != INVALID_LSN && record.GetLSN() != last_lsn + 1) {
+        printf("  warning: lsn %d follows lsn %d\n", record.GetLSN(), last_lsn);
+      }
+      last_lsn = record.GetLSN();
+      records++;
+      pos += record.GetSize();
+    }
+    if (pos != raw_size) {
+      damaged = true;
+      break;
+    }
+  }
+
+  printf("%s: %" PRId64 " records in %" PRId64 " frames (%" PRId64 " compressed), %" PRId64 " bytes on disk, %" PRId64
+         " bytes of records\n",
+         log_file.c_str(), records, frames, compressed_frames, file_bytes, raw_bytes);
+  if (damaged) {
+    printf("log ends with a damaged or incomplete frame after %" PRId64 " bytes\n", file_bytes);
+  }
+  printf("%-16s %10s %12s %8s %8s\n", "type", "records", "bytes", "avg", "max");
+  for (const auto &entry : type_stats) {
+    const auto &stats = entry.second;
+    printf("%-16s %10" PRId64 " %12" PRId64 " %8.1f %8d\n", LogRecordTypeName(entry.first), stats.count_,
+           stats.bytes_, 1.0 * stats.bytes_ / stats.count_, stats.max_size_);
+  }
+
+  int64_t committed = 0;
+  int64_t aborted = 0;
+  int64_t longest = 0;
+  std::vector<txn_id_t> losers;
+  for (const auto &entry : txn_stats) {
+    if (entry.second.end_ == LogRecordType::COMMIT) {
+      committed++;
+    } else if (entry.second.end_ == LogRecordType::ABORT) {
+      aborted++;
+    } else {
+      losers.push_back(entry.first);
+    }
+    longest = std::max(longest, entry.second.records_);
+  }
+  printf("transactions: %zu (%" PRId64 " committed, %" PRId64 " aborted, %zu without an end record), longest chain "
+         "%" PRId64 " records\n",
+         txn_stats.size(), committed, aborted, losers.size(), longest);
+  for (auto txn_id : losers) {
+    printf("  txn %d is undone by recovery, last lsn %d\n", txn_id, txn_stats[txn_id].last_lsn_);
+  }
+  if (print_txns) {
+    for (const auto &entry : txn_stats) {
+      printf("txn %d:", entry.first);
+      for (auto lsn : txn_chains[entry.first]) {
+        printf(" %d", lsn);
+      }
+      printf("\n");
+    }
+  }
+
+  if (!replay_db.empty()) {
+    return Replay(log_file, replay_db, pool_size);
+  }
+  return 0;
+}
+
+}  // namespace bustub
+
+int main(int argc, char **argv) { return bustub::LogDump(argc, argv); }